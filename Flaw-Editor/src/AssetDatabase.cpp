@@ -13,19 +13,156 @@ namespace flaw {
 
 	static Scope<filewatch::FileWatch<std::filesystem::path>> g_fileWatch;
 
+	// what the last session knew about an .asset file, files whose write time and size still match are not opened on startup
+	struct AssetIndexEntry {
+		uint64_t lastWriteTime = 0;
+		uint64_t fileSize = 0;
+		uint64_t dataOffset = 0;
+		AssetMetadata metadata;
+	};
+
+	template <>
+	struct Serializer<AssetIndexEntry> {
+		static void Serialize(SerializationArchive& archive, const AssetIndexEntry& value) {
+			archive << value.lastWriteTime;
+			archive << value.fileSize;
+			archive << value.dataOffset;
+			archive << value.metadata;
+		}
+
+		static void Deserialize(SerializationArchive& archive, AssetIndexEntry& value) {
+			archive >> value.lastWriteTime;
+			archive >> value.fileSize;
+			archive >> value.dataOffset;
+			archive >> value.metadata;
+		}
+	};
+
+	constexpr uint32_t AssetIndexMagic = 0x58444941; // "AIDX"
+	constexpr uint32_t AssetIndexVersion = 1;
+
+	static std::unordered_map<std::string, AssetIndexEntry> g_assetIndex;
+
+	static std::filesystem::path GetAssetIndexPath() {
+		return Project::GetConfig().path + "/Intermediate/AssetIndex.cache";
+	}
+
+	static void LoadAssetIndex() {
+		g_assetIndex.clear();
+
+		MappedFile file;
+		if (!file.Open(GetAssetIndexPath().generic_string().c_str())) {
+			return; // first time the project is opened
+		}
+
+		try {
+			SerializationArchive archive = SerializationArchive::View(file.Data(), file.Size());
+
+			uint32_t magic, version;
+			archive >> magic >> version;
+			if (magic != AssetIndexMagic || version != AssetIndexVersion) {
+				return;
+			}
+
+			archive >> g_assetIndex;
+		}
+		catch (const std::runtime_error&) {
+			Log::Warn("Asset index is broken, every asset file is read again");
+			g_assetIndex.clear();
+		}
+	}
+
+	static void SaveAssetIndex() {
+		// files that are gone or did not register are read again next time
+		for (auto it = g_assetIndex.begin(); it != g_assetIndex.end(); ) {
+			if (g_assetMetadataMap.find(it->first) == g_assetMetadataMap.end()) {
+				it = g_assetIndex.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+
+		const std::filesystem::path indexPath = GetAssetIndexPath();
+
+		std::error_code error;
+		std::filesystem::create_directories(indexPath.parent_path(), error);
+
+		SerializationArchive archive;
+		archive << AssetIndexMagic << AssetIndexVersion;
+		archive << g_assetIndex;
+
+		if (!FileSystem::WriteFile(indexPath.generic_string().c_str(), archive.Data(), archive.RemainingSize())) {
+			Log::Warn("Failed to write asset index: %s", indexPath.generic_string().c_str());
+		}
+	}
+
+	// parses only the metadata in front of the asset data, files copied outside the editor get a new handle
+	static bool ReadAssetHeader(const std::filesystem::path& assetFile, AssetIndexEntry& outEntry) {
+		MappedFile file;
+		if (!file.Open(assetFile.generic_string().c_str())) {
+			return false;
+		}
+
+		SerializationArchive archive = SerializationArchive::View(file.Data(), file.Size());
+
+		AssetMetadata metadata;
+		try {
+			archive >> metadata;
+		}
+		catch (const std::runtime_error&) {
+			Log::Warn("Asset file is too short for its metadata: %s", assetFile.generic_string().c_str());
+			return false;
+		}
+
+		const uint64_t assetDataOffset = archive.Offset();
+		const int8_t* assetDataBegin = archive.Data() + assetDataOffset;
+		const uint64_t assetDataSize = archive.RemainingSize();
+
+		uint64_t fileIndex = FileSystem::FileIndex(assetFile.generic_string().c_str());
+		if (metadata.fileIndex != fileIndex) {
+			//    . Ÿ ͸ ؾ .
+			metadata.handle = AssetManager::GenerateNewAssetHandle();
+			metadata.fileIndex = fileIndex;
+
+			SerializationArchive newArchive;
+			newArchive << metadata;
+			newArchive.Append(assetDataBegin, assetDataSize);
+
+			file.Close(); // the mapping would keep the file from being rewritten
+
+			if (!FileSystem::MakeFile(assetFile.generic_string().c_str(), newArchive.Data(), newArchive.RemainingSize())) {
+				return false;
+			}
+		}
+
+		std::error_code error;
+		outEntry.lastWriteTime = static_cast<uint64_t>(std::filesystem::last_write_time(assetFile, error).time_since_epoch().count());
+		outEntry.fileSize = std::filesystem::file_size(assetFile, error);
+		outEntry.dataOffset = assetDataOffset;
+		outEntry.metadata = metadata;
+
+		return true;
+	}
+
 	void AssetDatabase::Init(Application& application) {
 		g_application = &application;
 
 		auto& projectConfig = Project::GetConfig();
 		g_contentsDir = projectConfig.path + "/Contents";
 
+		LoadAssetIndex();
 		RegisterAssetsInFolder(GetContentsDirectory().generic_string().c_str());
+		SaveAssetIndex();
+
 		SetFileWatchState(true);
 	}
 
 	void AssetDatabase::Cleanup() {
 		SetFileWatchState(false);
 
+		SaveAssetIndex();
+
 		for (auto& [path, metadata] : g_assetMetadataMap) {
 			AssetManager::UnregisterAsset(metadata.handle);
 		}
@@ -76,223 +213,51 @@ namespace flaw {
 				continue;
 			}
 
-			std::vector<int8_t> fileData;
-			if (!FileSystem::ReadFile(assetFile.generic_string().c_str(), fileData)) {
-				continue;
-			}
-
-			SerializationArchive archive(fileData.data(), fileData.size());
-
-			AssetMetadata metadata;
-			archive >> metadata;
+			const std::string assetPath = assetFile.generic_string();
+			const uint64_t lastWriteTime = static_cast<uint64_t>(dir.last_write_time().time_since_epoch().count());
+			const uint64_t fileSize = dir.file_size();
 
-			const uint32_t assetDataOffset = archive.Offset();
-			const int8_t* assetDataBegin = archive.Data() + assetDataOffset;
-			const uint32_t assetDataSize = archive.RemainingSize();
+			AssetIndexEntry indexEntry;
 
-			uint64_t fileIndex = FileSystem::FileIndex(assetFile.generic_string().c_str());
-			if (metadata.fileIndex != fileIndex) {
-				//    . Ÿ ͸ ؾ .
-				metadata.handle = AssetManager::GenerateNewAssetHandle();
-				metadata.fileIndex = fileIndex;
-
-				SerializationArchive newArchive;
-				newArchive << metadata;
-				newArchive.Append(assetDataBegin, assetDataSize);
-
-				if (!FileSystem::MakeFile(assetFile.generic_string().c_str(), newArchive.Data(), newArchive.RemainingSize())) {
+			auto indexIt = g_assetIndex.find(assetPath);
+			if (indexIt != g_assetIndex.end() && indexIt->second.lastWriteTime == lastWriteTime && indexIt->second.fileSize == fileSize) {
+				indexEntry = indexIt->second;
+			}
+			else {
+				if (!ReadAssetHeader(assetFile, indexEntry)) {
 					continue;
 				}
+				g_assetIndex[assetPath] = indexEntry;
 			}
 
+			const AssetMetadata& metadata = indexEntry.metadata;
+
 			if (AssetManager::IsAssetRegistered(metadata.handle)) {
 				continue;
 			}
 
-			Ref<Asset> asset = CreateAssetInstance(metadata.type, assetFile, assetDataOffset);
+			Ref<Asset> asset = CreateAssetInstance(metadata.type, assetFile, indexEntry.dataOffset);
 			if (!asset) {
 				continue;
 			}
 
-			g_assetMetadataMap[assetFile.generic_string()] = metadata;
+			g_assetMetadataMap[assetPath] = metadata;
 			AssetManager::RegisterAsset(metadata.handle, asset);
 		}
 	}
 
-	Ref<Asset> AssetDatabase::CreateAssetInstance(AssetType assetType, const std::filesystem::path& path, int32_t dataOffset) {
-		Ref<Asset> asset;
-
-		switch (assetType) {
-		case AssetType::Texture2D:
-			asset = CreateRef<Texture2DAsset>(
-				[path, dataOffset](Texture2DAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.format;
-					archive >> desc.width;
-					archive >> desc.height;
-					archive.Consume(sizeof(Texture2D::Wrap) * 2);
-					archive.Consume(sizeof(Texture2D::Filter) * 2);
-					archive >> desc.usage;
-					archive >> desc.accessFlags;
-					archive >> desc.bindFlags;
-					archive >> desc.data;
-				}
-			);
-			break;
-		case AssetType::Texture2DArray:
-			asset = CreateRef<Texture2DArrayAsset>(
-				[path, dataOffset](Texture2DArrayAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.arraySize;
-					archive >> desc.format;
-					archive >> desc.width;
-					archive >> desc.height;
-					archive >> desc.usage;
-					archive >> desc.accessFlags;
-					archive >> desc.bindFlags;
-					archive >> desc.data;
-				}
-			);
-			break;
-		case AssetType::TextureCube:
-			asset = CreateRef<TextureCubeAsset>(
-				[path, dataOffset](TextureCubeAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.format;
-					archive >> desc.width;
-					archive >> desc.height;
-					archive >> desc.layout;
-					archive >> desc.data;
-				}
-			);
-			break;
-		case AssetType::Font:
-			asset = CreateRef<FontAsset>(
-				[path, dataOffset](FontAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.fontData;
-					archive >> desc.width;
-					archive >> desc.height;
-					archive >> desc.atlasData;
-				}
-			);
-			break;
-		case AssetType::Sound:
-			asset = CreateRef<SoundAsset>(
-				[path, dataOffset](SoundAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.soundData;
-				}
-			);
-			break;
-		case AssetType::SkeletalMesh:
-			asset = CreateRef<SkeletalMeshAsset>(
-				[path, dataOffset](SkeletalMeshAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.segments;
-					archive >> desc.skeleton;
-					archive >> desc.materials;
-					archive >> desc.vertices;
-					archive >> desc.indices;
-				}
-			);
-			break;
-		case AssetType::GraphicsShader:
-			asset = CreateRef<GraphicsShaderAsset>(
-				[path, dataOffset](GraphicsShaderAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.shaderCompileFlags;
-					archive >> desc.shaderPath;
-				}
-			);
-			break;
-		case AssetType::Material:
-			asset = CreateRef<MaterialAsset>(
-				[path, dataOffset](MaterialAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.renderMode;
-					archive >> desc.cullMode;
-					archive >> desc.depthTest;
-					archive >> desc.depthWrite;
-					archive >> desc.shaderHandle;
-					archive >> desc.albedoTexture;
-					archive >> desc.normalTexture;
-					archive >> desc.emissiveTexture;
-					archive >> desc.metallicTexture;
-					archive >> desc.roughnessTexture;
-					archive >> desc.ambientOcclusionTexture;
-					archive >> desc.baseColor;
-				}
-			);
-			break;
-		case AssetType::Skeleton:
-			asset = CreateRef<SkeletonAsset>(
-				[path, dataOffset](SkeletonAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.globalInvMatrix;
-					archive >> desc.nodes;
-					archive >> desc.bones;
-					archive >> desc.sockets;
-					archive >> desc.animationHandles;
-				}
-			);
-			break;
-		case AssetType::SkeletalAnimation:
-			asset = CreateRef<SkeletalAnimationAsset>(
-				[path, dataOffset](SkeletalAnimationAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.name;
-					archive >> desc.durationSec;
-					archive >> desc.animationNodes;
-				}
-			);
-			break;
-		case AssetType::StaticMesh:
-			asset = CreateRef<StaticMeshAsset>(
-				[path, dataOffset](StaticMeshAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.segments;
-					archive >> desc.materials;
-					archive >> desc.vertices;
-					archive >> desc.indices;
-				}
-			);
-			break;
-		case AssetType::Prefab:
-			asset = CreateRef<PrefabAsset>(
-				[path, dataOffset](PrefabAsset::Descriptor& desc) {
-					std::vector<int8_t> data;
-					FileSystem::ReadFile(path.generic_string().c_str(), data);
-					SerializationArchive archive(&data[dataOffset], data.size() - dataOffset);
-					archive >> desc.prefabData;
-				}
-			);
-			break;
-		}
+	Ref<Asset> AssetDatabase::CreateAssetInstance(AssetType assetType, const std::filesystem::path& path, uint64_t dataOffset) {
+		return CreateSerializedAsset(assetType, [path, dataOffset](const std::function<void(SerializationArchive&)>& read) {
+			// the archive reads straight from the mapping
+			MappedFile file;
+			if (!file.Open(path.generic_string().c_str()) || file.Size() < dataOffset) {
+				Log::Error("Failed to map asset file: %s", path.generic_string().c_str());
+				return;
+			}
 
-		return asset;
+			SerializationArchive archive = SerializationArchive::View(file.Data() + dataOffset, file.Size() - dataOffset);
+			read(archive);
+		});
 	}
 
 	bool AssetDatabase::GetAssetMetadata(const char* assetFile, AssetMetadata& outMetaData) {
@@ -338,6 +303,51 @@ namespace flaw {
 		}
 	}
 
+	bool AssetDatabase::BuildAssetBundle(const char* path, bool compress) {
+		AssetBundleBuilder builder;
+		if (!builder.Open(path)) {
+			Log::Error("Failed to create asset bundle: %s", path);
+			return false;
+		}
+
+		int32_t assetCount = 0;
+		for (const auto& [assetFile, metadata] : g_assetMetadataMap) {
+			MappedFile file;
+			if (!file.Open(assetFile.generic_string().c_str())) {
+				Log::Warn("Skipped %s while building the asset bundle", assetFile.generic_string().c_str());
+				continue;
+			}
+
+			SerializationArchive archive = SerializationArchive::View(file.Data(), file.Size());
+
+			AssetMetadata fileMetadata;
+			try {
+				archive >> fileMetadata;
+			}
+			catch (const std::runtime_error&) {
+				Log::Warn("Skipped %s while building the asset bundle, it is too short for its metadata", assetFile.generic_string().c_str());
+				continue;
+			}
+
+			// a failed write leaves the bundle broken, there is no point in adding the rest
+			if (!builder.AddAsset(metadata.handle, metadata.type, archive.Data() + archive.Offset(), archive.RemainingSize(), compress)) {
+				Log::Error("Failed to write %s to asset bundle: %s", assetFile.generic_string().c_str(), path);
+				return false;
+			}
+
+			assetCount++;
+		}
+
+		if (!builder.Finish()) {
+			Log::Error("Failed to write asset bundle: %s", path);
+			return false;
+		}
+
+		Log::Info("Asset bundle built: %s (%d assets)", path, assetCount);
+
+		return true;
+	}
+
 	const std::filesystem::path& AssetDatabase::GetContentsDirectory() {
 		return g_contentsDir;
 	}
@@ -358,32 +368,46 @@ namespace flaw {
 
 		SerializationArchive archive;
 		archive << meta;
-		serializeFunc(archive);
 
-		if (!FileSystem::WriteFile(path, archive.Data(), archive.RemainingSize())) {
+		// imported meshes and textures go to the file in chunks instead of being held in memory whole
+		if (!archive.OpenStream(path)) {
 			Log::Error("Failed to write asset file: %s", path);
 			return AssetHandle();
 		}
 
-		return meta.handle;
-	}
+		serializeFunc(archive);
 
-	AssetHandle AssetDatabase::RecreateAssetFile(const char* path, AssetType assetType, std::function<void(SerializationArchive&)> serializeFunc) {
-		std::vector<int8_t> fileData;
-		if (!FileSystem::ReadFile(path, fileData)) {
+		if (!archive.CloseStream()) {
+			Log::Error("Failed to write asset file: %s", path);
 			return AssetHandle();
 		}
 
-		SerializationArchive archive(fileData.data(), fileData.size());
+		return meta.handle;
+	}
 
+	AssetHandle AssetDatabase::RecreateAssetFile(const char* path, AssetType assetType, std::function<void(SerializationArchive&)> serializeFunc) {
 		AssetMetadata metadata;
-		archive >> metadata;
+		{
+			MappedFile file;
+			if (!file.Open(path)) {
+				return AssetHandle();
+			}
+
+			SerializationArchive archive = SerializationArchive::View(file.Data(), file.Size());
+			archive >> metadata;
+		}
 
 		SerializationArchive newArchive;
 		newArchive << metadata;
+
+		if (!newArchive.OpenStream(path)) {
+			Log::Error("Failed to write asset file: %s", path);
+			return AssetHandle();
+		}
+
 		serializeFunc(newArchive);
 
-		if (!FileSystem::WriteFile(path, newArchive.Data(), newArchive.RemainingSize())) {
+		if (!newArchive.CloseStream()) {
 			Log::Error("Failed to write asset file: %s", path);
 			return AssetHandle();
 		}
@@ -407,6 +431,9 @@ namespace flaw {
 		else if (settings->type == AssetCreateSettings::Type::Prefab) {
 			return CreateAssetFile(settings->destPath.c_str(), AssetType::Prefab, [settings](SerializationArchive& archive) { FillSerializationArchive(archive, (PrefabCreateSettings*)settings); });
 		}
+		else if (settings->type == AssetCreateSettings::Type::Animator) {
+			return CreateAssetFile(settings->destPath.c_str(), AssetType::Animator, [settings](SerializationArchive& archive) { FillSerializationArchive(archive, (AnimatorCreateSettings*)settings); });
+		}
 
 		return AssetHandle();
 	}
@@ -427,6 +454,9 @@ namespace flaw {
 		else if (settings->type == AssetCreateSettings::Type::Prefab) {
 			RecreateAssetFile(assetFile, AssetType::Prefab, [settings](SerializationArchive& archive) { FillSerializationArchive(archive, (PrefabCreateSettings*)settings); });
 		}
+		else if (settings->type == AssetCreateSettings::Type::Animator) {
+			RecreateAssetFile(assetFile, AssetType::Animator, [settings](SerializationArchive& archive) { FillSerializationArchive(archive, (AnimatorCreateSettings*)settings); });
+		}
 
 		AssetMetadata metadata = g_assetMetadataMap[assetFile];
 		AssetManager::UnloadAsset(metadata.handle);
@@ -473,12 +503,18 @@ namespace flaw {
 		archive << settings->name;
 		archive << settings->durationSec;
 		archive << settings->animationNodes;
+		archive << settings->compressedAnimationNodes;
 	}
 
 	void AssetDatabase::FillSerializationArchive(SerializationArchive& archive, const PrefabCreateSettings* settings) {
 		archive << settings->prefabData;
 	}
 
+	void AssetDatabase::FillSerializationArchive(SerializationArchive& archive, const AnimatorCreateSettings* settings) {
+		archive << settings->skeleton;
+		archive << settings->graph;
+	}
+
 	bool AssetDatabase::ImportAsset(const AssetImportSettings* settings) {
 		if (settings->type == AssetImportSettings::Type::Texture2D) {
 			return ImportTexture2D((Texture2DImportSettings*)settings);
@@ -600,6 +636,19 @@ namespace flaw {
 		}).IsValid();
 	}
 
+	// large meshes build their bvh on the job system, the result is stored with the mesh asset
+	template<typename T>
+	static void BuildMeshBVH(const std::vector<T>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshSegment>& segments, const BVHBuildSettings& settings, std::vector<BVHNode>& outNodes, std::vector<BVHTriangle>& outTriangles, std::vector<int32_t>& outTriangleIndices) {
+		BVHBuildSettings buildSettings = settings;
+		buildSettings.jobSystem = &g_application->GetJobSystem();
+
+		BVHBuildStats stats;
+		Mesh::BuildBVH(vertices, indices, segments, outNodes, outTriangles, outTriangleIndices, buildSettings, &stats);
+
+		Log::Info("Mesh bvh built, %u triangles in %d nodes (%d leaves, depth %d, max leaf %d, average leaf %.2f), sah cost %.2f",
+			static_cast<uint32_t>(outTriangles.size()), stats.nodeCount, stats.leafCount, stats.maxDepth, stats.maxLeafTriangles, stats.averageLeafTriangles, stats.sahCost);
+	}
+
 	bool AssetDatabase::ImportModel(ModelImportSettings* settings) {
 		Model model(settings->srcPath.c_str(), settings->progressHandler);
 		if (!model.IsValid()) {
@@ -713,10 +762,18 @@ namespace flaw {
 					}
 				}
 
+				std::vector<BVHNode> bvhNodes;
+				std::vector<BVHTriangle> bvhTriangles;
+				std::vector<int32_t> bvhTriangleIndices;
+				BuildMeshBVH(vertices, model.GetIndices(), segments, settings->bvhBuild, bvhNodes, bvhTriangles, bvhTriangleIndices);
+
 				archive << segments;
 				archive << materials;
 				archive << vertices;
 				archive << model.GetIndices();
+				archive << bvhNodes;
+				archive << bvhTriangles;
+				archive << bvhTriangleIndices;
 			}).IsValid();
 		}
 		else {
@@ -739,6 +796,18 @@ namespace flaw {
 					return SkeletalAnimationNode(boneAnim.name, positionKeys, rotationKeys, scaleKeys);
 					});
 
+				if (settings->compressAnimations) {
+					SkeletalAnimationCompressionStats stats;
+					for (const auto& node : animSettings.animationNodes) {
+						animSettings.compressedAnimationNodes.push_back(CompressSkeletalAnimationNode(node, animSettings.durationSec, settings->animationCompression, &stats));
+					}
+					animSettings.animationNodes.clear();
+
+					Log::Info("Animation %s compressed %.2fx (%u -> %u keys), max error position %f rotation %f scale %f", 
+						animation.name.c_str(), stats.GetCompressionRatio(), stats.rawKeyCount, stats.compressedKeyCount, 
+						stats.maxPositionError, stats.maxRotationError, stats.maxScaleError);
+				}
+
 				skeletalAnimHandles.push_back(CreateAsset(&animSettings));
 			}
 
@@ -785,11 +854,19 @@ namespace flaw {
 					});
 					skeletonSettings.animationHandles = skeletalAnimHandles;
 
+					std::vector<BVHNode> bvhNodes;
+					std::vector<BVHTriangle> bvhTriangles;
+					std::vector<int32_t> bvhTriangleIndices;
+					BuildMeshBVH(vertices, model.GetIndices(), segments, settings->bvhBuild, bvhNodes, bvhTriangles, bvhTriangleIndices);
+
 					archive << segments;
 					archive << CreateAsset(&skeletonSettings);
 					archive << materials;
 					archive << vertices;
 					archive << model.GetIndices();
+					archive << bvhNodes;
+					archive << bvhTriangles;
+					archive << bvhTriangleIndices;
 				}).IsValid();
 			}
 		}
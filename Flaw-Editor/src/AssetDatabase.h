@@ -32,6 +32,7 @@ namespace flaw {
 			Skeleton,
 			SkeletalAnimation,
 			Prefab,
+			Animator,
 		};
 
 		Type type;
@@ -97,6 +98,7 @@ namespace flaw {
 		std::string name;
 		float durationSec = 0.0f;
 		std::vector<SkeletalAnimationNode> animationNodes;
+		std::vector<CompressedSkeletalAnimationNode> compressedAnimationNodes;
 
 		SkeletalAnimationCreateSettings() {
 			type = Type::SkeletalAnimation;
@@ -111,6 +113,15 @@ namespace flaw {
 		}
 	};
 
+	struct AnimatorCreateSettings : public AssetCreateSettings {
+		AssetHandle skeleton;
+		AnimatorGraphDesc graph;
+
+		AnimatorCreateSettings() {
+			type = Type::Animator;
+		}
+	};
+
 	struct AssetImportSettings {
 		enum class Type {
 			Texture2D,
@@ -192,6 +203,11 @@ namespace flaw {
 
 		bool withoutSkin; // If this is true, only import animations
 
+		bool compressAnimations = true;
+		SkeletalAnimationCompressionSettings animationCompression;
+
+		BVHBuildSettings bvhBuild; // the job system is filled in by the import
+
 		std::function<bool(float)> progressHandler;
 
 		ModelImportSettings() {
@@ -227,10 +243,13 @@ namespace flaw {
 
 		static bool ImportAsset(const AssetImportSettings* importSettings);
 
+		// packs every registered .asset file into one bundle, list it in ProjectConfig::bundles to have the runtime mount it
+		static bool BuildAssetBundle(const char* path, bool compress);
+
 	private:
 		static void RegisterAssetsInFolder(const char* folderPath, bool recursive = true);
 
-		static Ref<Asset> CreateAssetInstance(AssetType assetType, const std::filesystem::path& path, int32_t dataOffset);
+		static Ref<Asset> CreateAssetInstance(AssetType assetType, const std::filesystem::path& path, uint64_t dataOffset);
 
 		static AssetHandle CreateAssetFile(const char* path, AssetType assetType, std::function<void(SerializationArchive&)> serializeFunc);
 		static AssetHandle RecreateAssetFile(const char* path, AssetType assetType, std::function<void(SerializationArchive&)> serializeFunc);
@@ -240,6 +259,7 @@ namespace flaw {
 		static void FillSerializationArchive(SerializationArchive& archive, const SkeletonCreateSettings* settings);
 		static void FillSerializationArchive(SerializationArchive& archive, const SkeletalAnimationCreateSettings* settings);
 		static void FillSerializationArchive(SerializationArchive& archive, const PrefabCreateSettings* settings);
+		static void FillSerializationArchive(SerializationArchive& archive, const AnimatorCreateSettings* settings);
 
 		static bool ImportTexture2D(Texture2DImportSettings* settings);
 		static bool ImportTextureCube(TextureCubeImportSettings* settings);
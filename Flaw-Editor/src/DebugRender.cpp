@@ -117,22 +117,22 @@ namespace flaw {
 		Frustum::Corners corners = frustrum.GetCorners();
 
 		// near plane
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topLeftNear, 1.0), transform * vec4(corners.topRightNear, 1.0), vec4(color, 1.0));
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topRightNear, 1.0), transform * vec4(corners.bottomRightNear, 1.0), vec4(color, 1.0));
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomRightNear, 1.0), transform * vec4(corners.bottomLeftNear, 1.0), vec4(color, 1.0));
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomLeftNear, 1.0), transform * vec4(corners.topLeftNear, 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topLeftNear(), 1.0), transform * vec4(corners.topRightNear(), 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topRightNear(), 1.0), transform * vec4(corners.bottomRightNear(), 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomRightNear(), 1.0), transform * vec4(corners.bottomLeftNear(), 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomLeftNear(), 1.0), transform * vec4(corners.topLeftNear(), 1.0), vec4(color, 1.0));
 
 		// far plane
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topLeftFar, 1.0), transform * vec4(corners.topRightFar, 1.0), vec4(color, 1.0));
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topRightFar, 1.0), transform * vec4(corners.bottomRightFar, 1.0), vec4(color, 1.0));
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomRightFar, 1.0), transform * vec4(corners.bottomLeftFar, 1.0), vec4(color, 1.0));
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomLeftFar, 1.0), transform * vec4(corners.topLeftFar, 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topLeftFar(), 1.0), transform * vec4(corners.topRightFar(), 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topRightFar(), 1.0), transform * vec4(corners.bottomRightFar(), 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomRightFar(), 1.0), transform * vec4(corners.bottomLeftFar(), 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomLeftFar(), 1.0), transform * vec4(corners.topLeftFar(), 1.0), vec4(color, 1.0));
 
 		// connecting lines
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topLeftNear, 1.0), transform * vec4(corners.topLeftFar, 1.0), vec4(color, 1.0));
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topRightNear, 1.0), transform * vec4(corners.topRightFar, 1.0), vec4(color, 1.0));
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomRightNear, 1.0), transform * vec4(corners.bottomRightFar, 1.0), vec4(color, 1.0));
-		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomLeftNear, 1.0), transform * vec4(corners.bottomLeftFar, 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topLeftNear(), 1.0), transform * vec4(corners.topLeftFar(), 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.topRightNear(), 1.0), transform * vec4(corners.topRightFar(), 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomRightNear(), 1.0), transform * vec4(corners.bottomRightFar(), 1.0), vec4(color, 1.0));
+		Renderer2D::DrawLine(entt::null, transform * vec4(corners.bottomLeftNear(), 1.0), transform * vec4(corners.bottomLeftFar(), 1.0), vec4(color, 1.0));
 	}
 
 	void DebugRender::DrawLineTriangle(const mat4& transform, const vec3& p0, const vec3& p1, const vec3& p2, const vec3& color) {
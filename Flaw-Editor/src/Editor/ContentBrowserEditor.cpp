@@ -221,6 +221,12 @@ namespace flaw {
 					AssetDatabase::CreateAsset(&settings);
 				}
 
+				if (ImGui::MenuItem("Animator")) {
+					AnimatorCreateSettings settings;
+					settings.destPath = _currentDirectory.generic_string() + "/NewAnimator.asset";
+					AssetDatabase::CreateAsset(&settings);
+				}
+
 				ImGui::EndMenu();
 			}
 
@@ -548,12 +554,36 @@ namespace flaw {
 			static bool withoutSkin = false;
 			ImGui::Checkbox("Without Skin", &withoutSkin);
 
+			static bool compressAnimations = true;
+			static SkeletalAnimationCompressionSettings compressionSettings;
+			ImGui::Checkbox("Compress Animations", &compressAnimations);
+			if (compressAnimations) {
+				ImGui::DragFloat("Position Tolerance", &compressionSettings.positionTolerance, 0.0001f, 0.0f, 1.0f, "%.4f");
+				ImGui::DragFloat("Rotation Tolerance", &compressionSettings.rotationTolerance, 0.0001f, 0.0f, 1.0f, "%.4f");
+				ImGui::DragFloat("Scale Tolerance", &compressionSettings.scaleTolerance, 0.0001f, 0.0f, 1.0f, "%.4f");
+			}
+
+			static BVHBuildSettings bvhSettings;
+			static const char* bvhSplitMethods[] = { "Midpoint", "Binned SAH" };
+			int32_t bvhSplitMethod = static_cast<int32_t>(bvhSettings.splitMethod);
+			if (ImGui::Combo("BVH Split Method", &bvhSplitMethod, bvhSplitMethods, IM_ARRAYSIZE(bvhSplitMethods))) {
+				bvhSettings.splitMethod = static_cast<BVHSplitMethod>(bvhSplitMethod);
+			}
+			ImGui::DragInt("BVH Max Depth", &bvhSettings.maxDepth, 1.0f, 1, Raycast::MaxTraversalDepth);
+			ImGui::DragInt("BVH Max Leaf Triangles", &bvhSettings.maxLeafTriangles, 1.0f, 1, 256);
+			if (bvhSettings.splitMethod == BVHSplitMethod::BinnedSAH) {
+				ImGui::DragInt("BVH Bin Count", &bvhSettings.binCount, 1.0f, 2, 64);
+			}
+
 			if (!_importFilePath.empty()) {
 				if (ImGui::Button("OK")) {
 					ModelImportSettings modelSettings;
 					modelSettings.srcPath = _importFilePath.generic_string();
 					modelSettings.destPath = _currentDirectory.generic_string() + "/" + _importFilePath.filename().replace_extension(".asset").generic_string();
 					modelSettings.withoutSkin = withoutSkin;
+					modelSettings.compressAnimations = compressAnimations;
+					modelSettings.animationCompression = compressionSettings;
+					modelSettings.bvhBuild = bvhSettings;
 					modelSettings.progressHandler = [](float progress) {
 						Log::Info("Model import progress: %.2f%%", progress * 100.0f);
 						return true;
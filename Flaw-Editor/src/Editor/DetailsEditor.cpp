@@ -392,11 +392,12 @@ namespace flaw {
 				ParticleComponentDrawer::Draw(_selectedEntt);
 			});
 
-			DrawComponent<StaticMeshComponent>(_selectedEntt, [](StaticMeshComponent& staticMeshComp) {
-				EditorHelper::DrawAssetPayloadTarget("Static Mesh", staticMeshComp.mesh, [&staticMeshComp](const char* filePath) {
+			DrawComponent<StaticMeshComponent>(_selectedEntt, [this](StaticMeshComponent& staticMeshComp) {
+				EditorHelper::DrawAssetPayloadTarget("Static Mesh", staticMeshComp.mesh, [this, &staticMeshComp](const char* filePath) {
 					AssetMetadata metadata;
 					if (AssetDatabase::GetAssetMetadata(filePath, metadata) && metadata.type == AssetType::StaticMesh) {
 						staticMeshComp.mesh = metadata.handle;
+						_scene->GetSpatialSystem().MarkDirty(_selectedEntt);
 
 						auto asset = AssetManager::GetAsset<StaticMeshAsset>(metadata.handle);
 						staticMeshComp.materials = asset->GetMaterialHandles();
@@ -415,11 +416,12 @@ namespace flaw {
 				ImGui::Checkbox("Cast Shadow", &staticMeshComp.castShadow);
 			});
 
-			DrawComponent<SkeletalMeshComponent>(_selectedEntt, [](SkeletalMeshComponent& skeletalMeshComp) {
-				EditorHelper::DrawAssetPayloadTarget("Skeletal Mesh", skeletalMeshComp.mesh, [&skeletalMeshComp](const char* filePath) {
+			DrawComponent<SkeletalMeshComponent>(_selectedEntt, [this](SkeletalMeshComponent& skeletalMeshComp) {
+				EditorHelper::DrawAssetPayloadTarget("Skeletal Mesh", skeletalMeshComp.mesh, [this, &skeletalMeshComp](const char* filePath) {
 					AssetMetadata metadata;
 					if (AssetDatabase::GetAssetMetadata(filePath, metadata) && metadata.type == AssetType::SkeletalMesh) {
 						skeletalMeshComp.mesh = metadata.handle;
+						_scene->GetSpatialSystem().MarkDirty(_selectedEntt);
 
 						auto asset = AssetManager::GetAsset<SkeletalMeshAsset>(metadata.handle);
 						skeletalMeshComp.materials = asset->GetMaterialHandles();
@@ -561,12 +563,36 @@ namespace flaw {
 			});
 
 			DrawComponent<AnimatorComponent>(_selectedEntt, [](AnimatorComponent& animatorComp) {
+				EditorHelper::DrawAssetPayloadTarget("Animator Asset", animatorComp.animatorAsset, [&animatorComp](const char* filePath) {
+					AssetMetadata metadata;
+					if (AssetDatabase::GetAssetMetadata(filePath, metadata) && metadata.type == AssetType::Animator) {
+						animatorComp.animatorAsset = metadata.handle;
+					}
+				});
+
 				EditorHelper::DrawAssetPayloadTarget("Skeleton Asset", animatorComp.skeletonAsset, [&animatorComp](const char* filePath) {
 					AssetMetadata metadata;
 					if (AssetDatabase::GetAssetMetadata(filePath, metadata) && metadata.type == AssetType::Skeleton) {
 						animatorComp.skeletonAsset = metadata.handle;
 					}
 				});
+
+				EditorHelper::DrawCheckbox("Use LOD", animatorComp.useLevelOfDetail);
+				if (animatorComp.useLevelOfDetail) {
+					EditorHelper::DrawList<AnimatorLevelOfDetail>("Level Of Details", animatorComp.levelOfDetails, [](AnimatorLevelOfDetail& lod) {
+						bool dirty = false;
+						dirty |= EditorHelper::DrawNumericInput("Min Screen Size", lod.minScreenSize, 0.0f, 0.01f);
+						dirty |= EditorHelper::DrawNumericInput("Update Interval", lod.updateInterval, 1);
+						dirty |= EditorHelper::DrawNumericInput("Max Bone Depth", lod.maxBoneDepth, -1);
+						return dirty;
+					});
+					EditorHelper::DrawNumericInput("Offscreen Update Interval", animatorComp.offscreenUpdateInterval, 0);
+				}
+
+				EditorHelper::DrawCheckbox("Use Crowd Pose", animatorComp.useCrowdPose);
+				if (animatorComp.useCrowdPose) {
+					EditorHelper::DrawNumericInput("Crowd Pose Time Step", animatorComp.crowdPoseTimeStep, 1.0f / 30.0f, 0.001f);
+				}
 			});
 
 			DrawComponent<CanvasComponent>(_selectedEntt, [this](CanvasComponent& canvasComp) {
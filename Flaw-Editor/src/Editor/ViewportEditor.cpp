@@ -112,7 +112,11 @@ namespace flaw {
             );
 
             if (ImGui::IsWindowHovered() && !ImGuizmo::IsOver() && Input::GetMouseButtonDown(MouseButton::Left)) {
-                entt::entity id = (entt::entity)MousePicking(remap.x, remap.y);
+                entt::entity id = PickMesh(mousePos, viewMatrix, projectionMatrix, isPerspective);
+                if (id == entt::null) {
+                    // sprites and other non mesh renderers are only in the id render target
+                    id = (entt::entity)MousePicking(remap.x, remap.y);
+                }
 
 			    _selectedEntt = Entity();
                 for (auto&& [entity] : _scene->GetRegistry().view<entt::entity>().each()) {
@@ -202,6 +206,23 @@ namespace flaw {
         _captureRenderTargetTexture = _graphicsContext.CreateTexture2D(desc);
     }
 
+    entt::entity ViewportEditor::PickMesh(const vec2& mousePos, const mat4& viewMatrix, const mat4& projectionMatrix, bool isPerspective) {
+        const mat4 invViewMatrix = inverse(viewMatrix);
+
+        // starts on the near plane, orthographic views look along the camera front
+        Ray ray = {};
+        ray.origin = ScreenToWorld(mousePos, _viewport, projectionMatrix, viewMatrix);
+        ray.direction = isPerspective ? normalize(ray.origin - vec3(invViewMatrix[3])) : normalize(vec3(invViewMatrix[2]));
+        ray.length = PickDistance;
+
+        MeshRayHit hit;
+        if (!_scene->GetSpatialSystem().RaycastMesh(ray, hit)) {
+            return entt::null;
+        }
+
+        return hit.entity;
+    }
+
     uint32_t ViewportEditor::MousePicking(int32_t x, int32_t y) {
 		auto mainMrt = Graphics::GetMainRenderPass();
 		auto idRenderTargetTex = std::static_pointer_cast<Texture2D>(mainMrt->GetRenderTargetTex(1));
@@ -19,11 +19,15 @@ namespace flaw {
 	private:
 		void CreateRequiredTextures();
 
+		// triangle level pick against the spatial system, entt::null when no mesh is hit
+		entt::entity PickMesh(const vec2& mousePos, const mat4& viewMatrix, const mat4& projectionMatrix, bool isPerspective);
 		uint32_t MousePicking(int32_t x, int32_t y);
 
 		void DrawDebugComponent();
 
 	private:
+		constexpr static float PickDistance = 1000.0f;
+
 		PlatformContext& _platformContext;
 		GraphicsContext& _graphicsContext;
 		EventDispatcher& _eventDispatcher;
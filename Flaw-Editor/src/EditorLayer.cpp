@@ -180,7 +180,7 @@ namespace flaw {
             if (ImGui::BeginDragDropTarget()) {
                 if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("CONTENT_FILE_PATH")) {
                     std::filesystem::path path = (const char*)payload->Data;
-                    if (path.extension() == ".scene") {
+                    if (path.extension() == ".scene" || path.extension() == BinarySceneExtension) {
 					    OpenScene(path.generic_string().c_str());
                     }
                 }
@@ -207,6 +207,14 @@ namespace flaw {
 						SaveSceneAs();
                     }
 
+					if (ImGui::MenuItem("Export Binary Scene..")) {
+						ExportBinaryScene();
+					}
+
+					if (ImGui::MenuItem("Build Asset Bundle..")) {
+						BuildAssetBundle();
+					}
+
 					ImGui::EndMenu();
 				}
 
@@ -448,10 +456,14 @@ namespace flaw {
 
     void EditorLayer::UpdateSceneAsEditorMode(const Ref<Scene>& scene) {
 		auto& transSys = scene->GetTransformSystem();
+		auto& spatialSys = scene->GetSpatialSystem();
+		auto& particleSys = scene->GetParticleSystem();
 		auto& renderSys = scene->GetRenderSystem();
 		auto& uiSys = scene->GetUISystem();
 
         transSys.Update();
+		spatialSys.Update();
+		particleSys.Update();
 
         _camera.OnUpdate();
 
@@ -573,8 +585,28 @@ namespace flaw {
 		}
 	}
 
+	void EditorLayer::ExportBinaryScene() {
+		std::string filePath = FileDialogs::SaveFile(Platform::GetPlatformContext(), "Binary Scene Files (*.bscene)\0*.bscene\0");
+		if (!filePath.empty()) {
+			if (std::filesystem::path(filePath).extension() != BinarySceneExtension) {
+				filePath += BinarySceneExtension;
+			}
+			_editorScene->ToFile(filePath.c_str());
+		}
+	}
+
+	void EditorLayer::BuildAssetBundle() {
+		std::string filePath = FileDialogs::SaveFile(Platform::GetPlatformContext(), "Asset Bundle Files (*.bundle)\0*.bundle\0");
+		if (!filePath.empty()) {
+			if (std::filesystem::path(filePath).extension() != AssetBundleExtension) {
+				filePath += AssetBundleExtension;
+			}
+			AssetDatabase::BuildAssetBundle(filePath.c_str(), true);
+		}
+	}
+
 	void EditorLayer::OpenScene() {
-		std::string filePath = FileDialogs::OpenFile(Platform::GetPlatformContext(), "Scene Files (*.scene)\0*.scene\0");
+		std::string filePath = FileDialogs::OpenFile(Platform::GetPlatformContext(), "Scene Files (*.scene;*.bscene)\0*.scene;*.bscene\0");
 		if (!filePath.empty()) {
 			OpenScene(filePath.c_str());
 		}
@@ -41,6 +41,8 @@ namespace flaw {
 		void NewScene();
 		void SaveScene();
 		void SaveSceneAs();
+		void ExportBinaryScene();
+		void BuildAssetBundle();
 		void OpenScene();
 		void OpenScene(const char* path);
 
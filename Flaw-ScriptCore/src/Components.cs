@@ -171,6 +171,26 @@
         {
             InternalCalls.PlayState_Animator(entityId, stateIndex);
         }
+
+        public void SetFloat(string name, float value)
+        {
+            InternalCalls.SetFloat_Animator(entityId, name, value);
+        }
+
+        public void SetInt(string name, int value)
+        {
+            InternalCalls.SetInt_Animator(entityId, name, value);
+        }
+
+        public void SetBool(string name, bool value)
+        {
+            InternalCalls.SetBool_Animator(entityId, name, value);
+        }
+
+        public void SetTrigger(string name)
+        {
+            InternalCalls.SetTrigger_Animator(entityId, name);
+        }
     }
 
     public class SkeletalMeshComponent : EntityComponent
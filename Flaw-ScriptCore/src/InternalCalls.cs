@@ -95,9 +95,24 @@ namespace Flaw
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal extern static bool Raycast_Physics(ref Ray ray, out RayHit hit);
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal extern static ulong Raycast_Spatial(ref Ray ray, out float distance);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal extern static void PlayState_Animator(EntityID id, int stateIndex);
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal extern static void SetFloat_Animator(EntityID id, string name, float value);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal extern static void SetInt_Animator(EntityID id, string name, int value);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal extern static void SetBool_Animator(EntityID id, string name, bool value);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal extern static void SetTrigger_Animator(EntityID id, string name);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal extern static void AttachEntityToSocket_SkeletalMesh(EntityID id, EntityID target, string socketName);
     }
@@ -48,5 +48,17 @@
             hit = new RayHit();
             return InternalCalls.Raycast_Physics(ref ray, out hit);
         }
+
+        // tests mesh bounds instead of colliders, entities without a collider can be hit
+        public static Entity RaycastBounds(Ray ray, out float distance)
+        {
+            ulong id = InternalCalls.Raycast_Spatial(ref ray, out distance);
+            if (id != ulong.MaxValue)
+            {
+                return new Entity(id);
+            }
+
+            return new Entity();
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "pch.h"
+#include "Engine/Graphics.h"
+#include "Engine/Material.h"
+#include "Graphics/Null/NullContext.h"
+
+#include <stdexcept>
+
+// the engine's Graphics.cpp pulls in the dx11 backend and the platform window,
+// the tests only get the null context and the shared buffers the render systems use
+namespace flaw {
+	static Scope<GraphicsContext> g_graphicsContext;
+
+	static Ref<GraphicsPipeline> g_graphicsPipeline;
+
+	static Ref<ConstantBuffer> g_globalConstantsCB;
+	static Ref<ConstantBuffer> g_materialConstantsCB;
+
+	static Ref<StructuredBuffer> g_batchedDataSB;
+
+	void Graphics::Init(GraphicsType type, int32_t width, int32_t height) {
+		if (type != GraphicsType::Null) {
+			throw std::runtime_error("Only the null graphics context is available in the tests");
+		}
+
+		g_graphicsContext = CreateScope<NullContext>(width, height);
+
+		g_graphicsPipeline = g_graphicsContext->CreateGraphicsPipeline();
+
+		g_globalConstantsCB = g_graphicsContext->CreateConstantBuffer(sizeof(GlobalConstants));
+		g_materialConstantsCB = g_graphicsContext->CreateConstantBuffer(sizeof(MaterialConstants));
+
+		StructuredBuffer::Descriptor batchedTransformSBDesc = {};
+		batchedTransformSBDesc.elmSize = sizeof(BatchedData);
+		batchedTransformSBDesc.count = MaxBatchedDataCount;
+		batchedTransformSBDesc.bindFlags = BindFlag::ShaderResource;
+		batchedTransformSBDesc.accessFlags = AccessFlag::Write;
+		g_batchedDataSB = g_graphicsContext->CreateStructuredBuffer(batchedTransformSBDesc);
+	}
+
+	void Graphics::Cleanup() {
+		g_batchedDataSB.reset();
+		g_materialConstantsCB.reset();
+		g_globalConstantsCB.reset();
+		g_graphicsPipeline.reset();
+		g_graphicsContext.reset();
+	}
+
+	void Graphics::Prepare() {
+		g_graphicsContext->Prepare();
+	}
+
+	void Graphics::Present() {
+		g_graphicsContext->Present();
+	}
+
+	Ref<VertexBuffer> Graphics::CreateVertexBuffer(const VertexBuffer::Descriptor& descriptor) {
+		return g_graphicsContext->CreateVertexBuffer(descriptor);
+	}
+
+	Ref<IndexBuffer> Graphics::CreateIndexBuffer(const IndexBuffer::Descriptor& descriptor) {
+		return g_graphicsContext->CreateIndexBuffer(descriptor);
+	}
+
+	Ref<ConstantBuffer> Graphics::CreateConstantBuffer(uint32_t size) {
+		return g_graphicsContext->CreateConstantBuffer(size);
+	}
+
+	Ref<StructuredBuffer> Graphics::CreateStructuredBuffer(const StructuredBuffer::Descriptor& desc) {
+		return g_graphicsContext->CreateStructuredBuffer(desc);
+	}
+
+	Ref<Texture2D> Graphics::CreateTexture2D(const Texture2D::Descriptor& descriptor) {
+		return g_graphicsContext->CreateTexture2D(descriptor);
+	}
+
+	GraphicsCommandQueue& Graphics::GetCommandQueue() {
+		return g_graphicsContext->GetCommandQueue();
+	}
+
+	Ref<GraphicsPipeline> Graphics::GetMainGraphicsPipeline() {
+		return g_graphicsPipeline;
+	}
+
+	Ref<ConstantBuffer> Graphics::GetGlobalConstantsCB() {
+		return g_globalConstantsCB;
+	}
+
+	Ref<ConstantBuffer> Graphics::GetMaterialConstantsCB() {
+		return g_materialConstantsCB;
+	}
+
+	Ref<StructuredBuffer> Graphics::GetBatchedDataSB() {
+		return g_batchedDataSB;
+	}
+
+	GraphicsContext& Graphics::GetGraphicsContext() {
+		return *g_graphicsContext;
+	}
+}
@@ -0,0 +1,22 @@
+#include "pch.h"
+#include "Log/Log.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace flaw {
+	static void Print(const char* level, const char* message, va_list args) {
+		std::printf("[%s] ", level);
+		std::vprintf(message, args);
+		std::printf("\n");
+	}
+
+	void Log::Initialize() {}
+	void Log::Cleanup() {}
+	void Log::PushLogSink(Ref<LogSink>) {}
+
+	void Log::Info(const char* message, ...) { va_list args; va_start(args, message); Print("info", message, args); va_end(args); }
+	void Log::Warn(const char* message, ...) { va_list args; va_start(args, message); Print("warn", message, args); va_end(args); }
+	void Log::Error(const char* message, ...) { va_list args; va_start(args, message); Print("error", message, args); va_end(args); }
+	void Log::Fatal(const char* message, ...) { va_list args; va_start(args, message); Print("fatal", message, args); va_end(args); }
+}
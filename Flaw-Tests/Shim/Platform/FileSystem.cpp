@@ -0,0 +1,55 @@
+#include "pch.h"
+#include "Platform/FileSystem.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace flaw {
+	MappedFile::MappedFile()
+		: _data(nullptr)
+		, _size(0)
+	{
+	}
+
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+	bool MappedFile::Open(const char* path) {
+		Close();
+
+		const int fd = open(path, O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+			close(fd);
+			return false;
+		}
+
+		// the mapping keeps its own reference to the file
+		void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if (view == MAP_FAILED) {
+			return false;
+		}
+
+		_data = static_cast<const int8_t*>(view);
+		_size = static_cast<uint64_t>(fileStat.st_size);
+
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (_data) {
+			munmap(const_cast<int8_t*>(_data), static_cast<size_t>(_size));
+			_data = nullptr;
+			_size = 0;
+		}
+	}
+}
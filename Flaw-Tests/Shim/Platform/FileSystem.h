@@ -0,0 +1,30 @@
+#pragma once
+
+// stands in for Flaw/src/Platform/FileSystem.h on linux, only MappedFile is declared, keep it in sync with the real header
+
+#include "Core.h"
+
+namespace flaw {
+	// read only view of a whole file, pages are loaded on first access and the data stays valid until Close
+	class MappedFile {
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// fails for empty files, they can't be mapped
+		bool Open(const char* path);
+		void Close();
+
+		bool IsOpen() const { return _data != nullptr; }
+
+		const int8_t* Data() const { return _data; }
+		uint64_t Size() const { return _size; }
+
+	private:
+		const int8_t* _data;
+		uint64_t _size;
+	};
+}
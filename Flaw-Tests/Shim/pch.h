@@ -0,0 +1,29 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <queue>
+#include <typeindex>
+#include <typeinfo>
+#include <bitset>
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <stdexcept>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <cstdlib>
+#include <chrono>
+
+
+
@@ -0,0 +1,43 @@
+project "Flaw-Tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir ("%{wks.location}/bin/%{cfg.buildcfg}/%{prj.name}")
+    objdir ("%{wks.location}/bin-int/%{cfg.buildcfg}/%{prj.name}")
+
+    -- Shim only stands in for the engine on non windows builds, see CMakeLists.txt
+    files {
+        "./src/**.h",
+        "./src/**.cpp",
+    }
+
+    includedirs {
+        "./src",
+        "%{wks.location}/Flaw/src",
+        vcpkg_root .. "/installed/%{cfg.architecture:gsub('x86_64','x64')}-%{cfg.system}/include",
+    }
+
+    libdirs {
+        "%{wks.location}/bin/%{cfg.buildcfg}/Flaw",
+    }
+
+    links {
+        "Flaw.lib",
+    }
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        symbols "on"
+
+        libdirs {
+            vcpkg_root .. "/installed/%{cfg.architecture:gsub('x86_64','x64')}-%{cfg.system}/debug/lib",
+        }
+
+    filter "configurations:Release"
+        runtime "Release"
+        optimize "on"
+
+        libdirs {
+            vcpkg_root .. "/installed/%{cfg.architecture:gsub('x86_64','x64')}-%{cfg.system}/lib",
+        }
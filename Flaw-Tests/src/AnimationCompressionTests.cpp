@@ -0,0 +1,179 @@
+#include "Test.h"
+#include "Engine/AnimationCompression.h"
+
+#include <random>
+
+using namespace flaw;
+using namespace flaw::test;
+
+constexpr float ClipDuration = 4.0f;
+constexpr int32_t ClipKeyCount = 121; // 30 keys per second
+
+static vec4 AxisAngle(const vec3& axis, float angle) {
+	const quat rotation = angleAxis(angle, normalize(axis));
+	return vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+}
+
+// slow curves sampled at 30 keys per second, most keys lie close to a straight line between their neighbours
+static SkeletalAnimationNode CreateSmoothNode() {
+	std::vector<SkeletalAnimationNodeKey<vec3>> positionKeys, scaleKeys;
+	std::vector<SkeletalAnimationNodeKey<vec4>> rotationKeys;
+
+	for (int32_t i = 0; i < ClipKeyCount; ++i) {
+		const float time = ClipDuration * i / (ClipKeyCount - 1);
+		positionKeys.push_back({ time, vec3(std::sin(time * 0.8f), std::cos(time * 0.5f) * 0.5f, time * 0.25f) });
+		rotationKeys.push_back({ time, AxisAngle(vec3(0.2f, 1.0f, 0.1f), std::sin(time) * 0.6f) });
+		scaleKeys.push_back({ time, vec3(1.0f) });
+	}
+
+	return SkeletalAnimationNode("Smooth", positionKeys, rotationKeys, scaleKeys);
+}
+
+// a jittery track, most keys survive the reduction and only quantization saves space
+static SkeletalAnimationNode CreateNoisyNode() {
+	std::mt19937 random(99);
+	std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+	std::vector<SkeletalAnimationNodeKey<vec3>> positionKeys, scaleKeys;
+	std::vector<SkeletalAnimationNodeKey<vec4>> rotationKeys;
+
+	for (int32_t i = 0; i < ClipKeyCount; ++i) {
+		const float time = ClipDuration * i / (ClipKeyCount - 1);
+		positionKeys.push_back({ time, vec3(noise(random), noise(random), noise(random)) * 10.0f });
+		rotationKeys.push_back({ time, AxisAngle(vec3(noise(random), noise(random), noise(random)) + vec3(0.0f, 0.0f, 2.0f), noise(random) * 3.0f) });
+		scaleKeys.push_back({ time, vec3(1.0f) + vec3(noise(random)) * 0.1f });
+	}
+
+	return SkeletalAnimationNode("Noisy", positionKeys, rotationKeys, scaleKeys);
+}
+
+static float GetRotationAngle(const quat& a, const quat& b) {
+	return 2.0f * std::acos(glm::clamp(std::abs(dot(a, b)), 0.0f, 1.0f));
+}
+
+// the stats only look at raw key times, sampling between them has to stay within the same bounds
+static void CheckBetweenKeys(const SkeletalAnimationNode& raw, const SkeletalAnimationNode& decoded, const SkeletalAnimationCompressionSettings& settings, float slack) {
+	float maxPositionError = 0.0f;
+	float maxRotationError = 0.0f;
+	float maxScaleError = 0.0f;
+
+	for (int32_t i = 0; i < ClipKeyCount * 4; ++i) {
+		const float time = ClipDuration * (i + 0.5f) / (ClipKeyCount * 4);
+		maxPositionError = std::max(maxPositionError, length(raw.InterpolatePosition(time) - decoded.InterpolatePosition(time)));
+		maxRotationError = std::max(maxRotationError, GetRotationAngle(raw.InterpolateRotation(time), decoded.InterpolateRotation(time)));
+		maxScaleError = std::max(maxScaleError, length(raw.InterpolateScale(time) - decoded.InterpolateScale(time)));
+	}
+
+	FCHECK(maxPositionError <= settings.positionTolerance * slack);
+	FCHECK(maxRotationError <= settings.rotationTolerance * slack);
+	FCHECK(maxScaleError <= settings.scaleTolerance * slack);
+}
+
+FTEST(AnimationCompression_SmoothClip) {
+	const SkeletalAnimationCompressionSettings settings;
+	const SkeletalAnimationNode raw = CreateSmoothNode();
+
+	SkeletalAnimationCompressionStats stats;
+	const CompressedSkeletalAnimationNode compressed = CompressSkeletalAnimationNode(raw, ClipDuration, settings, &stats);
+
+	std::printf("  smooth: %u -> %u keys, %llu -> %llu bytes, ratio %.2f, max error %.6f / %.6f rad / %.6f\n",
+		stats.rawKeyCount, stats.compressedKeyCount, (unsigned long long)stats.rawSize, (unsigned long long)stats.compressedSize,
+		stats.GetCompressionRatio(), stats.maxPositionError, stats.maxRotationError, stats.maxScaleError);
+
+	FCHECK(stats.rawKeyCount == ClipKeyCount * 3);
+	FCHECK(compressed.scaleKeys.size() == 1);			// constant track
+	FCHECK(stats.GetCompressionRatio() > 4.0f);
+
+	// removed keys may be off by the tolerance, quantization adds a little on top
+	FCHECK(stats.maxPositionError <= settings.positionTolerance * 1.5f);
+	FCHECK(stats.maxRotationError <= settings.rotationTolerance * 1.5f);
+	FCHECK(stats.maxScaleError <= settings.scaleTolerance * 1.5f);
+
+	CheckBetweenKeys(raw, SkeletalAnimationNode(compressed), settings, 1.5f);
+}
+
+FTEST(AnimationCompression_NoisyClip) {
+	const SkeletalAnimationCompressionSettings settings;
+	const SkeletalAnimationNode raw = CreateNoisyNode();
+
+	SkeletalAnimationCompressionStats stats;
+	const CompressedSkeletalAnimationNode compressed = CompressSkeletalAnimationNode(raw, ClipDuration, settings, &stats);
+
+	std::printf("  noisy: %u -> %u keys, ratio %.2f, max error %.6f / %.6f rad / %.6f\n",
+		stats.rawKeyCount, stats.compressedKeyCount, stats.GetCompressionRatio(), stats.maxPositionError, stats.maxRotationError, stats.maxScaleError);
+
+	// nothing to remove, 16 bit keys still halve the size
+	FCHECK(stats.compressedKeyCount > stats.rawKeyCount * 9 / 10);
+	FCHECK(stats.GetCompressionRatio() > 1.8f);
+
+	// key times snap to half a time step, on a track this steep that moves the sampled value as well
+	float maxPositionSpeed = 0.0f;
+	float maxRotationSpeed = 0.0f;
+	for (size_t i = 1; i < raw.GetPositionKeys().size(); ++i) {
+		const float duration = raw.GetPositionKeys()[i].time - raw.GetPositionKeys()[i - 1].time;
+		maxPositionSpeed = std::max(maxPositionSpeed, length(raw.GetPositionKeys()[i].value - raw.GetPositionKeys()[i - 1].value) / duration);
+
+		const vec4& a = raw.GetRotationKeys()[i - 1].value;
+		const vec4& b = raw.GetRotationKeys()[i].value;
+		maxRotationSpeed = std::max(maxRotationSpeed, GetRotationAngle(quat(a.w, a.x, a.y, a.z), quat(b.w, b.x, b.y, b.z)) / duration);
+	}
+
+	const float timeSnap = compressed.timeStep * 0.5f;
+
+	// a 20 unit range quantized to 16 bits is within 0.0003 per axis
+	FCHECK(stats.maxPositionError <= settings.positionTolerance + 20.0f / 65535.0f * 2.0f + maxPositionSpeed * timeSnap);
+	FCHECK(stats.maxRotationError <= settings.rotationTolerance * 1.5f + maxRotationSpeed * timeSnap);
+	FCHECK(stats.maxScaleError <= settings.scaleTolerance * 1.5f);
+}
+
+FTEST(AnimationCompression_ConstantClip) {
+	std::vector<SkeletalAnimationNodeKey<vec3>> positionKeys, scaleKeys;
+	std::vector<SkeletalAnimationNodeKey<vec4>> rotationKeys;
+	for (int32_t i = 0; i < ClipKeyCount; ++i) {
+		const float time = ClipDuration * i / (ClipKeyCount - 1);
+		positionKeys.push_back({ time, vec3(1.0f, 2.0f, 3.0f) });
+		rotationKeys.push_back({ time, AxisAngle(Up, 0.5f) });
+		scaleKeys.push_back({ time, vec3(2.0f) });
+	}
+
+	const SkeletalAnimationNode raw("Constant", positionKeys, rotationKeys, scaleKeys);
+
+	SkeletalAnimationCompressionStats stats;
+	const CompressedSkeletalAnimationNode compressed = CompressSkeletalAnimationNode(raw, ClipDuration, SkeletalAnimationCompressionSettings(), &stats);
+
+	FCHECK(compressed.positionKeys.size() == 1 && compressed.rotationKeys.size() == 1 && compressed.scaleKeys.size() == 1);
+
+	const SkeletalAnimationNode decoded(compressed);
+	FCHECK(length(decoded.InterpolatePosition(1.7f) - vec3(1.0f, 2.0f, 3.0f)) < 1e-5f);
+	FCHECK(length(decoded.InterpolateScale(3.1f) - vec3(2.0f)) < 1e-5f);
+}
+
+FTEST(AnimationCompression_CompressedNodeSerialization) {
+	const CompressedSkeletalAnimationNode compressed = CompressSkeletalAnimationNode(CreateSmoothNode(), ClipDuration, SkeletalAnimationCompressionSettings());
+
+	SerializationArchive archive;
+	archive << compressed;
+
+	SerializationArchive reader(archive.Data(), archive.RemainingSize());
+	CompressedSkeletalAnimationNode loaded;
+	reader >> loaded;
+
+	FCHECK(loaded.nodeName == compressed.nodeName);
+	FCHECK(loaded.positionKeys.size() == compressed.positionKeys.size());
+	FCHECK(loaded.rotationKeys.size() == compressed.rotationKeys.size());
+
+	const SkeletalAnimationNode a(compressed), b(loaded);
+	FCHECK(a.InterpolatePosition(2.3f) == b.InterpolatePosition(2.3f));
+
+	// a decoded node has no raw keys left, writing it as a raw node would silently drop the animation
+	bool threw = false;
+	try {
+		SerializationArchive nodeArchive;
+		nodeArchive << a;
+	}
+	catch (const std::runtime_error&) {
+		threw = true;
+	}
+
+	FCHECK(threw);
+}
@@ -0,0 +1,307 @@
+#include "Test.h"
+#include "Engine/Animator.h"
+
+using namespace flaw;
+using namespace flaw::test;
+
+static Ref<Skeleton> CreateTestSkeleton() {
+	Skeleton::Descriptor desc = {};
+	desc.globalInvMatrix = mat4(1.0f);
+
+	SkeletonNode root;
+	root.name = "Root";
+	desc.nodes.push_back(root);
+
+	return CreateRef<Skeleton>(desc);
+}
+
+// the root moves along x, the graph logic only looks at the duration
+static Ref<SkeletalAnimation> CreateTestAnimation(const std::string& name, float durationSec) {
+	std::vector<SkeletalAnimationNodeKey<vec3>> positionKeys = { { 0.0f, vec3(0.0f) }, { durationSec, vec3(1.0f, 0.0f, 0.0f) } };
+	std::vector<SkeletalAnimationNodeKey<vec4>> rotationKeys = { { 0.0f, vec4(0.0f, 0.0f, 0.0f, 1.0f) } };
+	std::vector<SkeletalAnimationNodeKey<vec3>> scaleKeys = { { 0.0f, vec3(1.0f) } };
+
+	std::vector<SkeletalAnimationNode> nodes;
+	nodes.emplace_back("Root", positionKeys, rotationKeys, scaleKeys);
+
+	return CreateRef<SkeletalAnimation>(name, durationSec, nodes);
+}
+
+static AnimatorStateDesc CreateClipState(const std::string& name, int32_t animationIndex, bool loop = true) {
+	AnimatorStateDesc state;
+	state.name = name;
+	state.motionType = AnimatorMotionType::Clip;
+	state.samples.push_back({ animationIndex, vec2(0.0f) });
+	state.loop = loop;
+	return state;
+}
+
+static AnimatorTransitionDesc CreateTransition(int32_t fromStateIndex, int32_t toStateIndex, float duration, float exitTime, const std::vector<AnimatorConditionDesc>& conditions) {
+	AnimatorTransitionDesc transition;
+	transition.fromStateIndex = fromStateIndex;
+	transition.toStateIndex = toStateIndex;
+	transition.duration = duration;
+	transition.exitTime = exitTime;
+	transition.conditions = conditions;
+	return transition;
+}
+
+// every graph gets the same clips, one second and two second long
+static Ref<Animator> CreateTestAnimator(const AnimatorGraphDesc& graph) {
+	Animator::Descriptor desc;
+	desc.skeleton = CreateTestSkeleton();
+	desc.graph = graph;
+	desc.animations = { CreateTestAnimation("Short", 1.0f), CreateTestAnimation("Long", 2.0f) };
+	return CreateRef<Animator>(desc);
+}
+
+static float GetWeight(const AnimatorMotionWeights& weights, int32_t sampleIndex) {
+	for (int32_t i = 0; i < weights.count; ++i) {
+		if (weights.sampleIndices[i] == sampleIndex) {
+			return weights.weights[i];
+		}
+	}
+	return 0.0f;
+}
+
+static float GetWeightSum(const AnimatorMotionWeights& weights) {
+	float sum = 0.0f;
+	for (int32_t i = 0; i < weights.count; ++i) {
+		sum += weights.weights[i];
+	}
+	return sum;
+}
+
+// samples are given out of order, the animator sorts them so the indices below are by position
+FTEST(Animator_BlendSpace1DWeights) {
+	AnimatorGraphDesc graph;
+	graph.parameters.push_back({ "Speed", AnimatorParameterType::Float, 0.0f });
+
+	AnimatorStateDesc locomotion;
+	locomotion.name = "Locomotion";
+	locomotion.motionType = AnimatorMotionType::BlendSpace1D;
+	locomotion.samples = { { 1, vec2(4.0f, 0.0f) }, { 0, vec2(0.0f, 0.0f) }, { 0, vec2(2.0f, 0.0f) } };
+	locomotion.parameterX = 0;
+	graph.states.push_back(locomotion);
+
+	Ref<Animator> animator = CreateTestAnimator(graph);
+
+	AnimatorMotionWeights weights;
+	float speed = -1.0f;
+
+	// clamped below the first and above the last sample
+	animator->GetMotionWeights(0, &speed, weights);
+	FCHECK(weights.count == 1 && weights.sampleIndices[0] == 0 && weights.weights[0] == 1.0f);
+
+	speed = 10.0f;
+	animator->GetMotionWeights(0, &speed, weights);
+	FCHECK(weights.count == 1 && weights.sampleIndices[0] == 2 && weights.weights[0] == 1.0f);
+
+	speed = 0.5f;
+	animator->GetMotionWeights(0, &speed, weights);
+	FCHECK(weights.count == 2);
+	FCHECK_NEAR(GetWeight(weights, 0), 0.75f, 1e-5f);
+	FCHECK_NEAR(GetWeight(weights, 1), 0.25f, 1e-5f);
+
+	speed = 3.0f;
+	animator->GetMotionWeights(0, &speed, weights);
+	FCHECK(weights.count == 2);
+	FCHECK_NEAR(GetWeight(weights, 1), 0.5f, 1e-5f);
+	FCHECK_NEAR(GetWeight(weights, 2), 0.5f, 1e-5f);
+
+	// halfway between the one second and the two second clip
+	FCHECK_NEAR(animator->GetStateDuration(0, weights), 1.5f, 1e-5f);
+
+	// exactly on the middle sample
+	speed = 2.0f;
+	animator->GetMotionWeights(0, &speed, weights);
+	FCHECK_NEAR(GetWeight(weights, 1), 1.0f, 1e-5f);
+	FCHECK_NEAR(GetWeightSum(weights), 1.0f, 1e-5f);
+}
+
+FTEST(Animator_BlendSpace2DWeights) {
+	AnimatorGraphDesc graph;
+	graph.parameters.push_back({ "X", AnimatorParameterType::Float, 0.0f });
+	graph.parameters.push_back({ "Y", AnimatorParameterType::Float, 0.0f });
+
+	AnimatorStateDesc strafe;
+	strafe.name = "Strafe";
+	strafe.motionType = AnimatorMotionType::BlendSpace2D;
+	strafe.samples = { { 0, vec2(0.0f, 0.0f) }, { 0, vec2(1.0f, 0.0f) }, { 0, vec2(0.0f, 1.0f) }, { 1, vec2(1.0f, 1.0f) }, { 1, vec2(5.0f, 5.0f) } };
+	strafe.parameterX = 0;
+	strafe.parameterY = 1;
+	graph.states.push_back(strafe);
+
+	Ref<Animator> animator = CreateTestAnimator(graph);
+
+	AnimatorMotionWeights weights;
+
+	// on a sample it plays alone
+	float parameters[2] = { 1.0f, 0.0f };
+	animator->GetMotionWeights(0, parameters, weights);
+	FCHECK(weights.count == 1 && weights.sampleIndices[0] == 1 && weights.weights[0] == 1.0f);
+
+	// inverse squared distance over the three closest, 0.125, 0.625 and 0.625 away
+	parameters[0] = 0.25f;
+	parameters[1] = 0.25f;
+	animator->GetMotionWeights(0, parameters, weights);
+	FCHECK(weights.count == AnimatorMotionWeights::MaxCount);
+	FCHECK_NEAR(GetWeight(weights, 0), 8.0f / 11.2f, 1e-5f);
+	FCHECK_NEAR(GetWeight(weights, 1), 1.6f / 11.2f, 1e-5f);
+	FCHECK_NEAR(GetWeight(weights, 2), 1.6f / 11.2f, 1e-5f);
+	FCHECK(GetWeight(weights, 3) == 0.0f);
+	FCHECK(GetWeight(weights, 4) == 0.0f);
+
+	// next to the outlying sample, 2, 18 and 25 away, the second sample at 25 loses the tie to the first
+	parameters[0] = 4.0f;
+	parameters[1] = 4.0f;
+	animator->GetMotionWeights(0, parameters, weights);
+	const float weightSum = 1.0f / 2.0f + 1.0f / 18.0f + 1.0f / 25.0f;
+	FCHECK(weights.count == AnimatorMotionWeights::MaxCount);
+	FCHECK_NEAR(GetWeight(weights, 4), (1.0f / 2.0f) / weightSum, 1e-5f);
+	FCHECK_NEAR(GetWeight(weights, 3), (1.0f / 18.0f) / weightSum, 1e-5f);
+	FCHECK_NEAR(GetWeight(weights, 1), (1.0f / 25.0f) / weightSum, 1e-5f);
+	FCHECK(GetWeight(weights, 0) == 0.0f && GetWeight(weights, 2) == 0.0f);
+}
+
+FTEST(Animator_TransitionConditions) {
+	AnimatorGraphDesc graph;
+	graph.parameters.push_back({ "Speed", AnimatorParameterType::Float, 0.0f });
+	graph.parameters.push_back({ "Grounded", AnimatorParameterType::Bool, 0.0f });
+	graph.parameters.push_back({ "Stance", AnimatorParameterType::Int, 0.0f });
+
+	graph.states.push_back(CreateClipState("Idle", 0));
+	graph.states.push_back(CreateClipState("Run", 0));
+	graph.states.push_back(CreateClipState("Crouch", 0));
+
+	// every condition has to pass
+	graph.transitions.push_back(CreateTransition(0, 1, 0.0f, -1.0f, { { 0, AnimatorConditionMode::Greater, 0.5f }, { 1, AnimatorConditionMode::If, 0.0f } }));
+	graph.transitions.push_back(CreateTransition(1, 0, 0.0f, -1.0f, { { 0, AnimatorConditionMode::Less, 0.1f } }));
+	graph.transitions.push_back(CreateTransition(0, 2, 0.0f, -1.0f, { { 2, AnimatorConditionMode::Equal, 2.0f } }));
+	graph.transitions.push_back(CreateTransition(2, 0, 0.0f, -1.0f, { { 2, AnimatorConditionMode::NotEqual, 2.0f }, { 1, AnimatorConditionMode::IfNot, 0.0f } }));
+
+	// neither exit time nor conditions, never taken
+	graph.transitions.push_back(CreateTransition(1, 2, 0.0f, -1.0f, {}));
+
+	AnimatorRuntime runtime(CreateTestAnimator(graph));
+	const int32_t speed = runtime.GetParameterIndex("Speed");
+	const int32_t grounded = runtime.GetParameterIndex("Grounded");
+	const int32_t stance = runtime.GetParameterIndex("Stance");
+
+	FCHECK(runtime.GetCurrentStateIndex() == 0);
+
+	runtime.SetFloat(speed, 1.0f);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 0);
+
+	runtime.SetBool(grounded, true);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 1);
+
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 1);
+
+	runtime.SetFloat(speed, 0.05f);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 0);
+
+	runtime.SetInt(stance, 2);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 2);
+
+	runtime.SetInt(stance, 1);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 2);
+
+	runtime.SetBool(grounded, false);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 0);
+}
+
+FTEST(Animator_TransitionExitTime) {
+	AnimatorGraphDesc graph;
+	graph.states.push_back(CreateClipState("Idle", 1));
+	graph.states.push_back(CreateClipState("Attack", 0, false));
+	graph.states.push_back(CreateClipState("Fidget", 0));
+
+	graph.transitions.push_back(CreateTransition(1, 0, 0.2f, 0.75f, {}));
+	graph.transitions.push_back(CreateTransition(2, 0, 0.0f, 1.5f, {}));
+
+	AnimatorRuntime runtime(CreateTestAnimator(graph));
+
+	runtime.PlayState(1);
+	runtime.Advance(0.5f);
+	FCHECK(runtime.GetCurrentStateIndex() == 1 && !runtime.IsInTransition());
+
+	// the cross fade starts once the one second clip is past 0.75 and ends after 0.2 seconds
+	runtime.Advance(0.3f);
+	FCHECK(runtime.GetCurrentStateIndex() == 1 && runtime.IsInTransition());
+
+	runtime.Advance(0.1f);
+	FCHECK(runtime.IsInTransition());
+
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 0 && !runtime.IsInTransition());
+
+	// a looping state counts its loops, 1.5 is halfway through the second one
+	runtime.PlayState(2);
+	runtime.Advance(0.9f);
+	runtime.Advance(0.4f);
+	FCHECK(runtime.GetCurrentStateIndex() == 2);
+
+	runtime.Advance(0.3f);
+	FCHECK(runtime.GetCurrentStateIndex() == 0);
+}
+
+FTEST(Animator_TriggerConsumedOnce) {
+	AnimatorGraphDesc graph;
+	graph.parameters.push_back({ "Jump", AnimatorParameterType::Trigger, 0.0f });
+	graph.parameters.push_back({ "Grounded", AnimatorParameterType::Bool, 1.0f });
+
+	graph.states.push_back(CreateClipState("Idle", 0));
+	graph.states.push_back(CreateClipState("Jump", 0, false));
+	graph.states.push_back(CreateClipState("DoubleJump", 0, false));
+
+	// both jumps use the same trigger, one press may only take one of them
+	graph.transitions.push_back(CreateTransition(0, 1, 0.0f, -1.0f, { { 0, AnimatorConditionMode::If, 0.0f }, { 1, AnimatorConditionMode::If, 0.0f } }));
+	graph.transitions.push_back(CreateTransition(1, 2, 0.0f, -1.0f, { { 0, AnimatorConditionMode::If, 0.0f } }));
+	graph.transitions.push_back(CreateTransition(1, 0, 0.0f, 1.0f, {}));
+	graph.transitions.push_back(CreateTransition(2, 0, 0.0f, 1.0f, {}));
+
+	AnimatorRuntime runtime(CreateTestAnimator(graph));
+	const int32_t jump = runtime.GetParameterIndex("Jump");
+	const int32_t grounded = runtime.GetParameterIndex("Grounded");
+
+	runtime.SetTrigger(jump);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 1);
+	FCHECK(runtime.GetFloat(jump) == 0.0f);
+
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 1);
+
+	// a second press does take the second transition
+	runtime.SetTrigger(jump);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 2);
+	FCHECK(runtime.GetFloat(jump) == 0.0f);
+
+	runtime.Advance(1.0f);
+	FCHECK(runtime.GetCurrentStateIndex() == 0);
+
+	// a trigger that no transition can use yet stays set until one does
+	runtime.SetBool(grounded, false);
+	runtime.SetTrigger(jump);
+	runtime.Advance(0.1f);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 0);
+	FCHECK(runtime.GetFloat(jump) == 1.0f);
+
+	runtime.SetBool(grounded, true);
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 1);
+	FCHECK(runtime.GetFloat(jump) == 0.0f);
+
+	runtime.Advance(0.1f);
+	FCHECK(runtime.GetCurrentStateIndex() == 1);
+}
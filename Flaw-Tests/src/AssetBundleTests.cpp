@@ -0,0 +1,148 @@
+#include "Test.h"
+#include "Engine/AssetBundle.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace flaw;
+using namespace flaw::test;
+
+namespace {
+	struct TestAsset {
+		AssetHandle handle;
+		AssetType type;
+		std::vector<int8_t> data;
+		bool compress;
+	};
+}
+
+static std::string GetTempBundlePath(const char* name) {
+	return (std::filesystem::temp_directory_path() / (std::string(name) + AssetBundleExtension)).string();
+}
+
+// repeating text deflates well, random bytes do not and have to be stored as they are
+static std::vector<TestAsset> CreateTestAssets() {
+	std::vector<TestAsset> assets;
+
+	TestAsset text = { AssetHandle(900), AssetType::Material, {}, true };
+	const std::string line = "albedo normal roughness metallic emissive\n";
+	for (int32_t i = 0; i < 256; ++i) {
+		text.data.insert(text.data.end(), line.begin(), line.end());
+	}
+	assets.push_back(text);
+
+	TestAsset noise = { AssetHandle(17), AssetType::Texture2D, std::vector<int8_t>(4099), true };
+	std::mt19937 random(1234);
+	for (auto& byte : noise.data) {
+		byte = static_cast<int8_t>(random());
+	}
+	assets.push_back(noise);
+
+	TestAsset plain = { AssetHandle(350), AssetType::Skeleton, std::vector<int8_t>(1000, 7), false };
+	assets.push_back(plain);
+
+	TestAsset small = { AssetHandle(5), AssetType::Sound, { 1, 2, 3 }, true };
+	assets.push_back(small);
+
+	return assets;
+}
+
+static bool BuildBundle(const std::string& path, const std::vector<TestAsset>& assets) {
+	AssetBundleBuilder builder;
+	if (!builder.Open(path.c_str())) {
+		return false;
+	}
+
+	for (const auto& asset : assets) {
+		if (!builder.AddAsset(asset.handle, asset.type, asset.data.data(), asset.data.size(), asset.compress)) {
+			return false;
+		}
+	}
+
+	return builder.Finish();
+}
+
+FTEST(AssetBundle_ReadsBackEveryAsset) {
+	const std::string path = GetTempBundlePath("FlawTests_AssetBundle");
+	const std::vector<TestAsset> assets = CreateTestAssets();
+
+	FCHECK(BuildBundle(path, assets));
+
+	AssetBundle bundle;
+	FCHECK(bundle.Open(path.c_str()));
+	FCHECK(bundle.GetEntryCount() == assets.size());
+
+	// entries are sorted by handle for the binary search, payloads keep their alignment
+	for (uint32_t i = 0; i < bundle.GetEntryCount(); ++i) {
+		const AssetBundleEntry& entry = bundle.GetEntryAt(i);
+		FCHECK(entry.offset % AssetBundleAlignment == 0);
+		if (i > 0) {
+			FCHECK(bundle.GetEntryAt(i - 1).handle < entry.handle);
+		}
+	}
+
+	std::vector<int8_t> buffer;
+	for (const auto& asset : assets) {
+		const AssetBundleEntry* entry = bundle.FindEntry(asset.handle);
+		FCHECK(entry != nullptr);
+		if (!entry) {
+			continue;
+		}
+
+		FCHECK(entry->type == asset.type);
+		FCHECK(entry->uncompressedSize == asset.data.size());
+
+		const int8_t* data = nullptr;
+		uint64_t size = 0;
+		FCHECK(bundle.ReadPayload(*entry, buffer, data, size));
+		FCHECK(size == asset.data.size());
+		FCHECK(data != nullptr && std::equal(asset.data.begin(), asset.data.end(), data));
+	}
+
+	FCHECK(bundle.FindEntry(AssetHandle(900))->compression == AssetBundleCompression::Deflate);
+	FCHECK(bundle.FindEntry(AssetHandle(900))->size < assets[0].data.size());
+	FCHECK(bundle.FindEntry(AssetHandle(17))->compression == AssetBundleCompression::None);
+	FCHECK(bundle.FindEntry(AssetHandle(350))->compression == AssetBundleCompression::None);
+
+	FCHECK(bundle.FindEntry(AssetHandle(4)) == nullptr);
+	FCHECK(bundle.FindEntry(AssetHandle(351)) == nullptr);
+	FCHECK(bundle.FindEntry(AssetHandle(1000)) == nullptr);
+
+	bundle.Close();
+	std::filesystem::remove(path);
+}
+
+FTEST(AssetBundle_RejectsBrokenFiles) {
+	const std::string path = GetTempBundlePath("FlawTests_BrokenAssetBundle");
+	const std::vector<TestAsset> assets = CreateTestAssets();
+
+	FCHECK(BuildBundle(path, assets));
+
+	std::vector<char> bytes(std::filesystem::file_size(path));
+	std::ifstream(path, std::ios::binary).read(bytes.data(), bytes.size());
+
+	auto writeAndOpen = [&path](const std::vector<char>& contents) {
+		std::ofstream(path, std::ios::binary | std::ios::trunc).write(contents.data(), contents.size());
+		AssetBundle bundle;
+		return bundle.Open(path.c_str());
+	};
+
+	FCHECK(writeAndOpen(bytes));
+
+	// the entry table is at the end, cutting it off must not be read past the mapping
+	FCHECK(!writeAndOpen(std::vector<char>(bytes.begin(), bytes.end() - sizeof(AssetBundleEntry))));
+
+	std::vector<char> wrongMagic = bytes;
+	wrongMagic[0] ^= 0x20;
+	FCHECK(!writeAndOpen(wrongMagic));
+
+	std::vector<char> wrongVersion = bytes;
+	wrongVersion[4] = static_cast<char>(AssetBundleVersion + 1);
+	FCHECK(!writeAndOpen(wrongVersion));
+
+	FCHECK(!writeAndOpen(std::vector<char>(bytes.begin(), bytes.begin() + sizeof(AssetBundleHeader) - 1)));
+
+	std::filesystem::remove(path);
+}
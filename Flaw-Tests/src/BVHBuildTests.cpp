@@ -0,0 +1,262 @@
+#include "Test.h"
+#include "Utils/Raycast.h"
+
+#include <random>
+
+using namespace flaw;
+using namespace flaw::test;
+
+// triangle lists, three vertices per triangle like Mesh::BuildBVH reads them
+static std::vector<vec3> CreateSphereMesh(int32_t sliceCount, int32_t stackCount) {
+	auto getPoint = [&](int32_t slice, int32_t stack) {
+		const float theta = glm::two_pi<float>() * slice / sliceCount;
+		const float phi = glm::pi<float>() * stack / stackCount;
+		return vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+	};
+
+	std::vector<vec3> vertices;
+	for (int32_t stack = 0; stack < stackCount; ++stack) {
+		for (int32_t slice = 0; slice < sliceCount; ++slice) {
+			const vec3 a = getPoint(slice, stack), b = getPoint(slice + 1, stack);
+			const vec3 c = getPoint(slice, stack + 1), d = getPoint(slice + 1, stack + 1);
+			vertices.insert(vertices.end(), { a, b, c, b, d, c });
+		}
+	}
+
+	return vertices;
+}
+
+static std::vector<vec3> CreateTerrainMesh(int32_t gridSize) {
+	auto getPoint = [&](int32_t x, int32_t z) {
+		const float height = std::sin(x * 0.3f) * std::cos(z * 0.2f) * 2.0f + std::sin(x * 0.05f + z * 0.07f) * 6.0f;
+		return vec3(static_cast<float>(x), height, static_cast<float>(z));
+	};
+
+	std::vector<vec3> vertices;
+	for (int32_t z = 0; z < gridSize; ++z) {
+		for (int32_t x = 0; x < gridSize; ++x) {
+			const vec3 a = getPoint(x, z), b = getPoint(x + 1, z);
+			const vec3 c = getPoint(x, z + 1), d = getPoint(x + 1, z + 1);
+			vertices.insert(vertices.end(), { a, c, b, b, c, d });
+		}
+	}
+
+	return vertices;
+}
+
+// small boxes scattered through a large volume, midpoint splits cut through clusters here
+static std::vector<vec3> CreateScatteredBoxesMesh(int32_t boxCount) {
+	std::mt19937 random(17);
+	std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> size(0.2f, 1.5f);
+
+	std::vector<vec3> vertices;
+	for (int32_t i = 0; i < boxCount; ++i) {
+		// clustered around a few centers
+		const vec3 center = vec3(position(random), position(random), position(random)) * (i % 4 == 0 ? 1.0f : 0.1f);
+		const vec3 extent(size(random));
+
+		vec3 corners[8];
+		for (int32_t c = 0; c < 8; ++c) {
+			corners[c] = center + extent * vec3(c & 1 ? 1.0f : -1.0f, c & 2 ? 1.0f : -1.0f, c & 4 ? 1.0f : -1.0f);
+		}
+
+		const int32_t faces[6][4] = { { 0, 1, 3, 2 }, { 4, 6, 7, 5 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 5, 7, 3 } };
+		for (const auto& face : faces) {
+			vertices.insert(vertices.end(), { corners[face[0]], corners[face[1]], corners[face[2]], corners[face[0]], corners[face[2]], corners[face[3]] });
+		}
+	}
+
+	return vertices;
+}
+
+// rays from outside the mesh bounds aimed at random points inside them
+static std::vector<Ray> CreateRays(const std::vector<vec3>& vertices, int32_t rayCount) {
+	vec3 boundsMin(std::numeric_limits<float>::max()), boundsMax(std::numeric_limits<float>::lowest());
+	for (const vec3& vertex : vertices) {
+		boundsMin = min(boundsMin, vertex);
+		boundsMax = max(boundsMax, vertex);
+	}
+
+	const vec3 center = (boundsMin + boundsMax) * 0.5f;
+	const float radius = length(boundsMax - boundsMin);
+
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	std::vector<Ray> rays;
+	for (int32_t i = 0; i < rayCount; ++i) {
+		const vec3 origin = center + normalize(vec3(unit(random), unit(random), unit(random)) + vec3(0.0f, 0.001f, 0.0f)) * radius;
+		const vec3 target = center + (boundsMax - boundsMin) * 0.5f * vec3(unit(random), unit(random), unit(random));
+
+		Ray ray;
+		ray.origin = origin;
+		ray.direction = normalize(target - origin);
+		ray.length = radius * 2.0f;
+		rays.push_back(ray);
+	}
+
+	return rays;
+}
+
+struct BVHTraversalCost {
+	BVHBuildStats stats;
+	float averageTriangleTests = 0.0f;	// triangles in the leaves a ray passes through
+	int32_t closestHitMismatches = 0;
+};
+
+static BVHTraversalCost MeasureBVH(const std::vector<vec3>& vertices, const std::vector<Ray>& rays, const BVHBuildSettings& settings) {
+	std::vector<BVHNode> nodes;
+	std::vector<BVHTriangle> triangles;
+
+	BVHTraversalCost cost;
+	Raycast::BuildBVH([&](int32_t i) { return vertices[i]; }, static_cast<int32_t>(vertices.size()), nodes, triangles, settings);
+
+	// scored with the default weights so every builder is compared the same way
+	cost.stats = Raycast::EvaluateBVH(nodes);
+
+	FlatBVH flatBVH;
+	Raycast::FlattenBVH(nodes, triangles, flatBVH);
+
+	int64_t triangleTests = 0;
+	for (const Ray& ray : rays) {
+		float closest = std::numeric_limits<float>::max();
+
+		Raycast::GetCandidateBVHTriangles(nodes, triangles, ray, [&](int32_t triangleStart, int32_t triangleCount) {
+			triangleTests += triangleCount;
+
+			for (int32_t i = triangleStart; i < triangleStart + triangleCount; ++i) {
+				vec3 position;
+				float t;
+				if (Raycast::BVHTriangleLineIntersect(triangles[i], ray, position, t) && t <= ray.length) {
+					closest = std::min(closest, t);
+				}
+			}
+		});
+
+		RayHit hit;
+		const bool hasHit = Raycast::RaycastBVH(flatBVH, triangles, ray, hit);
+		const bool expectHit = closest != std::numeric_limits<float>::max();
+		if (hasHit != expectHit || (hasHit && std::abs(hit.distance - closest) > 1e-3f)) {
+			cost.closestHitMismatches++;
+		}
+	}
+
+	cost.averageTriangleTests = static_cast<float>(triangleTests) / rays.size();
+	return cost;
+}
+
+static void CompareBuilders(const char* name, const std::vector<vec3>& vertices) {
+	const std::vector<Ray> rays = CreateRays(vertices, 2000);
+
+	// what Mesh built before the sah builder, three levels of midpoint splits
+	BVHBuildSettings oldMidpoint;
+	oldMidpoint.splitMethod = BVHSplitMethod::Midpoint;
+	oldMidpoint.maxDepth = 3;
+	oldMidpoint.maxLeafTriangles = 1;
+
+	BVHBuildSettings midpoint;
+	midpoint.splitMethod = BVHSplitMethod::Midpoint;
+
+	const BVHBuildSettings sah;
+
+	const BVHTraversalCost oldCost = MeasureBVH(vertices, rays, oldMidpoint);
+	const BVHTraversalCost midpointCost = MeasureBVH(vertices, rays, midpoint);
+	const BVHTraversalCost sahCost = MeasureBVH(vertices, rays, sah);
+
+	std::printf("  %s, %zu triangles: sah cost %.1f / %.1f / %.1f, triangle tests per ray %.1f / %.1f / %.1f (old midpoint / midpoint / binned sah)\n",
+		name, vertices.size() / 3,
+		oldCost.stats.sahCost, midpointCost.stats.sahCost, sahCost.stats.sahCost,
+		oldCost.averageTriangleTests, midpointCost.averageTriangleTests, sahCost.averageTriangleTests);
+
+	// the simd kernel rounds differently, a ray grazing a silhouette edge may land on either side
+	FCHECK(oldCost.closestHitMismatches <= 2);
+	FCHECK(midpointCost.closestHitMismatches <= 2);
+	FCHECK(sahCost.closestHitMismatches <= 2);
+
+	// eight leaves cannot keep up with any deep tree, sah has to be at least as good as midpoint at the same depth
+	FCHECK(sahCost.stats.sahCost * 4.0f < oldCost.stats.sahCost);
+	FCHECK(sahCost.averageTriangleTests * 4.0f < oldCost.averageTriangleTests);
+	FCHECK(sahCost.stats.sahCost <= midpointCost.stats.sahCost * 1.1f);
+
+	FCHECK(sahCost.stats.maxDepth <= sah.maxDepth);
+	FCHECK(sahCost.stats.maxDepth < Raycast::MaxTraversalDepth);
+}
+
+FTEST(BVHBuild_SphereTraversalCost) {
+	CompareBuilders("sphere", CreateSphereMesh(64, 32));
+}
+
+FTEST(BVHBuild_TerrainTraversalCost) {
+	CompareBuilders("terrain", CreateTerrainMesh(64));
+}
+
+FTEST(BVHBuild_ScatteredBoxesTraversalCost) {
+	CompareBuilders("scattered boxes", CreateScatteredBoxesMesh(400));
+}
+
+// a comb of one triangle per level, deeper than the traversal stack, as a tree loaded from outside the builder could be
+static void CreateCombBVH(int32_t levelCount, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles) {
+	for (int32_t level = 0; level <= levelCount; ++level) {
+		const float z = static_cast<float>(level);
+		triangles.emplace_back(vec3(-1.0f, -1.0f, z), vec3(1.0f, -1.0f, z), vec3(0.0f, 1.0f, z));
+	}
+
+	auto createNode = [&](int32_t firstLevel, int32_t triangleStart, int32_t triangleCount) {
+		BVHNode node;
+		node.boundingBox.min = vec3(-1.0f, -1.0f, static_cast<float>(firstLevel));
+		node.boundingBox.max = vec3(1.0f, 1.0f, static_cast<float>(levelCount));
+		node.triangleStart = triangleStart;
+		node.triangleCount = triangleCount;
+		nodes.push_back(node);
+		return static_cast<int32_t>(nodes.size()) - 1;
+	};
+
+	// the interior child holds the deeper levels and is nearer to a ray coming down z, so every level defers its leaf
+	int32_t parent = createNode(0, 0, levelCount + 1);
+	for (int32_t level = 0; level < levelCount; ++level) {
+		const int32_t leaf = createNode(level, level, 1);
+		nodes[leaf].boundingBox.max.z = static_cast<float>(level);
+
+		const int32_t rest = createNode(level + 1, level + 1, levelCount - level);
+		nodes[parent].childA = leaf;
+		nodes[parent].childB = rest;
+		parent = rest;
+	}
+}
+
+FTEST(BVHBuild_TraversalDeeperThanStack) {
+	constexpr int32_t LevelCount = Raycast::MaxTraversalDepth * 2;
+
+	std::vector<BVHNode> nodes;
+	std::vector<BVHTriangle> triangles;
+	CreateCombBVH(LevelCount, nodes, triangles);
+
+	FlatBVH flatBVH;
+	Raycast::FlattenBVH(nodes, triangles, flatBVH);
+
+	Ray ray;
+	ray.origin = vec3(0.0f, 0.0f, LevelCount + 10.0f);
+	ray.direction = vec3(0.0f, 0.0f, -1.0f);
+	ray.length = 1000.0f;
+
+	// deferred leaves past the stack used to be dropped
+	int32_t hitCount = 0;
+	Raycast::TraverseBVH(flatBVH, ray, [&](int32_t, float, const vec2&) {
+		hitCount++;
+		return ray.length;
+	});
+
+	FCHECK(hitCount == LevelCount + 1);
+
+	int32_t candidateCount = 0;
+	Raycast::GetCandidateBVHTriangles(nodes, triangles, ray, [&](int32_t, int32_t triangleCount) {
+		candidateCount += triangleCount;
+	});
+
+	FCHECK(candidateCount == LevelCount + 1);
+
+	RayHit hit;
+	FCHECK(Raycast::RaycastBVH(flatBVH, triangles, ray, hit));
+	FCHECK_NEAR(hit.distance, 10.0f, 1e-4f);
+}
@@ -0,0 +1,68 @@
+#include "Test.h"
+#include "Utils/DynamicAABBTree.h"
+
+using namespace flaw;
+using namespace flaw::test;
+
+static bool IntersectRay(const AABB& box, const vec3& origin, const vec3& direction, float maxDistance, float& outDistance) {
+	return box.IntersectRay(origin, 1.0f / direction, maxDistance, outDistance);
+}
+
+FTEST(AABB_IntersectRay) {
+	const AABB box(vec3(0.0f), vec3(1.0f));
+
+	float distance = -1.0f;
+	FCHECK(IntersectRay(box, vec3(-2.0f, 0.5f, 0.5f), vec3(1.0f, 0.0f, 0.0f), 100.0f, distance));
+	FCHECK_NEAR(distance, 2.0f, 1e-5f);
+
+	FCHECK(!IntersectRay(box, vec3(-2.0f, 0.5f, 0.5f), vec3(-1.0f, 0.0f, 0.0f), 100.0f, distance));	// pointing away
+	FCHECK(!IntersectRay(box, vec3(-2.0f, 0.5f, 0.5f), vec3(1.0f, 0.0f, 0.0f), 1.5f, distance));	// too short
+
+	FCHECK(IntersectRay(box, vec3(0.5f), normalize(vec3(1.0f, 2.0f, 3.0f)), 100.0f, distance));		// from inside
+	FCHECK(distance == 0.0f);
+}
+
+// axis aligned rays have infinite inverse components, an origin on a slab plane used to turn the test into NaN and miss
+FTEST(AABB_IntersectRayOnSlabPlane) {
+	const AABB box(vec3(0.0f), vec3(1.0f));
+
+	float distance = -1.0f;
+	FCHECK(IntersectRay(box, vec3(-2.0f, 0.0f, 0.5f), vec3(1.0f, 0.0f, 0.0f), 100.0f, distance));		// along the min y face
+	FCHECK_NEAR(distance, 2.0f, 1e-5f);
+
+	FCHECK(IntersectRay(box, vec3(-2.0f, 1.0f, 1.0f), vec3(1.0f, 0.0f, 0.0f), 100.0f, distance));		// along the max y, max z edge
+	FCHECK(IntersectRay(box, vec3(0.5f, 0.5f, -3.0f), vec3(-0.0f, 0.0f, 1.0f), 100.0f, distance));	// negative zero components
+	FCHECK_NEAR(distance, 3.0f, 1e-5f);
+
+	FCHECK(!IntersectRay(box, vec3(-2.0f, -0.001f, 0.5f), vec3(1.0f, 0.0f, 0.0f), 100.0f, distance));	// just below the face
+	FCHECK(!IntersectRay(box, vec3(-2.0f, 1.001f, 0.5f), vec3(1.0f, 0.0f, 0.0f), 100.0f, distance));
+
+	// flat boxes, like a quad lying in a plane
+	const AABB flat(vec3(0.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 1.0f));
+	FCHECK(IntersectRay(flat, vec3(0.5f, 0.0f, -1.0f), vec3(0.0f, 0.0f, 1.0f), 100.0f, distance));
+	FCHECK(IntersectRay(flat, vec3(0.5f, 5.0f, 0.5f), vec3(0.0f, -1.0f, 0.0f), 100.0f, distance));
+	FCHECK_NEAR(distance, 5.0f, 1e-5f);
+}
+
+FTEST(DynamicAABBTree_QueryRayOnSlabPlane) {
+	DynamicAABBTree tree(0.0f);
+
+	for (int32_t i = 0; i < 16; ++i) {
+		const vec3 min = vec3(static_cast<float>(i) * 2.0f, 0.0f, 0.0f);
+		tree.CreateProxy(AABB(min, min + vec3(1.0f)), i);
+	}
+
+	// grazes the bottom face of every box, the tree nodes share that plane too
+	Ray ray;
+	ray.origin = vec3(-1.0f, 0.0f, 0.5f);
+	ray.direction = vec3(1.0f, 0.0f, 0.0f);
+	ray.length = 1000.0f;
+
+	int32_t hitCount = 0;
+	tree.QueryRay(ray, [&](int32_t, float) {
+		hitCount++;
+		return ray.length;
+	});
+
+	FCHECK(hitCount == 16);
+}
@@ -0,0 +1,141 @@
+#include "Test.h"
+#include "Math/FrustumCulling.h"
+
+#include <random>
+
+using namespace flaw;
+using namespace flaw::test;
+
+namespace {
+	struct TestVolume {
+		vec3 position;
+		float radius;
+		vec3 extent;
+	};
+}
+
+static std::vector<TestVolume> CreateRandomVolumes(uint32_t count, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> size(0.1f, 8.0f);
+
+	std::vector<TestVolume> volumes(count);
+	for (auto& volume : volumes) {
+		volume.position = vec3(position(random), position(random), position(random) + 50.0f);
+		volume.radius = size(random);
+		volume.extent = vec3(size(random), size(random), size(random));
+	}
+
+	return volumes;
+}
+
+// only translated, so the world box and sphere match what the scalar tests see exactly
+static void FillCullingVolumes(const std::vector<TestVolume>& testVolumes, CullingVolumes& volumes) {
+	volumes.Resize(static_cast<uint32_t>(testVolumes.size()));
+	for (uint32_t i = 0; i < testVolumes.size(); ++i) {
+		const TestVolume& volume = testVolumes[i];
+		volumes.Set(i, vec3(0.0f), volume.radius, -volume.extent, volume.extent, translate(mat4(1.0f), volume.position));
+	}
+}
+
+// culled when either the sphere or the box is fully outside
+static bool IsVisibleScalar(Frustum& frustum, const TestVolume& volume) {
+	const mat4 modelMatrix = translate(mat4(1.0f), volume.position);
+	return frustum.TestInside(vec3(0.0f), volume.radius, modelMatrix) && frustum.TestInside(-volume.extent, volume.extent, modelMatrix);
+}
+
+// volumes touching a plane within rounding may go either way between the two paths
+static bool IsOnPlane(const Frustum& frustum, const TestVolume& volume) {
+	for (const auto& plane : frustum.planes.data) {
+		const float distance = plane.Distance(volume.position);
+		const float boxRadius = dot(abs(plane.Normal()), volume.extent);
+		if (std::abs(distance - volume.radius) < 1e-3f || std::abs(distance - boxRadius) < 1e-3f) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void CheckAgainstScalar(Frustum& frustum, const std::vector<TestVolume>& testVolumes, uint32_t begin, uint32_t end) {
+	CullingVolumes volumes;
+	FillCullingVolumes(testVolumes, volumes);
+
+	std::vector<uint32_t> visibleIndices(end - begin);
+	const uint32_t visibleCount = CullVolumes(frustum, volumes, begin, end, visibleIndices.data());
+	visibleIndices.resize(visibleCount);
+
+	std::vector<uint32_t> expectedIndices;
+	for (uint32_t i = begin; i < end; ++i) {
+		if (IsVisibleScalar(frustum, testVolumes[i])) {
+			expectedIndices.push_back(i);
+		}
+	}
+
+	// both lists are ascending, walk them together and skip volumes on a plane
+	int32_t mismatchCount = 0;
+	uint32_t v = 0, e = 0;
+	while (v < visibleIndices.size() || e < expectedIndices.size()) {
+		const uint32_t visibleIndex = v < visibleIndices.size() ? visibleIndices[v] : UINT32_MAX;
+		const uint32_t expectedIndex = e < expectedIndices.size() ? expectedIndices[e] : UINT32_MAX;
+
+		if (visibleIndex == expectedIndex) {
+			v++, e++;
+			continue;
+		}
+
+		const uint32_t index = visibleIndex < expectedIndex ? visibleIndex : expectedIndex;
+		mismatchCount += !IsOnPlane(frustum, testVolumes[index]);
+		(visibleIndex < expectedIndex ? v : e)++;
+	}
+
+	FCHECK(mismatchCount == 0);
+}
+
+static Frustum CreatePerspectiveTestFrustum() {
+	Frustum frustum;
+	CreateFrustum(glm::radians(70.0f), glm::radians(45.0f), 0.5f, 100.0f, vec3(3.0f, 5.0f, -10.0f), normalize(vec3(-3.0f, -5.0f, 50.0f)), frustum);
+	return frustum;
+}
+
+static Frustum CreateOrthographicTestFrustum() {
+	Frustum frustum;
+	CreateOrthographicFrustum(-30.0f, 20.0f, -15.0f, 25.0f, 1.0f, 80.0f, LookAt(vec3(-5.0f, 40.0f, 20.0f), vec3(0.0f, 0.0f, 50.0f), Up), frustum);
+	return frustum;
+}
+
+// counts around the 4 and 8 wide batches leave a scalar tail, odd begins start off the lane boundary
+FTEST(FrustumCulling_SIMDMatchesScalar) {
+	const std::vector<TestVolume> testVolumes = CreateRandomVolumes(4099, 11);
+
+	Frustum perspective = CreatePerspectiveTestFrustum();
+	Frustum orthographic = CreateOrthographicTestFrustum();
+
+	const uint32_t ranges[][2] = { { 0, 1 }, { 0, 3 }, { 0, 4 }, { 0, 7 }, { 0, 8 }, { 0, 13 }, { 3, 21 }, { 5, 1029 }, { 0, 4099 } };
+	for (const auto& range : ranges) {
+		CheckAgainstScalar(perspective, testVolumes, range[0], range[1]);
+		CheckAgainstScalar(orthographic, testVolumes, range[0], range[1]);
+	}
+}
+
+FTEST(FrustumCulling_TaskMatchesSingleBatch) {
+	const std::vector<TestVolume> testVolumes = CreateRandomVolumes(2501, 23);
+	Frustum frustum = CreatePerspectiveTestFrustum();
+
+	CullingVolumes volumes;
+	FillCullingVolumes(testVolumes, volumes);
+
+	std::vector<uint32_t> expectedIndices(volumes.Count());
+	expectedIndices.resize(CullVolumes(frustum, volumes, 0, volumes.Count(), expectedIndices.data()));
+	FCHECK(!expectedIndices.empty() && expectedIndices.size() < volumes.Count());
+
+	JobSystem jobSystem(2);
+	JobCounter counter;
+
+	// a batch size off the lane width, so every batch ends in a partial group
+	FrustumCullTask task;
+	task.Schedule(jobSystem, counter, frustum, volumes, 333);
+	jobSystem.Wait(counter);
+	task.Finish();
+
+	FCHECK(task.GetVisibleIndices() == expectedIndices);
+}
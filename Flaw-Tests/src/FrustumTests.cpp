@@ -0,0 +1,85 @@
+#include "Test.h"
+#include "Math/Math.h"
+
+#include <random>
+
+using namespace flaw;
+using namespace flaw::test;
+
+static bool IsInside(Frustum& frustum, const vec3& point) {
+	return frustum.TestInside(point, 0.0f, mat4(1.0f));
+}
+
+// the frustum has to cull exactly what the projection keeps, clip space is x, y in [-1, 1] and z in [0, 1]
+static bool IsInsideProjection(const mat4& viewProjection, const vec3& point) {
+	const vec4 clip = viewProjection * vec4(point, 1.0f);
+	const vec3 ndc = vec3(clip) / clip.w;
+	return ndc.x >= -1.0f && ndc.x <= 1.0f && ndc.y >= -1.0f && ndc.y <= 1.0f && ndc.z >= 0.0f && ndc.z <= 1.0f;
+}
+
+static void CheckAgainstProjection(float left, float right, float bottom, float top, float nearClip, float farClip, const mat4& view) {
+	Frustum frustum;
+	CreateOrthographicFrustum(left, right, bottom, top, nearClip, farClip, view, frustum);
+
+	const mat4 viewProjection = Orthographic(left, right, bottom, top, nearClip, farClip) * view;
+	const mat4 invView = inverse(view);
+
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> unit(-0.5f, 1.5f);
+
+	int32_t mismatchCount = 0;
+	for (int32_t i = 0; i < 10000; ++i) {
+		// sample around the box in view space, a small margin keeps points off the faces where rounding decides
+		const vec3 viewPoint = vec3(mix(left, right, unit(random)), mix(bottom, top, unit(random)), mix(nearClip, farClip, unit(random)));
+		const vec3 margin = vec3(right - left, top - bottom, farClip - nearClip) * 1e-3f;
+		if (any(lessThan(abs(viewPoint - vec3(left, bottom, nearClip)), margin)) || any(lessThan(abs(viewPoint - vec3(right, top, farClip)), margin))) {
+			continue;
+		}
+
+		const vec3 worldPoint = invView * vec4(viewPoint, 1.0f);
+		mismatchCount += IsInside(frustum, worldPoint) != IsInsideProjection(viewProjection, worldPoint);
+	}
+
+	FCHECK(mismatchCount == 0);
+}
+
+FTEST(Frustum_OrthographicMatchesProjection) {
+	CheckAgainstProjection(-5.0f, 5.0f, -3.0f, 3.0f, 1.0f, 100.0f, LookAt(vec3(0.0f, 0.0f, -10.0f), vec3(0.0f), Up));
+	CheckAgainstProjection(-5.0f, 5.0f, -3.0f, 3.0f, 1.0f, 100.0f, LookAt(vec3(3.0f, 20.0f, -7.0f), vec3(1.0f, 0.0f, 2.0f), Up));
+}
+
+FTEST(Frustum_OrthographicPlanes) {
+	Frustum frustum;
+	CreateOrthographicFrustum(-5.0f, 5.0f, -3.0f, 3.0f, 1.0f, 100.0f, LookAt(vec3(0.0f, 0.0f, -10.0f), vec3(0.0f), Up), frustum);
+
+	FCHECK(IsInside(frustum, vec3(0.0f)));
+	FCHECK(IsInside(frustum, vec3(4.9f, 2.9f, 0.0f)));
+	FCHECK(!IsInside(frustum, vec3(5.1f, 0.0f, 0.0f)));
+	FCHECK(!IsInside(frustum, vec3(0.0f, -3.1f, 0.0f)));
+	FCHECK(!IsInside(frustum, vec3(0.0f, 0.0f, -9.5f)));	// before the near plane
+	FCHECK(IsInside(frustum, vec3(0.0f, 0.0f, 89.0f)));
+	FCHECK(!IsInside(frustum, vec3(0.0f, 0.0f, 91.0f)));	// past the far plane
+
+	// spheres touching a face from outside are kept
+	FCHECK(frustum.TestInside(vec3(6.0f, 0.0f, 0.0f), 1.5f, mat4(1.0f)));
+	FCHECK(!frustum.TestInside(vec3(7.0f, 0.0f, 0.0f), 1.5f, mat4(1.0f)));
+}
+
+// cascades and shadow boxes are off center in light view space, the box must not be recentered on the view axis
+FTEST(Frustum_OffCenterOrthographic) {
+	const mat4 view = LookAt(vec3(10.0f, 0.0f, 0.0f), vec3(10.0f, 0.0f, 1.0f), Up);
+
+	Frustum frustum;
+	CreateOrthographicFrustum(2.0f, 8.0f, -1.0f, 5.0f, 0.5f, 10.0f, view, frustum);
+
+	const Frustum::Corners corners = frustum.GetCorners();
+	const vec3 eps = vec3(1e-4f);
+	FCHECK(all(lessThan(abs(corners.topLeftNear() - vec3(12.0f, 5.0f, 0.5f)), eps)));
+	FCHECK(all(lessThan(abs(corners.bottomRightFar() - vec3(18.0f, -1.0f, 10.0f)), eps)));
+
+	FCHECK(IsInside(frustum, vec3(15.0f, 2.0f, 5.0f)));
+	FCHECK(!IsInside(frustum, vec3(10.0f, 2.0f, 5.0f)));	// on the view axis, left of the box
+
+	CheckAgainstProjection(2.0f, 8.0f, -1.0f, 5.0f, 0.5f, 10.0f, view);
+	CheckAgainstProjection(-20.0f, -12.0f, 3.0f, 9.0f, -4.0f, 6.0f, LookAt(vec3(1.0f, 2.0f, 3.0f), vec3(2.0f, 1.0f, 5.0f), Up));
+}
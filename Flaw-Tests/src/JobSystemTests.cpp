@@ -0,0 +1,177 @@
+#include "Test.h"
+#include "Reference/ThreadPool.h"
+#include "Utils/JobSystem.h"
+
+#include <atomic>
+#include <array>
+
+using namespace flaw;
+using namespace flaw::test;
+
+static int32_t GetTestWorkerCount() {
+	const int32_t hardwareThreads = static_cast<int32_t>(std::thread::hardware_concurrency());
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+FTEST(JobSystem_RunsEveryScheduledJob) {
+	JobSystem jobSystem(GetTestWorkerCount());
+
+	std::atomic<int32_t> sum = 0;
+	JobCounter counter;
+	for (int32_t i = 1; i <= 10000; ++i) {
+		jobSystem.Schedule([&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); }, &counter);
+	}
+
+	jobSystem.Wait(counter);
+
+	FCHECK(counter.IsDone());
+	FCHECK(sum.load() == 10000 * 10001 / 2);
+}
+
+FTEST(JobSystem_DependencyRunsFirst) {
+	JobSystem jobSystem(GetTestWorkerCount());
+
+	for (int32_t round = 0; round < 100; ++round) {
+		std::atomic<int32_t> firstDone = 0;
+		std::atomic<int32_t> orderViolations = 0;
+
+		JobCounter first;
+		for (int32_t i = 0; i < 16; ++i) {
+			jobSystem.Schedule([&firstDone]() { firstDone.fetch_add(1); }, &first);
+		}
+
+		JobCounter second;
+		for (int32_t i = 0; i < 16; ++i) {
+			jobSystem.Schedule([&firstDone, &orderViolations]() {
+				if (firstDone.load() != 16) {
+					orderViolations.fetch_add(1);
+				}
+			}, &second, &first);
+		}
+
+		jobSystem.Wait(second);
+
+		FCHECK(orderViolations.load() == 0);
+	}
+}
+
+FTEST(JobSystem_NestedJobsFromWorkers) {
+	JobSystem jobSystem(GetTestWorkerCount());
+
+	std::atomic<int32_t> leafCount = 0;
+	JobCounter counter;
+	for (int32_t i = 0; i < 64; ++i) {
+		jobSystem.Schedule([&jobSystem, &leafCount]() {
+			JobCounter inner;
+			for (int32_t j = 0; j < 64; ++j) {
+				jobSystem.Schedule([&leafCount]() { leafCount.fetch_add(1); }, &inner);
+			}
+			jobSystem.Wait(inner);
+		}, &counter);
+	}
+
+	jobSystem.Wait(counter);
+
+	FCHECK(leafCount.load() == 64 * 64);
+}
+
+FTEST(JobSystem_ParallelForVisitsEveryIndexOnce) {
+	JobSystem jobSystem(GetTestWorkerCount());
+
+	for (int32_t count : { 0, 1, 7, 64, 1000, 12345 }) {
+		std::vector<std::atomic<int32_t>> visits(count);
+		jobSystem.ParallelFor(count, 16, [&visits](int32_t index) { visits[index].fetch_add(1); });
+
+		bool allOnce = true;
+		for (const auto& visit : visits) {
+			allOnce &= visit.load() == 1;
+		}
+
+		FCHECK(allOnce);
+	}
+}
+
+FTEST(JobSystem_LargeCallablesAreStored) {
+	JobSystem jobSystem(1);
+
+	std::array<int64_t, 32> values; // bigger than Job::InlineSize, goes to the heap
+	for (int32_t i = 0; i < 32; ++i) {
+		values[i] = i;
+	}
+
+	std::atomic<int64_t> sum = 0;
+	JobCounter counter;
+	jobSystem.Schedule([values, &sum]() {
+		int64_t localSum = 0;
+		for (int64_t value : values) {
+			localSum += value;
+		}
+		sum.store(localSum);
+	}, &counter);
+
+	jobSystem.Wait(counter);
+
+	FCHECK(sum.load() == 31 * 32 / 2);
+}
+
+// small per entity tasks like AnimationSystem submits, the case the single locked queue of ThreadPool handled badly
+constexpr int32_t BenchmarkTaskCount = 200000;
+
+static void SimulateEntityWork(std::atomic<int64_t>& sink, int32_t index) {
+	int64_t value = index;
+	for (int32_t i = 0; i < 64; ++i) {
+		value = value * 6364136223846793005ll + 1442695040888963407ll;
+	}
+	sink.fetch_add(value & 1, std::memory_order_relaxed);
+}
+
+FBENCH(JobSystem_ThroughputAgainstThreadPool) {
+	const int32_t workerCount = GetTestWorkerCount();
+
+	std::atomic<int64_t> poolSink = 0;
+	const double poolMs = MeasureMs(3, [&]() {
+		std::atomic<int32_t> remaining = BenchmarkTaskCount;
+		std::mutex doneMutex;
+		std::condition_variable doneCondition;
+		{
+			ThreadPool pool(workerCount);
+			for (int32_t i = 0; i < BenchmarkTaskCount; ++i) {
+				pool.EnqueueTask([&, i]() {
+					SimulateEntityWork(poolSink, i);
+					if (remaining.fetch_sub(1) == 1) {
+						std::lock_guard<std::mutex> lock(doneMutex);
+						doneCondition.notify_one();
+					}
+				});
+			}
+
+			std::unique_lock<std::mutex> lock(doneMutex);
+			doneCondition.wait(lock, [&remaining]() { return remaining.load() == 0; });
+		}
+	});
+
+	std::atomic<int64_t> jobSink = 0;
+	const double jobMs = MeasureMs(3, [&]() {
+		JobSystem jobSystem(workerCount);
+		JobCounter counter;
+		for (int32_t i = 0; i < BenchmarkTaskCount; ++i) {
+			jobSystem.Schedule([&jobSink, i]() { SimulateEntityWork(jobSink, i); }, &counter);
+		}
+		jobSystem.Wait(counter);
+	});
+
+	std::atomic<int64_t> parallelForSink = 0;
+	const double parallelForMs = MeasureMs(3, [&]() {
+		JobSystem jobSystem(workerCount);
+		jobSystem.ParallelFor(BenchmarkTaskCount, 256, [&parallelForSink](int32_t index) { SimulateEntityWork(parallelForSink, index); });
+	});
+
+	std::printf("  %d tasks on %d workers\n", BenchmarkTaskCount, workerCount);
+	std::printf("  ThreadPool            %8.2f ms\n", poolMs);
+	std::printf("  JobSystem::Schedule   %8.2f ms (%.2fx)\n", jobMs, poolMs / jobMs);
+	std::printf("  JobSystem::ParallelFor%8.2f ms (%.2fx)\n", parallelForMs, poolMs / parallelForMs);
+
+	// every run does the same work
+	FCHECK(poolSink.load() == jobSink.load());
+	FCHECK(jobSink.load() == parallelForSink.load());
+}
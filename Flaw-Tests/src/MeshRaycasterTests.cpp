@@ -0,0 +1,292 @@
+#include "Test.h"
+#include "Engine/MeshRaycaster.h"
+#include "Engine/Mesh.h"
+#include "Utils/JobSystem.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace flaw;
+using namespace flaw::test;
+
+namespace {
+	struct TestMesh {
+		std::vector<Vertex3D> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<MeshSegment> segments;
+		Ref<Mesh> mesh;
+	};
+
+	struct TestInstance {
+		entt::entity entity;
+		const TestMesh* mesh;
+		mat4 worldTransform;
+	};
+
+	struct BruteForceHit {
+		entt::entity entity;
+		int32_t segmentIndex;
+		int32_t triangleIndex;
+		vec2 barycentric;
+		float distance;
+	};
+
+	struct BruteForceResult {
+		std::vector<BruteForceHit> hits; // nearest first
+		bool ambiguous = false; // a triangle edge or a second hit is within rounding
+	};
+}
+
+// two segments of random triangles, the second one indexes from its own vertex start
+static TestMesh CreateTestMesh(std::mt19937& random, int32_t triangleCountA, int32_t triangleCountB) {
+	std::uniform_real_distribution<float> position(-2.0f, 2.0f);
+	std::uniform_real_distribution<float> offset(-0.6f, 0.6f);
+
+	TestMesh testMesh;
+	for (int32_t triangleCount : { triangleCountA, triangleCountB }) {
+		MeshSegment segment;
+		segment.vertexStart = static_cast<uint32_t>(testMesh.vertices.size());
+		segment.vertexCount = triangleCount * 3;
+		segment.indexStart = static_cast<uint32_t>(testMesh.indices.size());
+		segment.indexCount = triangleCount * 3;
+
+		for (int32_t i = 0; i < triangleCount; ++i) {
+			const vec3 center(position(random), position(random), position(random));
+			for (int32_t k = 0; k < 3; ++k) {
+				Vertex3D vertex = {};
+				vertex.position = center + vec3(offset(random), offset(random), offset(random));
+				testMesh.vertices.push_back(vertex);
+			}
+
+			// reversed winding on every other triangle, raycasts are two sided
+			const uint32_t first = i * 3;
+			if (i % 2) {
+				testMesh.indices.insert(testMesh.indices.end(), { first, first + 2, first + 1 });
+			}
+			else {
+				testMesh.indices.insert(testMesh.indices.end(), { first, first + 1, first + 2 });
+			}
+		}
+
+		testMesh.segments.push_back(segment);
+	}
+
+	testMesh.mesh = CreateRef<Mesh>(testMesh.vertices, testMesh.indices, testMesh.segments);
+
+	return testMesh;
+}
+
+// moller trumbore in double precision against the world space triangles
+static BruteForceResult RaycastBruteForce(const std::vector<TestInstance>& instances, const Ray& ray) {
+	constexpr double EdgeEpsilon = 1e-4;
+	constexpr double DistanceEpsilon = 1e-3;
+
+	const dvec3 origin = dvec3(ray.origin);
+	const dvec3 direction = dvec3(ray.direction);
+
+	BruteForceResult result;
+	for (const TestInstance& instance : instances) {
+		const TestMesh& testMesh = *instance.mesh;
+
+		for (int32_t segmentIndex = 0; segmentIndex < static_cast<int32_t>(testMesh.segments.size()); ++segmentIndex) {
+			const MeshSegment& segment = testMesh.segments[segmentIndex];
+
+			for (uint32_t triangleIndex = 0; triangleIndex < segment.indexCount / 3; ++triangleIndex) {
+				dvec3 p[3];
+				for (uint32_t k = 0; k < 3; ++k) {
+					const uint32_t vertexIndex = segment.vertexStart + testMesh.indices[segment.indexStart + triangleIndex * 3 + k];
+					p[k] = dvec3(instance.worldTransform * vec4(testMesh.vertices[vertexIndex].position, 1.0f));
+				}
+
+				const dvec3 edge1 = p[1] - p[0];
+				const dvec3 edge2 = p[2] - p[0];
+				const dvec3 h = cross(direction, edge2);
+				const double a = dot(edge1, h);
+				if (std::abs(a) < 1e-12) {
+					continue;
+				}
+
+				const double f = 1.0 / a;
+				const dvec3 s = origin - p[0];
+				const double u = f * dot(s, h);
+				const dvec3 q = cross(s, edge1);
+				const double v = f * dot(direction, q);
+				const double t = f * dot(edge2, q);
+
+				// close to an edge or to either end of the ray either side may win
+				const bool inside = u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= 0.0 && t <= ray.length;
+				const bool nearEdge = u > -EdgeEpsilon && v > -EdgeEpsilon && u + v < 1.0 + EdgeEpsilon && t > -DistanceEpsilon && t < ray.length + DistanceEpsilon
+					&& (u < EdgeEpsilon || v < EdgeEpsilon || u + v > 1.0 - EdgeEpsilon || t < DistanceEpsilon || t > ray.length - DistanceEpsilon);
+
+				result.ambiguous |= nearEdge;
+
+				if (inside) {
+					result.hits.push_back({ instance.entity, segmentIndex, static_cast<int32_t>(triangleIndex), vec2(u, v), static_cast<float>(t) });
+				}
+			}
+		}
+	}
+
+	std::sort(result.hits.begin(), result.hits.end(), [](const BruteForceHit& lhs, const BruteForceHit& rhs) { return lhs.distance < rhs.distance; });
+
+	for (size_t i = 1; i < result.hits.size(); ++i) {
+		result.ambiguous |= result.hits[i].distance - result.hits[i - 1].distance < DistanceEpsilon;
+	}
+
+	return result;
+}
+
+static bool IsSameHit(const MeshRayHit& hit, const BruteForceHit& expected) {
+	return hit.entity == expected.entity
+		&& hit.segmentIndex == expected.segmentIndex
+		&& hit.triangleIndex == expected.triangleIndex
+		&& std::abs(hit.barycentric.x - expected.barycentric.x) < 1e-3f
+		&& std::abs(hit.barycentric.y - expected.barycentric.y) < 1e-3f
+		&& std::abs(hit.distance - expected.distance) < 1e-3f;
+}
+
+static const BruteForceHit* FindHit(const BruteForceResult& result, const MeshRayHit& hit) {
+	for (const auto& expected : result.hits) {
+		if (IsSameHit(hit, expected)) {
+			return &expected;
+		}
+	}
+	return nullptr;
+}
+
+// every mode against a brute force test of every triangle, ambiguous rays are left out
+FTEST(MeshRaycaster_MatchesBruteForce) {
+	constexpr int32_t InstanceCount = 24;
+	constexpr int32_t RayCount = 2000;
+
+	Graphics::Init(GraphicsType::Null, 640, 480);
+
+	{
+		std::mt19937 random(5);
+
+		TestMesh meshes[2] = { CreateTestMesh(random, 40, 25), CreateTestMesh(random, 7, 60) };
+
+		std::uniform_real_distribution<float> position(-12.0f, 12.0f);
+		std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+		MeshRaycaster raycaster;
+		std::vector<TestInstance> instances;
+
+		for (int32_t i = 0; i < InstanceCount; ++i) {
+			TestInstance instance;
+			instance.entity = static_cast<entt::entity>(100 + i);
+			instance.mesh = &meshes[i % 2];
+			instance.worldTransform = ModelMatrix(vec3(position(random), position(random), position(random)), vec3(angle(random), angle(random), angle(random)), vec3(scale(random), scale(random), scale(random)));
+
+			const MeshBoundingBox& bounds = instance.mesh->mesh->GetBoundingBox();
+			raycaster.AddInstance(instance.entity, instance.mesh->mesh, instance.worldTransform, AABB(bounds.min, bounds.max).Transform(instance.worldTransform));
+
+			instances.push_back(instance);
+		}
+
+		raycaster.Update();
+
+		// from outside the scene toward a point inside it, a few fall short of the far side
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> rayLength(20.0f, 80.0f);
+
+		std::vector<RaycastQuery> queries;
+		for (int32_t i = 0; i < RayCount; ++i) {
+			const vec3 origin = normalize(vec3(unit(random), unit(random), unit(random)) + vec3(0.0f, 0.0f, 1e-3f)) * 30.0f;
+			const vec3 target = vec3(unit(random), unit(random), unit(random)) * 12.0f;
+
+			RaycastQuery query;
+			query.ray.origin = origin;
+			query.ray.direction = normalize(target - origin);
+			query.ray.length = rayLength(random);
+			queries.push_back(query);
+		}
+
+		JobSystem jobSystem(2);
+
+		RaycastBatchResult closest, any, all;
+		for (auto& query : queries) { query.mode = RaycastMode::Closest; }
+		raycaster.RaycastBatch(queries, closest, &jobSystem);
+		for (auto& query : queries) { query.mode = RaycastMode::Any; }
+		raycaster.RaycastBatch(queries, any);
+		for (auto& query : queries) { query.mode = RaycastMode::All; }
+		raycaster.RaycastBatch(queries, all, &jobSystem);
+
+		int32_t checkedCount = 0, hitCount = 0, multiHitCount = 0;
+		int32_t closestMismatches = 0, anyMismatches = 0, allMismatches = 0, singleMismatches = 0;
+
+		for (int32_t i = 0; i < RayCount; ++i) {
+			const BruteForceResult expected = RaycastBruteForce(instances, queries[i].ray);
+			if (expected.ambiguous) {
+				continue;
+			}
+
+			checkedCount++;
+			hitCount += !expected.hits.empty();
+			multiHitCount += expected.hits.size() > 1;
+
+			// closest, through the batch and the single ray shortcut
+			if (expected.hits.empty()) {
+				closestMismatches += closest.HasHit(i);
+			}
+			else {
+				closestMismatches += closest.ranges[i].count != 1 || !IsSameHit(closest.GetHit(i), expected.hits[0]);
+			}
+
+			MeshRayHit single;
+			const bool singleHit = raycaster.Raycast(queries[i].ray, single);
+			singleMismatches += singleHit != !expected.hits.empty() || (singleHit && !IsSameHit(single, expected.hits[0]));
+
+			// any, one of the hits
+			if (expected.hits.empty()) {
+				anyMismatches += any.HasHit(i);
+			}
+			else {
+				anyMismatches += any.ranges[i].count != 1 || FindHit(expected, any.GetHit(i)) == nullptr;
+			}
+
+			// all, every hit nearest first
+			if (all.ranges[i].count != expected.hits.size()) {
+				allMismatches++;
+				continue;
+			}
+
+			for (uint32_t h = 0; h < all.ranges[i].count; ++h) {
+				allMismatches += !IsSameHit(all.GetHit(i, h), expected.hits[h]);
+			}
+		}
+
+		std::printf("  %d of %d rays checked, %d hit, %d hit more than once\n", checkedCount, RayCount, hitCount, multiHitCount);
+
+		FCHECK(checkedCount > RayCount * 9 / 10);
+		FCHECK(hitCount > checkedCount / 4 && multiHitCount > hitCount / 4);
+		FCHECK(closestMismatches == 0);
+		FCHECK(singleMismatches == 0);
+		FCHECK(anyMismatches == 0);
+		FCHECK(allMismatches == 0);
+
+		// hits report their submesh, both segments of both meshes are hit
+		bool segmentHit[2][2] = {};
+		for (const auto& hit : all.hits) {
+			const int32_t meshIndex = (static_cast<int32_t>(hit.entity) - 100) % 2;
+			segmentHit[meshIndex][hit.segmentIndex] = true;
+		}
+		FCHECK(segmentHit[0][0] && segmentHit[0][1] && segmentHit[1][0] && segmentHit[1][1]);
+
+		// removed instances are no longer hit
+		for (int32_t instanceId = 0; instanceId < InstanceCount; instanceId += 2) {
+			raycaster.RemoveInstance(instanceId);
+		}
+		raycaster.Update();
+		raycaster.RaycastBatch(queries, all);
+
+		int32_t removedHitCount = 0;
+		for (const auto& hit : all.hits) {
+			removedHitCount += (static_cast<int32_t>(hit.entity) - 100) % 2 == 0;
+		}
+		FCHECK(!all.hits.empty() && removedHitCount == 0);
+	}
+
+	Graphics::Cleanup();
+}
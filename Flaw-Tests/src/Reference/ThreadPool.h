@@ -0,0 +1,70 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <vector>
+#include <functional>
+
+namespace flaw::test {
+	// the single queue pool JobSystem replaced, kept as the baseline of the job benchmarks
+	class ThreadPool {
+	public:
+		ThreadPool(int32_t threadCount) : _stopSignal(false) {
+			for (int32_t i = 0; i < threadCount; ++i) {
+				_threads.emplace_back(&ThreadPool::WorkerThread, this);
+			}
+		}
+
+		~ThreadPool() {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stopSignal = true;
+			}
+
+			_conditionVariable.notify_all();
+
+			for (auto& thread : _threads) {
+				thread.join();
+			}
+		}
+
+		void EnqueueTask(std::function<void()> task) {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_tasks.push(std::move(task));
+			}
+
+			_conditionVariable.notify_one();
+		}
+
+	private:
+		static void WorkerThread(ThreadPool* pool) {
+			while (true) {
+				std::function<void()> task;
+
+				{
+					std::unique_lock<std::mutex> lock(pool->_mutex);
+					pool->_conditionVariable.wait(lock, [pool] { return !pool->_tasks.empty() || pool->_stopSignal; });
+					if (pool->_stopSignal && pool->_tasks.empty()) {
+						return;
+					}
+					task = std::move(pool->_tasks.front());
+					pool->_tasks.pop();
+				}
+
+				task();
+			}
+		}
+
+	private:
+		std::mutex _mutex;
+		std::condition_variable _conditionVariable;
+		std::vector<std::thread> _threads;
+
+		std::queue<std::function<void()>> _tasks;
+
+		bool _stopSignal;
+	};
+}
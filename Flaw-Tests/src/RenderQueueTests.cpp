@@ -0,0 +1,207 @@
+#include "Test.h"
+#include "Engine/RenderQueue.h"
+#include "Graphics/Null/NullContext.h"
+
+using namespace flaw;
+using namespace flaw::test;
+
+namespace {
+	// stands in for a gpu palette, the queue only compares the pointers
+	class FakeStructuredBuffer : public StructuredBuffer {
+	public:
+		void Create(const Descriptor&) override {}
+		void Update(const void*, uint32_t) override {}
+		void Fetch(void*, uint32_t) override {}
+		uint32_t Size() const override { return 0; }
+	};
+}
+
+static mat4 GetGridTransform(int32_t index) {
+	return translate(mat4(1.0f), vec3(static_cast<float>(index % 32), 0.0f, static_cast<float>(index / 32)));
+}
+
+// crowd entities push their shared palette in entity order, the sort has to gather them into one draw per palette
+FTEST(RenderQueue_CrowdPalettesShareDraws) {
+	constexpr int32_t CrowdPaletteCount = 3;
+	constexpr int32_t CrowdEntityCount = 300;
+	constexpr int32_t SoloEntityCount = 4;
+
+	Ref<Mesh> mesh = CreateRef<Mesh>();
+	Ref<Material> material = CreateRef<Material>();
+
+	std::vector<Ref<StructuredBuffer>> crowdPalettes;
+	for (int32_t i = 0; i < CrowdPaletteCount; ++i) {
+		crowdPalettes.push_back(CreateRef<FakeStructuredBuffer>());
+	}
+
+	RenderQueue queue;
+	queue.Open();
+
+	for (int32_t i = 0; i < CrowdEntityCount; ++i) {
+		queue.Push(mesh, 0, GetGridTransform(i), material, crowdPalettes[i % CrowdPaletteCount]);
+	}
+
+	// entities outside the crowd keep their own palette and draw
+	for (int32_t i = 0; i < SoloEntityCount; ++i) {
+		queue.Push(mesh, 0, GetGridTransform(CrowdEntityCount + i), material, CreateRef<FakeStructuredBuffer>());
+	}
+
+	queue.Close();
+
+	const RenderQueueStats& stats = queue.GetStats();
+	FCHECK(stats.skinnedDrawCount == CrowdPaletteCount + SoloEntityCount);
+	FCHECK(stats.skinnedInstanceCount == CrowdEntityCount + SoloEntityCount);
+	FCHECK(stats.drawCount == stats.skinnedDrawCount);
+
+	uint32_t crowdInstanceCount = 0;
+	while (!queue.Empty()) {
+		for (const auto& object : queue.Front().skeletalInstancingObjects) {
+			for (const auto& palette : crowdPalettes) {
+				if (object.skeletonBoneMatrices == palette) {
+					FCHECK(object.instanceCount == CrowdEntityCount / CrowdPaletteCount);
+					crowdInstanceCount += object.instanceCount;
+				}
+			}
+		}
+		queue.Pop();
+	}
+
+	FCHECK(crowdInstanceCount == CrowdEntityCount);
+}
+
+FTEST(RenderQueue_StatsResetOnOpen) {
+	Ref<Mesh> mesh = CreateRef<Mesh>();
+	Ref<Material> material = CreateRef<Material>();
+
+	RenderQueue queue;
+	queue.Open();
+	for (int32_t i = 0; i < 50; ++i) {
+		queue.Push(mesh, 0, GetGridTransform(i), material);
+	}
+	queue.Close();
+
+	FCHECK(queue.GetStats().drawCount == 1);
+	FCHECK(queue.GetStats().instanceCount == 50);
+	FCHECK(queue.GetStats().skinnedDrawCount == 0);
+
+	queue.Open();
+	queue.Close();
+
+	FCHECK(queue.GetStats().drawCount == 0);
+	FCHECK(queue.GetStats().instanceCount == 0);
+}
+
+static Ref<Texture2D> CreateTestTexture() {
+	Texture2D::Descriptor desc = {};
+	desc.format = PixelFormat::RGBA8;
+	desc.width = 4;
+	desc.height = 4;
+	desc.usage = UsageFlag::Static;
+	desc.bindFlags = BindFlag::ShaderResource;
+	return Graphics::CreateTexture2D(desc);
+}
+
+template<typename T>
+static Ref<Mesh> CreateQuadMesh() {
+	std::vector<T> vertices(4);
+	vertices[0].position = vec3(-1.0f, -1.0f, 0.0f);
+	vertices[1].position = vec3(1.0f, -1.0f, 0.0f);
+	vertices[2].position = vec3(1.0f, 1.0f, 0.0f);
+	vertices[3].position = vec3(-1.0f, 1.0f, 0.0f);
+	return CreateRef<Mesh>(PrimitiveTopology::TriangleList, vertices, std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3 });
+}
+
+// same per entry sequence as RenderSystem::RenderGeometry, the null context counts what reaches the command queue
+FTEST(RenderQueue_NullContextFrameStats) {
+	constexpr uint32_t QuadIndexCount = 6;
+
+	Graphics::Init(GraphicsType::Null, 640, 480);
+
+	{
+		NullContext& context = static_cast<NullContext&>(Graphics::GetGraphicsContext());
+		GraphicsCommandQueue& cmdQueue = Graphics::GetCommandQueue();
+		Ref<GraphicsPipeline> pipeline = Graphics::GetMainGraphicsPipeline();
+		Ref<StructuredBuffer> batchedDataSB = Graphics::GetBatchedDataSB();
+
+		Ref<Mesh> rock = CreateQuadMesh<Vertex3D>();
+		Ref<Mesh> tree = CreateQuadMesh<Vertex3D>();
+		Ref<Mesh> character = CreateQuadMesh<SkinnedVertex3D>();
+
+		StructuredBuffer::Descriptor paletteDesc = {};
+		paletteDesc.elmSize = sizeof(mat4);
+		paletteDesc.count = 64;
+		paletteDesc.bindFlags = BindFlag::ShaderResource;
+		paletteDesc.accessFlags = AccessFlag::Write;
+		Ref<StructuredBuffer> palette = Graphics::CreateStructuredBuffer(paletteDesc);
+
+		Ref<Material> plain = CreateRef<Material>();
+		Ref<Material> textured = CreateRef<Material>();
+		textured->albedoTexture = CreateTestTexture();
+		textured->normalTexture = CreateTestTexture();
+
+		RenderQueue queue;
+		queue.Open();
+		for (int32_t i = 0; i < 10; ++i) {
+			queue.Push(rock, GetGridTransform(i), plain);
+		}
+		for (int32_t i = 0; i < 5; ++i) {
+			queue.Push(tree, GetGridTransform(10 + i), plain);
+		}
+		for (int32_t i = 0; i < 3; ++i) {
+			queue.Push(rock, GetGridTransform(15 + i), textured);
+		}
+		for (int32_t i = 0; i < 4; ++i) {
+			queue.Push(character, GetGridTransform(18 + i), plain, palette);
+		}
+		queue.Close();
+
+		const RenderQueueStats queueStats = queue.GetStats();
+		FCHECK(queueStats.drawCount == 4);
+		FCHECK(queueStats.skinnedDrawCount == 1);
+
+		// the render pass bind of Prepare is counted on its own
+		context.Prepare();
+		const NullFrameStats prepareStats = context.GetFrameStats();
+
+		uint32_t entryCount = 0;
+		while (!queue.Empty()) {
+			auto& entry = queue.Front();
+
+			cmdQueue.SetPipeline(pipeline);
+			cmdQueue.SetStructuredBuffer(batchedDataSB, 0);
+			BindMaterialTextures(cmdQueue, *entry.material);
+			cmdQueue.Execute();
+
+			DrawInstancingObjects(cmdQueue, entry, batchedDataSB);
+			DrawSkeletalInstancingObjects(cmdQueue, entry, batchedDataSB, 1);
+
+			entryCount++;
+			queue.Pop();
+		}
+
+		context.Present();
+
+		const NullFrameStats& stats = context.GetLastFrameStats();
+		FCHECK(entryCount == 2);
+
+		// one draw and one batched data upload per instancing object
+		FCHECK(stats.drawCalls == queueStats.drawCount);
+		FCHECK(stats.vertexCount == QuadIndexCount * (10 + 5 + 3 + 4));
+		FCHECK(stats.bufferUpdates == prepareStats.bufferUpdates + queueStats.drawCount);
+		FCHECK(stats.bufferUpdateBytes == prepareStats.bufferUpdateBytes + (10 + 5 + 3 + 4) * sizeof(BatchedData));
+		FCHECK(stats.executes == entryCount + queueStats.drawCount);
+
+		// pipeline and batched buffer per entry, two textures on one of them,
+		// topology and vertex buffer per draw and the bone palette on the skinned one
+		FCHECK(stats.stateChanges == prepareStats.stateChanges + entryCount * 2 + 2 + queueStats.drawCount * 2 + queueStats.skinnedDrawCount);
+		FCHECK(stats.renderPassBinds == prepareStats.renderPassBinds);
+
+		// an empty frame records nothing besides Prepare
+		context.Prepare();
+		context.Present();
+		FCHECK(context.GetLastFrameStats().drawCalls == 0);
+		FCHECK(context.GetLastFrameStats().bufferUpdates == prepareStats.bufferUpdates);
+	}
+
+	Graphics::Cleanup();
+}
@@ -0,0 +1,156 @@
+#include "Test.h"
+#include "Utils/RadixSort.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+
+using namespace flaw;
+using namespace flaw::test;
+
+namespace {
+	struct FakeMesh { int32_t id; };
+	struct FakeMaterial { int32_t id; };
+	struct WorldMatrix { float values[16]; };
+
+	// same shape as RenderQueue::SortItem, the packet is a frame allocated draw
+	struct DrawPacket {
+		const FakeMesh* mesh;
+		const FakeMaterial* material;
+		int32_t segmentIndex;
+		WorldMatrix worldMatrix;
+	};
+
+	struct SortItem {
+		uint64_t key;
+		const DrawPacket* packet;
+	};
+
+	struct DrawScene {
+		std::vector<FakeMesh> meshes;
+		std::vector<FakeMaterial> materials;
+		std::vector<DrawPacket> packets;
+	};
+}
+
+// 100k draws over a few hundred meshes and materials in push order, the count RenderQueue was tuned for
+static DrawScene CreateDrawScene(int32_t drawCount, int32_t meshCount, int32_t materialCount) {
+	DrawScene scene;
+	scene.meshes.resize(meshCount);
+	scene.materials.resize(materialCount);
+
+	std::mt19937 random(1234);
+	scene.packets.resize(drawCount);
+	for (auto& packet : scene.packets) {
+		packet.mesh = &scene.meshes[random() % meshCount];
+		packet.material = &scene.materials[random() % materialCount];
+		packet.segmentIndex = random() % 4;
+		packet.worldMatrix.values[12] = static_cast<float>(random() % 1000);
+	}
+
+	return scene;
+}
+
+static uint64_t MakeSortKey(const DrawScene& scene, const DrawPacket& packet) {
+	const uint64_t material = packet.material - scene.materials.data();
+	const uint64_t mesh = packet.mesh - scene.meshes.data();
+	return (material << 26) | (mesh << 6) | packet.segmentIndex;
+}
+
+FTEST(RadixSort_MatchesStableSort) {
+	std::mt19937_64 random(42);
+
+	for (size_t count : { 0, 1, 2, 255, 256, 1000, 65536 }) {
+		std::vector<std::pair<uint64_t, uint32_t>> items(count), temp;
+		for (uint32_t i = 0; i < count; ++i) {
+			// narrow keys so equal keys show the sort is stable, wide ones exercise every pass
+			items[i] = { (i & 1) ? random() : random() % 16, i };
+		}
+
+		auto expected = items;
+		std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+		RadixSort(items, temp, [](const auto& item) { return item.first; });
+
+		FCHECK(items == expected);
+	}
+}
+
+FTEST(RadixSort_SkipsUniformDigits) {
+	// only the lowest byte differs, every other pass is skipped and the result must still land in items
+	std::vector<uint64_t> items = { 0xAB00000000000003ull, 0xAB00000000000001ull, 0xAB00000000000002ull };
+	std::vector<uint64_t> temp;
+
+	RadixSort(items, temp, [](uint64_t key) { return key; });
+
+	FCHECK(items == std::vector<uint64_t>({ 0xAB00000000000001ull, 0xAB00000000000002ull, 0xAB00000000000003ull }));
+}
+
+FBENCH(RenderQueue_Sort100kDraws) {
+	constexpr int32_t DrawCount = 100000;
+	const DrawScene scene = CreateDrawScene(DrawCount, 256, 64);
+
+	// what RenderQueue did before sort keys, a hash map lookup per draw into per material and per mesh lists
+	struct MeshKey {
+		const FakeMesh* mesh;
+		int32_t segmentIndex;
+		bool operator==(const MeshKey& other) const { return mesh == other.mesh && segmentIndex == other.segmentIndex; }
+	};
+	struct MeshKeyHash {
+		size_t operator()(const MeshKey& key) const { return std::hash<const void*>()(key.mesh) * 31 + key.segmentIndex; }
+	};
+
+	size_t mapInstanceCount = 0;
+	const double mapMs = MeasureMs(5, [&]() {
+		std::unordered_map<const FakeMaterial*, std::unordered_map<MeshKey, std::vector<WorldMatrix>, MeshKeyHash>> entries;
+		for (const auto& packet : scene.packets) {
+			entries[packet.material][{ packet.mesh, packet.segmentIndex }].push_back(packet.worldMatrix);
+		}
+
+		mapInstanceCount = 0;
+		for (const auto& [material, instances] : entries) {
+			mapInstanceCount += instances.size();
+		}
+	});
+
+	std::vector<SortItem> items, temp;
+	items.reserve(DrawCount);
+
+	auto countInstances = [](const std::vector<SortItem>& sorted) {
+		size_t count = 0;
+		for (size_t i = 0; i < sorted.size(); ++i) {
+			count += i == 0 || sorted[i].key != sorted[i - 1].key;
+		}
+		return count;
+	};
+
+	auto fillItems = [&]() {
+		items.clear();
+		for (const auto& packet : scene.packets) {
+			items.push_back({ MakeSortKey(scene, packet), &packet });
+		}
+	};
+
+	size_t stdSortInstanceCount = 0;
+	const double stdSortMs = MeasureMs(5, [&]() {
+		fillItems();
+		std::sort(items.begin(), items.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+		stdSortInstanceCount = countInstances(items);
+	});
+
+	size_t radixInstanceCount = 0;
+	const double radixMs = MeasureMs(5, [&]() {
+		fillItems();
+		RadixSort(items, temp, [](const SortItem& item) { return item.key; });
+		radixInstanceCount = countInstances(items);
+	});
+
+	std::printf("  %d draws, %zu instanced draws\n", DrawCount, radixInstanceCount);
+	std::printf("  nested hash maps %8.2f ms\n", mapMs);
+	std::printf("  std::sort        %8.2f ms (%.2fx)\n", stdSortMs, mapMs / stdSortMs);
+	std::printf("  RadixSort        %8.2f ms (%.2fx)\n", radixMs, mapMs / radixMs);
+
+	// every approach has to end up with the same batches
+	FCHECK(mapInstanceCount == radixInstanceCount);
+	FCHECK(stdSortInstanceCount == radixInstanceCount);
+}
@@ -0,0 +1,284 @@
+#include "Test.h"
+#include "Engine/Application.h"
+#include "Engine/Scene.h"
+#include "Engine/Entity.h"
+#include "Engine/Components.h"
+#include "Engine/ParticleSystem.h"
+#include "Engine/SceneBinary.h"
+#include "Engine/Serialization.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace flaw;
+using namespace flaw::test;
+
+// only built with the engine (premake), the systems of a scene load their shaders from Resources so run it next to them
+static Application& GetTestApplication() {
+	static Application app({ "Flaw-Tests", 320, 240, 0, nullptr });
+	return app;
+}
+
+// the yaml writer covers every field of every component, comparing it is cheaper than a field by field check per type
+static std::string ToYaml(Entity entity) {
+	YAML::Emitter out;
+	Serialize(out, entity);
+	return out.c_str();
+}
+
+// one child per component type under a single root so the entity order does not depend on the registry, every value differs from its default
+static void BuildAllComponentScene(Scene& scene) {
+	Entity root = scene.CreateEntity(vec3(1.0f, 2.0f, 3.0f), vec3(0.1f, 0.2f, 0.3f), vec3(2.0f), "Root");
+
+	auto createChild = [&](const char* name) {
+		Entity entity = scene.CreateEntity(vec3(-1.0f, 0.5f, 4.0f), vec3(0.0f, 1.5f, 0.0f), vec3(0.5f, 1.0f, 2.0f), name);
+		entity.SetParent(root);
+		return entity;
+	};
+
+	auto& camera = createChild("Camera").AddComponent<CameraComponent>();
+	camera.perspective = true;
+	camera.fov = 60.0f;
+	camera.orthoSize = 3.0f;
+	camera.aspectRatio = 4.0f / 3.0f;
+	camera.nearClip = 0.5f;
+	camera.farClip = 500.0f;
+	camera.depth = 2;
+
+	auto& sprite = createChild("SpriteRenderer").AddComponent<SpriteRendererComponent>();
+	sprite.color = vec4(0.2f, 0.4f, 0.6f, 0.8f);
+
+	auto& rigidbody2D = createChild("Rigidbody2D").AddComponent<Rigidbody2DComponent>();
+	rigidbody2D.bodyType = Rigidbody2DComponent::BodyType::Dynamic;
+	rigidbody2D.fixedRotation = true;
+	rigidbody2D.density = 2.5f;
+	rigidbody2D.friction = 0.7f;
+	rigidbody2D.restitution = 0.3f;
+	rigidbody2D.restitutionThreshold = 1.5f;
+
+	auto& boxCollider2D = createChild("BoxCollider2D").AddComponent<BoxCollider2DComponent>();
+	boxCollider2D.offset = vec2(0.25f, -0.25f);
+	boxCollider2D.size = vec2(2.0f, 3.0f);
+
+	auto& circleCollider2D = createChild("CircleCollider2D").AddComponent<CircleCollider2DComponent>();
+	circleCollider2D.offset = vec2(-0.5f, 0.5f);
+	circleCollider2D.radius = 1.25f;
+
+	auto& rigidbody = createChild("Rigidbody").AddComponent<RigidbodyComponent>();
+	rigidbody.bodyType = PhysicsBodyType::Dynamic;
+	rigidbody.isKinematic = true;
+	rigidbody.mass = 7.5f;
+
+	auto& boxCollider = createChild("BoxCollider").AddComponent<BoxColliderComponent>();
+	boxCollider.isTrigger = true;
+	boxCollider.staticFriction = 0.4f;
+	boxCollider.dynamicFriction = 0.6f;
+	boxCollider.restitution = 0.9f;
+	boxCollider.size = vec3(1.0f, 2.0f, 3.0f);
+
+	auto& sphereCollider = createChild("SphereCollider").AddComponent<SphereColliderComponent>();
+	sphereCollider.isTrigger = true;
+	sphereCollider.staticFriction = 0.3f;
+	sphereCollider.restitution = 0.2f;
+	sphereCollider.radius = 4.0f;
+
+	auto& meshCollider = createChild("MeshCollider").AddComponent<MeshColliderComponent>();
+	meshCollider.isTrigger = true;
+	meshCollider.dynamicFriction = 0.8f;
+
+	auto& text = createChild("Text").AddComponent<TextComponent>();
+	text.text = L"round trip \x00e9\x4e2d";
+	text.color = vec4(1.0f, 0.5f, 0.25f, 1.0f);
+
+	createChild("SoundListener").AddComponent<SoundListenerComponent>();
+
+	auto& soundSource = createChild("SoundSource").AddComponent<SoundSourceComponent>();
+	soundSource.loop = true;
+	soundSource.volume = 0.35f;
+
+	auto& staticMesh = createChild("StaticMesh").AddComponent<StaticMeshComponent>();
+	staticMesh.castShadow = false;
+
+	auto& skeletalMesh = createChild("SkeletalMesh").AddComponent<SkeletalMeshComponent>();
+	skeletalMesh.castShadow = false;
+
+	Entity particleEntity = createChild("Particle");
+	auto& particle = particleEntity.AddComponent<ParticleComponent>();
+	particle.maxParticles = 333;
+	particle.spaceType = ParticleComponent::SpaceType::World;
+	particle.startSpeed = 3.0f;
+	particle.startLifeTime = 2.5f;
+	particle.startColor = vec4(0.1f, 0.9f, 0.5f, 1.0f);
+	particle.startSize = vec3(0.5f, 0.25f, 1.0f);
+	particle.modules = ParticleComponent::ModuleType::Emission | ParticleComponent::ModuleType::Shape | ParticleComponent::ModuleType::RandomSpeed
+		| ParticleComponent::ModuleType::RandomColor | ParticleComponent::ModuleType::RandomSize | ParticleComponent::ModuleType::ColorOverLifetime
+		| ParticleComponent::ModuleType::SizeOverLifetime | ParticleComponent::ModuleType::Noise | ParticleComponent::ModuleType::Renderer;
+
+	ParticleSystem& particleSys = scene.GetParticleSystem();
+
+	auto emission = particleSys.AddModule<EmissionModule>(particleEntity);
+	emission->spawnOverTime = 42;
+	emission->burst = true;
+	emission->burstStartTime = 0.5f;
+	emission->burstParticleCount = 12;
+	emission->burstCycleCount = 3;
+	emission->burstCycleInterval = 1.5f;
+
+	auto shape = particleSys.AddModule<ShapeModule>(particleEntity);
+	shape->shapeType = ShapeModule::ShapeType::Box;
+	shape->box.size = vec3(1.0f, 2.0f, 3.0f);
+	shape->box.thickness = vec3(0.1f, 0.2f, 0.3f);
+
+	auto randomSpeed = particleSys.AddModule<RandomSpeedModule>(particleEntity);
+	randomSpeed->minSpeed = 0.25f;
+	randomSpeed->maxSpeed = 4.0f;
+
+	auto randomColor = particleSys.AddModule<RandomColorModule>(particleEntity);
+	randomColor->minColor = vec4(0.1f, 0.2f, 0.3f, 0.4f);
+	randomColor->maxColor = vec4(0.5f, 0.6f, 0.7f, 0.8f);
+
+	auto randomSize = particleSys.AddModule<RandomSizeModule>(particleEntity);
+	randomSize->minSize = vec3(0.5f);
+	randomSize->maxSize = vec3(2.0f);
+
+	auto colorOverLifetime = particleSys.AddModule<ColorOverLifetimeModule>(particleEntity);
+	colorOverLifetime->easing = Easing::SineIn;
+	colorOverLifetime->easingStartRatio = 0.25f;
+	colorOverLifetime->redFactorRange = vec2(1.0f, 0.0f);
+	colorOverLifetime->alphaFactorRange = vec2(1.0f, 0.5f);
+
+	auto sizeOverLifetime = particleSys.AddModule<SizeOverLifetimeModule>(particleEntity);
+	sizeOverLifetime->easing = Easing::CubicOut;
+	sizeOverLifetime->easingStartRatio = 0.5f;
+	sizeOverLifetime->sizeFactorRange = vec2(1.0f, 3.0f);
+
+	auto noise = particleSys.AddModule<NoiseModule>(particleEntity);
+	noise->strength = 2.5f;
+	noise->frequency = 0.75f;
+
+	auto renderer = particleSys.AddModule<RendererModule>(particleEntity);
+	renderer->alignment = RendererModule::Alignment::Velocity;
+
+	auto& skyLight = createChild("SkyLight").AddComponent<SkyLightComponent>();
+	skyLight.color = vec3(0.3f, 0.4f, 0.5f);
+	skyLight.intensity = 0.25f;
+
+	auto& directionalLight = createChild("DirectionalLight").AddComponent<DirectionalLightComponent>();
+	directionalLight.color = vec3(1.0f, 0.9f, 0.8f);
+	directionalLight.intensity = 3.0f;
+
+	auto& pointLight = createChild("PointLight").AddComponent<PointLightComponent>();
+	pointLight.color = vec3(0.2f, 1.0f, 0.2f);
+	pointLight.intensity = 5.0f;
+	pointLight.range = 12.0f;
+
+	auto& spotLight = createChild("SpotLight").AddComponent<SpotLightComponent>();
+	spotLight.color = vec3(1.0f, 0.2f, 0.2f);
+	spotLight.intensity = 4.0f;
+	spotLight.inner = 0.25f;
+	spotLight.outer = 0.75f;
+	spotLight.range = 20.0f;
+
+	createChild("SkyBox").AddComponent<SkyBoxComponent>();
+	createChild("Decal").AddComponent<DecalComponent>();
+
+	auto& landscape = createChild("Landscape").AddComponent<LandscapeComponent>();
+	landscape.tilingX = 8;
+	landscape.tilingY = 4;
+	landscape.lodLevelMax = 6;
+	landscape.lodDistanceRange = vec2(5.0f, 250.0f);
+
+	auto& animator = createChild("Animator").AddComponent<AnimatorComponent>();
+	animator.useLevelOfDetail = false;
+	animator.levelOfDetails = { { 0.5f, 1, -1 }, { 0.0f, 3, 6 } };
+	animator.offscreenUpdateInterval = 0;
+	animator.useCrowdPose = true;
+	animator.crowdPoseTimeStep = 1.0f / 15.0f;
+
+	auto& canvas = createChild("Canvas").AddComponent<CanvasComponent>();
+	canvas.renderMode = CanvasComponent::RenderMode::ScreenSpaceCamera;
+	canvas.renderCamera = root.GetUUID();
+	canvas.planeDistance = 2.0f;
+
+	auto& canvasScaler = createChild("CanvasScaler").AddComponent<CanvasScalerComponent>();
+	canvasScaler.scaleMode = CanvasScalerComponent::ScaleMode::ScaleWithScreenSize;
+	canvasScaler.scaleFactor = 1.5f;
+	canvasScaler.referenceResolution = vec2(1280.0f, 720.0f);
+
+	auto& rectLayout = createChild("RectLayout").AddComponent<RectLayoutComponent>();
+	rectLayout.anchorMin = vec2(0.0f, 0.25f);
+	rectLayout.anchorMax = vec2(1.0f, 0.75f);
+	rectLayout.pivot = vec2(0.0f, 1.0f);
+	rectLayout.sizeDelta = vec2(100.0f, 50.0f);
+
+	auto& image = createChild("Image").AddComponent<ImageComponent>();
+	image.color = vec4(0.5f, 0.5f, 1.0f, 0.5f);
+
+	std::vector<MonoScriptComponent::FieldInfo> fields = {
+		{ "System.Int32", "count", "7" },
+		{ "System.Single", "speed", "1.5" },
+		{ "System.String", "label", "hello" },
+	};
+	createChild("MonoScript").AddComponent<MonoScriptComponent>("Game.Player", fields);
+}
+
+FTEST(SceneBinary_RoundTripsEveryComponent) {
+	Application& app = GetTestApplication();
+
+	Scene source(app);
+	BuildAllComponentScene(source);
+
+	std::vector<int8_t> bytes;
+	SerializeBinary(source, bytes);
+
+	FCHECK(IsBinaryScene(bytes.data(), bytes.size()));
+
+	// a table per component type, a type missing here was dropped from BinarySceneComponents
+	BinarySceneHeader header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	FCHECK(header.entityCount == 29);
+	FCHECK(header.tableCount == 28);
+
+	Scene loaded(app);
+	FCHECK(DeserializeBinary(bytes.data(), bytes.size(), loaded));
+
+	for (auto&& [entity, entityComp] : source.GetRegistry().view<EntityComponent>().each()) {
+		Entity sourceEntity(entity, &source);
+		Entity loadedEntity = loaded.FindEntityByUUID(sourceEntity.GetUUID());
+
+		FCHECK(loadedEntity);
+		if (loadedEntity) {
+			FCHECK(ToYaml(sourceEntity) == ToYaml(loadedEntity));
+		}
+	}
+
+	// writing the loaded scene again has to give the same file, records and string order included
+	std::vector<int8_t> rewritten;
+	SerializeBinary(loaded, rewritten);
+
+	FCHECK(rewritten.size() == bytes.size());
+	FCHECK(rewritten == bytes);
+}
+
+FTEST(SceneBinary_RejectsBrokenFiles) {
+	Application& app = GetTestApplication();
+
+	Scene source(app);
+	BuildAllComponentScene(source);
+
+	std::vector<int8_t> bytes;
+	SerializeBinary(source, bytes);
+
+	Scene truncated(app);
+	FCHECK(!DeserializeBinary(bytes.data(), bytes.size() / 2, truncated));
+
+	std::vector<int8_t> wrongVersion = bytes;
+	BinarySceneHeader header;
+	std::memcpy(&header, wrongVersion.data(), sizeof(header));
+	header.version = BinarySceneVersion + 1;
+	std::memcpy(wrongVersion.data(), &header, sizeof(header));
+
+	Scene newer(app);
+	FCHECK(!DeserializeBinary(wrongVersion.data(), wrongVersion.size(), newer));
+}
@@ -0,0 +1,65 @@
+#include "Test.h"
+#include "Utils/SerializationArchive.h"
+
+using namespace flaw;
+using namespace flaw::test;
+
+FTEST(SerializationArchive_RoundTripsContainers) {
+	const std::string name = "archive";
+	const std::vector<float> values = { 1.0f, -2.5f, 3.25f };
+	const std::vector<std::string> names = { "a", "", "long enough to not be inlined" };
+	const std::unordered_map<uint32_t, int64_t> lookup = { { 1, -1 }, { 7, 49 } };
+
+	SerializationArchive writer;
+	writer << name << values << names << lookup;
+
+	std::string readName;
+	std::vector<float> readValues;
+	std::vector<std::string> readNames;
+	std::unordered_map<uint32_t, int64_t> readLookup;
+
+	SerializationArchive reader = SerializationArchive::View(writer.Data(), writer.RemainingSize());
+	reader >> readName >> readValues >> readNames >> readLookup;
+
+	FCHECK(readName == name);
+	FCHECK(readValues == values);
+	FCHECK(readNames == names);
+	FCHECK(readLookup == lookup);
+	FCHECK(reader.RemainingSize() == 0);
+}
+
+// a view points at memory it does not own, appending would have gone to the unused buffer and been lost
+FTEST(SerializationArchive_ViewRejectsWrites) {
+	const int8_t bytes[8] = {};
+	SerializationArchive view = SerializationArchive::View(bytes, sizeof(bytes));
+
+	bool threw = false;
+	try {
+		view << uint32_t(1);
+	}
+	catch (const std::runtime_error&) {
+		threw = true;
+	}
+
+	FCHECK(threw);
+	FCHECK(view.Data() == bytes);
+	FCHECK(view.RemainingSize() == sizeof(bytes));
+}
+
+FTEST(SerializationArchive_ReadPastEndThrows) {
+	SerializationArchive writer;
+	writer << uint32_t(1000);
+
+	SerializationArchive reader(writer.Data(), writer.RemainingSize());
+
+	bool threw = false;
+	try {
+		std::vector<uint64_t> values;
+		reader >> values;
+	}
+	catch (const std::runtime_error&) {
+		threw = true;
+	}
+
+	FCHECK(threw);
+}
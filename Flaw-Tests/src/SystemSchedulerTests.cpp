@@ -0,0 +1,85 @@
+#include "Test.h"
+#include "Engine/SystemScheduler.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace flaw;
+using namespace flaw::test;
+
+namespace {
+	// stand ins for the components and systems Scene::RegisterSystems declares
+	struct Transform {};
+	struct Rigidbody2D {};
+	struct Animator {};
+	struct Animation {};
+	struct SoundListener {};
+	struct SoundSource {};
+	struct SkeletalMesh {};
+	struct Skeletal {};
+}
+
+// waits for the other system to start, false when it never runs alongside
+static bool WaitForStart(const std::atomic<bool>& started) {
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+	while (!started.load()) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			return false;
+		}
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+FTEST(SystemScheduler_ConflictingSystemsKeepOrder) {
+	JobSystem jobSystem(2);
+	SystemScheduler scheduler(jobSystem);
+
+	std::vector<int32_t> order;
+	std::mutex orderMutex;
+	auto record = [&](int32_t value) {
+		std::lock_guard<std::mutex> lock(orderMutex);
+		order.push_back(value);
+	};
+
+	scheduler.AddSystem("Writer", SystemAccess().Write<Transform>(), [&]() { record(0); });
+	scheduler.AddSystem("Reader", SystemAccess().Read<Transform>(), [&]() { record(1); });
+	scheduler.AddSystem("Exclusive", SystemAccess().Exclusive().MainThread(), [&]() { record(2); });
+
+	for (int32_t i = 0; i < 100; ++i) {
+		order.clear();
+		scheduler.Run();
+		FCHECK(order == std::vector<int32_t>({ 0, 1, 2 }));
+	}
+}
+
+// same access sets as the scene frame, animation has to run next to the transform update and sound
+FTEST(SystemScheduler_SceneFrameOverlapsAnimation) {
+	JobSystem jobSystem(2);
+	SystemScheduler scheduler(jobSystem);
+
+	std::atomic<bool> transformStarted = false;
+	std::atomic<bool> soundStarted = false;
+	std::atomic<bool> animationDone = false;
+	std::atomic<bool> overlapped = false;
+	std::atomic<bool> skeletalAfterAnimation = false;
+
+	scheduler.AddSystem("Script", SystemAccess().Exclusive().MainThread(), []() {});
+	scheduler.AddSystem("Physics2D", SystemAccess().Write<Transform, Rigidbody2D>(), []() {});
+	scheduler.AddSystem("Physics", SystemAccess().Exclusive().MainThread(), []() {});
+	scheduler.AddSystem("Animation", SystemAccess().Read<Animator>().Write<Animation>(), [&]() {
+		overlapped = WaitForStart(transformStarted) && WaitForStart(soundStarted);
+		animationDone = true;
+	});
+	scheduler.AddSystem("Transform", SystemAccess().Write<Transform>(), [&]() { transformStarted = true; });
+	scheduler.AddSystem("Sound", SystemAccess().Read<Transform, SoundListener>().Write<SoundSource>().MainThread(), [&]() { soundStarted = true; });
+	scheduler.AddSystem("Skeletal", SystemAccess().Read<SkeletalMesh, Animation>().Write<Transform, Skeletal>().MainThread(), [&]() {
+		skeletalAfterAnimation = animationDone.load();
+	});
+	scheduler.AddSystem("Render", SystemAccess().Exclusive().MainThread(), []() {});
+
+	scheduler.Run();
+
+	FCHECK(overlapped.load());
+	FCHECK(skeletalAfterAnimation.load());
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <chrono>
+
+namespace flaw::test {
+	using TestFunc = void(*)();
+
+	struct TestCase {
+		const char* name;
+		TestFunc func;
+		bool benchmark;
+	};
+
+	std::vector<TestCase>& GetTestCases();
+
+	void ReportFailure(const char* file, int32_t line, const char* expression);
+
+	struct TestRegistrar {
+		TestRegistrar(const char* name, TestFunc func, bool benchmark) {
+			GetTestCases().push_back({ name, func, benchmark });
+		}
+	};
+
+	// milliseconds spent in func, the best of repeatCount runs
+	template<typename Func>
+	double MeasureMs(int32_t repeatCount, const Func& func) {
+		double best = 0.0;
+		for (int32_t i = 0; i < repeatCount; ++i) {
+			const auto begin = std::chrono::high_resolution_clock::now();
+			func();
+			const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+			if (i == 0 || elapsed < best) {
+				best = elapsed;
+			}
+		}
+		return best;
+	}
+}
+
+#define FTEST_CONCAT_INNER(a, b) a##b
+#define FTEST_CONCAT(a, b) FTEST_CONCAT_INNER(a, b)
+
+// tests run by default, benchmarks only with --bench
+#define FTEST(name) \
+	static void name(); \
+	static flaw::test::TestRegistrar FTEST_CONCAT(g_registrar_, name)(#name, &name, false); \
+	static void name()
+
+#define FBENCH(name) \
+	static void name(); \
+	static flaw::test::TestRegistrar FTEST_CONCAT(g_registrar_, name)(#name, &name, true); \
+	static void name()
+
+#define FCHECK(expression) \
+	do { if (!(expression)) { flaw::test::ReportFailure(__FILE__, __LINE__, #expression); } } while (false)
+
+#define FCHECK_NEAR(a, b, epsilon) \
+	do { if (!(std::abs((a) - (b)) <= (epsilon))) { flaw::test::ReportFailure(__FILE__, __LINE__, #a " ~= " #b); } } while (false)
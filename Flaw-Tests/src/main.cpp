@@ -0,0 +1,58 @@
+#include "Test.h"
+
+#include <cstring>
+
+namespace flaw::test {
+	static int32_t g_failureCount = 0;
+
+	std::vector<TestCase>& GetTestCases() {
+		static std::vector<TestCase> testCases;
+		return testCases;
+	}
+
+	void ReportFailure(const char* file, int32_t line, const char* expression) {
+		std::printf("  %s(%d): check failed: %s\n", file, line, expression);
+		g_failureCount++;
+	}
+}
+
+// FlawTests [--bench] [name filter]
+int main(int argc, char** argv) {
+	using namespace flaw::test;
+
+	bool runBenchmarks = false;
+	const char* filter = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--bench") == 0) {
+			runBenchmarks = true;
+		}
+		else {
+			filter = argv[i];
+		}
+	}
+
+	int32_t failedCases = 0;
+	int32_t runCases = 0;
+
+	for (const TestCase& testCase : GetTestCases()) {
+		if (testCase.benchmark != runBenchmarks || (filter && !std::strstr(testCase.name, filter))) {
+			continue;
+		}
+
+		std::printf("[ RUN  ] %s\n", testCase.name);
+
+		const int32_t failuresBefore = g_failureCount;
+		testCase.func();
+
+		const bool passed = g_failureCount == failuresBefore;
+		std::printf("[ %s ] %s\n", passed ? " OK " : "FAIL", testCase.name);
+
+		failedCases += passed ? 0 : 1;
+		runCases++;
+	}
+
+	std::printf("%d of %d passed\n", runCases - failedCases, runCases);
+
+	return failedCases == 0 ? 0 : 1;
+}
@@ -63,6 +63,7 @@ project "Flaw"
 
         links {
             "libpng16d.lib",
+            "zlibd.lib",
             "freetyped.lib",
             "fmtd.lib",
             "spdlogd.lib",
@@ -88,6 +89,7 @@ project "Flaw"
 
         links {
             "libpng16.lib",
+            "zlib.lib",
             "freetype.lib",
             "fmt.lib",
             "spdlog.lib",
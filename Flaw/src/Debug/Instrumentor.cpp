@@ -0,0 +1,234 @@
+#include "pch.h"
+#include "Instrumentor.h"
+
+namespace flaw {
+	static constexpr auto TraceWriteInterval = std::chrono::milliseconds(10);
+
+	Instrumentor::Instrumentor()
+		: _enabled(true)
+		, _recording(false)
+		, _eventCount(0)
+		, _stopWriter(false)
+	{
+	}
+
+	Instrumentor::~Instrumentor() {
+		if (_outputStream.is_open()) {
+			EndSession();
+		}
+	}
+
+	void Instrumentor::BeginSession(const std::string& name, const std::string& filepath) {
+		std::lock_guard<std::mutex> lock(_sessionMutex);
+
+		if (_outputStream.is_open()) {
+			return; // session already running
+		}
+
+		_outputStream.open(filepath);
+		if (!_outputStream.is_open()) {
+			return;
+		}
+
+		_sessionName = name;
+		_eventCount = 0;
+		_outputStream << "{\"otherData\": {\"session\":\"" << _sessionName << "\"},\"traceEvents\":[";
+
+		// events recorded between sessions are discarded
+		{
+			std::lock_guard<std::mutex> buffersLock(_buffersMutex);
+			for (auto& buffer : _buffers) {
+				buffer->Drain([](const ProfileEvent&) {});
+			}
+		}
+
+		_stopWriter = false;
+		_writerThread = std::thread(&Instrumentor::WriterThread, this);
+
+		_recording.store(_enabled.load());
+	}
+
+	void Instrumentor::EndSession() {
+		std::lock_guard<std::mutex> lock(_sessionMutex);
+
+		if (!_outputStream.is_open()) {
+			return;
+		}
+
+		_recording.store(false);
+
+		{
+			std::lock_guard<std::mutex> writerLock(_writerMutex);
+			_stopWriter = true;
+		}
+
+		_writerCondition.notify_one();
+		_writerThread.join();
+
+		WriteEvents();
+
+		uint64_t droppedCount = 0;
+		{
+			std::lock_guard<std::mutex> buffersLock(_buffersMutex);
+			for (auto& buffer : _buffers) {
+				droppedCount += buffer->GetDroppedCount();
+			}
+		}
+
+		if (_eventCount++ > 0) {
+			_outputStream << ",";
+		}
+
+		_outputStream << "{\"name\":\"DroppedEvents\",\"ph\":\"C\",\"pid\":0,\"tid\":0,\"ts\":" << Now() / 1000 << ",\"args\":{\"value\":" << droppedCount << "}}";
+		_outputStream << "]}";
+		_outputStream.close();
+	}
+
+	void Instrumentor::SetEnabled(bool enabled) {
+		std::lock_guard<std::mutex> lock(_sessionMutex);
+
+		_enabled.store(enabled);
+		_recording.store(enabled && _outputStream.is_open());
+	}
+
+	ProfileEventBuffer& Instrumentor::GetThreadBuffer() {
+		thread_local Ref<ProfileEventBuffer> threadBuffer;
+
+		if (!threadBuffer) {
+			std::lock_guard<std::mutex> lock(_buffersMutex);
+			threadBuffer = CreateRef<ProfileEventBuffer>(static_cast<uint32_t>(_buffers.size()) + 1);
+			_buffers.push_back(threadBuffer);
+		}
+
+		return *threadBuffer;
+	}
+
+	uint32_t Instrumentor::InternName(const char* name) {
+		thread_local std::unordered_map<const char*, uint32_t> threadNameIds;
+
+		auto it = threadNameIds.find(name);
+		if (it != threadNameIds.end()) {
+			return it->second;
+		}
+
+		std::lock_guard<std::mutex> lock(_namesMutex);
+
+		uint32_t nameId;
+
+		auto globalIt = _nameIds.find(name);
+		if (globalIt != _nameIds.end()) {
+			nameId = globalIt->second;
+		}
+		else {
+			nameId = static_cast<uint32_t>(_names.size());
+
+			std::string escaped = name;
+			std::replace(escaped.begin(), escaped.end(), '"', '\'');
+
+			_names.push_back(escaped);
+			_nameIds[name] = nameId;
+		}
+
+		threadNameIds[name] = nameId;
+
+		return nameId;
+	}
+
+	void Instrumentor::RecordScope(const char* name, int64_t start, int64_t end) {
+		if (!IsRecording()) {
+			return;
+		}
+
+		ProfileEvent event = {};
+		event.nameId = InternName(name);
+		event.type = ProfileEventType::Scope;
+		event.start = start;
+		event.duration = end - start;
+
+		GetThreadBuffer().Push(event);
+	}
+
+	void Instrumentor::RecordCounter(const char* name, double value) {
+		if (!IsRecording()) {
+			return;
+		}
+
+		ProfileEvent event = {};
+		event.nameId = InternName(name);
+		event.type = ProfileEventType::Counter;
+		event.start = Now();
+		event.value = value;
+
+		GetThreadBuffer().Push(event);
+	}
+
+	void Instrumentor::RecordFrame() {
+		if (!IsRecording()) {
+			return;
+		}
+
+		ProfileEvent event = {};
+		event.nameId = InternName("Frame");
+		event.type = ProfileEventType::Frame;
+		event.start = Now();
+
+		GetThreadBuffer().Push(event);
+	}
+
+	void Instrumentor::WriterThread(Instrumentor* instrumentor) {
+		std::unique_lock<std::mutex> lock(instrumentor->_writerMutex);
+
+		while (!instrumentor->_stopWriter) {
+			instrumentor->_writerCondition.wait_for(lock, TraceWriteInterval, [instrumentor] { return instrumentor->_stopWriter; });
+
+			lock.unlock();
+			instrumentor->WriteEvents();
+			lock.lock();
+		}
+	}
+
+	void Instrumentor::WriteEvents() {
+		std::vector<Ref<ProfileEventBuffer>> buffers;
+		{
+			std::lock_guard<std::mutex> lock(_buffersMutex);
+			buffers = _buffers;
+		}
+
+		for (auto& buffer : buffers) {
+			const uint32_t threadId = buffer->GetThreadId();
+			buffer->Drain([this, threadId](const ProfileEvent& event) { WriteEvent(threadId, event); });
+		}
+
+		_outputStream.flush();
+	}
+
+	void Instrumentor::WriteEvent(uint32_t threadId, const ProfileEvent& event) {
+		const char* name;
+		{
+			std::lock_guard<std::mutex> lock(_namesMutex);
+			name = _names[event.nameId].c_str();
+		}
+
+		if (_eventCount++ > 0) {
+			_outputStream << ",";
+		}
+
+		// chrome trace timestamps are microseconds
+		const double ts = event.start / 1000.0;
+
+		_outputStream << std::fixed;
+		_outputStream.precision(3);
+
+		switch (event.type) {
+		case ProfileEventType::Scope:
+			_outputStream << "{\"cat\":\"function\",\"dur\":" << event.duration / 1000.0 << ",\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << threadId << ",\"ts\":" << ts << "}";
+			break;
+		case ProfileEventType::Counter:
+			_outputStream << "{\"name\":\"" << name << "\",\"ph\":\"C\",\"pid\":0,\"tid\":" << threadId << ",\"ts\":" << ts << ",\"args\":{\"value\":" << event.value << "}}";
+			break;
+		case ProfileEventType::Frame:
+			_outputStream << "{\"name\":\"" << name << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":" << threadId << ",\"ts\":" << ts << "}";
+			break;
+		}
+	}
+}
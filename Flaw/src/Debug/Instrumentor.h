@@ -1,151 +1,209 @@
 //
-// Basic instrumentation profiler by Cherno
-
-// Usage: include this header file somewhere in your code (eg. precompiled header), and then use like:
+// Instrumentation profiler writing Chrome trace (chrome://tracing) files
+//
+// Usage:
 //
-// Instrumentor::Get().BeginSession("Session Name");        // Begin session 
+// FLAW_PROFILE_BEGIN_SESSION("Session Name", "results.json");
 // {
-//     InstrumentationTimer timer("Profiled Scope Name");   // Place code like this in scopes you'd like to include in profiling
-//     // Code
+//     FLAW_PROFILE_SCOPE("Profiled Scope Name");    // scope names must be string literals or outlive the session
+//     FLAW_PROFILE_COUNTER("Visible Objects", count);
 // }
-// Instrumentor::Get().EndSession();                        // End Session
+// FLAW_PROFILE_FRAME();                             // frame marker, called once per frame
+// FLAW_PROFILE_END_SESSION();
 //
-// You will probably want to macro-fy this, to switch on/off easily and use things like __FUNCSIG__ for the profile name.
+// Events are pushed into per-thread ring buffers without locking, a background thread drains them and writes the trace file.
+// Recording can be switched off at runtime with Instrumentor::Get().SetEnabled(false), disabled scopes only cost an atomic load.
 //
 #pragma once
 
+#include "Core.h"
+
 #include <string>
 #include <chrono>
 #include <algorithm>
 #include <fstream>
-
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <thread>
+#include <vector>
+#include <unordered_map>
+#include <deque>
 
 namespace flaw {
-    struct ProfileResult
-    {
-        std::string Name;
-        long long Start, End;
-        uint32_t ThreadID;
-    };
-
-    struct InstrumentationSession
-    {
-        std::string Name;
-    };
-
-    class Instrumentor
-    {
-    private:
-        InstrumentationSession* m_CurrentSession;
-        std::ofstream m_OutputStream;
-        int m_ProfileCount;
-    public:
-        Instrumentor()
-            : m_CurrentSession(nullptr), m_ProfileCount(0)
-        {
-        }
-
-        void BeginSession(const std::string& name, const std::string& filepath = "results.json")
-        {
-            m_OutputStream.open(filepath);
-            WriteHeader();
-            m_CurrentSession = new InstrumentationSession{ name };
-        }
-
-        void EndSession()
-        {
-            WriteFooter();
-            m_OutputStream.close();
-            delete m_CurrentSession;
-            m_CurrentSession = nullptr;
-            m_ProfileCount = 0;
-        }
-
-        void WriteProfile(const ProfileResult& result)
-        {
-            if (m_ProfileCount++ > 0)
-                m_OutputStream << ",";
-
-            std::string name = result.Name;
-            std::replace(name.begin(), name.end(), '"', '\'');
-
-            m_OutputStream << "{";
-            m_OutputStream << "\"cat\":\"function\",";
-            m_OutputStream << "\"dur\":" << (result.End - result.Start) << ',';
-            m_OutputStream << "\"name\":\"" << name << "\",";
-            m_OutputStream << "\"ph\":\"X\",";
-            m_OutputStream << "\"pid\":0,";
-            m_OutputStream << "\"tid\":" << result.ThreadID << ",";
-            m_OutputStream << "\"ts\":" << result.Start;
-            m_OutputStream << "}";
-
-            m_OutputStream.flush();
-        }
-
-        void WriteHeader()
-        {
-            m_OutputStream << "{\"otherData\": {},\"traceEvents\":[";
-            m_OutputStream.flush();
-        }
-
-        void WriteFooter()
-        {
-            m_OutputStream << "]}";
-            m_OutputStream.flush();
-        }
-
-        static Instrumentor& Get()
-        {
-            static Instrumentor instance;
-            return instance;
-        }
-    };
-
-    class InstrumentationTimer
-    {
-    public:
-        InstrumentationTimer(const char* name)
-            : m_Name(name), m_Stopped(false)
-        {
-            m_StartTimepoint = std::chrono::high_resolution_clock::now();
-        }
-
-        ~InstrumentationTimer()
-        {
-            if (!m_Stopped)
-                Stop();
-        }
-
-        void Stop()
-        {
-            auto endTimepoint = std::chrono::high_resolution_clock::now();
-
-            long long start = std::chrono::time_point_cast<std::chrono::microseconds>(m_StartTimepoint).time_since_epoch().count();
-            long long end = std::chrono::time_point_cast<std::chrono::microseconds>(endTimepoint).time_since_epoch().count();
-
-            uint32_t threadID = std::hash<std::thread::id>{}(std::this_thread::get_id());
-            Instrumentor::Get().WriteProfile({ m_Name, start, end, threadID });
-
-            m_Stopped = true;
-        }
-    private:
-        const char* m_Name;
-        std::chrono::time_point<std::chrono::high_resolution_clock> m_StartTimepoint;
-        bool m_Stopped;
-    };
+	enum class ProfileEventType : uint8_t {
+		Scope,
+		Counter,
+		Frame
+	};
+
+	struct ProfileEvent {
+		uint32_t nameId;
+		ProfileEventType type;
+		int64_t start; // nanoseconds
+		int64_t duration; // nanoseconds, scope only
+		double value; // counter only
+	};
+
+	// single producer (owner thread), single consumer (trace writer) ring buffer
+	class ProfileEventBuffer {
+	public:
+		static constexpr uint32_t Capacity = 1 << 14;
+
+		ProfileEventBuffer(uint32_t threadId) : _threadId(threadId), _head(0), _tail(0), _dropped(0) {}
+
+		bool Push(const ProfileEvent& event) {
+			const uint32_t head = _head.load(std::memory_order_relaxed);
+			if (head - _tail.load(std::memory_order_acquire) == Capacity) {
+				_dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			_events[head & (Capacity - 1)] = event;
+			_head.store(head + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		template<typename Func>
+		void Drain(const Func& func) {
+			const uint32_t head = _head.load(std::memory_order_acquire);
+			uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+			for (; tail != head; ++tail) {
+				func(_events[tail & (Capacity - 1)]);
+			}
+
+			_tail.store(tail, std::memory_order_release);
+		}
+
+		uint32_t GetThreadId() const { return _threadId; }
+		uint64_t GetDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+	private:
+		uint32_t _threadId;
+
+		std::atomic<uint32_t> _head;
+		std::atomic<uint32_t> _tail;
+		std::atomic<uint64_t> _dropped;
+
+		ProfileEvent _events[Capacity];
+	};
+
+	class Instrumentor {
+	public:
+		static Instrumentor& Get() {
+			static Instrumentor instance;
+			return instance;
+		}
+
+		void BeginSession(const std::string& name, const std::string& filepath = "results.json");
+		void EndSession();
+
+		void SetEnabled(bool enabled);
+		bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+		// enabled and inside a session
+		bool IsRecording() const { return _recording.load(std::memory_order_relaxed); }
+
+		void RecordScope(const char* name, int64_t start, int64_t end);
+		void RecordCounter(const char* name, double value);
+		void RecordFrame();
+
+		static int64_t Now() {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+	private:
+		Instrumentor();
+		~Instrumentor();
+
+		ProfileEventBuffer& GetThreadBuffer();
+		uint32_t InternName(const char* name);
+
+		static void WriterThread(Instrumentor* instrumentor);
+
+		void WriteEvents();
+		void WriteEvent(uint32_t threadId, const ProfileEvent& event);
+
+	private:
+		std::atomic<bool> _enabled;
+		std::atomic<bool> _recording;
+
+		std::mutex _sessionMutex;
+		std::string _sessionName;
+		std::ofstream _outputStream;
+		int64_t _eventCount;
+
+		std::thread _writerThread;
+		std::mutex _writerMutex;
+		std::condition_variable _writerCondition;
+		bool _stopWriter;
+
+		// only locked when a thread records for the first time
+		std::mutex _buffersMutex;
+		std::vector<Ref<ProfileEventBuffer>> _buffers;
+
+		// only locked when a thread sees a name for the first time
+		std::mutex _namesMutex;
+		std::unordered_map<std::string, uint32_t> _nameIds;
+		std::deque<std::string> _names;
+	};
+
+	class InstrumentationTimer {
+	public:
+		InstrumentationTimer(const char* name)
+			: _name(name)
+			, _stopped(!Instrumentor::Get().IsRecording())
+		{
+			if (!_stopped) {
+				_start = Instrumentor::Now();
+			}
+		}
+
+		~InstrumentationTimer() {
+			if (!_stopped) {
+				Stop();
+			}
+		}
+
+		void Stop() {
+			Instrumentor::Get().RecordScope(_name, _start, Instrumentor::Now());
+			_stopped = true;
+		}
+
+	private:
+		const char* _name;
+		int64_t _start = 0;
+		bool _stopped;
+	};
 }
 
+#if defined(_MSC_VER)
+	#define FLAW_FUNC_SIG __FUNCSIG__
+#elif defined(__GNUC__) || defined(__clang__)
+	#define FLAW_FUNC_SIG __PRETTY_FUNCTION__
+#else
+	#define FLAW_FUNC_SIG __func__
+#endif
+
+#define FLAW_PROFILE_CONCAT_IMPL(a, b) a##b
+#define FLAW_PROFILE_CONCAT(a, b) FLAW_PROFILE_CONCAT_IMPL(a, b)
+
 #define FLAW_PROFILE
 
 #ifdef FLAW_PROFILE
     #define FLAW_PROFILE_BEGIN_SESSION(name, filepath) ::flaw::Instrumentor::Get().BeginSession(name, filepath)
     #define FLAW_PROFILE_END_SESSION() ::flaw::Instrumentor::Get().EndSession()
-    #define FLAW_PROFILE_SCOPE(name) ::flaw::InstrumentationTimer timer##__LINE__(name);
-    #define FLAW_PROFILE_FUNCTION() FLAW_PROFILE_SCOPE(__FUNCSIG__)
+    #define FLAW_PROFILE_SCOPE(name) ::flaw::InstrumentationTimer FLAW_PROFILE_CONCAT(timer, __LINE__)(name);
+    #define FLAW_PROFILE_FUNCTION() FLAW_PROFILE_SCOPE(FLAW_FUNC_SIG)
+    #define FLAW_PROFILE_COUNTER(name, value) ::flaw::Instrumentor::Get().RecordCounter(name, static_cast<double>(value))
+    #define FLAW_PROFILE_FRAME() ::flaw::Instrumentor::Get().RecordFrame()
 #else
     #define FLAW_PROFILE_BEGIN_SESSION(name, filepath)
     #define FLAW_PROFILE_END_SESSION()
     #define FLAW_PROFILE_SCOPE(name)
     #define FLAW_PROFILE_FUNCTION()
-#endif
\ No newline at end of file
+    #define FLAW_PROFILE_COUNTER(name, value)
+    #define FLAW_PROFILE_FRAME()
+#endif
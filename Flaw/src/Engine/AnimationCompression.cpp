@@ -0,0 +1,235 @@
+#include "pch.h"
+#include "AnimationCompression.h"
+
+#include <algorithm>
+
+namespace flaw {
+	// the three smaller components of a unit quaternion lie in [-1/sqrt(2), 1/sqrt(2)]
+	constexpr float SmallestThreeRange = 0.70710678f;
+	constexpr uint16_t SmallestThreeValueMask = 0x7fff;
+	constexpr float SmallestThreeValueMax = 32767.0f;
+
+	void EncodeSmallestThree(const vec4& rotation, uint16_t out[3]) {
+		const vec4 normalized = normalize(rotation);
+
+		int32_t largest = 0;
+		for (int32_t i = 1; i < 4; ++i) {
+			if (abs(normalized[i]) > abs(normalized[largest])) {
+				largest = i;
+			}
+		}
+
+		// q and -q are the same rotation, flip so the dropped component is positive
+		const float sign = normalized[largest] < 0.0f ? -1.0f : 1.0f;
+
+		int32_t outIndex = 0;
+		for (int32_t i = 0; i < 4; ++i) {
+			if (i == largest) {
+				continue;
+			}
+
+			const float value = glm::clamp((normalized[i] * sign + SmallestThreeRange) / (2.0f * SmallestThreeRange), 0.0f, 1.0f);
+			out[outIndex++] = static_cast<uint16_t>(value * SmallestThreeValueMax + 0.5f);
+		}
+
+		// index of the dropped component goes to the top bits of the first two values
+		out[0] |= (largest & 1) << 15;
+		out[1] |= ((largest >> 1) & 1) << 15;
+	}
+
+	vec4 DecodeSmallestThree(const uint16_t in[3]) {
+		const int32_t largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+
+		vec4 result;
+		float sumSquared = 0.0f;
+
+		int32_t inIndex = 0;
+		for (int32_t i = 0; i < 4; ++i) {
+			if (i == largest) {
+				continue;
+			}
+
+			const float value = (in[inIndex++] & SmallestThreeValueMask) / SmallestThreeValueMax * 2.0f * SmallestThreeRange - SmallestThreeRange;
+			result[i] = value;
+			sumSquared += value * value;
+		}
+
+		result[largest] = sqrt(std::max(0.0f, 1.0f - sumSquared));
+
+		return result;
+	}
+
+	static quat ToQuat(const vec4& value) {
+		return quat(value.w, value.x, value.y, value.z);
+	}
+
+	static float GetRotationAngle(const quat& a, const quat& b) {
+		return 2.0f * acos(glm::clamp(abs(dot(a, b)), 0.0f, 1.0f));
+	}
+
+	// keeps the keys a straight interpolation between the kept keys cannot reproduce within the tolerance
+	template<typename T, typename Interpolate, typename GetError>
+	static std::vector<SkeletalAnimationNodeKey<T>> ReduceKeys(const std::vector<SkeletalAnimationNodeKey<T>>& keys, float tolerance, const Interpolate& interpolate, const GetError& getError) {
+		if (keys.size() <= 1) {
+			return keys;
+		}
+
+		const bool constant = std::all_of(keys.begin(), keys.end(), [&](const auto& key) { return getError(keys[0].value, key.value) <= tolerance; });
+		if (constant) {
+			return { keys[0] };
+		}
+
+		std::vector<SkeletalAnimationNodeKey<T>> result;
+		result.push_back(keys[0]);
+
+		size_t start = 0;
+		for (size_t end = 2; end < keys.size(); ++end) {
+			const auto& startKey = keys[start];
+			const auto& endKey = keys[end];
+			const float duration = endKey.time - startKey.time;
+
+			for (size_t i = start + 1; i < end; ++i) {
+				const float factor = duration > 0.0f ? (keys[i].time - startKey.time) / duration : 0.0f;
+				if (getError(interpolate(startKey.value, endKey.value, factor), keys[i].value) > tolerance) {
+					// the segment can not reach this far, the previous key is needed
+					result.push_back(keys[end - 1]);
+					start = end - 1;
+					break;
+				}
+			}
+		}
+
+		result.push_back(keys.back());
+
+		return result;
+	}
+
+	static uint16_t QuantizeTime(float time, float timeStep) {
+		return static_cast<uint16_t>(glm::clamp(time / timeStep + 0.5f, 0.0f, 65535.0f));
+	}
+
+	// keys falling on the same quantized time as the previous key are dropped, they would interpolate over zero time
+	template<typename T, typename Encode>
+	static std::vector<QuantizedAnimationKey> QuantizeKeys(const std::vector<SkeletalAnimationNodeKey<T>>& keys, float timeStep, const Encode& encode) {
+		std::vector<QuantizedAnimationKey> result;
+		result.reserve(keys.size());
+
+		for (const auto& key : keys) {
+			QuantizedAnimationKey quantized;
+			quantized.time = QuantizeTime(key.time, timeStep);
+
+			if (!result.empty() && result.back().time == quantized.time) {
+				continue;
+			}
+
+			encode(key.value, quantized.value);
+			result.push_back(quantized);
+		}
+
+		return result;
+	}
+
+	static void GetRange(const std::vector<SkeletalAnimationNodeKey<vec3>>& keys, vec3& outMin, vec3& outRange) {
+		if (keys.empty()) {
+			outMin = vec3(0.0f);
+			outRange = vec3(0.0f);
+			return;
+		}
+
+		vec3 minValue = keys[0].value;
+		vec3 maxValue = keys[0].value;
+		for (const auto& key : keys) {
+			minValue = glm::min(minValue, key.value);
+			maxValue = glm::max(maxValue, key.value);
+		}
+
+		outMin = minValue;
+		outRange = maxValue - minValue;
+	}
+
+	static std::vector<QuantizedAnimationKey> QuantizeRangeKeys(const std::vector<SkeletalAnimationNodeKey<vec3>>& keys, float timeStep, vec3& outMin, vec3& outRange) {
+		GetRange(keys, outMin, outRange);
+
+		const vec3 minValue = outMin;
+		const vec3 range = outRange;
+
+		return QuantizeKeys(keys, timeStep, [&minValue, &range](const vec3& value, uint16_t out[3]) {
+			out[0] = QuantizeRange16(value.x, minValue.x, range.x);
+			out[1] = QuantizeRange16(value.y, minValue.y, range.y);
+			out[2] = QuantizeRange16(value.z, minValue.z, range.z);
+		});
+	}
+
+	template<typename T>
+	static uint64_t GetRawTrackSize(const std::vector<SkeletalAnimationNodeKey<T>>& keys) {
+		return keys.size() * (sizeof(float) + sizeof(T));
+	}
+
+	static void AccumulateStats(const SkeletalAnimationNode& node, const CompressedSkeletalAnimationNode& compressed, SkeletalAnimationCompressionStats& stats) {
+		stats.rawSize += GetRawTrackSize(node.GetPositionKeys()) + GetRawTrackSize(node.GetRotationKeys()) + GetRawTrackSize(node.GetScaleKeys());
+		stats.rawKeyCount += node.GetPositionKeys().size() + node.GetRotationKeys().size() + node.GetScaleKeys().size();
+
+		const uint32_t compressedKeyCount = compressed.positionKeys.size() + compressed.rotationKeys.size() + compressed.scaleKeys.size();
+		stats.compressedSize += sizeof(float) + sizeof(vec3) * 4 + compressedKeyCount * sizeof(QuantizedAnimationKey);
+		stats.compressedKeyCount += compressedKeyCount;
+
+		// compare the decoded node against every raw key
+		const SkeletalAnimationNode decoded(compressed);
+
+		int32_t keyCursor = -1;
+		for (const auto& key : node.GetPositionKeys()) {
+			stats.maxPositionError = std::max(stats.maxPositionError, length(decoded.InterpolatePosition(key.time, keyCursor) - key.value));
+		}
+
+		keyCursor = -1;
+		for (const auto& key : node.GetRotationKeys()) {
+			stats.maxRotationError = std::max(stats.maxRotationError, GetRotationAngle(decoded.InterpolateRotation(key.time, keyCursor), normalize(ToQuat(key.value))));
+		}
+
+		keyCursor = -1;
+		for (const auto& key : node.GetScaleKeys()) {
+			stats.maxScaleError = std::max(stats.maxScaleError, length(decoded.InterpolateScale(key.time, keyCursor) - key.value));
+		}
+	}
+
+	CompressedSkeletalAnimationNode CompressSkeletalAnimationNode(const SkeletalAnimationNode& node, float durationSec, const SkeletalAnimationCompressionSettings& settings, SkeletalAnimationCompressionStats* stats) {
+		auto lerpVec3 = [](const vec3& a, const vec3& b, float factor) { return mix(a, b, factor); };
+		auto vec3Error = [](const vec3& a, const vec3& b) { return length(a - b); };
+
+		auto slerpRotation = [](const vec4& a, const vec4& b, float factor) {
+			const quat result = normalize(slerp(ToQuat(a), ToQuat(b), factor));
+			return vec4(result.x, result.y, result.z, result.w);
+		};
+		auto rotationError = [](const vec4& a, const vec4& b) { return GetRotationAngle(normalize(ToQuat(a)), normalize(ToQuat(b))); };
+
+		const auto positionKeys = ReduceKeys(node.GetPositionKeys(), settings.positionTolerance, lerpVec3, vec3Error);
+		const auto rotationKeys = ReduceKeys(node.GetRotationKeys(), settings.rotationTolerance, slerpRotation, rotationError);
+		const auto scaleKeys = ReduceKeys(node.GetScaleKeys(), settings.scaleTolerance, lerpVec3, vec3Error);
+
+		// keys may sit past the clip duration, the time scale has to cover them
+		float endTime = durationSec;
+		auto extendEndTime = [&endTime](const auto& keys) {
+			if (!keys.empty()) {
+				endTime = std::max(endTime, keys.back().time);
+			}
+		};
+
+		extendEndTime(positionKeys);
+		extendEndTime(rotationKeys);
+		extendEndTime(scaleKeys);
+
+		CompressedSkeletalAnimationNode result;
+		result.nodeName = node.GetNodeName();
+		result.timeStep = endTime > 0.0f ? endTime / 65535.0f : 1.0f;
+
+		result.positionKeys = QuantizeRangeKeys(positionKeys, result.timeStep, result.positionMin, result.positionRange);
+		result.scaleKeys = QuantizeRangeKeys(scaleKeys, result.timeStep, result.scaleMin, result.scaleRange);
+		result.rotationKeys = QuantizeKeys(rotationKeys, result.timeStep, [](const vec4& value, uint16_t out[3]) { EncodeSmallestThree(value, out); });
+
+		if (stats) {
+			AccumulateStats(node, result, *stats);
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Core.h"
+#include "Math/Math.h"
+#include "Skeleton.h"
+
+namespace flaw {
+	struct SkeletalAnimationCompressionSettings {
+		float positionTolerance = 0.0005f;	// max position error of a removed key
+		float rotationTolerance = 0.001f;	// max angle error of a removed key in radians
+		float scaleTolerance = 0.0005f;		// max scale error of a removed key
+	};
+
+	struct SkeletalAnimationCompressionStats {
+		uint64_t rawSize = 0;
+		uint64_t compressedSize = 0;
+
+		uint32_t rawKeyCount = 0;
+		uint32_t compressedKeyCount = 0;
+
+		// largest difference between the raw keys and the decoded compressed node
+		float maxPositionError = 0.0f;
+		float maxRotationError = 0.0f;
+		float maxScaleError = 0.0f;
+
+		float GetCompressionRatio() const { return compressedSize ? static_cast<float>(rawSize) / compressedSize : 0.0f; }
+	};
+
+	// drops keys a straight interpolation reproduces within the tolerances and quantizes the rest, stats are accumulated when given
+	CompressedSkeletalAnimationNode CompressSkeletalAnimationNode(const SkeletalAnimationNode& node, float durationSec, const SkeletalAnimationCompressionSettings& settings, SkeletalAnimationCompressionStats* stats = nullptr);
+
+	// rotations are (x, y, z, w)
+	void EncodeSmallestThree(const vec4& rotation, uint16_t out[3]);
+	vec4 DecodeSmallestThree(const uint16_t in[3]);
+
+	inline uint16_t QuantizeUnorm16(float value) {
+		return static_cast<uint16_t>(glm::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	}
+
+	inline float DequantizeUnorm16(uint16_t value) {
+		return value / 65535.0f;
+	}
+
+	inline uint16_t QuantizeRange16(float value, float minValue, float range) {
+		return range > 0.0f ? QuantizeUnorm16((value - minValue) / range) : 0;
+	}
+
+	inline float DequantizeRange16(uint16_t value, float minValue, float range) {
+		return minValue + DequantizeUnorm16(value) * range;
+	}
+}
@@ -15,44 +15,63 @@ namespace flaw {
 	{
 	}
 
-	void AnimationSystem::RegisterEntity(entt::registry& registry, entt::entity entity) {
-		auto& enttComp = registry.get<EntityComponent>(entity);
-		auto& skeletalMeshComp = registry.get<AnimatorComponent>(entity);
+	Ref<Animator> AnimationSystem::GetDefaultAnimator(const AssetHandle& skeletonHandle) {
+		auto it = _defaultAnimators.find(skeletonHandle);
+		if (it != _defaultAnimators.end()) {
+			return it->second;
+		}
 
-		// TODO: get animator asset and get animator from asset, but for now just test with test animator
-		static Scope<Animator> animator;
-		if (!animator) {
-			Ref<SkeletonAsset> skeletonAsset = AssetManager::GetAsset<SkeletonAsset>(skeletalMeshComp.skeletonAsset);
-			if (!skeletonAsset) {
-				return;
+		Ref<SkeletonAsset> skeletonAsset = AssetManager::GetAsset<SkeletonAsset>(skeletonHandle);
+		if (!skeletonAsset) {
+			return nullptr;
+		}
+
+		// one looping state per animation of the skeleton, the first one plays
+		Animator::Descriptor desc = {};
+		desc.skeleton = skeletonAsset->GetSkeleton();
+
+		for (auto& animHandle : skeletonAsset->GetAnimationHandles()) {
+			auto animAsset = AssetManager::GetAsset<SkeletalAnimationAsset>(animHandle);
+			if (!animAsset) {
+				continue;
 			}
 
-			Animator::Descriptor desc = {};
-			desc.skeleton = skeletonAsset->GetSkeleton();
-			
-			for (auto& animHandle : skeletonAsset->GetAnimationHandles()) {
-				auto animAsset = AssetManager::GetAsset<SkeletalAnimationAsset>(animHandle);
-				if (!animAsset) {
-					continue;
-				}
+			AnimatorMotionSampleDesc sample;
+			sample.animationIndex = static_cast<int32_t>(desc.animations.size());
 
-				Ref<AnimatorAnimation1D> anim = CreateRef<AnimatorAnimation1D>(animAsset->GetAnimation());
+			AnimatorStateDesc state;
+			state.name = animAsset->GetAnimation()->GetName();
+			state.samples.push_back(sample);
 
-				Ref<AnimatorState> state = CreateRef<AnimatorState>();
-				state->SetAnimation(anim);
-				state->SetLoop(true);
+			desc.graph.animations.push_back(animHandle);
+			desc.graph.states.push_back(state);
+			desc.animations.push_back(animAsset->GetAnimation());
+		}
 
-				desc.states.push_back(state);
-			}
+		Ref<Animator> animator = CreateRef<Animator>(desc);
+		_defaultAnimators[skeletonHandle] = animator;
 
-			desc.defaultStateIndex = 0;
+		return animator;
+	}
+
+	void AnimationSystem::RegisterEntity(entt::registry& registry, entt::entity entity) {
+		auto& animatorComp = registry.get<AnimatorComponent>(entity);
 
-			animator = CreateScope<Animator>(desc);
+		// entities sharing an animator asset share its graph, only the runtime is per entity
+		Ref<Animator> animator;
+		if (auto animatorAsset = AssetManager::GetAsset<AnimatorAsset>(animatorComp.animatorAsset)) {
+			animator = animatorAsset->GetAnimator();
+		}
+		else {
+			animator = GetDefaultAnimator(animatorComp.skeletonAsset);
+		}
+
+		if (!animator) {
+			return;
 		}
 
 		auto context = CreateRef<AnimatorJobContext>();
-		context->runtimeAnimator = CreateRef<AnimatorRuntime>(*animator);
-		context->runtimeAnimator->SetToDefaultState();
+		context->runtimeAnimator = CreateRef<AnimatorRuntime>(animator);
 		context->isBackBufferReady.store(false);
 
 		context->animatedBoneMatrices0.resize(animator->GetSkeleton()->GetBoneCount());
@@ -75,6 +94,13 @@ namespace flaw {
 
 		context->animatedSkinMatricesSB = Graphics::CreateStructuredBuffer(desc);
 
+		// the buffer is bound before the first sample is done, start from the binding pose
+		const Skeleton& skeleton = *animator->GetSkeleton();
+		std::vector<mat4> modelMatrices;
+		ComputeModelMatrices(skeleton, skeleton.GetBindingPose(), modelMatrices);
+		ComputeBoneAndSkinMatrices(skeleton, modelMatrices, context->frontAnimatedBoneMatrices, context->frontAnimatedSkinMatrices);
+		context->animatedSkinMatricesSB->Update(context->frontAnimatedSkinMatrices->data(), context->frontAnimatedSkinMatrices->size() * sizeof(mat4));
+
 		_animatorJobContexts[entity] = context;
 	}
 
@@ -82,6 +108,33 @@ namespace flaw {
 		_animatorJobContexts.erase(entity);
 	}
 
+	// interval 0 means no update at all
+	static void SelectLevelOfDetail(const AnimatorComponent& animatorComp, float screenSize, int32_t& outUpdateInterval, int32_t& outMaxBoneDepth) {
+		outUpdateInterval = 1;
+		outMaxBoneDepth = -1;
+
+		if (!animatorComp.useLevelOfDetail || animatorComp.levelOfDetails.empty()) {
+			return;
+		}
+
+		if (screenSize < 0.0f) {
+			outUpdateInterval = animatorComp.offscreenUpdateInterval;
+			outMaxBoneDepth = animatorComp.levelOfDetails.back().maxBoneDepth;
+			return;
+		}
+
+		const AnimatorLevelOfDetail* selected = &animatorComp.levelOfDetails.back();
+		for (const auto& lod : animatorComp.levelOfDetails) {
+			if (screenSize >= lod.minScreenSize) {
+				selected = &lod;
+				break;
+			}
+		}
+
+		outUpdateInterval = selected->updateInterval;
+		outMaxBoneDepth = selected->maxBoneDepth;
+	}
+
 	void AnimationSystem::Start() {
 		auto& registry = _scene.GetRegistry();
 
@@ -93,7 +146,98 @@ namespace flaw {
 		registry.on_destroy<AnimatorComponent>().connect<&AnimationSystem::UnregisterEntity>(*this);
 	}
 
+	Ref<AnimatorCrowdPose> AnimationSystem::AcquireCrowdPose(const Ref<Animator>& animator, const AnimatorCrowdSample& sample, int32_t maxNodeDepth) {
+		const AnimatorCrowdPoseKey key = { animator.get(), sample.stateIndex, sample.timeBucket, maxNodeDepth };
+
+		auto it = _crowdPoses.find(key);
+		if (it != _crowdPoses.end()) {
+			it->second->lastUsedFrame = _frame;
+			_crowdStats.hits++;
+			return it->second;
+		}
+
+		auto crowdPose = CreateRef<AnimatorCrowdPose>();
+		crowdPose->animator = animator;
+		crowdPose->sample = sample;
+		crowdPose->maxNodeDepth = maxNodeDepth;
+		crowdPose->lastUsedFrame = _frame;
+
+		_crowdPoses[key] = crowdPose;
+		_crowdStats.misses++;
+
+		_app.AddAsyncTask([crowdPose]() {
+			const Animator& animator = *crowdPose->animator;
+			const Skeleton& skeleton = *animator.GetSkeleton();
+
+			// single clip states do not read parameters
+			AnimatorMotionWeights weights;
+			animator.GetMotionWeights(crowdPose->sample.stateIndex, nullptr, weights);
+			animator.SampleState(crowdPose->sample.stateIndex, weights, crowdPose->sample.normalizedTime, crowdPose->cursors, crowdPose->pose, crowdPose->tempPose, crowdPose->maxNodeDepth);
+
+			ComputeModelMatrices(skeleton, crowdPose->pose, crowdPose->modelMatrices);
+			ComputeBoneAndSkinMatrices(skeleton, crowdPose->modelMatrices, &crowdPose->boneMatrices, &crowdPose->skinMatrices);
+		}, &crowdPose->jobCounter);
+
+		return crowdPose;
+	}
+
+	bool AnimationSystem::UpdateCrowdPose(AnimatorJobContext& context, const AnimatorComponent& animatorComp, int32_t maxBoneDepth) {
+		AnimatorRuntime& runtime = *context.runtimeAnimator;
+
+		AnimatorCrowdSample sample;
+		if (!runtime.GetCrowdSample(animatorComp.crowdPoseTimeStep, sample)) {
+			return false;
+		}
+
+		context.crowdPose = AcquireCrowdPose(runtime.GetAnimator(), sample, maxBoneDepth);
+
+		// the runtime only keeps time and transitions going, its own poses are stale once it leaves the crowd
+		runtime.Advance(context.pendingDeltaTime);
+		context.pendingDeltaTime = 0.0f;
+		context.framesSinceSample = 0;
+		context.hasKeyPose = false;
+		context.hasSampled = true;
+		context.isBackBufferReady.store(false);
+
+		return true;
+	}
+
+	void AnimationSystem::UploadCrowdPose(AnimatorCrowdPose& crowdPose) {
+		if (crowdPose.isUploaded) {
+			return;
+		}
+
+		_app.GetJobSystem().Wait(crowdPose.jobCounter);
+
+		// buffers are only created on the main thread, the palette itself is computed by animation jobs
+		if (!crowdPose.skinMatricesSB) {
+			const uint32_t boneCount = crowdPose.animator->GetSkeleton()->GetBoneCount();
+
+			auto& freeBuffers = _freeCrowdSkinBuffers[boneCount];
+			if (!freeBuffers.empty()) {
+				crowdPose.skinMatricesSB = std::move(freeBuffers.back());
+				freeBuffers.pop_back();
+			}
+			else {
+				StructuredBuffer::Descriptor desc = {};
+				desc.elmSize = sizeof(mat4);
+				desc.count = boneCount;
+				desc.bindFlags = BindFlag::ShaderResource;
+				desc.accessFlags = AccessFlag::Write;
+
+				crowdPose.skinMatricesSB = Graphics::CreateStructuredBuffer(desc);
+			}
+		}
+
+		crowdPose.skinMatricesSB->Update(crowdPose.skinMatrices.data(), crowdPose.skinMatrices.size() * sizeof(mat4));
+		crowdPose.isUploaded = true;
+	}
+
 	void AnimationSystem::Update() {
+		_frame++;
+		_crowdStats.hits = 0;
+		_crowdStats.misses = 0;
+
 		for (auto&& [entity, animatorComp] : _scene.GetRegistry().view<AnimatorComponent>().each()) {
 			auto it = _animatorJobContexts.find(entity);
 			if (it == _animatorJobContexts.end()) {
@@ -102,10 +246,77 @@ namespace flaw {
 
 			auto context = it->second;
 
-			_app.AddAsyncTask([context]() {
-				context->runtimeAnimator->Update(Time::DeltaTime(), *context->backAnimatedBoneMatrices, *context->backAnimatedSkinMatrices);
+			context->pendingDeltaTime += Time::DeltaTime();
+
+			const float screenSize = context->screenSize;
+			context->screenSize = -1.0f;
+
+			if (!context->jobCounter.IsDone()) {
+				continue; // previous update is still running, its back buffer must not be touched
+			}
+
+			int32_t updateInterval, maxBoneDepth;
+			SelectLevelOfDetail(animatorComp, screenSize, updateInterval, maxBoneDepth);
+
+			if (updateInterval <= 0) {
+				if (context->hasSampled) {
+					// frozen, time keeps accumulating so the animation resumes where it would be
+					context->hasKeyPose = false;
+					continue;
+				}
+
+				updateInterval = 1;
+			}
+
+			if (animatorComp.useCrowdPose && UpdateCrowdPose(*context, animatorComp, maxBoneDepth)) {
+				continue;
+			}
+
+			// samples lag one interval behind, the frames in between blend from the previous sample to the last one
+			const bool interpolate = context->hasKeyPose;
+			const bool sample = !interpolate || ++context->framesSinceSample >= updateInterval;
+
+			float deltaTime = 0.0f;
+			if (sample) {
+				deltaTime = context->pendingDeltaTime;
+				context->pendingDeltaTime = 0.0f;
+				context->framesSinceSample = 0;
+				context->hasKeyPose = true;
+				context->hasSampled = true;
+			}
+
+			const float keyFactor = interpolate ? static_cast<float>(context->framesSinceSample + 1) / updateInterval : 1.0f;
+
+			_app.AddAsyncTask([context, sample, deltaTime, maxBoneDepth, interpolate, keyFactor]() {
+				if (sample) {
+					context->runtimeAnimator->Sample(deltaTime, maxBoneDepth, interpolate);
+				}
+				context->runtimeAnimator->Evaluate(keyFactor, *context->backAnimatedBoneMatrices, *context->backAnimatedSkinMatrices);
 				context->isBackBufferReady.store(true);
-			});
+			}, &context->jobCounter);
+		}
+
+		// palettes nobody sampled this frame are dropped, entities still showing one keep it alive
+		_crowdStats.paletteCount = 0;
+		_crowdStats.paletteBytes = 0;
+
+		for (auto it = _crowdPoses.begin(); it != _crowdPoses.end(); ) {
+			const auto& crowdPose = it->second;
+			if (crowdPose->lastUsedFrame != _frame) {
+				// entities still showing the palette keep its buffer
+				if (crowdPose.use_count() == 1 && crowdPose->skinMatricesSB) {
+					_freeCrowdSkinBuffers[crowdPose->animator->GetSkeleton()->GetBoneCount()].push_back(std::move(crowdPose->skinMatricesSB));
+				}
+
+				it = _crowdPoses.erase(it);
+				continue;
+			}
+
+			// bone and skin matrices on the cpu, skin matrices on the gpu
+			_crowdStats.paletteCount++;
+			_crowdStats.paletteBytes += crowdPose->animator->GetSkeleton()->GetBoneCount() * sizeof(mat4) * 3;
+
+			++it;
 		}
 	}
 
@@ -116,6 +327,19 @@ namespace flaw {
 		registry.on_destroy<AnimatorComponent>().disconnect<&AnimationSystem::UnregisterEntity>(*this);
 
 		_animatorJobContexts.clear();
+		_defaultAnimators.clear();
+		_crowdPoses.clear();
+		_freeCrowdSkinBuffers.clear();
+		_crowdStats = AnimationCrowdStats();
+	}
+
+	void AnimationSystem::ReportScreenSize(entt::entity entity, float screenSize) {
+		auto it = _animatorJobContexts.find(entity);
+		if (it == _animatorJobContexts.end()) {
+			return;
+		}
+
+		it->second->screenSize = std::max(it->second->screenSize, screenSize);
 	}
 
 	bool AnimationSystem::HasAnimatorJobContext(entt::entity entity) const {
@@ -134,8 +358,31 @@ namespace flaw {
 			std::swap(context->frontAnimatedBoneMatrices, context->backAnimatedBoneMatrices);
 			std::swap(context->frontAnimatedSkinMatrices, context->backAnimatedSkinMatrices);
 			context->animatedSkinMatricesSB->Update(context->frontAnimatedSkinMatrices->data(), context->frontAnimatedSkinMatrices->size() * sizeof(mat4));
+
+			// the entity left its crowd, its own matrices are ready
+			context->crowdPose.reset();
 		}
 
 		return *context;
 	}
+
+	const std::vector<mat4>& AnimationSystem::GetAnimatedBoneMatrices(entt::entity entity) {
+		auto& context = GetAnimatorJobContext(entity);
+		if (context.crowdPose) {
+			_app.GetJobSystem().Wait(context.crowdPose->jobCounter);
+			return context.crowdPose->boneMatrices;
+		}
+
+		return *context.frontAnimatedBoneMatrices;
+	}
+
+	Ref<StructuredBuffer> AnimationSystem::GetAnimatedSkinMatricesSB(entt::entity entity) {
+		auto& context = GetAnimatorJobContext(entity);
+		if (context.crowdPose) {
+			UploadCrowdPose(*context.crowdPose);
+			return context.crowdPose->skinMatricesSB;
+		}
+
+		return context.animatedSkinMatricesSB;
+	}
 }
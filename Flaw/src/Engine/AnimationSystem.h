@@ -6,11 +6,67 @@
 #include "Utils/UUID.h"
 #include "Skeleton.h"
 #include "Animator.h"
+#include "Utils/JobSystem.h"
 
 namespace flaw {
 	class Application;
 	class Scene;
+	struct AnimatorComponent;
+
+	// skinning palette of one clip at one time bucket, shared by every crowd entity sampling it
+	struct AnimatorCrowdPose {
+		Ref<Animator> animator;
+		AnimatorCrowdSample sample;
+		int32_t maxNodeDepth = -1;
+
+		std::vector<mat4> boneMatrices;
+		std::vector<mat4> skinMatrices;
+		Ref<StructuredBuffer> skinMatricesSB; // taken from the pool by the first upload, the update runs on a worker
+
+		// scratch of the job computing the palette
+		std::vector<SkeletalAnimationCursor> cursors;
+		SkeletonPose pose;
+		SkeletonPose tempPose;
+		std::vector<mat4> modelMatrices;
+
+		JobCounter jobCounter;
+		bool isUploaded = false;
+		uint64_t lastUsedFrame = 0;
+	};
+
+	struct AnimatorCrowdPoseKey {
+		const Animator* animator;
+		int32_t stateIndex;
+		int32_t timeBucket;
+		int32_t maxNodeDepth;
+
+		bool operator==(const AnimatorCrowdPoseKey& other) const {
+			return animator == other.animator && stateIndex == other.stateIndex && timeBucket == other.timeBucket && maxNodeDepth == other.maxNodeDepth;
+		}
+	};
 
+	struct AnimationCrowdStats {
+		uint32_t hits = 0;			// crowd entities that reused a cached palette this frame
+		uint32_t misses = 0;		// palettes computed this frame
+		uint32_t paletteCount = 0;	// palettes alive in the cache
+		uint64_t paletteBytes = 0;	// cpu and gpu memory of those palettes
+	};
+}
+
+namespace std {
+	template<>
+	struct hash<flaw::AnimatorCrowdPoseKey> {
+		std::size_t operator()(const flaw::AnimatorCrowdPoseKey& key) const {
+			std::size_t value = std::hash<const flaw::Animator*>()(key.animator);
+			value = value * 31 + std::hash<int32_t>()(key.stateIndex);
+			value = value * 31 + std::hash<int32_t>()(key.timeBucket);
+			value = value * 31 + std::hash<int32_t>()(key.maxNodeDepth);
+			return value;
+		}
+	};
+}
+
+namespace flaw {
 	struct AnimatorJobContext {
 		Ref<AnimatorRuntime> runtimeAnimator;
 
@@ -28,7 +84,19 @@ namespace flaw {
 
 		std::atomic<bool> isBackBufferReady;
 
+		JobCounter jobCounter;
+		float pendingDeltaTime = 0.0f;
+
+		// level of detail
+		float screenSize = -1.0f; // largest size reported by the renderer since the last update, -1 when no camera saw the mesh
+		int32_t framesSinceSample = 0;
+		bool hasKeyPose = false; // false until the first sample and while frozen
+		bool hasSampled = false; // the first update samples even when the entity starts frozen
+
 		Ref<StructuredBuffer> animatedSkinMatricesSB;
+
+		// set while the entity renders a shared crowd palette instead of its own matrices
+		Ref<AnimatorCrowdPose> crowdPose;
 	};
 
 	class AnimationSystem {
@@ -42,7 +110,25 @@ namespace flaw {
 		bool HasAnimatorJobContext(entt::entity entity) const;
 		AnimatorJobContext& GetAnimatorJobContext(entt::entity entity);
 
+		// called by the renderer for every camera that sees the entity, drives the level of detail of the next update
+		void ReportScreenSize(entt::entity entity, float screenSize);
+
+		// what the entity renders with, the crowd palette when it shares one
+		const std::vector<mat4>& GetAnimatedBoneMatrices(entt::entity entity);
+		Ref<StructuredBuffer> GetAnimatedSkinMatricesSB(entt::entity entity);
+
+		const AnimationCrowdStats& GetCrowdStats() const { return _crowdStats; }
+
 	private:
+		// returns false when the entity has to sample its own pose
+		bool UpdateCrowdPose(AnimatorJobContext& context, const AnimatorComponent& animatorComp, int32_t maxBoneDepth);
+
+		Ref<AnimatorCrowdPose> AcquireCrowdPose(const Ref<Animator>& animator, const AnimatorCrowdSample& sample, int32_t maxNodeDepth);
+		void UploadCrowdPose(AnimatorCrowdPose& crowdPose);
+
+		// used by entities without an animator asset
+		Ref<Animator> GetDefaultAnimator(const AssetHandle& skeletonHandle);
+
 		void RegisterEntity(entt::registry& registry, entt::entity entity);
 		void UnregisterEntity(entt::registry& registry, entt::entity entity);
 
@@ -51,6 +137,12 @@ namespace flaw {
 		Scene& _scene;
 
 		std::unordered_map<entt::entity, Ref<AnimatorJobContext>> _animatorJobContexts;
+		std::unordered_map<AssetHandle, Ref<Animator>> _defaultAnimators; // skeleton asset -> animator
+
+		std::unordered_map<AnimatorCrowdPoseKey, Ref<AnimatorCrowdPose>> _crowdPoses;
+		std::unordered_map<uint32_t, std::vector<Ref<StructuredBuffer>>> _freeCrowdSkinBuffers; // bone count -> buffers of evicted palettes
+		AnimationCrowdStats _crowdStats;
+		uint64_t _frame = 0;
 	};
 }
 
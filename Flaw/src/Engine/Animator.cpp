@@ -2,156 +2,498 @@
 #include "Animator.h"
 #include "Log/Log.h"
 
+#include <algorithm>
+
 namespace flaw {
-	void AnimatorAnimation1D::GetAnimationMatrices(Ref<Skeleton> skeleton, float time, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) {
-		const float normalizedTime = glm::clamp(time / GetDuration(), 0.f, 1.f);
-		skeleton->GetAnimatedBoneAndSkinMatrices(_animation, normalizedTime, animatedBoneMatrices, animatedSkinMatrices);
+	static int32_t ValidateParameterIndex(int32_t index, size_t parameterCount) {
+		if (index < -1 || index >= static_cast<int32_t>(parameterCount)) {
+			Log::Error("Animator: Invalid parameter index %d", index);
+			return -1;
+		}
+		return index;
 	}
 
-	float AnimatorAnimation1D::GetDuration() const {
-		return _animation->GetDurationSec();
+	Animator::Animator(const Animator::Descriptor& desc)
+		: _skeleton(desc.skeleton)
+		, _parameters(desc.graph.parameters)
+		, _transitions(desc.graph.transitions)
+		, _defaultStateIndex(desc.graph.defaultStateIndex)
+	{
+		_states.resize(desc.graph.states.size());
+		for (size_t i = 0; i < desc.graph.states.size(); ++i) {
+			const auto& stateDesc = desc.graph.states[i];
+			auto& state = _states[i];
+
+			state.name = stateDesc.name;
+			state.motionType = stateDesc.motionType;
+			state.parameterX = ValidateParameterIndex(stateDesc.parameterX, _parameters.size());
+			state.parameterY = ValidateParameterIndex(stateDesc.parameterY, _parameters.size());
+			state.speed = stateDesc.speed;
+			state.loop = stateDesc.loop;
+
+			for (const auto& sampleDesc : stateDesc.samples) {
+				if (sampleDesc.animationIndex < 0 || sampleDesc.animationIndex >= static_cast<int32_t>(desc.animations.size()) || !desc.animations[sampleDesc.animationIndex]) {
+					Log::Error("Animator: State %s has a sample without animation", stateDesc.name.c_str());
+					continue;
+				}
+
+				MotionSample sample;
+				sample.animation = desc.animations[sampleDesc.animationIndex];
+				sample.binding = _skeleton->GetAnimationBinding(sample.animation);
+				sample.position = sampleDesc.position;
+
+				state.samples.push_back(sample);
+
+				if (state.motionType == AnimatorMotionType::Clip) {
+					break;
+				}
+			}
+
+			if (state.motionType == AnimatorMotionType::BlendSpace1D) {
+				std::sort(state.samples.begin(), state.samples.end(), [](const MotionSample& a, const MotionSample& b) { return a.position.x < b.position.x; });
+			}
+		}
+
+		for (auto& transition : _transitions) {
+			for (auto& condition : transition.conditions) {
+				condition.parameterIndex = ValidateParameterIndex(condition.parameterIndex, _parameters.size());
+			}
+		}
+
+		// any state transitions are checked first
+		for (int32_t i = 0; i < static_cast<int32_t>(_transitions.size()); ++i) {
+			const auto& transition = _transitions[i];
+			if (transition.toStateIndex < 0 || transition.toStateIndex >= static_cast<int32_t>(_states.size())) {
+				Log::Error("Animator: Transition %d has an invalid target state", i);
+				continue;
+			}
+
+			if (transition.fromStateIndex == -1) {
+				for (auto& state : _states) {
+					state.transitionIndices.push_back(i);
+				}
+			}
+		}
+
+		for (int32_t i = 0; i < static_cast<int32_t>(_transitions.size()); ++i) {
+			const auto& transition = _transitions[i];
+			if (transition.toStateIndex < 0 || transition.toStateIndex >= static_cast<int32_t>(_states.size())) {
+				continue;
+			}
+
+			if (transition.fromStateIndex >= 0 && transition.fromStateIndex < static_cast<int32_t>(_states.size())) {
+				_states[transition.fromStateIndex].transitionIndices.push_back(i);
+			}
+		}
+
+		if (_defaultStateIndex < 0 || _defaultStateIndex >= static_cast<int32_t>(_states.size())) {
+			_defaultStateIndex = _states.empty() ? -1 : 0;
+		}
 	}
 
-	void AnimatorAnimation2D::GetAnimationMatrices(Ref<Skeleton> skeleton, float time, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) {
-		const float normalizedTime = glm::clamp(time / GetDuration(), 0.f, 1.f);
-		skeleton->GetBlendedAnimatedBoneAndSkinMatrices(_animation0, _animation1, normalizedTime, _blendFactor, animatedBoneMatrices, animatedSkinMatrices);
+	int32_t Animator::GetStateIndex(const std::string& name) const {
+		for (int32_t i = 0; i < static_cast<int32_t>(_states.size()); ++i) {
+			if (_states[i].name == name) {
+				return i;
+			}
+		}
+		return -1;
 	}
 
-	float AnimatorAnimation2D::GetDuration() const {
-		return std::max(_animation0->GetDurationSec(), _animation1->GetDurationSec());
+	int32_t Animator::GetParameterIndex(const std::string& name) const {
+		for (int32_t i = 0; i < static_cast<int32_t>(_parameters.size()); ++i) {
+			if (_parameters[i].name == name) {
+				return i;
+			}
+		}
+		return -1;
 	}
 
-	bool AnimatorTransition::CanTransition() const {
-		return _condition && _condition();
+	static float GetParameter(const float* parameters, int32_t index) {
+		return index == -1 ? 0.0f : parameters[index];
 	}
 
-	void AnimatorTransition::GetAnimationMatrices(float time, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) {
-		Ref<Skeleton> _skeleton = _animator.GetSkeleton();
-		Ref<AnimatorState> fromState = _animator.GetAnimatorState(_fromStateIndex);
-		Ref<AnimatorState> toState = _animator.GetAnimatorState(_toStateIndex);
+	void Animator::GetMotionWeights(int32_t stateIndex, const float* parameters, AnimatorMotionWeights& outWeights) const {
+		const auto& state = _states[stateIndex];
 
-		std::vector<mat4> fromBoneMatrices;
-		std::vector<mat4> fromSkinMatrices;
-		fromState->GetAnimation()->GetAnimationMatrices(_skeleton, 1.f, fromBoneMatrices, fromSkinMatrices);
+		outWeights.count = 0;
 
-		std::vector<mat4> toBoneMatrices;
-		std::vector<mat4> toSkinMatrices;
-		toState->GetAnimation()->GetAnimationMatrices(_skeleton, 0.f, toBoneMatrices, toSkinMatrices);
+		if (state.samples.empty()) {
+			return;
+		}
 
-		const float normalizedTime = glm::clamp(time / _duration, 0.f, 1.f);
+		auto add = [&outWeights](int32_t sampleIndex, float weight) {
+			outWeights.sampleIndices[outWeights.count] = sampleIndex;
+			outWeights.weights[outWeights.count] = weight;
+			outWeights.count++;
+		};
 
-		animatedBoneMatrices.resize(fromBoneMatrices.size());
-		animatedSkinMatrices.resize(fromSkinMatrices.size());
-		for (size_t i = 0; i < fromBoneMatrices.size(); ++i) {
-			vec3 positionFrom, positionTo;
-			quat rotationFrom, rotationTo;
-			vec3 scaleFrom, scaleTo;
+		if (state.motionType == AnimatorMotionType::Clip || state.samples.size() == 1) {
+			add(0, 1.0f);
+			return;
+		}
 
-			ExtractModelMatrix(fromBoneMatrices[i], positionFrom, rotationFrom, scaleFrom);
-			ExtractModelMatrix(toBoneMatrices[i], positionTo, rotationTo, scaleTo);
+		if (state.motionType == AnimatorMotionType::BlendSpace1D) {
+			const float x = GetParameter(parameters, state.parameterX);
+			const int32_t lastIndex = static_cast<int32_t>(state.samples.size()) - 1;
 
-			vec3 finalPosition = glm::mix(positionFrom, positionTo, normalizedTime);
-			quat finalRotation = normalize(slerp(rotationFrom, rotationTo, normalizedTime));
-			vec3 finalScale = glm::mix(scaleFrom, scaleTo, normalizedTime);
+			if (x <= state.samples[0].position.x) {
+				add(0, 1.0f);
+				return;
+			}
 
-			animatedBoneMatrices[i] = ModelMatrix(finalPosition, finalRotation, finalScale);
+			if (x >= state.samples[lastIndex].position.x) {
+				add(lastIndex, 1.0f);
+				return;
+			}
 
-			ExtractModelMatrix(fromSkinMatrices[i], positionFrom, rotationFrom, scaleFrom);
-			ExtractModelMatrix(toSkinMatrices[i], positionTo, rotationTo, scaleTo);
+			int32_t right = 1;
+			while (state.samples[right].position.x < x) {
+				right++;
+			}
 
-			finalPosition = glm::mix(positionFrom, positionTo, normalizedTime);
-			finalRotation = normalize(slerp(rotationFrom, rotationTo, normalizedTime));
-			finalScale = glm::mix(scaleFrom, scaleTo, normalizedTime);
+			const float left = state.samples[right - 1].position.x;
+			const float range = state.samples[right].position.x - left;
+			const float factor = range > 0.0f ? (x - left) / range : 0.0f;
 
-			animatedSkinMatrices[i] = ModelMatrix(finalPosition, finalRotation, finalScale);
+			add(right - 1, 1.0f - factor);
+			add(right, factor);
+			return;
+		}
+
+		// 2d, inverse squared distance over the closest samples
+		const vec2 point(GetParameter(parameters, state.parameterX), GetParameter(parameters, state.parameterY));
+
+		int32_t closest[AnimatorMotionWeights::MaxCount];
+		float closestDistances[AnimatorMotionWeights::MaxCount];
+		int32_t closestCount = 0;
+
+		for (int32_t i = 0; i < static_cast<int32_t>(state.samples.size()); ++i) {
+			const vec2 diff = state.samples[i].position - point;
+			const float distance = dot(diff, diff);
+
+			if (distance < 1e-6f) {
+				add(i, 1.0f);
+				return;
+			}
+
+			// insertion into the short sorted list
+			int32_t insertAt = closestCount;
+			while (insertAt > 0 && closestDistances[insertAt - 1] > distance) {
+				insertAt--;
+			}
+
+			if (insertAt >= AnimatorMotionWeights::MaxCount) {
+				continue;
+			}
+
+			const int32_t last = std::min(closestCount, AnimatorMotionWeights::MaxCount - 1);
+			for (int32_t j = last; j > insertAt; --j) {
+				closest[j] = closest[j - 1];
+				closestDistances[j] = closestDistances[j - 1];
+			}
+
+			closest[insertAt] = i;
+			closestDistances[insertAt] = distance;
+			closestCount = std::min(closestCount + 1, AnimatorMotionWeights::MaxCount);
+		}
+
+		float weightSum = 0.0f;
+		for (int32_t i = 0; i < closestCount; ++i) {
+			weightSum += 1.0f / closestDistances[i];
+		}
+
+		for (int32_t i = 0; i < closestCount; ++i) {
+			add(closest[i], (1.0f / closestDistances[i]) / weightSum);
 		}
 	}
-	
-	Animator::Animator(const Animator::Descriptor& desc)
-		: _skeleton(desc.skeleton)
-		, _states(desc.states)
-		, _transitions(desc.transitions)
-		, _defaultStateIndex(desc.defaultStateIndex)
-	{	
+
+	float Animator::GetStateDuration(int32_t stateIndex, const AnimatorMotionWeights& weights) const {
+		const auto& state = _states[stateIndex];
+
+		float duration = 0.0f;
+		for (int32_t i = 0; i < weights.count; ++i) {
+			duration += state.samples[weights.sampleIndices[i]].animation->GetDurationSec() * weights.weights[i];
+		}
+
+		return state.speed > 0.0f ? duration / state.speed : 0.0f;
+	}
+
+	void Animator::SampleState(int32_t stateIndex, const AnimatorMotionWeights& weights, float normalizedTime, std::vector<SkeletalAnimationCursor>& cursors, SkeletonPose& outPose, SkeletonPose& tempPose, int32_t maxNodeDepth) const {
+		const auto& state = _states[stateIndex];
+
+		cursors.resize(state.samples.size());
+
+		if (weights.count == 0) {
+			outPose = _skeleton->GetBindingPose();
+			return;
+		}
+
+		// samples play in sync, each one at the same normalized time
+		float accumulatedWeight = 0.0f;
+		for (int32_t i = 0; i < weights.count; ++i) {
+			const int32_t sampleIndex = weights.sampleIndices[i];
+			const auto& sample = state.samples[sampleIndex];
+			const float timeSec = sample.animation->GetDurationSec() * normalizedTime;
+
+			SkeletonPose& target = i == 0 ? outPose : tempPose;
+			SamplePose(*_skeleton, *sample.animation, *sample.binding, timeSec, &cursors[sampleIndex], target, maxNodeDepth);
+
+			accumulatedWeight += weights.weights[i];
+			if (i > 0 && accumulatedWeight > 0.0f) {
+				BlendPoses(outPose, tempPose, weights.weights[i] / accumulatedWeight, outPose);
+			}
+		}
 	}
 
-	AnimatorRuntime::AnimatorRuntime(Animator& animator) 
+	AnimatorRuntime::AnimatorRuntime(Ref<Animator> animator)
 		: _animator(animator)
 		, _currentStateIndex(-1)
-		, _currentTransitionIndex(-1)
 		, _currentTime(0.0f)
+		, _currentTransitionIndex(-1)
+		, _nextStateIndex(-1)
+		, _nextTime(0.0f)
+		, _transitionTime(0.0f)
 	{
-		_currentStateIndex = animator._defaultStateIndex;
+		_parameters.reserve(animator->GetParameters().size());
+		for (const auto& parameter : animator->GetParameters()) {
+			_parameters.push_back(parameter.defaultValue);
+		}
+
+		_stateCursors.resize(animator->GetStateCount());
+
+		SetToDefaultState();
 	}
 
 	void AnimatorRuntime::SetToDefaultState() {
-		_currentStateIndex = _animator._defaultStateIndex;
-		_currentTransitionIndex = -1;
+		_currentStateIndex = _animator->GetDefaultStateIndex();
 		_currentTime = 0.0f;
+		_currentTransitionIndex = -1;
 	}
 
 	void AnimatorRuntime::PlayState(int32_t stateIndex) {
-		if (stateIndex < 0 || stateIndex >= _animator._states.size()) {
+		if (stateIndex < 0 || stateIndex >= _animator->GetStateCount()) {
 			Log::Error("AnimatorRuntime::PlayState: Invalid state index %d", stateIndex);
 			return;
 		}
 
 		_currentStateIndex = stateIndex;
-		_currentTransitionIndex = -1;
 		_currentTime = 0.0f;
+		_currentTransitionIndex = -1;
+	}
+
+	void AnimatorRuntime::SetFloat(int32_t parameterIndex, float value) {
+		if (parameterIndex < 0 || parameterIndex >= static_cast<int32_t>(_parameters.size())) {
+			Log::Error("AnimatorRuntime::SetFloat: Invalid parameter index %d", parameterIndex);
+			return;
+		}
+
+		_parameters[parameterIndex] = value;
+	}
+
+	float AnimatorRuntime::GetFloat(int32_t parameterIndex) const {
+		if (parameterIndex < 0 || parameterIndex >= static_cast<int32_t>(_parameters.size())) {
+			Log::Error("AnimatorRuntime::GetFloat: Invalid parameter index %d", parameterIndex);
+			return 0.0f;
+		}
+
+		return _parameters[parameterIndex];
 	}
 
 	void AnimatorRuntime::Update(float deltaTime, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) {
-		if (IsInTransition()) {
-			UpdateTransition(deltaTime, animatedBoneMatrices, animatedSkinMatrices);
+		Sample(deltaTime);
+		Evaluate(1.0f, animatedBoneMatrices, animatedSkinMatrices);
+	}
+
+	void AnimatorRuntime::SampleState(int32_t stateIndex, float normalizedTime, SkeletonPose& outPose, int32_t maxNodeDepth) {
+		const float stateTime = _animator->IsStateLooping(stateIndex) ? normalizedTime - std::floor(normalizedTime) : std::min(normalizedTime, 1.0f);
+
+		AnimatorMotionWeights weights;
+		_animator->GetMotionWeights(stateIndex, _parameters.data(), weights);
+		_animator->SampleState(stateIndex, weights, stateTime, _stateCursors[stateIndex], outPose, _scratch.tempPose, maxNodeDepth);
+	}
+
+	float AnimatorRuntime::AdvanceStateTime(int32_t stateIndex, float normalizedTime, float deltaTime) const {
+		AnimatorMotionWeights weights;
+		_animator->GetMotionWeights(stateIndex, _parameters.data(), weights);
+
+		const float duration = _animator->GetStateDuration(stateIndex, weights);
+		if (duration <= 0.0f) {
+			return normalizedTime;
 		}
-		else {
-			UpdateState(deltaTime, animatedBoneMatrices, animatedSkinMatrices);
+
+		normalizedTime += deltaTime / duration;
+		if (!_animator->IsStateLooping(stateIndex)) {
+			return std::min(normalizedTime, 1.0f);
+		}
+
+		// later loops fold into the second one so the time keeps its precision
+		if (normalizedTime >= 2.0f) {
+			normalizedTime -= std::floor(normalizedTime) - 1.0f;
 		}
+
+		return normalizedTime;
 	}
 
-	void AnimatorRuntime::UpdateTransition(float deltaTime, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) {
-		if (_currentTransitionIndex == -1) {
+	void AnimatorRuntime::Sample(float deltaTime, int32_t maxNodeDepth, bool interpolate) {
+		if (_currentStateIndex == -1) {
 			return;
 		}
 
-		Ref<AnimatorTransition> transition = _animator._transitions[_currentTransitionIndex];
+		std::swap(_scratch.pose, _scratch.previousPose);
 
-		transition->GetAnimationMatrices(_currentTime, animatedBoneMatrices, animatedSkinMatrices);
+		// sample then advance, the first sample of a state is at its start
+		if (IsInTransition()) {
+			const auto& transition = _animator->GetTransitions()[_currentTransitionIndex];
+			const float factor = transition.duration > 0.0f ? glm::clamp(_transitionTime / transition.duration, 0.0f, 1.0f) : 1.0f;
 
-		_currentTime += deltaTime;
-		if (_currentTime >= transition->GetDuration()) {
-			_currentTransitionIndex = -1;
-			_currentStateIndex = transition->GetToStateIndex();
-			_currentTime = 0.0f;
+			SampleState(_currentStateIndex, _currentTime, _scratch.fromPose, maxNodeDepth);
+			SampleState(_nextStateIndex, _nextTime, _scratch.toPose, maxNodeDepth);
+			BlendPoses(_scratch.fromPose, _scratch.toPose, factor, _scratch.pose);
+		}
+		else {
+			SampleState(_currentStateIndex, _currentTime, _scratch.pose, maxNodeDepth);
+		}
+
+		Advance(deltaTime);
+
+		// nothing to interpolate from on the first sample
+		if (!interpolate || _scratch.previousPose.GetNodeCount() != _scratch.pose.GetNodeCount()) {
+			_scratch.previousPose = _scratch.pose;
 		}
 	}
 
-	void AnimatorRuntime::UpdateState(float deltaTime, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) {
+	void AnimatorRuntime::Advance(float deltaTime) {
 		if (_currentStateIndex == -1) {
 			return;
 		}
 
-		Ref<AnimatorState> currentState = _animator._states[_currentStateIndex];
+		if (IsInTransition()) {
+			const auto& transition = _animator->GetTransitions()[_currentTransitionIndex];
+
+			_currentTime = AdvanceStateTime(_currentStateIndex, _currentTime, deltaTime);
+			_nextTime = AdvanceStateTime(_nextStateIndex, _nextTime, deltaTime);
+			_transitionTime += deltaTime;
 
-		currentState->GetAnimation()->GetAnimationMatrices(_animator._skeleton, _currentTime, animatedBoneMatrices, animatedSkinMatrices);
-		
-		_currentTime += deltaTime;
-		if (currentState->IsLooping() && _currentTime >= currentState->GetAnimation()->GetDuration()) {
-			_currentTime = 0.0f;
+			if (_transitionTime >= transition.duration) {
+				_currentStateIndex = _nextStateIndex;
+				_currentTime = _nextTime;
+				_currentTransitionIndex = -1;
+			}
+		}
+		else {
+			_currentTime = AdvanceStateTime(_currentStateIndex, _currentTime, deltaTime);
+
+			CheckTransitions();
+		}
+	}
+
+	bool AnimatorRuntime::GetCrowdSample(float timeStep, AnimatorCrowdSample& outSample) const {
+		if (_currentStateIndex == -1 || IsInTransition() || !_animator->IsStateSingleClip(_currentStateIndex) || timeStep <= 0.0f) {
+			return false;
+		}
+
+		AnimatorMotionWeights weights;
+		_animator->GetMotionWeights(_currentStateIndex, _parameters.data(), weights);
+
+		const float duration = _animator->GetStateDuration(_currentStateIndex, weights);
+		if (duration <= 0.0f) {
+			return false;
 		}
 
-		if (!currentState->HasTransition()) {
+		// same folding as SampleState, the second loop samples like the first
+		const float stateTime = _animator->IsStateLooping(_currentStateIndex) ? _currentTime - std::floor(_currentTime) : std::min(_currentTime, 1.0f);
+
+		outSample.stateIndex = _currentStateIndex;
+		outSample.timeBucket = static_cast<int32_t>(stateTime * duration / timeStep);
+		outSample.normalizedTime = std::min(outSample.timeBucket * timeStep / duration, 1.0f);
+
+		return true;
+	}
+
+	void AnimatorRuntime::Evaluate(float keyFactor, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) {
+		if (_scratch.pose.GetNodeCount() == 0) {
 			return;
 		}
 
-		Ref<AnimatorTransition> transition = _animator._transitions[currentState->GetTransitionIndex()];
-		if (!transition->CanTransition()) {
+		// the temp pose is only used while sampling
+		const SkeletonPose* pose = &_scratch.pose;
+		if (keyFactor < 1.0f) {
+			BlendPoses(_scratch.previousPose, _scratch.pose, keyFactor, _scratch.tempPose);
+			pose = &_scratch.tempPose;
+		}
+
+		const Skeleton& skeleton = *_animator->GetSkeleton();
+		ComputeModelMatrices(skeleton, *pose, _scratch.modelMatrices);
+		ComputeBoneAndSkinMatrices(skeleton, _scratch.modelMatrices, &animatedBoneMatrices, &animatedSkinMatrices);
+	}
+
+	bool AnimatorRuntime::CanTransition(const AnimatorTransitionDesc& transition) const {
+		if (transition.fromStateIndex == -1 && transition.toStateIndex == _currentStateIndex) {
+			return false;
+		}
+
+		if (transition.exitTime >= 0.0f && _currentTime < transition.exitTime) {
+			return false;
+		}
+
+		// a transition with neither exit time nor conditions would fire immediately, it is never taken
+		if (transition.exitTime < 0.0f && transition.conditions.empty()) {
+			return false;
+		}
+
+		for (const auto& condition : transition.conditions) {
+			const float value = GetParameter(_parameters.data(), condition.parameterIndex);
+
+			bool passed = false;
+			switch (condition.mode) {
+			case AnimatorConditionMode::Greater: passed = value > condition.threshold; break;
+			case AnimatorConditionMode::Less: passed = value < condition.threshold; break;
+			case AnimatorConditionMode::Equal: passed = value == condition.threshold; break;
+			case AnimatorConditionMode::NotEqual: passed = value != condition.threshold; break;
+			case AnimatorConditionMode::If: passed = value != 0.0f; break;
+			case AnimatorConditionMode::IfNot: passed = value == 0.0f; break;
+			}
+
+			if (!passed) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void AnimatorRuntime::CheckTransitions() {
+		const auto& transitions = _animator->GetTransitions();
+
+		for (int32_t transitionIndex : _animator->GetStateTransitionIndices(_currentStateIndex)) {
+			if (CanTransition(transitions[transitionIndex])) {
+				StartTransition(transitionIndex);
+				return;
+			}
+		}
+	}
+
+	void AnimatorRuntime::StartTransition(int32_t transitionIndex) {
+		const auto& transition = _animator->GetTransitions()[transitionIndex];
+		const auto& parameters = _animator->GetParameters();
+
+		// triggers are consumed by the transition that used them
+		for (const auto& condition : transition.conditions) {
+			if (condition.parameterIndex != -1 && parameters[condition.parameterIndex].type == AnimatorParameterType::Trigger) {
+				_parameters[condition.parameterIndex] = 0.0f;
+			}
+		}
+
+		if (transition.duration <= 0.0f) {
+			_currentStateIndex = transition.toStateIndex;
+			_currentTime = 0.0f;
 			return;
 		}
 
-		_currentTransitionIndex = currentState->GetTransitionIndex();
-		_currentStateIndex = -1;
-		_currentTime = 0.0f;
+		_currentTransitionIndex = transitionIndex;
+		_nextStateIndex = transition.toStateIndex;
+		_nextTime = 0.0f;
+		_transitionTime = 0.0f;
 	}
-}
\ No newline at end of file
+}
@@ -1,144 +1,333 @@
 #pragma once
 
 #include "Core.h"
+#include "Asset.h"
 #include "Skeleton.h"
 
-#include <unordered_map>
-
 namespace flaw {
-	class Animator;
+	// graph description, this is what animator assets store
 
-	class AnimatorAnimation {
-	public:
-		virtual ~AnimatorAnimation() = default;
+	enum class AnimatorParameterType : uint8_t {
+		Float,
+		Int,
+		Bool,
+		Trigger, // bool that is reset once a transition consumes it
+	};
 
-		virtual void GetAnimationMatrices(Ref<Skeleton> skeleton, float time, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) = 0;
-		virtual float GetDuration() const = 0;
+	struct AnimatorParameterDesc {
+		std::string name;
+		AnimatorParameterType type = AnimatorParameterType::Float;
+		float defaultValue = 0.0f; // every type is stored as a float, bools are 0 or 1
 	};
 
-	class AnimatorAnimation1D : public AnimatorAnimation {
-	public:
-		AnimatorAnimation1D(Ref<SkeletalAnimation> animation) : _animation(animation) {}
-		virtual ~AnimatorAnimation1D() = default;
+	enum class AnimatorConditionMode : uint8_t {
+		Greater,
+		Less,
+		Equal,
+		NotEqual,
+		If,		// bool or trigger is set
+		IfNot,	// bool or trigger is not set
+	};
 
-		void GetAnimationMatrices(Ref<Skeleton> skeleton, float time, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) override;
-		float GetDuration() const override;
+	struct AnimatorConditionDesc {
+		int32_t parameterIndex = -1;
+		AnimatorConditionMode mode = AnimatorConditionMode::If;
+		float threshold = 0.0f;
+	};
 
-	private:
-		Ref<SkeletalAnimation> _animation;
+	enum class AnimatorMotionType : uint8_t {
+		Clip,
+		BlendSpace1D,
+		BlendSpace2D,
 	};
 
-	class AnimatorAnimation2D : public AnimatorAnimation {
-	public:
-		AnimatorAnimation2D(Ref<SkeletalAnimation> animation0, Ref<SkeletalAnimation> animation1) 
-			: _animation0(animation0)
-			, _animation1(animation1)
-			, _blendFactor(0.5f) 
-		{
-		}
+	struct AnimatorMotionSampleDesc {
+		int32_t animationIndex = -1;	// index in the graph animations
+		vec2 position = vec2(0.0f);		// position in the blend space, 1d spaces only use x
+	};
 
-		virtual ~AnimatorAnimation2D() = default;
+	struct AnimatorStateDesc {
+		std::string name;
+		AnimatorMotionType motionType = AnimatorMotionType::Clip;
+		std::vector<AnimatorMotionSampleDesc> samples; // clips only use the first one
+		int32_t parameterX = -1;
+		int32_t parameterY = -1;
+		float speed = 1.0f;
+		bool loop = true;
+	};
 
-		void GetAnimationMatrices(Ref<Skeleton> skeleton, float time, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices) override;
-		float GetDuration() const override;
+	struct AnimatorTransitionDesc {
+		int32_t fromStateIndex = -1;	// -1 for any state
+		int32_t toStateIndex = -1;
+		float duration = 0.2f;			// cross fade in seconds
+		float exitTime = -1.0f;			// normalized time since the source state was entered, below 2 for looping states, negative for none
+		std::vector<AnimatorConditionDesc> conditions; // all of them have to pass
+	};
 
-		void SetBlendFactor(float factor) { _blendFactor = glm::clamp(factor, 0.0f, 1.0f); }
+	struct AnimatorGraphDesc {
+		std::vector<AssetHandle> animations;
+		std::vector<AnimatorParameterDesc> parameters;
+		std::vector<AnimatorStateDesc> states;
+		std::vector<AnimatorTransitionDesc> transitions;
+		int32_t defaultStateIndex = 0;
+	};
 
-	private:
-		Ref<SkeletalAnimation> _animation0, _animation1;
+	template<>
+	struct Serializer<AnimatorParameterDesc> {
+		static void Serialize(SerializationArchive& archive, const AnimatorParameterDesc& value) {
+			archive << value.name;
+			archive << value.type;
+			archive << value.defaultValue;
+		}
 
-		float _blendFactor;
+		static void Deserialize(SerializationArchive& archive, AnimatorParameterDesc& value) {
+			archive >> value.name;
+			archive >> value.type;
+			archive >> value.defaultValue;
+		}
 	};
 
-	class AnimatorTransition {
-	public:
-		AnimatorTransition(Animator& animator) : _animator(animator) {}
+	template<>
+	struct Serializer<AnimatorConditionDesc> {
+		static void Serialize(SerializationArchive& archive, const AnimatorConditionDesc& value) {
+			archive << value.parameterIndex;
+			archive << value.mode;
+			archive << value.threshold;
+		}
 
-		bool CanTransition() const;
+		static void Deserialize(SerializationArchive& archive, AnimatorConditionDesc& value) {
+			archive >> value.parameterIndex;
+			archive >> value.mode;
+			archive >> value.threshold;
+		}
+	};
 
-		void GetAnimationMatrices(float time, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices);
+	template<>
+	struct Serializer<AnimatorMotionSampleDesc> {
+		static void Serialize(SerializationArchive& archive, const AnimatorMotionSampleDesc& value) {
+			archive << value.animationIndex;
+			archive << value.position;
+		}
 
-		float GetDuration() const { return _duration; }
+		static void Deserialize(SerializationArchive& archive, AnimatorMotionSampleDesc& value) {
+			archive >> value.animationIndex;
+			archive >> value.position;
+		}
+	};
 
-		int32_t GetFromStateIndex() const { return _fromStateIndex; }
-		int32_t GetToStateIndex() const { return _toStateIndex; }
+	template<>
+	struct Serializer<AnimatorStateDesc> {
+		static void Serialize(SerializationArchive& archive, const AnimatorStateDesc& value) {
+			archive << value.name;
+			archive << value.motionType;
+			archive << value.samples;
+			archive << value.parameterX;
+			archive << value.parameterY;
+			archive << value.speed;
+			archive << value.loop;
+		}
 
-	private:
-		Animator& _animator;
+		static void Deserialize(SerializationArchive& archive, AnimatorStateDesc& value) {
+			archive >> value.name;
+			archive >> value.motionType;
+			archive >> value.samples;
+			archive >> value.parameterX;
+			archive >> value.parameterY;
+			archive >> value.speed;
+			archive >> value.loop;
+		}
+	};
 
-		std::function<bool()> _condition;
-		int32_t _fromStateIndex = -1;
-		int32_t _toStateIndex = -1;
+	template<>
+	struct Serializer<AnimatorTransitionDesc> {
+		static void Serialize(SerializationArchive& archive, const AnimatorTransitionDesc& value) {
+			archive << value.fromStateIndex;
+			archive << value.toStateIndex;
+			archive << value.duration;
+			archive << value.exitTime;
+			archive << value.conditions;
+		}
 
-		float _duration = 0.0f;
+		static void Deserialize(SerializationArchive& archive, AnimatorTransitionDesc& value) {
+			archive >> value.fromStateIndex;
+			archive >> value.toStateIndex;
+			archive >> value.duration;
+			archive >> value.exitTime;
+			archive >> value.conditions;
+		}
 	};
 
-	class AnimatorState {
-	public:
-		void SetAnimation(Ref<AnimatorAnimation> animation) { _animation = animation; }
-		Ref<AnimatorAnimation> GetAnimation() const { return _animation; }
+	template<>
+	struct Serializer<AnimatorGraphDesc> {
+		static void Serialize(SerializationArchive& archive, const AnimatorGraphDesc& value) {
+			archive << value.animations;
+			archive << value.parameters;
+			archive << value.states;
+			archive << value.transitions;
+			archive << value.defaultStateIndex;
+		}
 
-		void SetLoop(bool loop) { _loop = loop; }
-		bool IsLooping() const { return _loop; }
+		static void Deserialize(SerializationArchive& archive, AnimatorGraphDesc& value) {
+			archive >> value.animations;
+			archive >> value.parameters;
+			archive >> value.states;
+			archive >> value.transitions;
+			archive >> value.defaultStateIndex;
+		}
+	};
 
-		bool HasTransition() const { return _transitionIndex != -1; }
-		int32_t GetTransitionIndex() const { return _transitionIndex; }
+	// samples of a state that contribute to its pose, a 2d blend space uses at most the three closest samples
+	struct AnimatorMotionWeights {
+		static constexpr int32_t MaxCount = 3;
 
-	private:
-		Ref<AnimatorAnimation> _animation;
-		bool _loop = false;
-		int32_t _transitionIndex = -1;
+		int32_t count = 0;
+		int32_t sampleIndices[MaxCount];
+		float weights[MaxCount];
 	};
 
+	// single clip a runtime is playing, runtimes with the same state and time bucket sample the same pose
+	struct AnimatorCrowdSample {
+		int32_t stateIndex = -1;
+		int32_t timeBucket = 0;
+		float normalizedTime = 0.0f; // start of the bucket
+	};
+
+	// buffers an AnimatorRuntime reuses every update
+	struct AnimatorPoseScratch {
+		SkeletonPose pose;
+		SkeletonPose previousPose;
+		SkeletonPose fromPose;
+		SkeletonPose toPose;
+		SkeletonPose tempPose;
+
+		std::vector<mat4> modelMatrices;
+	};
+
+	// immutable once built, every entity playing the same graph shares one
 	class Animator {
 	public:
 		struct Descriptor {
 			Ref<Skeleton> skeleton;
-			std::vector<Ref<AnimatorState>> states;
-			std::vector<Ref<AnimatorTransition>> transitions;
-			int32_t defaultStateIndex = 0;
+			AnimatorGraphDesc graph;
+			std::vector<Ref<SkeletalAnimation>> animations; // resolved graph animations, same order
 		};
 
 		Animator(const Descriptor& desc);
 
-		void SetSkeleton(Ref<Skeleton> skeleton) { _skeleton = skeleton; }
 		Ref<Skeleton> GetSkeleton() const { return _skeleton; }
 
-		Ref<AnimatorState> GetAnimatorState(int32_t index) const { return _states[index]; }
+		int32_t GetStateCount() const { return static_cast<int32_t>(_states.size()); }
+		int32_t GetDefaultStateIndex() const { return _defaultStateIndex; }
+		int32_t GetStateIndex(const std::string& name) const;
+
+		const std::vector<AnimatorParameterDesc>& GetParameters() const { return _parameters; }
+		int32_t GetParameterIndex(const std::string& name) const;
+
+		const std::vector<AnimatorTransitionDesc>& GetTransitions() const { return _transitions; }
+
+		// transitions to check while the state plays, any state transitions come first
+		const std::vector<int32_t>& GetStateTransitionIndices(int32_t stateIndex) const { return _states[stateIndex].transitionIndices; }
+
+		bool IsStateLooping(int32_t stateIndex) const { return _states[stateIndex].loop; }
+
+		// the pose of the state only depends on its time, no parameter is involved
+		bool IsStateSingleClip(int32_t stateIndex) const { return _states[stateIndex].motionType == AnimatorMotionType::Clip || _states[stateIndex].samples.size() <= 1; }
+
+		void GetMotionWeights(int32_t stateIndex, const float* parameters, AnimatorMotionWeights& outWeights) const;
+
+		// seconds one loop of the state takes with the given weights, speed included
+		float GetStateDuration(int32_t stateIndex, const AnimatorMotionWeights& weights) const;
+
+		// cursors belong to the runtime playing the state, tempPose is scratch space for blending
+		// nodes deeper than maxNodeDepth keep the binding pose, -1 samples every node
+		void SampleState(int32_t stateIndex, const AnimatorMotionWeights& weights, float normalizedTime, std::vector<SkeletalAnimationCursor>& cursors, SkeletonPose& outPose, SkeletonPose& tempPose, int32_t maxNodeDepth = -1) const;
 
 	private:
-		friend class AnimatorRuntime;
+		struct MotionSample {
+			Ref<SkeletalAnimation> animation;
+			Ref<SkeletalAnimationBinding> binding;
+			vec2 position;
+		};
+
+		struct State {
+			std::string name;
+			AnimatorMotionType motionType;
+			std::vector<MotionSample> samples; // 1d blend spaces are sorted by position
+			int32_t parameterX;
+			int32_t parameterY;
+			float speed;
+			bool loop;
+
+			std::vector<int32_t> transitionIndices;
+		};
 
 		Ref<Skeleton> _skeleton;
 
-		std::vector<Ref<AnimatorState>> _states;
-		std::vector<Ref<AnimatorTransition>> _transitions;
+		std::vector<AnimatorParameterDesc> _parameters;
+		std::vector<State> _states;
+		std::vector<AnimatorTransitionDesc> _transitions;
 
 		int32_t _defaultStateIndex;
 	};
 
+	// per entity playback state of a shared Animator, only the playing states are sampled
 	class AnimatorRuntime {
 	public:
-		AnimatorRuntime() = default;
-		AnimatorRuntime(Animator& animator);
+		AnimatorRuntime(Ref<Animator> animator);
 
 		void SetToDefaultState();
 		void PlayState(int32_t stateIndex);
 
+		// parameters are set by index, look it up once with GetParameterIndex
+		int32_t GetParameterIndex(const std::string& name) const { return _animator->GetParameterIndex(name); }
+		void SetFloat(int32_t parameterIndex, float value);
+		void SetInt(int32_t parameterIndex, int32_t value) { SetFloat(parameterIndex, static_cast<float>(value)); }
+		void SetBool(int32_t parameterIndex, bool value) { SetFloat(parameterIndex, value ? 1.0f : 0.0f); }
+		void SetTrigger(int32_t parameterIndex) { SetFloat(parameterIndex, 1.0f); }
+		float GetFloat(int32_t parameterIndex) const;
+
+		// samples and evaluates at full detail
 		void Update(float deltaTime, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices);
 
+		// samples a new key pose and advances the animator, the last key pose becomes the previous one unless interpolate is false
+		void Sample(float deltaTime, int32_t maxNodeDepth = -1, bool interpolate = true);
+
+		// outputs the previous key pose blended toward the last key pose, keyFactor 1 outputs the last key pose as is
+		void Evaluate(float keyFactor, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices);
+
+		// advances time and transitions without sampling, for runtimes whose pose comes from elsewhere
+		void Advance(float deltaTime);
+
+		// false while blending, in a transition or in a blend space state, timeStep is the bucket size in seconds
+		bool GetCrowdSample(float timeStep, AnimatorCrowdSample& outSample) const;
+
+		const Ref<Animator>& GetAnimator() const { return _animator; }
+
 		bool IsInTransition() const { return _currentTransitionIndex != -1; }
+		int32_t GetCurrentStateIndex() const { return _currentStateIndex; } // the source state while in a transition
 
 	private:
-		void UpdateTransition(float deltaTime, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices);
-		void UpdateState(float deltaTime, std::vector<mat4>& animatedBoneMatrices, std::vector<mat4>& animatedSkinMatrices);
+		void SampleState(int32_t stateIndex, float normalizedTime, SkeletonPose& outPose, int32_t maxNodeDepth);
+		float AdvanceStateTime(int32_t stateIndex, float normalizedTime, float deltaTime) const;
+
+		bool CanTransition(const AnimatorTransitionDesc& transition) const;
+		void CheckTransitions();
+		void StartTransition(int32_t transitionIndex);
 
 	private:
-		Animator& _animator;
+		Ref<Animator> _animator;
+
+		std::vector<float> _parameters;
 
 		int32_t _currentStateIndex;
+		float _currentTime; // normalized, counts loops
+
 		int32_t _currentTransitionIndex;
+		int32_t _nextStateIndex;
+		float _nextTime;
+		float _transitionTime; // seconds
 
-		float _currentTime;
+		std::vector<std::vector<SkeletalAnimationCursor>> _stateCursors; // state index -> cursors of its samples
+		AnimatorPoseScratch _scratch;
 	};
-}
\ No newline at end of file
+}
@@ -17,8 +17,14 @@
 #include "Physics.h"
 
 namespace flaw {
+	// one worker per core besides the main thread, hardware_concurrency may report 0 when it can not tell
+	static int32_t GetJobWorkerCount() {
+		const int32_t hardwareThreads = static_cast<int32_t>(std::thread::hardware_concurrency());
+		return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
 	Application::Application(const ApplicationProps& props) 
-		: _threadPool(4)
+		: _jobSystem(GetJobWorkerCount())
 	{
 		FLAW_PROFILE_FUNCTION();
 
@@ -33,7 +39,7 @@ namespace flaw {
 		}
 
 		Platform::Init(props.title, props.width, props.height, _eventDispatcher);
-		Graphics::Init(GraphicsType::DX11);
+		Graphics::Init(props.graphicsType);
 		Renderer2D::Init();
 		Fonts::Init();
 		Sounds::Init();
@@ -41,6 +47,12 @@ namespace flaw {
 		AssetManager::Init();
 		Scripting::Init(*this);
 
+		// shipping builds load their assets from the bundles of the project, the editor registers .asset files instead
+		const ProjectConfig& projectConfig = Project::GetConfig();
+		for (const auto& bundle : projectConfig.bundles) {
+			AssetManager::MountBundle((projectConfig.path + "/" + bundle).c_str());
+		}
+
 		// ̺Ʈ 
 		_eventDispatcher.Register<KeyPressEvent>([this](const KeyPressEvent& event) { Input::OnKeyPress(event.key); }, PID(this));
 		_eventDispatcher.Register<KeyReleaseEvent>([this](const KeyReleaseEvent& event) { Input::OnKeyRelease(event.key); }, PID(this));
@@ -108,14 +120,12 @@ namespace flaw {
 		_tasks.emplace_back(task);
 	}
 
-	void Application::AddAsyncTask(const std::function<void()>& task) {
-		_threadPool.EnqueueTask(task);
-	}
-
 	void Application::Run() {
 		Time::Start();
 
 		while (_running && Platform::PollEvents()) {
+			FLAW_PROFILE_FRAME();
+
 			_eventDispatcher.PollEvents();
 
 			Time::Update();
@@ -3,7 +3,8 @@
 #include "Core.h"
 #include "LayerRegistry.h"
 #include "Event/EventDispatcher.h"
-#include "Utils/ThreadPool.h"
+#include "Graphics/GraphicsType.h"
+#include "Utils/JobSystem.h"
 
 #include <functional>
 #include <mutex>
@@ -16,6 +17,8 @@ namespace flaw {
 
 		int argc;
 		char** argv;
+
+		GraphicsType graphicsType = GraphicsType::DX11; // Null runs without a window surface, for tests and servers
 	};
 
 	class FAPI Application {
@@ -33,12 +36,16 @@ namespace flaw {
 		// add main thread task, task will be excuted after everthing is done
 		void AddTask(const std::function<void()>& task);
 
-		// add async task, task will be excuted in thread pool
-		void AddAsyncTask(const std::function<void()>& task);
+		// add async task, task will be excuted in job system
+		template<typename Func>
+		void AddAsyncTask(Func&& task, JobCounter* counter = nullptr) {
+			_jobSystem.Schedule(std::forward<Func>(task), counter);
+		}
 
 		void Run();
 
 		inline EventDispatcher& GetEventDispatcher() { return _eventDispatcher; }
+		inline JobSystem& GetJobSystem() { return _jobSystem; }
 
 	private:
 		void ExecuteTasks();
@@ -52,7 +59,7 @@ namespace flaw {
 
 		std::function<void(float& x, float& y, float& width, float& height)> _userGetViewportFunc;
 
-		ThreadPool _threadPool;
+		JobSystem _jobSystem;
 
 		std::vector<std::function<void()>> _tasks;
 		std::mutex _taskMutex;
@@ -34,6 +34,7 @@ namespace flaw {
 		Skeleton,
 		SkeletalAnimation,
 		Prefab,
+		Animator,
 	};
 
 	class Asset {
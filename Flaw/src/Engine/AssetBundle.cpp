@@ -0,0 +1,181 @@
+#include "pch.h"
+#include "AssetBundle.h"
+#include "Log/Log.h"
+
+#include <zlib.h>
+#include <algorithm>
+
+namespace flaw {
+	static_assert(sizeof(AssetBundleHeader) == 24 && sizeof(AssetBundleEntry) == 40, "asset bundle structs are the file layout");
+	static_assert(std::is_trivial_v<AssetBundleHeader> && std::is_trivial_v<AssetBundleEntry>, "asset bundle structs are copied with memcpy");
+
+	bool AssetBundleBuilder::Open(const char* path) {
+		_stream.open(path, std::ios::binary | std::ios::trunc);
+		if (!_stream.is_open()) {
+			return false;
+		}
+
+		_offset = 0;
+		_entries.clear();
+
+		// the header is written again by Finish
+		AssetBundleHeader header = {};
+		return WritePadded(&header, sizeof(header));
+	}
+
+	bool AssetBundleBuilder::AddAsset(const AssetHandle& handle, AssetType type, const int8_t* data, uint64_t size, bool compress) {
+		AssetBundleEntry entry = {};
+		entry.handle = handle;
+		entry.type = type;
+		entry.offset = _offset;
+		entry.size = size;
+		entry.uncompressedSize = size;
+
+		// zlib sizes are 32 bit on windows
+		if (compress && size > 0 && size <= std::numeric_limits<uLong>::max()) {
+			uLongf compressedSize = compressBound(static_cast<uLong>(size));
+			std::vector<int8_t> compressed(compressedSize);
+
+			if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressedSize, reinterpret_cast<const Bytef*>(data), static_cast<uLong>(size), Z_DEFAULT_COMPRESSION) == Z_OK && compressedSize < size) {
+				entry.compression = AssetBundleCompression::Deflate;
+				entry.size = compressedSize;
+
+				_entries.push_back(entry);
+				return WritePadded(compressed.data(), compressedSize);
+			}
+		}
+
+		_entries.push_back(entry);
+		return WritePadded(data, size);
+	}
+
+	bool AssetBundleBuilder::Finish() {
+		std::sort(_entries.begin(), _entries.end(), [](const AssetBundleEntry& a, const AssetBundleEntry& b) { return a.handle < b.handle; });
+
+		for (uint32_t i = 1; i < _entries.size(); ++i) {
+			if (_entries[i - 1].handle == _entries[i].handle) {
+				Log::Warn("Asset bundle has more than one asset with handle %llu, only one of them can be found", _entries[i].handle);
+			}
+		}
+
+		AssetBundleHeader header = {};
+		header.magic = AssetBundleMagic;
+		header.version = AssetBundleVersion;
+		header.entryCount = static_cast<uint32_t>(_entries.size());
+		header.entriesOffset = _offset;
+
+		WritePadded(_entries.data(), _entries.size() * sizeof(AssetBundleEntry));
+
+		_stream.seekp(0);
+		_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		const bool succeeded = _stream.good();
+		_stream.close();
+		_entries.clear();
+
+		return succeeded;
+	}
+
+	bool AssetBundleBuilder::WritePadded(const void* data, uint64_t size) {
+		static const char zeros[AssetBundleAlignment] = {};
+
+		const uint64_t padding = (AssetBundleAlignment - (size & (AssetBundleAlignment - 1))) & (AssetBundleAlignment - 1);
+
+		_stream.write(static_cast<const char*>(data), size);
+		_stream.write(zeros, padding);
+		_offset += size + padding;
+
+		return _stream.good();
+	}
+
+	bool AssetBundle::Open(const char* path) {
+		Close();
+
+		if (!_file.Open(path)) {
+			return false;
+		}
+
+		const uint64_t fileSize = _file.Size();
+		if (fileSize < sizeof(AssetBundleHeader)) {
+			Close();
+			return false;
+		}
+
+		AssetBundleHeader header = {};
+		std::memcpy(&header, _file.Data(), sizeof(header));
+
+		if (header.magic != AssetBundleMagic || header.version != AssetBundleVersion) {
+			Log::Error("%s is not an asset bundle of version %u", path, AssetBundleVersion);
+			Close();
+			return false;
+		}
+
+		if (header.entriesOffset % alignof(AssetBundleEntry) != 0 || header.entriesOffset > fileSize || (fileSize - header.entriesOffset) / sizeof(AssetBundleEntry) < header.entryCount) {
+			Log::Error("Asset bundle %s is truncated", path);
+			Close();
+			return false;
+		}
+
+		_entries = reinterpret_cast<const AssetBundleEntry*>(_file.Data() + header.entriesOffset);
+		_entryCount = header.entryCount;
+
+		for (uint32_t i = 0; i < _entryCount; ++i) {
+			const AssetBundleEntry& entry = _entries[i];
+			if (entry.offset > fileSize || entry.size > fileSize - entry.offset || (i > 0 && _entries[i - 1].handle > entry.handle)) {
+				Log::Error("Asset bundle %s has a broken entry table", path);
+				Close();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void AssetBundle::Close() {
+		_file.Close();
+		_entries = nullptr;
+		_entryCount = 0;
+	}
+
+	const AssetBundleEntry* AssetBundle::FindEntry(const AssetHandle& handle) const {
+		const AssetBundleEntry* end = _entries + _entryCount;
+		const AssetBundleEntry* it = std::lower_bound(_entries, end, static_cast<uint64_t>(handle), [](const AssetBundleEntry& entry, uint64_t value) { return entry.handle < value; });
+
+		if (it == end || it->handle != handle) {
+			return nullptr;
+		}
+
+		return it;
+	}
+
+	bool AssetBundle::ReadPayload(const AssetBundleEntry& entry, std::vector<int8_t>& buffer, const int8_t*& outData, uint64_t& outSize) const {
+		const int8_t* stored = _file.Data() + entry.offset;
+
+		switch (entry.compression) {
+		case AssetBundleCompression::None:
+			outData = stored;
+			outSize = entry.size;
+			return true;
+		case AssetBundleCompression::Deflate:
+		{
+			if (entry.size > std::numeric_limits<uLong>::max() || entry.uncompressedSize > std::numeric_limits<uLong>::max()) {
+				return false;
+			}
+
+			buffer.resize(entry.uncompressedSize);
+
+			uLongf uncompressedSize = static_cast<uLongf>(entry.uncompressedSize);
+			if (uncompress(reinterpret_cast<Bytef*>(buffer.data()), &uncompressedSize, reinterpret_cast<const Bytef*>(stored), static_cast<uLong>(entry.size)) != Z_OK || uncompressedSize != entry.uncompressedSize) {
+				Log::Error("Failed to inflate asset %llu of a bundle", entry.handle);
+				return false;
+			}
+
+			outData = buffer.data();
+			outSize = entry.uncompressedSize;
+			return true;
+		}
+		}
+
+		return false;
+	}
+}
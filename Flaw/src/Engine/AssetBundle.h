@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Core.h"
+#include "Asset.h"
+#include "Platform/FileSystem.h"
+
+#include <vector>
+#include <fstream>
+
+namespace flaw {
+	// many assets packed into one file for shipping builds, the editor writes one from its .asset files
+	constexpr uint32_t AssetBundleMagic = 0x4c444e42; // "BNDL"
+	constexpr uint32_t AssetBundleVersion = 1;
+	constexpr uint64_t AssetBundleAlignment = 16;
+	constexpr const char* AssetBundleExtension = ".bundle";
+
+	enum class AssetBundleCompression : uint32_t {
+		None = 0,
+		Deflate,
+	};
+
+	// layout
+	//   header
+	//   payloads	the serialized descriptor of each asset, same bytes as an .asset file after its metadata, every one starts AssetBundleAlignment aligned
+	//   entries	entryCount AssetBundleEntry sorted by handle
+	// both structs are copied to and from the file as they are, so they stay trivial, value initialize them
+	struct AssetBundleHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t padding;
+
+		uint64_t entriesOffset;
+	};
+
+	struct AssetBundleEntry {
+		uint64_t handle;
+		AssetType type;
+		AssetBundleCompression compression;
+
+		uint64_t offset;					// from the start of the file
+		uint64_t size;						// stored bytes
+		uint64_t uncompressedSize;
+	};
+
+	// payloads go to the file as they are added, only the entries are kept until Finish
+	class AssetBundleBuilder {
+	public:
+		bool Open(const char* path);
+
+		// compressed payloads are only stored when they are smaller
+		bool AddAsset(const AssetHandle& handle, AssetType type, const int8_t* data, uint64_t size, bool compress);
+
+		// writes the sorted entries and closes the file, false if any write failed
+		bool Finish();
+
+	private:
+		bool WritePadded(const void* data, uint64_t size);
+
+	private:
+		std::ofstream _stream;
+		uint64_t _offset = 0;
+
+		std::vector<AssetBundleEntry> _entries;
+	};
+
+	// reads a bundle through a mapping, it can be shared between threads once opened
+	class AssetBundle {
+	public:
+		AssetBundle() = default;
+
+		AssetBundle(const AssetBundle&) = delete;
+		AssetBundle& operator=(const AssetBundle&) = delete;
+
+		bool Open(const char* path);
+		void Close();
+
+		// null when the bundle has no asset with this handle
+		const AssetBundleEntry* FindEntry(const AssetHandle& handle) const;
+
+		uint32_t GetEntryCount() const { return _entryCount; }
+		const AssetBundleEntry& GetEntryAt(uint32_t index) const { return _entries[index]; }
+
+		// uncompressed payloads point into the mapping, compressed ones are inflated into buffer
+		bool ReadPayload(const AssetBundleEntry& entry, std::vector<int8_t>& buffer, const int8_t*& outData, uint64_t& outSize) const;
+
+	private:
+		MappedFile _file;
+
+		const AssetBundleEntry* _entries = nullptr;
+		uint32_t _entryCount = 0;
+	};
+}
@@ -7,10 +7,12 @@
 #include "Graphics.h"
 #include "Graphics/GraphicsFunc.h"
 #include "Serialization.h"
+#include "AssetBundle.h"
 
 namespace flaw {
 	static std::unordered_map<std::string, AssetHandle> g_assetKeyMap;
 	static std::unordered_map<AssetHandle, Ref<Asset>> g_registeredAssets;
+	static std::vector<Ref<AssetBundle>> g_mountedBundles;
 
 	void AssetManager::Init() {
 		RegisterDefaultGraphicsShaders();
@@ -115,6 +117,7 @@ namespace flaw {
 
 	void AssetManager::Cleanup() {
 		g_registeredAssets.clear();
+		g_mountedBundles.clear();
 	}
 
 	void AssetManager::RegisterKey(const std::string_view& key, const AssetHandle& handle) {
@@ -158,9 +161,45 @@ namespace flaw {
 		g_registeredAssets.erase(it);
 	}
 
+	// registers the asset of the first mounted bundle that has the handle, assets keep their bundle mapped
+	static Ref<Asset> RegisterBundledAsset(const AssetHandle& handle) {
+		for (const auto& bundle : g_mountedBundles) {
+			const AssetBundleEntry* entry = bundle->FindEntry(handle);
+			if (!entry) {
+				continue;
+			}
+
+			Ref<Asset> asset = CreateSerializedAsset(entry->type, [bundle, entry](const std::function<void(SerializationArchive&)>& read) {
+				std::vector<int8_t> buffer;
+				const int8_t* data;
+				uint64_t size;
+				if (!bundle->ReadPayload(*entry, buffer, data, size)) {
+					return;
+				}
+
+				SerializationArchive archive = SerializationArchive::View(data, size);
+				read(archive);
+			});
+
+			if (!asset) {
+				Log::Warn("Bundled asset %llu has an unknown type", (uint64_t)handle);
+				return nullptr;
+			}
+
+			g_registeredAssets[handle] = asset;
+			return asset;
+		}
+
+		return nullptr;
+	}
+
 	void AssetManager::LoadAsset(const AssetHandle& handle) {
 		auto it = g_registeredAssets.find(handle);
 		if (it == g_registeredAssets.end()) {
+			Ref<Asset> asset = RegisterBundledAsset(handle);
+			if (asset) {
+				asset->Load();
+			}
 			return;
 		}
 
@@ -200,7 +239,11 @@ namespace flaw {
 	Ref<Asset> AssetManager::GetAsset(const AssetHandle& handle) {
 		auto it = g_registeredAssets.find(handle);
 		if (it == g_registeredAssets.end()) {
-			return nullptr;
+			Ref<Asset> asset = RegisterBundledAsset(handle);
+			if (asset) {
+				asset->Load();
+			}
+			return asset;
 		}
 
 		if (!it->second->IsLoaded()) {
@@ -223,6 +266,22 @@ namespace flaw {
 		return g_registeredAssets.find(handle) != g_registeredAssets.end();
 	}
 
+	bool AssetManager::MountBundle(const char* path) {
+		Ref<AssetBundle> bundle = CreateRef<AssetBundle>();
+		if (!bundle->Open(path)) {
+			Log::Error("Failed to mount asset bundle: %s", path);
+			return false;
+		}
+
+		g_mountedBundles.push_back(bundle);
+		return true;
+	}
+
+	void AssetManager::UnmountBundles() {
+		// assets resolved from a bundle hold on to it until they are unregistered
+		g_mountedBundles.clear();
+	}
+
 	void AssetManager::EachAssets(const std::function<void(const AssetHandle&, const Ref<Asset>&)>& func) {
 		for (const auto& [handle, asset] : g_registeredAssets) {
 			func(handle, asset);
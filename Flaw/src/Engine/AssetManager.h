@@ -29,6 +29,11 @@ namespace flaw {
 
 		static bool IsAssetRegistered(const AssetHandle& handle);
 
+		// handles that are not registered resolve to assets of mounted bundles, the first mounted bundle wins
+		// Application mounts the bundles listed in ProjectConfig::bundles
+		static bool MountBundle(const char* path);
+		static void UnmountBundles();
+
 		template <typename T>
 		static Ref<T> GetAsset(const AssetHandle& handle) {
 			return std::dynamic_pointer_cast<T>(GetAsset(handle));
@@ -111,7 +111,7 @@ namespace flaw {
 		Descriptor desc;
 		_getDesc(desc);
 
-		_mesh = CreateRef<Mesh>(desc.vertices, desc.indices, desc.segments);
+		_mesh = CreateRef<Mesh>(desc.vertices, desc.indices, desc.segments, std::move(desc.bvhNodes), std::move(desc.bvhTriangles), std::move(desc.bvhTriangleIndices));
 		_materials = std::move(desc.materials);
 	}
 
@@ -124,7 +124,7 @@ namespace flaw {
 		Descriptor desc;
 		_getDesc(desc);
 
-		_mesh = CreateRef<Mesh>(desc.vertices, desc.indices, desc.segments);
+		_mesh = CreateRef<Mesh>(desc.vertices, desc.indices, desc.segments, std::move(desc.bvhNodes), std::move(desc.bvhTriangles), std::move(desc.bvhTriangleIndices));
 		_materials = std::move(desc.materials);
 		_skeleton = desc.skeleton;
 	}
@@ -226,13 +226,45 @@ namespace flaw {
 		Descriptor desc;
 		_getDesc(desc);
 
-		_animation = CreateRef<SkeletalAnimation>(desc.name, desc.durationSec, desc.animationNodes);
+		if (!desc.compressedAnimationNodes.empty()) {
+			_animation = CreateRef<SkeletalAnimation>(desc.name, desc.durationSec, desc.compressedAnimationNodes);
+		}
+		else {
+			_animation = CreateRef<SkeletalAnimation>(desc.name, desc.durationSec, desc.animationNodes);
+		}
 	}
 
 	void SkeletalAnimationAsset::Unload() {
 		_animation.reset();
 	}
 
+	void AnimatorAsset::Load() {
+		Descriptor desc;
+		_getDesc(desc);
+
+		auto skeletonAsset = AssetManager::GetAsset<SkeletonAsset>(desc.skeleton);
+		if (!skeletonAsset) {
+			Log::Error("AnimatorAsset: Skeleton asset not found");
+			return;
+		}
+
+		Animator::Descriptor animatorDesc = {};
+		animatorDesc.skeleton = skeletonAsset->GetSkeleton();
+		animatorDesc.graph = desc.graph;
+
+		animatorDesc.animations.reserve(desc.graph.animations.size());
+		for (const auto& animationHandle : desc.graph.animations) {
+			auto animationAsset = AssetManager::GetAsset<SkeletalAnimationAsset>(animationHandle);
+			animatorDesc.animations.push_back(animationAsset ? animationAsset->GetAnimation() : nullptr);
+		}
+
+		_animator = CreateRef<Animator>(animatorDesc);
+	}
+
+	void AnimatorAsset::Unload() {
+		_animator.reset();
+	}
+
 	void PrefabAsset::Load() {
 		Descriptor desc;
 		_getDesc(desc);
@@ -243,4 +275,195 @@ namespace flaw {
 	void PrefabAsset::Unload() {
 		_prefab.reset();
 	}
+
+	Ref<Asset> CreateSerializedAsset(AssetType assetType, const AssetPayloadReader& reader) {
+		Ref<Asset> asset;
+
+		switch (assetType) {
+		case AssetType::Texture2D:
+			asset = CreateRef<Texture2DAsset>(
+				[reader](Texture2DAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.format;
+						archive >> desc.width;
+						archive >> desc.height;
+						archive.Consume(sizeof(Texture2D::Wrap) * 2);
+						archive.Consume(sizeof(Texture2D::Filter) * 2);
+						archive >> desc.usage;
+						archive >> desc.accessFlags;
+						archive >> desc.bindFlags;
+						archive >> desc.data;
+					});
+				}
+			);
+			break;
+		case AssetType::Texture2DArray:
+			asset = CreateRef<Texture2DArrayAsset>(
+				[reader](Texture2DArrayAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.arraySize;
+						archive >> desc.format;
+						archive >> desc.width;
+						archive >> desc.height;
+						archive >> desc.usage;
+						archive >> desc.accessFlags;
+						archive >> desc.bindFlags;
+						archive >> desc.data;
+					});
+				}
+			);
+			break;
+		case AssetType::TextureCube:
+			asset = CreateRef<TextureCubeAsset>(
+				[reader](TextureCubeAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.format;
+						archive >> desc.width;
+						archive >> desc.height;
+						archive >> desc.layout;
+						archive >> desc.data;
+					});
+				}
+			);
+			break;
+		case AssetType::Font:
+			asset = CreateRef<FontAsset>(
+				[reader](FontAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.fontData;
+						archive >> desc.width;
+						archive >> desc.height;
+						archive >> desc.atlasData;
+					});
+				}
+			);
+			break;
+		case AssetType::Sound:
+			asset = CreateRef<SoundAsset>(
+				[reader](SoundAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.soundData;
+					});
+				}
+			);
+			break;
+		case AssetType::SkeletalMesh:
+			asset = CreateRef<SkeletalMeshAsset>(
+				[reader](SkeletalMeshAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.segments;
+						archive >> desc.skeleton;
+						archive >> desc.materials;
+						archive >> desc.vertices;
+						archive >> desc.indices;
+						if (archive.RemainingSize() > 0) {
+							archive >> desc.bvhNodes;
+							archive >> desc.bvhTriangles;
+						}
+						if (archive.RemainingSize() > 0) {
+							archive >> desc.bvhTriangleIndices;
+						}
+					});
+				}
+			);
+			break;
+		case AssetType::GraphicsShader:
+			asset = CreateRef<GraphicsShaderAsset>(
+				[reader](GraphicsShaderAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.shaderCompileFlags;
+						archive >> desc.shaderPath;
+					});
+				}
+			);
+			break;
+		case AssetType::Material:
+			asset = CreateRef<MaterialAsset>(
+				[reader](MaterialAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.renderMode;
+						archive >> desc.cullMode;
+						archive >> desc.depthTest;
+						archive >> desc.depthWrite;
+						archive >> desc.shaderHandle;
+						archive >> desc.albedoTexture;
+						archive >> desc.normalTexture;
+						archive >> desc.emissiveTexture;
+						archive >> desc.metallicTexture;
+						archive >> desc.roughnessTexture;
+						archive >> desc.ambientOcclusionTexture;
+						archive >> desc.baseColor;
+					});
+				}
+			);
+			break;
+		case AssetType::Skeleton:
+			asset = CreateRef<SkeletonAsset>(
+				[reader](SkeletonAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.globalInvMatrix;
+						archive >> desc.nodes;
+						archive >> desc.bones;
+						archive >> desc.sockets;
+						archive >> desc.animationHandles;
+					});
+				}
+			);
+			break;
+		case AssetType::SkeletalAnimation:
+			asset = CreateRef<SkeletalAnimationAsset>(
+				[reader](SkeletalAnimationAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.name;
+						archive >> desc.durationSec;
+						archive >> desc.animationNodes;
+						if (archive.RemainingSize() > 0) {
+							archive >> desc.compressedAnimationNodes;
+						}
+					});
+				}
+			);
+			break;
+		case AssetType::StaticMesh:
+			asset = CreateRef<StaticMeshAsset>(
+				[reader](StaticMeshAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.segments;
+						archive >> desc.materials;
+						archive >> desc.vertices;
+						archive >> desc.indices;
+						if (archive.RemainingSize() > 0) {
+							archive >> desc.bvhNodes;
+							archive >> desc.bvhTriangles;
+						}
+						if (archive.RemainingSize() > 0) {
+							archive >> desc.bvhTriangleIndices;
+						}
+					});
+				}
+			);
+			break;
+		case AssetType::Prefab:
+			asset = CreateRef<PrefabAsset>(
+				[reader](PrefabAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.prefabData;
+					});
+				}
+			);
+			break;
+		case AssetType::Animator:
+			asset = CreateRef<AnimatorAsset>(
+				[reader](AnimatorAsset::Descriptor& desc) {
+					reader([&desc](SerializationArchive& archive) {
+						archive >> desc.skeleton;
+						archive >> desc.graph;
+					});
+				}
+			);
+			break;
+		}
+
+		return asset;
+	}
 }
\ No newline at end of file
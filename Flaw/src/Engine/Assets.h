@@ -11,6 +11,7 @@
 #include "Mesh.h"
 #include "Material.h"
 #include "Skeleton.h"
+#include "Animator.h"
 #include "Prefab.h"
 
 namespace flaw {
@@ -159,6 +160,11 @@ namespace flaw {
 			std::vector<AssetHandle> materials;
 			std::vector<Vertex3D> vertices;
 			std::vector<uint32_t> indices;
+
+			// built on import, empty for assets saved before so the mesh builds its own
+			std::vector<BVHNode> bvhNodes;
+			std::vector<BVHTriangle> bvhTriangles;
+			std::vector<int32_t> bvhTriangleIndices;
 		};
 
 		StaticMeshAsset(const std::function<void(Descriptor&)>& getDesc) : _getDesc(getDesc) {}
@@ -189,6 +195,11 @@ namespace flaw {
 			std::vector<AssetHandle> materials;
 			std::vector<SkinnedVertex3D> vertices;
 			std::vector<uint32_t> indices;
+
+			// built on import, empty for assets saved before so the mesh builds its own
+			std::vector<BVHNode> bvhNodes;
+			std::vector<BVHTriangle> bvhTriangles;
+			std::vector<int32_t> bvhTriangleIndices;
 		};
 
 		SkeletalMeshAsset(const std::function<void(Descriptor&)>& getDesc) : _getDesc(getDesc) {}
@@ -316,6 +327,7 @@ namespace flaw {
 			std::string name;
 			float durationSec;
 			std::vector<SkeletalAnimationNode> animationNodes;
+			std::vector<CompressedSkeletalAnimationNode> compressedAnimationNodes; // used instead of animationNodes when not empty
 		};
 
 		SkeletalAnimationAsset(const std::function<void(Descriptor&)>& getDesc) : _getDesc(getDesc) {}
@@ -336,6 +348,32 @@ namespace flaw {
 		Ref<SkeletalAnimation> _animation;
 	};
 
+	class AnimatorAsset : public Asset {
+	public:
+		struct Descriptor {
+			AssetHandle skeleton;
+			AnimatorGraphDesc graph;
+		};
+
+		AnimatorAsset(const std::function<void(Descriptor&)>& getDesc) : _getDesc(getDesc) {}
+
+		void Load() override;
+		void Unload() override;
+
+		AssetType GetAssetType() const override { return AssetType::Animator; }
+		bool IsLoaded() const override { return _animator != nullptr; }
+
+		void GetDescriptor(Descriptor& desc) const { _getDesc(desc); }
+
+		// shared by every entity using this asset
+		const Ref<Animator>& GetAnimator() const { return _animator; }
+
+	private:
+		std::function<void(Descriptor&)> _getDesc;
+
+		Ref<Animator> _animator;
+	};
+
 	class PrefabAsset : public Asset {
 	public:
 		struct Descriptor {
@@ -359,4 +397,11 @@ namespace flaw {
 
 		Ref<Prefab> _prefab;
 	};
+
+	// hands an archive over the serialized descriptor of an asset to the callback, the archive is only valid during the call
+	using AssetPayloadReader = std::function<void(const std::function<void(SerializationArchive&)>&)>;
+
+	// asset of the given type whose descriptor is deserialized from the reader every time it loads
+	// the payload layout is the one of .asset files after their metadata, asset bundles store the same bytes
+	Ref<Asset> CreateSerializedAsset(AssetType assetType, const AssetPayloadReader& reader);
 }
\ No newline at end of file
@@ -116,6 +116,6 @@ namespace flaw {
 	}
 
 	void OrthographicCamera::UpdateFrustum() {
-		// TODO: Implement orthographic frustrum
+		CreateOrthographicFrustum(_left, _right, _bottom, _top, _nearFarClip.x, _nearFarClip.y, GetViewMatrix(), _frustrum);
 	}
 }
\ No newline at end of file
@@ -22,6 +22,17 @@ namespace flaw {
 		EntityComponent(const EntityComponent& other) = default;
 	};
 
+	// intrusive hierarchy links, children of an entity form a doubly linked list through the sibling handles
+	struct RelationshipComponent {
+		entt::entity parent = entt::null;
+		entt::entity firstChild = entt::null;
+		entt::entity lastChild = entt::null;
+		entt::entity prevSibling = entt::null;
+		entt::entity nextSibling = entt::null;
+
+		uint32_t childCount = 0;
+	};
+
 	struct TransformComponent {
 		vec3 position = vec3(0.0f);
 		vec3 rotation = vec3(0.0f);
@@ -498,12 +509,33 @@ namespace flaw {
 		}
 	};
 
+	struct AnimatorLevelOfDetail {
+		float minScreenSize = 0.0f;	// fraction of the screen height the mesh bounds have to cover for this level
+		int32_t updateInterval = 1;	// frames between samples, frames in between interpolate the last two samples
+		int32_t maxBoneDepth = -1;	// deeper nodes keep the binding pose, -1 samples every node
+	};
+
 	struct AnimatorComponent {
 		AssetHandle animatorAsset;
 		
 		// TODO: ӽ÷ 
 		AssetHandle skeletonAsset;
 
+		// levels are sorted by descending screen size, the last one is used below every threshold
+		bool useLevelOfDetail = true;
+		std::vector<AnimatorLevelOfDetail> levelOfDetails = {
+			{ 0.25f, 1, -1 },
+			{ 0.1f, 2, -1 },
+			{ 0.03f, 4, 8 },
+			{ 0.0f, 8, 5 },
+		};
+
+		int32_t offscreenUpdateInterval = 8; // used while neither a camera nor a shadow map sees the mesh, 0 freezes the pose
+
+		// entities playing the same clip within the same time step share one skinning palette
+		bool useCrowdPose = false;
+		float crowdPoseTimeStep = 1.0f / 30.0f; // seconds
+
 		AnimatorComponent() = default;
 		AnimatorComponent(const AssetHandle& animatorAsset) : animatorAsset(animatorAsset) {}
 		AnimatorComponent(const AnimatorComponent& other) = default;
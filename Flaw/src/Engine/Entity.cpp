@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Entity.h"
 #include "Components.h"
+#include "TransformSystem.h"
 #include "Log/Log.h"
 
 namespace flaw {
@@ -24,90 +25,125 @@ namespace flaw {
 		return _scene->_registry.get<EntityComponent>(_handle).name;
 	}
 
+	static void DetachFromParent(entt::registry& registry, entt::entity entity) {
+		auto& relation = registry.get<RelationshipComponent>(entity);
+		auto& parentRelation = registry.get<RelationshipComponent>(relation.parent);
+
+		if (relation.prevSibling != entt::null) {
+			registry.get<RelationshipComponent>(relation.prevSibling).nextSibling = relation.nextSibling;
+		}
+		else {
+			parentRelation.firstChild = relation.nextSibling;
+		}
+
+		if (relation.nextSibling != entt::null) {
+			registry.get<RelationshipComponent>(relation.nextSibling).prevSibling = relation.prevSibling;
+		}
+		else {
+			parentRelation.lastChild = relation.prevSibling;
+		}
+
+		parentRelation.childCount--;
+
+		relation.parent = entt::null;
+		relation.prevSibling = entt::null;
+		relation.nextSibling = entt::null;
+	}
+
+	static void AttachToParent(entt::registry& registry, entt::entity entity, entt::entity parent) {
+		auto& relation = registry.get<RelationshipComponent>(entity);
+		auto& parentRelation = registry.get<RelationshipComponent>(parent);
+
+		relation.parent = parent;
+		relation.prevSibling = parentRelation.lastChild;
+		relation.nextSibling = entt::null;
+
+		if (parentRelation.lastChild != entt::null) {
+			registry.get<RelationshipComponent>(parentRelation.lastChild).nextSibling = entity;
+		}
+		else {
+			parentRelation.firstChild = entity;
+		}
+
+		parentRelation.lastChild = entity;
+		parentRelation.childCount++;
+	}
+
 	bool Entity::HasParent() const {
-		return _scene->_parentMap.find(GetUUID()) != _scene->_parentMap.end();
+		return _scene->_registry.get<RelationshipComponent>(_handle).parent != entt::null;
 	}
 
 	void Entity::SetParent(Entity parent) {
-		UUID thisUUID = GetUUID();
-		UUID parentUUID = parent.GetUUID();
+		auto& registry = _scene->_registry;
+		const entt::entity parentHandle = (entt::entity)parent;
 
-		if (thisUUID == parentUUID) {
+		if (_handle == parentHandle) {
 			// can't set self as parent
 			return;
 		}
 
 		// check if set parent to already parent
-		auto oldParentIt = _scene->_parentMap.find(thisUUID);
-		if (oldParentIt != _scene->_parentMap.end() && oldParentIt->second == parentUUID) {
+		const auto& relation = registry.get<RelationshipComponent>(_handle);
+		if (relation.parent == parentHandle) {
 			return;
 		}
 
-		// check if parent is a child of this object
-		std::queue<UUID> q;
-		q.push(parentUUID);
-		while (!q.empty()) {
-			auto currentUUID = q.front();
-			q.pop();
-
-			if (currentUUID == thisUUID) {
+		// check if parent is a child of this object, only the ancestors of the new parent need to be visited
+		for (entt::entity current = registry.get<RelationshipComponent>(parentHandle).parent; current != entt::null; current = registry.get<RelationshipComponent>(current).parent) {
+			if (current == _handle) {
 				// parent is a child of this object, so we can't set it as parent
 				return;
 			}
-
-			auto parentIt = _scene->_parentMap.find(currentUUID);
-			if (parentIt != _scene->_parentMap.end()) {
-				q.push(parentIt->second);
-			}
 		}
 
 		// remove this object from its old parent
-		if (oldParentIt != _scene->_parentMap.end()) {
-			_scene->_childMap[oldParentIt->second].erase(thisUUID);
+		if (relation.parent != entt::null) {
+			DetachFromParent(registry, _handle);
 		}
 
 		// excute
-		_scene->_parentMap[thisUUID] = parentUUID;
-		_scene->_childMap[parentUUID].insert(thisUUID);
+		AttachToParent(registry, _handle, parentHandle);
 
 		GetComponent<TransformComponent>().dirty = true;
+		_scene->GetTransformSystem().MarkHierarchyDirty();
 	}
 
 	void Entity::UnsetParent() {
-		UUID thisUUID = GetUUID();
+		auto& registry = _scene->_registry;
 
-		auto parentIt = _scene->_parentMap.find(thisUUID);
-		if (parentIt == _scene->_parentMap.end()) {
+		if (registry.get<RelationshipComponent>(_handle).parent == entt::null) {
 			// no parent to unset
 			return;
 		}
 
 		// remove this object from its parent
-		_scene->_childMap[parentIt->second].erase(thisUUID);
-		_scene->_parentMap.erase(thisUUID);
+		DetachFromParent(registry, _handle);
 
 		GetComponent<TransformComponent>().dirty = true;
+		_scene->GetTransformSystem().MarkHierarchyDirty();
 	}
 
 	Entity Entity::GetParent() const {
-		auto it = _scene->_parentMap.find(GetUUID());
-		if (it != _scene->_parentMap.end()) {
-			return _scene->FindEntityByUUID(it->second);
+		const entt::entity parent = _scene->_registry.get<RelationshipComponent>(_handle).parent;
+		if (parent != entt::null) {
+			return Entity(parent, _scene);
 		}
 		return Entity();
 	}
 
 	bool Entity::HasChild() const {
-		auto it = _scene->_childMap.find(GetUUID());
-		return it != _scene->_childMap.end() && !it->second.empty();
+		return _scene->_registry.get<RelationshipComponent>(_handle).firstChild != entt::null;
 	}
 
-	void Entity::EachChildren(const std::function<void(const Entity& entity)>& func) const {
-		auto it = _scene->_childMap.find(GetUUID());
-		if (it != _scene->_childMap.end()) {
-			for (const auto& childUUID : it->second) {
-				func(_scene->FindEntityByUUID(childUUID));
-			}
-		}
+	uint32_t Entity::GetChildCount() const {
+		return _scene->_registry.get<RelationshipComponent>(_handle).childCount;
+	}
+
+	entt::entity Entity::GetFirstChildHandle() const {
+		return _scene->_registry.get<RelationshipComponent>(_handle).firstChild;
+	}
+
+	entt::entity Entity::GetNextSiblingHandle(entt::entity child) const {
+		return _scene->_registry.get<RelationshipComponent>(child).nextSibling;
 	}
-}
\ No newline at end of file
+}
@@ -40,7 +40,15 @@ namespace flaw {
 		Entity GetParent() const;
 
 		bool HasChild() const;
-		void EachChildren(const std::function<void(const Entity& entity)>& func) const;
+		uint32_t GetChildCount() const;
+
+		// walks the sibling list in place, func must not reparent the child it is given
+		template<typename Func>
+		void EachChildren(const Func& func) const {
+			for (entt::entity child = GetFirstChildHandle(); child != entt::null; child = GetNextSiblingHandle(child)) {
+				func(Entity(child, _scene));
+			}
+		}
 
 		const UUID& GetUUID() const;
 		const std::string& GetName() const;
@@ -58,6 +66,10 @@ namespace flaw {
 			return !(*this == other);
 		}
 
+	private:
+		entt::entity GetFirstChildHandle() const;
+		entt::entity GetNextSiblingHandle(entt::entity child) const;
+
 	private:
 		entt::entity _handle;
 		Scene* _scene;
@@ -7,37 +7,9 @@
 
 #define NOMINMAX
 #include "Graphics/DX11/DXContext.h"
+#include "Graphics/Null/NullContext.h"
 
 namespace flaw {
-	struct RaycastUniform {
-		vec4 rayOrigin;
-		vec4 rayDirection;
-		float rayLength;
-		int32_t triangleCount;
-
-		int32_t padding[2];
-	};
-
-	struct RaycastTriangle {
-		vec3 p0;
-		vec3 p1;
-		vec3 p2;
-		vec3 center;
-		vec3 normal;
-		uint32_t index;
-	};
-
-	struct RaycastResult {
-		int32_t index;
-
-		vec3 position;
-		vec3 normal;
-		float distance;
-	};
-
-	constexpr int32_t MaxRaycastTriangles = 10000;
-	constexpr int32_t MaxRayHits = MaxRaycastTriangles + 1;
-
 	static Scope<GraphicsContext> g_graphicsContext;
 
 	static Ref<GraphicsPipeline> g_graphicsPipeline;
@@ -48,20 +20,22 @@ namespace flaw {
 
 	static Ref<StructuredBuffer> g_batchedDataSB;
 
-	static Ref<ComputeShader> g_raycastShader;
-	static Ref<ConstantBuffer> g_raycastUniformCB;
-	static Ref<StructuredBuffer> g_raycastTriSB;
-	static Ref<StructuredBuffer> g_raycastResultSB;
-
 	void Graphics::Init(GraphicsType type) {
 		int32_t width, height;
 		Platform::GetFrameBufferSize(width, height);
 
+		Init(type, width, height);
+	}
+
+	void Graphics::Init(GraphicsType type, int32_t width, int32_t height) {
 		switch (type)
 		{
 		case flaw::GraphicsType::DX11:
 			g_graphicsContext = CreateScope<DXContext>(Platform::GetPlatformContext(), width, height);
 			break;
+		case flaw::GraphicsType::Null:
+			g_graphicsContext = CreateScope<NullContext>(width, height);
+			break;
 		default:
 			throw std::runtime_error("Unsupported graphics type");
 			break;
@@ -80,24 +54,6 @@ namespace flaw {
 		batchedTransformSBDesc.accessFlags = AccessFlag::Write;
 		g_batchedDataSB = Graphics::CreateStructuredBuffer(batchedTransformSBDesc);
 
-		// NOTE: for raycasting
-		g_raycastShader = CreateComputeShader("Resources/Shaders/raycast.fx");
-
-		g_raycastUniformCB = CreateConstantBuffer(sizeof(RaycastUniform));
-
-		StructuredBuffer::Descriptor sbDesc = {};
-		sbDesc.elmSize = sizeof(RaycastTriangle);
-		sbDesc.count = MaxRaycastTriangles;
-		sbDesc.bindFlags = BindFlag::ShaderResource;
-		sbDesc.accessFlags = AccessFlag::Write;
-		g_raycastTriSB = CreateStructuredBuffer(sbDesc);
-
-		sbDesc.elmSize = sizeof(RaycastResult);
-		sbDesc.count = MaxRayHits;
-		sbDesc.bindFlags = BindFlag::UnorderedAccess;
-		sbDesc.accessFlags = AccessFlag::Read | AccessFlag::Write;
-		g_raycastResultSB = CreateStructuredBuffer(sbDesc);
-
 		// TODO: think about this, this is for object picker. but not use in build
 		auto mainMrt = Graphics::GetMainRenderPass();
 
@@ -133,10 +89,6 @@ namespace flaw {
 	}
 
 	void Graphics::Cleanup() {
-		g_raycastResultSB.reset();
-		g_raycastTriSB.reset();
-		g_raycastUniformCB.reset();
-		g_raycastShader.reset();
 		g_materialConstantsCB.reset();
 		g_globalConstantsCB.reset();
 		g_computePipeline.reset();
@@ -243,86 +195,6 @@ namespace flaw {
 		return g_computePipeline;
 	}
 
-	int32_t Graphics::Raycast(
-		const Ray& ray,
-		const std::function<std::vector<BVHNode>& (int32_t)>& getNodesFunc,
-		const std::function<std::vector<BVHTriangle>& (int32_t)>& getTrianglesFunc,
-		int32_t candidateCount,
-		RayHit& hit) 
-	{
-		std::vector<RaycastTriangle> candidateTris;
-		for (uint32_t i = 0; i < candidateCount; i++) {
-			auto& nodes = getNodesFunc(i);
-			auto& triangles = getTrianglesFunc(i);
-
-			Raycast::GetCandidateBVHTriangles(nodes, triangles, ray, [&](int32_t start, int32_t count) {
-				std::transform(triangles.begin() + start, triangles.begin() + start + count, std::back_inserter(candidateTris), [i](const BVHTriangle& tri) {
-					return RaycastTriangle{
-						tri.p0,
-						tri.p1,
-						tri.p2,
-						tri.center,
-						tri.normal,
-						i
-					};
-				});
-			});
-		}
-
-		if (candidateTris.empty()) {
-			return -1;
-		}
-
-		g_raycastTriSB->Update(candidateTris.data(), candidateTris.size() * sizeof(RaycastTriangle));
-
-		RaycastUniform raycastUniform = {};
-		raycastUniform.rayOrigin = vec4(ray.origin, 1.0f);
-		raycastUniform.rayDirection = vec4(ray.direction, 0.0f);
-		raycastUniform.rayLength = ray.length;
-		raycastUniform.triangleCount = candidateTris.size();
-		g_raycastUniformCB->Update(&raycastUniform, sizeof(RaycastUniform));
-
-		// NOTE: first raycast result is represented total result count
-		RaycastResult defaultResult = {};
-		defaultResult.index = 0;
-		g_raycastResultSB->Update(&defaultResult, sizeof(RaycastResult));
-
-		auto& cmdQueue = g_graphicsContext->GetCommandQueue();
-
-		g_computePipeline->SetShader(g_raycastShader);
-
-		cmdQueue.SetComputePipeline(g_computePipeline);
-		cmdQueue.SetComputeConstantBuffer(g_raycastUniformCB, 0);
-		cmdQueue.SetComputeStructuredBuffer(g_raycastTriSB, BindFlag::ShaderResource, 0);
-		cmdQueue.SetComputeStructuredBuffer(g_raycastResultSB, BindFlag::UnorderedAccess, 0);
-		cmdQueue.Dispatch(CalculateDispatchGroupCount(1024, candidateTris.size()), 1, 1);
-
-		cmdQueue.Execute();
-
-		std::vector<RaycastResult> results(MaxRayHits);
-		g_raycastResultSB->Fetch(results.data(), MaxRayHits * sizeof(RaycastResult));
-		
-		int32_t resultCount = std::min(results[0].index, MaxRayHits - 1);
-
-		// ĺ    ͸
-		int32_t closestIndex = -1;
-		float minDist = std::numeric_limits<float>::max();
-		for (int32_t i = 0; i < resultCount; i++) {
-			auto& result = results[i + 1];
-			
-			if (result.distance < minDist) {
-				hit.position = result.position;
-				hit.normal = result.normal;
-				hit.distance = result.distance;
-
-				closestIndex = result.index;
-				minDist = result.distance;
-			}
-		}
-
-		return closestIndex;
-	}
-
 	void Graphics::CaptureTexture(const Ref<Texture2D>& srcTex, std::vector<uint8_t>& outData) {
 		Texture2D::Descriptor desc = {};
 		desc.width = srcTex->GetWidth();
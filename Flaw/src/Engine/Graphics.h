@@ -16,10 +16,6 @@ namespace flaw {
 	
 	constexpr static uint32_t MaxBatchedDataCount = 10000;
 
-	enum class GraphicsType {
-		DX11
-	};
-
 	struct QuadVertex {
 		vec3 position;
 		vec2 texcoord;
@@ -83,6 +79,8 @@ namespace flaw {
 	class Graphics {
 	public:
 		static void Init(GraphicsType type);
+		// sized explicitly, a null context needs no platform window
+		static void Init(GraphicsType type, int32_t width, int32_t height);
 		static void Cleanup();
 
 		static void Prepare();
@@ -117,14 +115,6 @@ namespace flaw {
 		static Ref<GraphicsPipeline> GetMainGraphicsPipeline();
 		static Ref<ComputePipeline> GetMainComputePipeline();
 
-		static int32_t Raycast(
-			const Ray& ray,
-			const std::function<std::vector<BVHNode>& (int32_t)>& getNodesFunc,
-			const std::function<std::vector<BVHTriangle>& (int32_t)>& getTrianglesFunc,
-			int32_t candidateCount,
-			RayHit& hit
-		);
-
 		static void CaptureTexture(const Ref<Texture2D>& srcTex, std::vector<uint8_t>& outData);
 		static void CaptureTextureArray(const Ref<Texture2DArray>& srcTex, std::vector<uint8_t>& outData);
 
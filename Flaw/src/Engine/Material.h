@@ -86,12 +86,12 @@ namespace flaw {
 			if (ambientOcclusionTexture) {
 				outConstants.reservedTextureBitMask |= MaterialTextureType::AmbientOcclusion;
 			}
-			for (int32_t i = 0; i < cubeTextures.size(); ++i) {
+			for (uint32_t i = 0; i < cubeTextures.size(); ++i) {
 				if (cubeTextures[i]) {
 					outConstants.cubeTextureBitMask |= (1 << i);
 				}
 			}
-			for (int32_t i = 0; i < textureArrays.size(); ++i) {
+			for (uint32_t i = 0; i < textureArrays.size(); ++i) {
 				if (textureArrays[i]) {
 					outConstants.textureArrayBitMask |= (1 << i);
 				}
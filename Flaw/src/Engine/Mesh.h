@@ -15,24 +15,9 @@ namespace flaw {
 		vec3 binormal;
 	};
 
-	template<>
-	struct Serializer<Vertex3D> {
-		static void Serialize(SerializationArchive& archive, const Vertex3D& value) {
-			archive << value.position.x << value.position.y << value.position.z;
-			archive << value.texcoord.x << value.texcoord.y;
-			archive << value.tangent.x << value.tangent.y << value.tangent.z;
-			archive << value.normal.x << value.normal.y << value.normal.z;
-			archive << value.binormal.x << value.binormal.y << value.binormal.z;
-		}
-
-		static void Deserialize(SerializationArchive& archive, Vertex3D& value) {
-			archive >> value.position.x >> value.position.y >> value.position.z;
-			archive >> value.texcoord.x >> value.texcoord.y;
-			archive >> value.tangent.x >> value.tangent.y >> value.tangent.z;
-			archive >> value.normal.x >> value.normal.y >> value.normal.z;
-			archive >> value.binormal.x >> value.binormal.y >> value.binormal.z;
-		}
-	};
+	// written as raw bytes, the layout is the file format
+	template<> struct IsTriviallySerializable<Vertex3D> : std::true_type {};
+	static_assert(sizeof(Vertex3D) == sizeof(float) * 14);
 
 	struct SkinnedVertex3D {
 		vec3 position;
@@ -44,28 +29,8 @@ namespace flaw {
 		vec4 boneWeights = vec4(0.0f);
 	};
 
-	template<>
-	struct Serializer<SkinnedVertex3D> {
-		static void Serialize(SerializationArchive& archive, const SkinnedVertex3D& value) {
-			archive << value.position.x << value.position.y << value.position.z;
-			archive << value.texcoord.x << value.texcoord.y;
-			archive << value.tangent.x << value.tangent.y << value.tangent.z;
-			archive << value.normal.x << value.normal.y << value.normal.z;
-			archive << value.binormal.x << value.binormal.y << value.binormal.z;
-			archive << value.boneIndices.x << value.boneIndices.y << value.boneIndices.z << value.boneIndices.w;
-			archive << value.boneWeights.x << value.boneWeights.y << value.boneWeights.z << value.boneWeights.w;
-		}
-
-		static void Deserialize(SerializationArchive& archive, SkinnedVertex3D& value) {
-			archive >> value.position.x >> value.position.y >> value.position.z;
-			archive >> value.texcoord.x >> value.texcoord.y;
-			archive >> value.tangent.x >> value.tangent.y >> value.tangent.z;
-			archive >> value.normal.x >> value.normal.y >> value.normal.z;
-			archive >> value.binormal.x >> value.binormal.y >> value.binormal.z;
-			archive >> value.boneIndices.x >> value.boneIndices.y >> value.boneIndices.z >> value.boneIndices.w;
-			archive >> value.boneWeights.x >> value.boneWeights.y >> value.boneWeights.z >> value.boneWeights.w;
-		}
-	};
+	template<> struct IsTriviallySerializable<SkinnedVertex3D> : std::true_type {};
+	static_assert(sizeof(SkinnedVertex3D) == sizeof(float) * 22);
 
 	struct MeshSegment {
 		PrimitiveTopology topology = PrimitiveTopology::TriangleList;
@@ -100,6 +65,11 @@ namespace flaw {
 		float radius = 0.0f;
 	};
 
+	struct MeshBoundingBox {
+		vec3 min = vec3(0.0);
+		vec3 max = vec3(0.0);
+	};
+
 	class Mesh {
 	public:
 		Mesh() = default;
@@ -114,15 +84,19 @@ namespace flaw {
 
 			GenerateGPUResources(vertices, indices);
 			GenerateBVH(vertices, indices);
-			GenerateBoundingSphere(vertices);
+			GenerateBoundingVolumes(vertices);
 		}
 
-		Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshSegment>& segments)
+		// a prebuilt bvh, usually stored with the mesh asset, skips building one
+		Mesh(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshSegment>& segments, std::vector<BVHNode>&& bvhNodes = {}, std::vector<BVHTriangle>&& bvhTriangles = {}, std::vector<int32_t>&& bvhTriangleIndices = {})
 			: _meshSegments(segments)
+			, _bvhNodes(std::move(bvhNodes))
+			, _bvhTriangles(std::move(bvhTriangles))
+			, _bvhTriangleIndices(std::move(bvhTriangleIndices))
 		{
 			GenerateGPUResources(vertices, indices);
 			GenerateBVH(vertices, indices);
-			GenerateBoundingSphere(vertices);
+			GenerateBoundingVolumes(vertices);
 		}
 
 		Mesh(PrimitiveTopology topology, const std::vector<SkinnedVertex3D>& vertices, const std::vector<uint32_t>& indices) {
@@ -135,15 +109,19 @@ namespace flaw {
 
 			GenerateGPUResources(vertices, indices);
 			GenerateBVH(vertices, indices);
-			GenerateBoundingSphere(vertices);
+			GenerateBoundingVolumes(vertices);
 		}
 
-		Mesh(const std::vector<SkinnedVertex3D>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshSegment>& segments)
+		// a prebuilt bvh, usually stored with the mesh asset, skips building one
+		Mesh(const std::vector<SkinnedVertex3D>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshSegment>& segments, std::vector<BVHNode>&& bvhNodes = {}, std::vector<BVHTriangle>&& bvhTriangles = {}, std::vector<int32_t>&& bvhTriangleIndices = {})
 			: _meshSegments(segments)
+			, _bvhNodes(std::move(bvhNodes))
+			, _bvhTriangles(std::move(bvhTriangles))
+			, _bvhTriangleIndices(std::move(bvhTriangleIndices))
 		{
 			GenerateGPUResources(vertices, indices);
 			GenerateBVH(vertices, indices);
-			GenerateBoundingSphere(vertices);
+			GenerateBoundingVolumes(vertices);
 		}
 
 		uint32_t GetMeshSegmentCount() const {
@@ -162,6 +140,10 @@ namespace flaw {
 			return _boundingSphere;
 		}
 
+		const MeshBoundingBox& GetBoundingBox() const {
+			return _boundingBox;
+		}
+
 		Ref<VertexBuffer> GetGPUVertexBuffer() const {
 			return _gpuVertexBuffer;
 		}
@@ -178,34 +160,63 @@ namespace flaw {
 			return _bvhTriangles;
 		}
 
-	private:
+		const FlatBVH& GetFlatBVH() const {
+			return _flatBVH;
+		}
+
+		// segment and triangle in the segment a bvh triangle was built from
+		void GetBVHTriangleSource(int32_t bvhTriangleIndex, int32_t& outSegmentIndex, int32_t& outTriangleIndex) const {
+			const int32_t sourceIndex = _bvhTriangleIndices[bvhTriangleIndex];
+
+			auto it = std::upper_bound(_segmentTriangleStarts.begin(), _segmentTriangleStarts.end(), sourceIndex);
+			outSegmentIndex = static_cast<int32_t>(it - _segmentTriangleStarts.begin()) - 1;
+			outTriangleIndex = sourceIndex - _segmentTriangleStarts[outSegmentIndex];
+		}
+
+		// one bvh over the triangles of every segment
 		template<typename T>
-		void GenerateBVH(const std::vector<T>& vertices, const std::vector<uint32_t>& indices) {
-			if (vertices.empty()) {
-				return;
+		static void BuildBVH(const std::vector<T>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshSegment>& segments, std::vector<BVHNode>& outNodes, std::vector<BVHTriangle>& outTriangles, std::vector<int32_t>& outTriangleIndices, const BVHBuildSettings& settings = BVHBuildSettings(), BVHBuildStats* outStats = nullptr) {
+			std::vector<vec3> positions;
+			for (const auto& segment : segments) {
+				for (uint32_t i = 0; i < segment.indexCount; ++i) {
+					positions.push_back(vertices[segment.vertexStart + indices[segment.indexStart + i]].position);
+				}
 			}
 
-			_bvhTriangles.clear();
-			_bvhNodes.clear();
-
-			for (const auto& meshInfo : _meshSegments) {
-				std::vector<BVHNode> bvhNodes;
-				std::vector<BVHTriangle> bvhTriangles;
+			Raycast::BuildBVH(
+				[&positions](int32_t index) { return positions[index]; },
+				static_cast<int32_t>(positions.size()),
+				outNodes,
+				outTriangles,
+				settings,
+				outStats,
+				&outTriangleIndices
+			);
+		}
 
-				Raycast::BuildBVH(
-					[&vertices, &indices, meshInfo](int32_t index) { return vertices[meshInfo.vertexStart + indices[meshInfo.indexStart + index]].position; },
-					meshInfo.indexCount,
-					bvhNodes,
-					bvhTriangles
-				);
+	private:
+		// keeps a bvh given to the constructor, only the traversal layout is built then
+		template<typename T>
+		void GenerateBVH(const std::vector<T>& vertices, const std::vector<uint32_t>& indices) {
+			// bvhs stored without their source triangles are rebuilt, raycasts report the segment of a hit
+			const bool hasSources = _bvhTriangleIndices.size() == _bvhTriangles.size();
+			if ((_bvhNodes.empty() || !hasSources) && !vertices.empty()) {
+				BuildBVH(vertices, indices, _meshSegments, _bvhNodes, _bvhTriangles, _bvhTriangleIndices);
+			}
 
-				_bvhNodes.insert(_bvhNodes.end(), bvhNodes.begin(), bvhNodes.end());
-				_bvhTriangles.insert(_bvhTriangles.end(), bvhTriangles.begin(), bvhTriangles.end());
+			// segments are concatenated in order by BuildBVH
+			_segmentTriangleStarts.clear();
+			int32_t triangleStart = 0;
+			for (const auto& segment : _meshSegments) {
+				_segmentTriangleStarts.push_back(triangleStart);
+				triangleStart += segment.indexCount / 3;
 			}
+
+			Raycast::FlattenBVH(_bvhNodes, _bvhTriangles, _flatBVH);
 		}
 
 		template<typename T>
-		void GenerateBoundingSphere(const std::vector<T>& vertices) {
+		void GenerateBoundingVolumes(const std::vector<T>& vertices) {
 			if (vertices.empty()) {
 				return;
 			}
@@ -217,6 +228,9 @@ namespace flaw {
 				max = glm::max(max, vertex.position);
 			}
 
+			_boundingBox.min = min;
+			_boundingBox.max = max;
+
 			_boundingSphere.center=  (min + max) * 0.5f;
 
 			_boundingSphere.radius = 0.0f;
@@ -254,7 +268,11 @@ namespace flaw {
 
 		std::vector<BVHNode> _bvhNodes;
 		std::vector<BVHTriangle> _bvhTriangles;
+		std::vector<int32_t> _bvhTriangleIndices; // source triangle of every bvh triangle
+		std::vector<int32_t> _segmentTriangleStarts;
+		FlatBVH _flatBVH;
 
 		MeshBoundingSphere _boundingSphere;
+		MeshBoundingBox _boundingBox;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "pch.h"
+#include "MeshRaycaster.h"
+#include "Mesh.h"
+#include "Utils/JobSystem.h"
+
+#include <algorithm>
+
+namespace flaw {
+	int32_t MeshRaycaster::AddInstance(entt::entity entity, const Ref<Mesh>& mesh, const mat4& worldTransform, const AABB& worldBounds) {
+		const TopLevelBVH::Instance instance = CreateInstance(entity, mesh, worldTransform, worldBounds);
+		const int32_t instanceId = _topLevelBVH.AddInstance(instance);
+
+		SetInstanceMesh(instanceId, mesh, instance);
+
+		return instanceId;
+	}
+
+	void MeshRaycaster::UpdateInstance(int32_t instanceId, const Ref<Mesh>& mesh, const mat4& worldTransform, const AABB& worldBounds) {
+		const TopLevelBVH::Instance instance = CreateInstance(GetEntity(instanceId), mesh, worldTransform, worldBounds);
+		_topLevelBVH.UpdateInstance(instanceId, instance);
+
+		SetInstanceMesh(instanceId, mesh, instance);
+	}
+
+	void MeshRaycaster::RemoveInstance(int32_t instanceId) {
+		_topLevelBVH.RemoveInstance(instanceId);
+		_instanceMeshes[instanceId] = InstanceMesh();
+	}
+
+	void MeshRaycaster::Update() {
+		_topLevelBVH.Update();
+	}
+
+	TopLevelBVH::Instance MeshRaycaster::CreateInstance(entt::entity entity, const Ref<Mesh>& mesh, const mat4& worldTransform, const AABB& worldBounds) const {
+		TopLevelBVH::Instance instance;
+		instance.bounds = worldBounds;
+		instance.worldToLocal = inverse(worldTransform);
+		instance.bvh = &mesh->GetFlatBVH();
+		instance.userData = static_cast<uint32_t>(entity);
+		return instance;
+	}
+
+	void MeshRaycaster::SetInstanceMesh(int32_t instanceId, const Ref<Mesh>& mesh, const TopLevelBVH::Instance& instance) {
+		if (instanceId >= static_cast<int32_t>(_instanceMeshes.size())) {
+			_instanceMeshes.resize(instanceId + 1);
+		}
+
+		// raycasts read these from worker threads, they are only written here
+		_instanceMeshes[instanceId].mesh = mesh;
+		_instanceMeshes[instanceId].normalMatrix = transpose(mat3(instance.worldToLocal));
+	}
+
+	bool MeshRaycaster::Raycast(const Ray& ray, MeshRayHit& outHit) const {
+		std::vector<MeshRayHit> hits;
+		Raycast({ ray, RaycastMode::Closest }, hits);
+
+		if (hits.empty()) {
+			return false;
+		}
+
+		outHit = hits[0];
+
+		return true;
+	}
+
+	void MeshRaycaster::Raycast(const RaycastQuery& query, std::vector<MeshRayHit>& outHits) const {
+		const Ray& ray = query.ray;
+		const size_t firstHit = outHits.size();
+
+		_topLevelBVH.RaycastTriangles(ray, [&](int32_t instanceId, int32_t triangleIndex, float distance, const vec2& barycentric) {
+			const InstanceMesh& instanceMesh = _instanceMeshes[instanceId];
+			const Mesh& mesh = *instanceMesh.mesh;
+
+			MeshRayHit hit;
+			hit.entity = GetEntity(instanceId);
+			mesh.GetBVHTriangleSource(triangleIndex, hit.segmentIndex, hit.triangleIndex);
+			hit.barycentric = barycentric;
+			hit.position = ray.origin + ray.direction * distance;
+			hit.normal = normalize(instanceMesh.normalMatrix * mesh.GetBVHTriangles()[triangleIndex].normal);
+			hit.distance = distance;
+
+			switch (query.mode) {
+			case RaycastMode::Closest:
+				// traversal only reports hits within the shortened ray, this one is the nearest so far
+				if (outHits.size() == firstHit) {
+					outHits.push_back(hit);
+				}
+				else {
+					outHits.back() = hit;
+				}
+				return distance;
+			case RaycastMode::Any:
+				outHits.push_back(hit);
+				return 0.0f;
+			default:
+				outHits.push_back(hit);
+				return ray.length;
+			}
+		});
+
+		if (query.mode == RaycastMode::All) {
+			std::sort(outHits.begin() + firstHit, outHits.end(), [](const MeshRayHit& lhs, const MeshRayHit& rhs) { return lhs.distance < rhs.distance; });
+		}
+	}
+
+	void MeshRaycaster::RaycastBatch(const std::vector<RaycastQuery>& queries, RaycastBatchResult& outResult, JobSystem* jobSystem) const {
+		const int32_t queryCount = static_cast<int32_t>(queries.size());
+		const int32_t batchCount = (queryCount + RaycastBatchSize - 1) / RaycastBatchSize;
+
+		outResult.ranges.assign(queryCount, {});
+		outResult.hits.clear();
+
+		// every batch collects its own hits, ranges start relative to their batch
+		std::vector<std::vector<MeshRayHit>> batchHits(batchCount);
+
+		auto raycastBatch = [this, &queries, &outResult, &batchHits, queryCount](int32_t batchIndex) {
+			auto& hits = batchHits[batchIndex];
+
+			const int32_t begin = batchIndex * RaycastBatchSize;
+			const int32_t end = std::min(begin + RaycastBatchSize, queryCount);
+			for (int32_t i = begin; i < end; ++i) {
+				const uint32_t start = static_cast<uint32_t>(hits.size());
+				Raycast(queries[i], hits);
+				outResult.ranges[i] = { start, static_cast<uint32_t>(hits.size()) - start };
+			}
+		};
+
+		if (jobSystem) {
+			jobSystem->ParallelFor(batchCount, 1, raycastBatch);
+		}
+		else {
+			for (int32_t i = 0; i < batchCount; ++i) {
+				raycastBatch(i);
+			}
+		}
+
+		for (int32_t batchIndex = 0; batchIndex < batchCount; ++batchIndex) {
+			const uint32_t offset = static_cast<uint32_t>(outResult.hits.size());
+
+			const int32_t begin = batchIndex * RaycastBatchSize;
+			const int32_t end = std::min(begin + RaycastBatchSize, queryCount);
+			for (int32_t i = begin; i < end; ++i) {
+				outResult.ranges[i].start += offset;
+			}
+
+			outResult.hits.insert(outResult.hits.end(), batchHits[batchIndex].begin(), batchHits[batchIndex].end());
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Core.h"
+#include "ECS/ECS.h"
+#include "Math/Math.h"
+#include "Utils/Raycast.h"
+#include "Utils/TopLevelBVH.h"
+
+#include <vector>
+
+namespace flaw {
+	class Mesh;
+	class JobSystem;
+
+	enum class RaycastMode : uint8_t {
+		Closest,	// nearest hit
+		Any,		// first hit found, for visibility checks
+		All,		// every hit, nearest first
+	};
+
+	struct RaycastQuery {
+		Ray ray;
+		RaycastMode mode = RaycastMode::Closest;
+	};
+
+	struct MeshRayHit {
+		entt::entity entity = entt::null;
+		int32_t segmentIndex = -1;		// submesh
+		int32_t triangleIndex = -1;		// in the segment, its indices start at indexStart + triangleIndex * 3
+		vec2 barycentric = vec2(0.0f);	// weights of the second and third vertex
+		vec3 position;
+		vec3 normal;
+		float distance = 0.0f;
+	};
+
+	// hits of every query of a batch in query order
+	struct RaycastBatchResult {
+		struct Range {
+			uint32_t start = 0;
+			uint32_t count = 0;
+		};
+
+		std::vector<Range> ranges; // one per query
+		std::vector<MeshRayHit> hits;
+
+		bool HasHit(int32_t queryIndex) const { return ranges[queryIndex].count != 0; }
+		const MeshRayHit& GetHit(int32_t queryIndex, uint32_t index = 0) const { return hits[ranges[queryIndex].start + index]; }
+	};
+
+	// triangle level raycasts over placed meshes, the top level bvh finds the instances and their mesh bvhs the triangles
+	// skinned meshes are tested in their binding pose, nothing here touches the gpu
+	class MeshRaycaster {
+	public:
+		int32_t AddInstance(entt::entity entity, const Ref<Mesh>& mesh, const mat4& worldTransform, const AABB& worldBounds);
+		void UpdateInstance(int32_t instanceId, const Ref<Mesh>& mesh, const mat4& worldTransform, const AABB& worldBounds);
+		void RemoveInstance(int32_t instanceId);
+
+		// raycasts see the instances of the last update
+		void Update();
+
+		bool Raycast(const Ray& ray, MeshRayHit& outHit) const;
+
+		// appends the hits of one query
+		void Raycast(const RaycastQuery& query, std::vector<MeshRayHit>& outHits) const;
+
+		// queries are independent and read only, a batch is split over the job system when one is given
+		// nothing may change the raycaster while a batch runs
+		void RaycastBatch(const std::vector<RaycastQuery>& queries, RaycastBatchResult& outResult, JobSystem* jobSystem = nullptr) const;
+
+		entt::entity GetEntity(int32_t instanceId) const { return static_cast<entt::entity>(_topLevelBVH.GetUserData(instanceId)); }
+
+		const TopLevelBVH& GetTopLevelBVH() const { return _topLevelBVH; }
+
+	private:
+		TopLevelBVH::Instance CreateInstance(entt::entity entity, const Ref<Mesh>& mesh, const mat4& worldTransform, const AABB& worldBounds) const;
+		void SetInstanceMesh(int32_t instanceId, const Ref<Mesh>& mesh, const TopLevelBVH::Instance& instance);
+
+	private:
+		constexpr static int32_t RaycastBatchSize = 32;
+
+		struct InstanceMesh {
+			Ref<Mesh> mesh; // keeps the bottom level bvh of the instance alive
+			mat3 normalMatrix;
+		};
+
+		TopLevelBVH _topLevelBVH;
+		std::vector<InstanceMesh> _instanceMeshes; // by instance id
+	};
+}
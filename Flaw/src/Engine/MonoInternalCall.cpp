@@ -6,6 +6,7 @@
 #include "Assets.h"
 #include "Physics.h"
 #include "PhysicsSystem.h"
+#include "SpatialSystem.h"
 #include "AnimationSystem.h"
 #include "SkeletalSystem.h"
 
@@ -193,6 +194,17 @@ namespace flaw {
 		return Scripting::GetScene().GetPhysicsSystem().GetPhysicsScene().Raycast(ray, hit);
 	}
 
+	uint64_t Raycast_Spatial(const Ray& ray, float& distance) {
+		auto& scene = Scripting::GetScene();
+
+		entt::entity hitEntity;
+		if (!scene.GetSpatialSystem().Raycast(ray, hitEntity, distance)) {
+			return std::numeric_limits<uint64_t>::max();
+		}
+
+		return (uint64_t)Entity(hitEntity, &scene).GetUUID();
+	}
+
 	void ScreenToWorld_Camera(UUID uuid, vec2& screenPos, vec3& worldPos) {
 		auto entity = Scripting::GetScene().FindEntityByUUID(uuid);
 		FASSERT(entity, "Entity not found with UUID");
@@ -224,6 +236,44 @@ namespace flaw {
 		runtimeAnimator->PlayState(stateIndex);
 	}
 
+	static void SetParameter_Animator(UUID uuid, MonoString* name, float value) {
+		auto entity = Scripting::GetScene().FindEntityByUUID(uuid);
+		FASSERT(entity, "Entity not found with UUID");
+
+		auto& animationSys = Scripting::GetScene().GetAnimationSystem();
+		if (!animationSys.HasAnimatorJobContext(entity)) {
+			return;
+		}
+
+		auto runtimeAnimator = animationSys.GetAnimatorJobContext(entity).runtimeAnimator;
+
+		char* nameStr = mono_string_to_utf8(name);
+		const int32_t parameterIndex = runtimeAnimator->GetParameterIndex(nameStr);
+		if (parameterIndex == -1) {
+			Log::Error("Animator parameter not found: %s", nameStr);
+		}
+		else {
+			runtimeAnimator->SetFloat(parameterIndex, value);
+		}
+		mono_free(nameStr);
+	}
+
+	void SetFloat_Animator(UUID uuid, MonoString* name, float value) {
+		SetParameter_Animator(uuid, name, value);
+	}
+
+	void SetInt_Animator(UUID uuid, MonoString* name, int32_t value) {
+		SetParameter_Animator(uuid, name, static_cast<float>(value));
+	}
+
+	void SetBool_Animator(UUID uuid, MonoString* name, bool value) {
+		SetParameter_Animator(uuid, name, value ? 1.0f : 0.0f);
+	}
+
+	void SetTrigger_Animator(UUID uuid, MonoString* name) {
+		SetParameter_Animator(uuid, name, 1.0f);
+	}
+
 	void AttachEntityToSocket_SkeletalMesh(UUID uuid, UUID target, MonoString* socketName) {
 		auto entity = Scripting::GetScene().FindEntityByUUID(uuid);
 		FASSERT(entity, "Entity not found with UUID");
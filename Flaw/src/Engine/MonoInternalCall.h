@@ -41,8 +41,13 @@ namespace flaw {
 	bool GetMouseButton_Input(MouseButton button);
 
 	bool Raycast_Physics(const Ray& ray, RayHit& hit);
+	uint64_t Raycast_Spatial(const Ray& ray, float& distance);
 
 	void PlayState_Animator(UUID uuid, int32_t stateIndex);
+	void SetFloat_Animator(UUID uuid, MonoString* name, float value);
+	void SetInt_Animator(UUID uuid, MonoString* name, int32_t value);
+	void SetBool_Animator(UUID uuid, MonoString* name, bool value);
+	void SetTrigger_Animator(UUID uuid, MonoString* name);
 
 	void AttachEntityToSocket_SkeletalMesh(UUID uuid, UUID target, MonoString* socketName);
 }
@@ -3,6 +3,7 @@
 #include "Core.h"
 
 #include <string>
+#include <vector>
 
 namespace flaw {
 	struct ProjectConfig {
@@ -10,6 +11,9 @@ namespace flaw {
 		std::string path;
 
 		std::string startScene;
+
+		// mounted by Application at startup, relative to path like startScene
+		std::vector<std::string> bundles;
 	};
 
 	class Project {
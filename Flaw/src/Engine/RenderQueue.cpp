@@ -1,149 +1,283 @@
 #include "pch.h"
 #include "RenderQueue.h"
+#include "Utils/RadixSort.h"
+
+#include <cstring>
 
 namespace flaw {
+	static constexpr uint32_t DepthBits = 21;
+	static constexpr uint32_t MaterialBits = 20;
+	static constexpr uint32_t MeshBits = 20;
+	static constexpr uint32_t SegmentBits = 6;
+
+	static constexpr uint64_t DepthShift = MaterialBits + MeshBits;
+	static constexpr uint64_t RenderModeShift = DepthBits + MaterialBits + MeshBits;
+
+	// spreads pointer bits so ids rarely collide, a collision only costs batching since grouping compares pointers
+	static uint32_t HashPointer(const void* ptr, uint32_t bits) {
+		const uint64_t value = (reinterpret_cast<uint64_t>(ptr) >> 4) * 0x9E3779B97F4A7C15ull;
+		return static_cast<uint32_t>(value >> (64 - bits));
+	}
+
+	// bit pattern of a non negative float sorts the same as its value
+	static uint32_t FloatBits(float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(float));
+		return bits;
+	}
+
 	RenderQueue::RenderQueue()
-		: _currentRenderMode(RenderMode::Count)
+		: _sortByDepth(false)
+		, _viewPosition(0.0f)
+		, _currentRenderEntry(0)
 	{
-		_renderEntries.resize(uint32_t(RenderMode::Count));
 	}
 
 	void RenderQueue::Open() {
-		_currentRenderMode = RenderMode::Count;
-		_currentRenderEntry = {};
-		_currentRenderEntryEnd = {};
+		_sortByDepth = false;
+		_viewPosition = vec3(0.0f);
 
-		_materialIndexMap.clear();
-		for (int32_t i = 0; i < _renderEntries.size(); i++) {
-			_renderEntries[i].clear();
-		}
+		_frameAllocator.Reset();
+
+		_sortItems.clear();
+
+		_retainedMeshes.clear();
+		_retainedMaterials.clear();
+		_retainedBoneMatrices.clear();
+
+		_batchedDatas.clear();
+		_instancingObjects.clear();
+		_skeletalInstancingObjects.clear();
+		_renderEntries.clear();
+
+		_currentRenderEntry = 0;
+		_stats = RenderQueueStats();
 	}
 
-	void RenderQueue::Close() {
-		_currentRenderMode = RenderMode::Count;
-		for (int32_t i = 0; i < _renderEntries.size(); i++) {
-			if (_renderEntries[i].size() > 0) {
-				_currentRenderMode = (RenderMode)i;
-				_currentRenderEntry = _renderEntries[i].begin();
-				_currentRenderEntryEnd = _renderEntries[i].end();
-				break;
-			}
-		}
+	void RenderQueue::Open(const vec3& viewPosition) {
+		Open();
+
+		_sortByDepth = true;
+		_viewPosition = viewPosition;
 	}
 
-	int32_t RenderQueue::GetRenderEntryIndex(const Ref<Material>& material) {
-		int32_t entryIndex = -1;
+	uint64_t RenderQueue::MakeSortKey(const DrawPacket& packet) const {
+		uint64_t depth = 0;
 
-		auto indexIt = _materialIndexMap.find(material);
-		if (indexIt == _materialIndexMap.end()) {
-			auto& entryList = _renderEntries[uint32_t(material->renderMode)];
-			entryIndex = entryList.size();
-			_materialIndexMap[material] = entryIndex;
-			entryList.resize(entryIndex + 1);
-		}
-		else {
-			entryIndex = indexIt->second;
+		if (_sortByDepth) {
+			const vec3 toObject = vec3(packet.batchedData.worldMatrix[3]) - _viewPosition;
+			const uint32_t distanceBits = FloatBits(dot(toObject, toObject));
+
+			if (packet.material->renderMode == RenderMode::Transparent) {
+				// back to front
+				depth = ((1u << DepthBits) - 1) - (distanceBits >> (32 - DepthBits - 1));
+			}
+			else {
+				// front to back, exponent only so nearby draws with the same material stay together
+				depth = distanceBits >> 23;
+			}
 		}
 
-		return entryIndex;
+		const uint64_t renderMode = static_cast<uint64_t>(packet.material->renderMode);
+		const uint64_t material = HashPointer(packet.material, MaterialBits);
+		// skinned draws also group by bone palette, crowds sharing one instance into a single draw
+		const void* meshIdentity = packet.boneMatrices ? reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(packet.mesh) ^ reinterpret_cast<uintptr_t>(packet.boneMatrices)) : packet.mesh;
+		const uint64_t mesh = (HashPointer(meshIdentity, MeshBits - SegmentBits) << SegmentBits) | (packet.segmentIndex & ((1u << SegmentBits) - 1));
+
+		return (renderMode << RenderModeShift) | (depth << DepthShift) | (material << MeshBits) | mesh;
 	}
 
-	void RenderQueue::Push(const Ref<Mesh>& mesh, int segmentIndex, const mat4& worldMat, const Ref<Material>& material) {
-		auto& entryList = _renderEntries[uint32_t(material->renderMode)];
-		int32_t entryIndex = GetRenderEntryIndex(material);
-		
-		auto& entry = entryList[entryIndex];
-		entry.material = material;
+	void RenderQueue::PushPacket(const Ref<Mesh>& mesh, int segmentIndex, const mat4& worldMat, const Ref<Material>& material, const Ref<StructuredBuffer>& boneMatrices) {
+		DrawPacket* packet = _frameAllocator.New<DrawPacket>();
+		packet->mesh = mesh.get();
+		packet->material = material.get();
+		packet->boneMatrices = boneMatrices.get();
+		packet->meshRef = Retain(_retainedMeshes, mesh);
+		packet->materialRef = Retain(_retainedMaterials, material);
+		packet->boneMatricesRef = Retain(_retainedBoneMatrices, boneMatrices);
+		packet->segmentIndex = segmentIndex;
+		packet->batchedData.worldMatrix = worldMat;
 
-		MeshKey meshKey{ mesh, segmentIndex };
-		int32_t instanceIndex = -1;
+		_sortItems.push_back({ MakeSortKey(*packet), packet });
+	}
 
-		auto instancingIndexIt = entry.instancintIndexMap.find(meshKey);
-		if (instancingIndexIt == entry.instancintIndexMap.end()) {
-			InstancingObject instance;
-			instance.mesh = mesh;
-			instance.segmentIndex = segmentIndex;
-			instance.instanceCount = 0;
+	void RenderQueue::Close() {
+		RadixSort(_sortItems, _sortTemp, [](const SortItem& item) { return item.key; });
 
-			instanceIndex = entry.instancingObjects.size();
-			entry.instancintIndexMap[meshKey] = instanceIndex;
-			entry.instancingObjects.emplace_back(instance);
-		}
-		else {
-			instanceIndex = instancingIndexIt->second;
-		}
+		const uint32_t packetCount = static_cast<uint32_t>(_sortItems.size());
 
-		auto& instance = entry.instancingObjects[instanceIndex];
-		instance.batchedDatas.emplace_back(BatchedData{ worldMat });
-		instance.instanceCount++;
-	}
+		// reserved for the worst case so spans handed out below stay valid
+		_batchedDatas.resize(packetCount);
+		_instancingObjects.reserve(packetCount);
+		_skeletalInstancingObjects.reserve(packetCount);
+		_renderEntries.reserve(packetCount);
 
-	void RenderQueue::Push(const Ref<Mesh>& mesh, int segmentIndex, const mat4& worldMat, const Ref<Material>& material, const Ref<StructuredBuffer>& boneMatrices) {
-		auto& entryList = _renderEntries[uint32_t(material->renderMode)];
-		int32_t entryIndex = GetRenderEntryIndex(material);
+		for (uint32_t i = 0; i < packetCount; ++i) {
+			const DrawPacket& packet = *_sortItems[i].packet;
+
+			BatchedData* batchedData = &_batchedDatas[i];
+			*batchedData = packet.batchedData;
+
+			if (_renderEntries.empty() || _renderEntries.back().material.get() != packet.material) {
+				RenderEntry entry;
+				entry.material = _retainedMaterials[packet.materialRef];
+				entry.instancingObjects.first = _instancingObjects.data() + _instancingObjects.size();
+				entry.skeletalInstancingObjects.first = _skeletalInstancingObjects.data() + _skeletalInstancingObjects.size();
+
+				_renderEntries.push_back(entry);
+			}
+
+			auto& entry = _renderEntries.back();
+
+			if (!packet.boneMatrices) {
+				auto& objects = entry.instancingObjects;
+
+				if (!objects.empty()) {
+					auto& last = objects.first[objects.count - 1];
+					if (last.mesh.get() == packet.mesh && last.segmentIndex == packet.segmentIndex && last.batchedDatas + last.instanceCount == batchedData) {
+						last.instanceCount++;
+						continue;
+					}
+				}
+
+				InstancingObject instance;
+				instance.mesh = _retainedMeshes[packet.meshRef];
+				instance.segmentIndex = packet.segmentIndex;
+				instance.batchedDatas = batchedData;
+				instance.instanceCount = 1;
 
-		auto& entry = entryList[entryIndex];
-		entry.material = material;
+				_instancingObjects.push_back(std::move(instance));
+				objects.count++;
+			}
+			else {
+				auto& objects = entry.skeletalInstancingObjects;
 
-		SkeletalMeshKey meshKey{ mesh, segmentIndex, boneMatrices };
-		int32_t instanceIndex = -1;
+				if (!objects.empty()) {
+					auto& last = objects.first[objects.count - 1];
+					if (last.mesh.get() == packet.mesh && last.segmentIndex == packet.segmentIndex && last.skeletonBoneMatrices.get() == packet.boneMatrices && last.batchedDatas + last.instanceCount == batchedData) {
+						last.instanceCount++;
+						continue;
+					}
+				}
 
-		auto skeletalInstancingIndexIt = entry.skeletalInstancingIndexMap.find(meshKey);
-		if (skeletalInstancingIndexIt == entry.skeletalInstancingIndexMap.end()) {
-			SkeletalInstancingObject instance;
-			instance.mesh = mesh;
-			instance.segmentIndex = segmentIndex;
-			instance.skeletonBoneMatrices = boneMatrices;
+				SkeletalInstancingObject instance;
+				instance.mesh = _retainedMeshes[packet.meshRef];
+				instance.segmentIndex = packet.segmentIndex;
+				instance.batchedDatas = batchedData;
+				instance.skeletonBoneMatrices = _retainedBoneMatrices[packet.boneMatricesRef];
+				instance.instanceCount = 1;
 
-			instanceIndex = entry.skeletalInstancingObjects.size();
-			entry.skeletalInstancingIndexMap[meshKey] = instanceIndex;
-			entry.skeletalInstancingObjects.emplace_back(instance);
+				_skeletalInstancingObjects.push_back(std::move(instance));
+				objects.count++;
+			}
 		}
-		else {
-			instanceIndex = skeletalInstancingIndexIt->second;
+
+		_stats.drawCount = static_cast<uint32_t>(_instancingObjects.size() + _skeletalInstancingObjects.size());
+		_stats.instanceCount = packetCount;
+		_stats.skinnedDrawCount = static_cast<uint32_t>(_skeletalInstancingObjects.size());
+		for (const auto& instance : _skeletalInstancingObjects) {
+			_stats.skinnedInstanceCount += instance.instanceCount;
 		}
 
-		auto& instance = entry.skeletalInstancingObjects[instanceIndex];
-		instance.batchedDatas.emplace_back(BatchedData{ worldMat });
-		instance.instanceCount++;
+		_currentRenderEntry = 0;
+	}
+
+	void RenderQueue::Push(const Ref<Mesh>& mesh, int segmentIndex, const mat4& worldMat, const Ref<Material>& material) {
+		PushPacket(mesh, segmentIndex, worldMat, material, nullptr);
+	}
+
+	void RenderQueue::Push(const Ref<Mesh>& mesh, int segmentIndex, const mat4& worldMat, const Ref<Material>& material, const Ref<StructuredBuffer>& boneMatrices) {
+		PushPacket(mesh, segmentIndex, worldMat, material, boneMatrices);
 	}
 
 	void RenderQueue::Push(const Ref<Mesh>& mesh, const mat4& worldMat, const Ref<Material>& material) {
-		int32_t segmentIdx = 0;
-		for (auto& segment : mesh->GetMeshSegments()) {
-			Push(mesh, segmentIdx, worldMat, material);
-			segmentIdx++;
+		for (uint32_t segmentIdx = 0; segmentIdx < mesh->GetMeshSegmentCount(); ++segmentIdx) {
+			PushPacket(mesh, segmentIdx, worldMat, material, nullptr);
 		}
 	}
 
 	void RenderQueue::Push(const Ref<Mesh>& mesh, const mat4& worldMat, const Ref<Material>& material, const Ref<StructuredBuffer>& boneMatrices) {
-		int32_t segmentIdx = 0;
-		for (auto& segment : mesh->GetMeshSegments()) {
-			Push(mesh, segmentIdx, worldMat, material, boneMatrices);
-			segmentIdx++;
+		for (uint32_t segmentIdx = 0; segmentIdx < mesh->GetMeshSegmentCount(); ++segmentIdx) {
+			PushPacket(mesh, segmentIdx, worldMat, material, boneMatrices);
 		}
 	}
 
 	void RenderQueue::Pop() {
-		FASSERT(_currentRenderMode != RenderMode::Count, "RenderQueue is empty");
-		if (++_currentRenderEntry == _currentRenderEntryEnd) {
-			do {
-				_currentRenderMode = (RenderMode)(uint32_t(_currentRenderMode) + 1);
-				if (_currentRenderMode == RenderMode::Count) {
-					break;
-				}
-				_currentRenderEntry = _renderEntries[uint32_t(_currentRenderMode)].begin();
-				_currentRenderEntryEnd = _renderEntries[uint32_t(_currentRenderMode)].end();
-			} while (_currentRenderEntry == _currentRenderEntryEnd);
-		}
+		FASSERT(_currentRenderEntry < _renderEntries.size(), "RenderQueue is empty");
+		_currentRenderEntry++;
 	}
 
 	bool RenderQueue::Empty() {
-		return _currentRenderMode == RenderMode::Count;
+		return _currentRenderEntry >= _renderEntries.size();
 	}
 
 	RenderEntry& RenderQueue::Front() {
-		FASSERT(_currentRenderMode != RenderMode::Count, "RenderQueue is empty");
-		return *_currentRenderEntry;
+		FASSERT(_currentRenderEntry < _renderEntries.size(), "RenderQueue is empty");
+		return _renderEntries[_currentRenderEntry];
+	}
+
+	void BindMaterialTextures(GraphicsCommandQueue& cmdQueue, const Material& material) {
+		if (material.albedoTexture) {
+			cmdQueue.SetTexture(material.albedoTexture, ReservedTextureStartSlot);
+		}
+		if (material.normalTexture) {
+			cmdQueue.SetTexture(material.normalTexture, ReservedTextureStartSlot + 1);
+		}
+		if (material.emissiveTexture) {
+			cmdQueue.SetTexture(material.emissiveTexture, ReservedTextureStartSlot + 2);
+		}
+		if (material.heightTexture) {
+			cmdQueue.SetTexture(material.heightTexture, ReservedTextureStartSlot + 3);
+		}
+		if (material.metallicTexture) {
+			cmdQueue.SetTexture(material.metallicTexture, ReservedTextureStartSlot + 4);
+		}
+		if (material.roughnessTexture) {
+			cmdQueue.SetTexture(material.roughnessTexture, ReservedTextureStartSlot + 5);
+		}
+		if (material.ambientOcclusionTexture) {
+			cmdQueue.SetTexture(material.ambientOcclusionTexture, ReservedTextureStartSlot + 6);
+		}
+		for (uint32_t i = 0; i < material.cubeTextures.size(); ++i) {
+			if (material.cubeTextures[i]) {
+				cmdQueue.SetTexture(material.cubeTextures[i], CubeTextureStartSlot + i);
+			}
+		}
+		for (uint32_t i = 0; i < material.textureArrays.size(); ++i) {
+			if (material.textureArrays[i]) {
+				cmdQueue.SetTexture(material.textureArrays[i], TextureArrayStartSlot + i);
+			}
+		}
+	}
+
+	void DrawInstancingObjects(GraphicsCommandQueue& cmdQueue, const RenderEntry& entry, const Ref<StructuredBuffer>& batchedDataSB) {
+		for (const auto& obj : entry.instancingObjects) {
+			const auto& mesh = obj.mesh;
+			const auto& meshSegment = mesh->GetMeshSegementAt(obj.segmentIndex);
+
+			batchedDataSB->Update(obj.batchedDatas, obj.instanceCount * sizeof(BatchedData));
+
+			cmdQueue.SetPrimitiveTopology(meshSegment.topology);
+			cmdQueue.SetVertexBuffer(mesh->GetGPUVertexBuffer());
+			cmdQueue.DrawIndexedInstanced(mesh->GetGPUIndexBuffer(), meshSegment.indexCount, obj.instanceCount, meshSegment.indexStart, meshSegment.vertexStart);
+
+			cmdQueue.Execute();
+		}
+	}
+
+	void DrawSkeletalInstancingObjects(GraphicsCommandQueue& cmdQueue, const RenderEntry& entry, const Ref<StructuredBuffer>& batchedDataSB, uint32_t boneMatricesSlot) {
+		for (const auto& obj : entry.skeletalInstancingObjects) {
+			const auto& mesh = obj.mesh;
+			const auto& meshSegment = mesh->GetMeshSegementAt(obj.segmentIndex);
+
+			batchedDataSB->Update(obj.batchedDatas, obj.instanceCount * sizeof(BatchedData));
+
+			cmdQueue.SetPrimitiveTopology(meshSegment.topology);
+			cmdQueue.SetStructuredBuffer(obj.skeletonBoneMatrices, boneMatricesSlot);
+			cmdQueue.SetVertexBuffer(mesh->GetGPUVertexBuffer());
+			cmdQueue.DrawIndexedInstanced(mesh->GetGPUIndexBuffer(), meshSegment.indexCount, obj.instanceCount, meshSegment.indexStart, meshSegment.vertexStart);
+
+			cmdQueue.Execute();
+		}
 	}
-}
\ No newline at end of file
+}
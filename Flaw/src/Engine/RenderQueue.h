@@ -5,53 +5,29 @@
 #include "Mesh.h"
 #include "Material.h"
 #include "Skeleton.h"
+#include "Utils/LinearAllocator.h"
 
-#include <map>
 #include <vector>
 
 namespace flaw {
-	struct MeshKey {
-		Ref<Mesh> mesh;
-		int32_t segmentIndex = 0;
-
-		bool operator==(const MeshKey& other) const {
-			return mesh == other.mesh && segmentIndex == other.segmentIndex;
-		};
-	};
-	
-	struct SkeletalMeshKey {
-		Ref<Mesh> mesh;
-		int32_t segmentIndex = 0;
-		Ref<StructuredBuffer> skeletonBoneMatrices;
-
-		bool operator==(const SkeletalMeshKey& other) const {
-			return mesh == other.mesh && segmentIndex == other.segmentIndex && skeletonBoneMatrices == other.skeletonBoneMatrices;
-		}
-	};
-}
+	template<typename T>
+	struct RenderSpan {
+		T* first = nullptr;
+		uint32_t count = 0;
 
-namespace std {
-	template<>
-	struct hash<flaw::MeshKey> {
-		size_t operator()(const flaw::MeshKey& key) const {
-			return hash<flaw::Ref<flaw::Mesh>>()(key.mesh) ^ hash<int32_t>()(key.segmentIndex);
-		}
-	};
+		T* begin() const { return first; }
+		T* end() const { return first + count; }
 
-	template <>
-	struct hash<flaw::SkeletalMeshKey> {
-		size_t operator()(const flaw::SkeletalMeshKey& key) const {
-			return hash<flaw::Ref<flaw::Mesh>>()(key.mesh) ^ hash<int32_t>()(key.segmentIndex) ^ hash<flaw::Ref<flaw::StructuredBuffer>>()(key.skeletonBoneMatrices);
-		}
+		uint32_t size() const { return count; }
+		bool empty() const { return count == 0; }
 	};
-}
 
-namespace flaw {
 	struct InstancingObject {
 		Ref<Mesh> mesh;
 		int32_t segmentIndex = 0;
 
-		std::vector<BatchedData> batchedDatas;
+		// points into the queue's per frame batched data, valid until the next Open
+		const BatchedData* batchedDatas = nullptr;
 		uint32_t instanceCount = 0;
 	};
 
@@ -59,26 +35,36 @@ namespace flaw {
 		Ref<Mesh> mesh;
 		int32_t segmentIndex = 0;
 
-		std::vector<BatchedData> batchedDatas;
+		const BatchedData* batchedDatas = nullptr;
 		Ref<StructuredBuffer> skeletonBoneMatrices;
 		uint32_t instanceCount = 0;
 	};
 
+	struct RenderQueueStats {
+		uint32_t drawCount = 0;				// instanced draws after batching
+		uint32_t instanceCount = 0;
+		uint32_t skinnedDrawCount = 0;		// crowds sharing a palette take one draw per mesh segment
+		uint32_t skinnedInstanceCount = 0;
+	};
+
 	struct RenderEntry {
 		Ref<Material> material;
 
-		std::unordered_map<MeshKey, int32_t> instancintIndexMap;
-		std::vector<InstancingObject> instancingObjects;
-
-		std::unordered_map<SkeletalMeshKey, int32_t> skeletalInstancingIndexMap;
-		std::vector<SkeletalInstancingObject> skeletalInstancingObjects;
+		RenderSpan<InstancingObject> instancingObjects;
+		RenderSpan<SkeletalInstancingObject> skeletalInstancingObjects;
 	};
 
+	// draws are recorded as 64 bit sort keys and radix sorted on Close
+	// key layout (msb to lsb): render mode 3 | depth 21 | material 20 | mesh, bone palette and segment 20
+	// opaque and masked draws use a coarse front to back depth so draws sharing a material still batch,
+	// transparent draws are sorted back to front
 	class RenderQueue {
 	public:
 		RenderQueue();
 
+		// without a view position draws are only grouped by material and mesh
 		void Open();
+		void Open(const vec3& viewPosition);
 		void Close();
 
 		void Push(const Ref<Mesh>& mesh, int segmentIndex, const mat4& worldMat, const Ref<Material>& material);
@@ -91,16 +77,64 @@ namespace flaw {
 
 		RenderEntry& Front();
 
+		// counted by Close
+		const RenderQueueStats& GetStats() const { return _stats; }
+
 	private:
-		int32_t GetRenderEntryIndex(const Ref<Material>& material);
+		// allocated from the frame allocator, raw pointers are kept alive by the retained refs below
+		struct DrawPacket {
+			Mesh* mesh;
+			Material* material;
+			StructuredBuffer* boneMatrices;
+			uint32_t meshRef, materialRef, boneMatricesRef; // indices into the retained refs
+			int32_t segmentIndex;
+			BatchedData batchedData;
+		};
+
+		struct SortItem {
+			uint64_t key;
+			DrawPacket* packet;
+		};
+
+		void PushPacket(const Ref<Mesh>& mesh, int segmentIndex, const mat4& worldMat, const Ref<Material>& material, const Ref<StructuredBuffer>& boneMatrices);
+
+		uint64_t MakeSortKey(const DrawPacket& packet) const;
+
+		// pushes usually repeat the same mesh and material, only consecutive duplicates are skipped
+		template<typename T>
+		uint32_t Retain(std::vector<Ref<T>>& retained, const Ref<T>& ref) {
+			if (retained.empty() || retained.back() != ref) {
+				retained.push_back(ref);
+			}
+			return static_cast<uint32_t>(retained.size()) - 1;
+		}
 
 	private:
-		std::unordered_map<Ref<Material>, int32_t> _materialIndexMap;
-		std::vector<std::vector<RenderEntry>> _renderEntries;
+		LinearAllocator _frameAllocator;
+
+		bool _sortByDepth;
+		vec3 _viewPosition;
+
+		std::vector<SortItem> _sortItems;
+		std::vector<SortItem> _sortTemp;
+
+		std::vector<Ref<Mesh>> _retainedMeshes;
+		std::vector<Ref<Material>> _retainedMaterials;
+		std::vector<Ref<StructuredBuffer>> _retainedBoneMatrices;
 
-		RenderMode _currentRenderMode;
-		std::vector<RenderEntry>::iterator _currentRenderEntry;
-		std::vector<RenderEntry>::iterator _currentRenderEntryEnd;
+		std::vector<BatchedData> _batchedDatas;
+		std::vector<InstancingObject> _instancingObjects;
+		std::vector<SkeletalInstancingObject> _skeletalInstancingObjects;
+		std::vector<RenderEntry> _renderEntries;
+
+		uint32_t _currentRenderEntry;
+		RenderQueueStats _stats;
 	};
-}
 
+	// binds every texture the material has to the reserved, cube and array slots the shaders expect
+	void BindMaterialTextures(GraphicsCommandQueue& cmdQueue, const Material& material);
+
+	// one instanced draw per object, the instances of each draw are uploaded to batchedDataSB first
+	void DrawInstancingObjects(GraphicsCommandQueue& cmdQueue, const RenderEntry& entry, const Ref<StructuredBuffer>& batchedDataSB);
+	void DrawSkeletalInstancingObjects(GraphicsCommandQueue& cmdQueue, const RenderEntry& entry, const Ref<StructuredBuffer>& batchedDataSB, uint32_t boneMatricesSlot);
+}
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "RenderSystem.h"
 #include "Scene.h"
+#include "Application.h"
 #include "Components.h"
 #include "AssetManager.h"
 #include "Assets.h"
@@ -11,6 +12,7 @@
 #include "ShadowSystem.h"
 #include "SkyBoxSystem.h"
 #include "SkeletalSystem.h"
+#include "SpatialSystem.h"
 
 // TODO: remove this
 #include "Renderer2D.h"
@@ -252,13 +254,21 @@ namespace flaw {
 	}
 
 	void RenderSystem::Update() {
-		// set camera render stages
-		_renderStages.clear();
+		// set camera render stages, kept between frames so their queues and culling buffers keep their memory
+		for (auto& [depth, stage] : _renderStages) {
+			stage.active = false;
+		}
+
 		for (auto&& [entity, transformComp, cameraComp] : _scene.GetRegistry().view<TransformComponent, CameraComponent>().each()) {
+			auto& stage = _renderStages[cameraComp.depth];
+			if (stage.active) {
+				continue; // first camera with this depth wins
+			}
+
 			const vec3 position = transformComp.GetWorldPosition();
 			const vec3 lookDirection = transformComp.GetWorldFront();
 
-			CameraRenderStage stage;
+			stage.active = true;
 			stage.cameraPosition = position;
 			stage.viewMatrix = LookAt(position, position + lookDirection, Up);
 
@@ -270,31 +280,46 @@ namespace flaw {
 				const float height = cameraComp.orthoSize;
 				const float width = height * cameraComp.aspectRatio;
 				stage.projectionMatrix = Orthographic(-width, width, -height, height, cameraComp.nearClip, cameraComp.farClip);
-				// TODO: orthographic frustum
+				CreateOrthographicFrustum(-width, width, -height, height, cameraComp.nearClip, cameraComp.farClip, stage.viewMatrix, stage.frustum);
 			}
-
-			_renderStages.emplace(cameraComp.depth, std::move(stage));
 		}
 
+		RemoveInactiveRenderStages();
+
 		UpdateSystems();
 	}
 
 	void RenderSystem::Update(Ref<Camera> camera) {
 		// set camera render stages
-		_renderStages.clear();
-		CameraRenderStage stage;
+		for (auto& [depth, stage] : _renderStages) {
+			stage.active = false;
+		}
+
+		auto& stage = _renderStages[0];
+		stage.active = true;
 		stage.cameraPosition = camera->GetPosition();
 		stage.viewMatrix = camera->GetViewMatrix();
 		stage.projectionMatrix = camera->GetProjectionMatrix();
 		stage.frustum = camera->GetFrustum();
-		_renderStages.emplace(0, std::move(stage));
+
+		RemoveInactiveRenderStages();
 
 		UpdateSystems();
 	}
 
+	void RenderSystem::RemoveInactiveRenderStages() {
+		for (auto it = _renderStages.begin(); it != _renderStages.end();) {
+			if (it->second.active) {
+				++it;
+			}
+			else {
+				it = _renderStages.erase(it);
+			}
+		}
+	}
+
 	void RenderSystem::UpdateSystems() {
 		_scene.GetLandscapeSystem().Update();
-		_scene.GetParticleSystem().Update();
 		_scene.GetSkyBoxSystem().Update();
 		_scene.GetShadowSystem().Update();
 
@@ -353,81 +378,129 @@ namespace flaw {
 		}
 	}
 
+	// fraction of the screen height the bounding sphere covers
+	static float GetScreenSize(const CameraRenderStage& stage, const vec3& center, float radius) {
+		const float projectedRadius = radius * stage.projectionMatrix[1][1];
+		if (stage.projectionMatrix[3][3] == 1.0f) {
+			return projectedRadius; // orthographic, distance does not matter
+		}
+
+		return projectedRadius / std::max(length(center - stage.cameraPosition), 0.0001f);
+	}
+
 	void RenderSystem::GatherRenderableObjects() {
 		auto& enttRegistry = _scene.GetRegistry();
 		auto& animationSys = _scene.GetAnimationSystem();
 		auto& skeletalSys = _scene.GetSkeletalSystem();
+		auto& spatialSys = _scene.GetSpatialSystem();
+		auto& jobSystem = _scene.GetApplication().GetJobSystem();
 
+		// the scene tree gives a coarse list per camera, candidates are collected once and culled exactly per stage below
+		_spatialEntities.clear();
 		for (auto& [depth, stage] : _renderStages) {
-			stage.renderQueue.Open();
+			spatialSys.QueryFrustum(stage.frustum, _spatialEntities);
+		}
 
-			// submit mesh
-			for (auto&& [entity, transform, staticMeshCom] : enttRegistry.view<TransformComponent, StaticMeshComponent>().each()) {
-				auto meshAsset = AssetManager::GetAsset<StaticMeshAsset>(staticMeshCom.mesh);
-				if (meshAsset == nullptr) {
-					continue;
-				}
+		if (_renderStages.size() > 1) {
+			std::sort(_spatialEntities.begin(), _spatialEntities.end());
+			_spatialEntities.erase(std::unique(_spatialEntities.begin(), _spatialEntities.end()), _spatialEntities.end());
+		}
 
-				Ref<Mesh> mesh = meshAsset->GetMesh();
+		_cullingCandidates.clear();
 
-				// NOTE: test frustums with sphere, but in the future, may be need secondary frustum check for bounding cube.
-				auto& boundingSphere = mesh->GetBoundingSphere();
-				if (!stage.frustum.TestInside(boundingSphere.center, boundingSphere.radius, transform.worldTransform)) {
-					continue;
-				}
+		for (entt::entity entity : _spatialEntities) {
+			auto& transform = enttRegistry.get<TransformComponent>(entity);
 
-				for (int32_t i = 0; i < mesh->GetMeshSegmentCount(); ++i) {
-					auto& materialHandle = staticMeshCom.materials[i];
-					auto materialAsset = AssetManager::GetAsset<MaterialAsset>(materialHandle);
-					if (!materialAsset) {
-						continue;
-					}
-					stage.renderQueue.Push(mesh, i, transform.worldTransform, materialAsset->GetMaterial());
+			if (auto staticMeshCom = enttRegistry.try_get<StaticMeshComponent>(entity)) {
+				auto meshAsset = AssetManager::GetAsset<StaticMeshAsset>(staticMeshCom->mesh);
+				if (meshAsset) {
+					_cullingCandidates.push_back({ entity, &transform.worldTransform, meshAsset->GetMesh(), false });
 				}
 			}
 
-			for (auto&& [entity, transform, skeletalMeshComp] : enttRegistry.view<TransformComponent, SkeletalMeshComponent>().each()) {
-				auto meshAsset = AssetManager::GetAsset<SkeletalMeshAsset>(skeletalMeshComp.mesh);
-				if (meshAsset == nullptr) {
-					continue;
+			if (auto skeletalMeshComp = enttRegistry.try_get<SkeletalMeshComponent>(entity)) {
+				auto meshAsset = AssetManager::GetAsset<SkeletalMeshAsset>(skeletalMeshComp->mesh);
+				if (meshAsset) {
+					_cullingCandidates.push_back({ entity, &transform.worldTransform, meshAsset->GetMesh(), true });
 				}
+			}
+		}
 
-				Ref<Mesh> mesh = meshAsset->GetMesh();
+		const int32_t candidateCount = static_cast<int32_t>(_cullingCandidates.size());
 
-				// NOTE: test frustums with sphere, but in the future, may be need secondary frustum check for bounding cube.
-				auto& boundingSphere = mesh->GetBoundingSphere();
-				if (!stage.frustum.TestInside(boundingSphere.center, boundingSphere.radius, transform.worldTransform)) {
-					continue;
-				}
+		_cullingVolumes.Resize(candidateCount);
+		jobSystem.ParallelFor(candidateCount, CullingVolumeBatchSize, [this](int32_t i) {
+			const auto& candidate = _cullingCandidates[i];
+			const auto& boundingSphere = candidate.mesh->GetBoundingSphere();
+			const auto& boundingBox = candidate.mesh->GetBoundingBox();
 
-				Ref<StructuredBuffer> boneMatricesSB;
+			_cullingVolumes.Set(i, boundingSphere.center, boundingSphere.radius, boundingBox.min, boundingBox.max, *candidate.worldTransform);
+		});
 
-				auto skeletonAsset = AssetManager::GetAsset<SkeletonAsset>(meshAsset->GetSkeletonHandle());
-				if (!skeletonAsset) {
-					continue;
-				}
+		// every camera is culled at the same time, each one split into batches
+		JobCounter cullingCounter;
+		for (auto& [depth, stage] : _renderStages) {
+			stage.cullTask.Schedule(jobSystem, cullingCounter, stage.frustum, _cullingVolumes);
+		}
+		jobSystem.Wait(cullingCounter);
+
+		for (auto& [depth, stage] : _renderStages) {
+			stage.cullTask.Finish();
+
+			stage.renderQueue.Open(stage.cameraPosition);
+
+			for (uint32_t index : stage.cullTask.GetVisibleIndices()) {
+				const auto& candidate = _cullingCandidates[index];
+				const auto& mesh = candidate.mesh;
 
-				if (animationSys.HasAnimatorJobContext(entity)) {
-					boneMatricesSB = animationSys.GetAnimatorJobContext(entity).animatedSkinMatricesSB;
+				if (!candidate.skeletal) {
+					auto& staticMeshCom = enttRegistry.get<StaticMeshComponent>(candidate.entity);
+
+					for (int32_t i = 0; i < mesh->GetMeshSegmentCount(); ++i) {
+						auto& materialHandle = staticMeshCom.materials[i];
+						auto materialAsset = AssetManager::GetAsset<MaterialAsset>(materialHandle);
+						if (!materialAsset) {
+							continue;
+						}
+						stage.renderQueue.Push(mesh, i, *candidate.worldTransform, materialAsset->GetMaterial());
+					}
 				}
 				else {
-					auto& skeletonUniforms = skeletalSys.GetSkeletonUniforms(skeletonAsset->GetSkeleton());
-					boneMatricesSB = skeletonUniforms.bindingPoseSkinMatricesSB;
-				}
+					auto& skeletalMeshComp = enttRegistry.get<SkeletalMeshComponent>(candidate.entity);
+					auto meshAsset = AssetManager::GetAsset<SkeletalMeshAsset>(skeletalMeshComp.mesh);
 
-				if (!boneMatricesSB) {
-					continue;
-				}
+					Ref<StructuredBuffer> boneMatricesSB;
+
+					auto skeletonAsset = AssetManager::GetAsset<SkeletonAsset>(meshAsset->GetSkeletonHandle());
+					if (!skeletonAsset) {
+						continue;
+					}
 
-				for (int32_t i = 0; i < mesh->GetMeshSegmentCount(); ++i) {
-					auto& materialHandle = skeletalMeshComp.materials[i];
+					if (animationSys.HasAnimatorJobContext(candidate.entity)) {
+						boneMatricesSB = animationSys.GetAnimatedSkinMatricesSB(candidate.entity);
 
-					auto materialAsset = AssetManager::GetAsset<MaterialAsset>(materialHandle);
-					if (!materialAsset) {
+						const vec3 center(_cullingVolumes.CenterX()[index], _cullingVolumes.CenterY()[index], _cullingVolumes.CenterZ()[index]);
+						animationSys.ReportScreenSize(candidate.entity, GetScreenSize(stage, center, _cullingVolumes.Radius()[index]));
+					}
+					else {
+						auto& skeletonUniforms = skeletalSys.GetSkeletonUniforms(skeletonAsset->GetSkeleton());
+						boneMatricesSB = skeletonUniforms.bindingPoseSkinMatricesSB;
+					}
+
+					if (!boneMatricesSB) {
 						continue;
 					}
 
-					stage.renderQueue.Push(mesh, i, transform.worldTransform, materialAsset->GetMaterial(), boneMatricesSB);
+					for (int32_t i = 0; i < mesh->GetMeshSegmentCount(); ++i) {
+						auto& materialHandle = skeletalMeshComp.materials[i];
+
+						auto materialAsset = AssetManager::GetAsset<MaterialAsset>(materialHandle);
+						if (!materialAsset) {
+							continue;
+						}
+
+						stage.renderQueue.Push(mesh, i, *candidate.worldTransform, materialAsset->GetMaterial(), boneMatricesSB);
+					}
 				}
 			}
 
@@ -507,67 +580,12 @@ namespace flaw {
 			cmdQueue.SetConstantBuffer(materialCB, 3);
 			cmdQueue.SetStructuredBuffer(batchedTransformSB, 0);
 
-			if (entry.material->albedoTexture) {
-				cmdQueue.SetTexture(entry.material->albedoTexture, ReservedTextureStartSlot);
-			}
-			if (entry.material->normalTexture) {
-				cmdQueue.SetTexture(entry.material->normalTexture, ReservedTextureStartSlot + 1);
-			}
-			if (entry.material->emissiveTexture) {
-				cmdQueue.SetTexture(entry.material->emissiveTexture, ReservedTextureStartSlot + 2);
-			}
-			if (entry.material->heightTexture) {
-				cmdQueue.SetTexture(entry.material->heightTexture, ReservedTextureStartSlot + 3);
-			}
-			if (entry.material->metallicTexture) {
-				cmdQueue.SetTexture(entry.material->metallicTexture, ReservedTextureStartSlot + 4);
-			}
-			if (entry.material->roughnessTexture) {
-				cmdQueue.SetTexture(entry.material->roughnessTexture, ReservedTextureStartSlot + 5);
-			}
-			if (entry.material->ambientOcclusionTexture) {
-				cmdQueue.SetTexture(entry.material->ambientOcclusionTexture, ReservedTextureStartSlot + 6);
-			}
-			for (int32_t i = 0; i < entry.material->cubeTextures.size(); ++i) {
-				if (entry.material->cubeTextures[i]) {
-					cmdQueue.SetTexture(entry.material->cubeTextures[i], CubeTextureStartSlot + i);
-				}
-			}
-			for (int32_t i = 0; i < entry.material->textureArrays.size(); ++i) {
-				if (entry.material->textureArrays[i]) {
-					cmdQueue.SetTexture(entry.material->textureArrays[i], TextureArrayStartSlot + i);
-				}
-			}
+			BindMaterialTextures(cmdQueue, *entry.material);
 
 			cmdQueue.Execute();
 
-			// instancing draw
-			for (auto& obj : entry.instancingObjects) {
-				auto& mesh = obj.mesh;
-				auto& meshSegment = mesh->GetMeshSegementAt(obj.segmentIndex);
-
-				batchedTransformSB->Update(obj.batchedDatas.data(), obj.batchedDatas.size() * sizeof(BatchedData));
-
-				cmdQueue.SetPrimitiveTopology(meshSegment.topology);
-				cmdQueue.SetVertexBuffer(mesh->GetGPUVertexBuffer());
-				cmdQueue.DrawIndexedInstanced(mesh->GetGPUIndexBuffer(), meshSegment.indexCount, obj.instanceCount, meshSegment.indexStart, meshSegment.vertexStart);
-
-				cmdQueue.Execute();
-			}
-
-			// skeletal mesh draw
-			for (auto& obj : entry.skeletalInstancingObjects) {
-				auto& mesh = obj.mesh;
-				auto& meshSegment = mesh->GetMeshSegementAt(obj.segmentIndex);
-
-				batchedTransformSB->Update(obj.batchedDatas.data(), obj.batchedDatas.size() * sizeof(BatchedData));
-
-				cmdQueue.SetPrimitiveTopology(meshSegment.topology);
-				cmdQueue.SetStructuredBuffer(obj.skeletonBoneMatrices, 1);
-				cmdQueue.SetVertexBuffer(mesh->GetGPUVertexBuffer());
-				cmdQueue.DrawIndexedInstanced(mesh->GetGPUIndexBuffer(), meshSegment.indexCount, obj.instanceCount, meshSegment.indexStart, meshSegment.vertexStart);
-				cmdQueue.Execute();
-			}
+			DrawInstancingObjects(cmdQueue, entry, batchedTransformSB);
+			DrawSkeletalInstancingObjects(cmdQueue, entry, batchedTransformSB, 1);
 
 			stage.renderQueue.Pop();
 		}
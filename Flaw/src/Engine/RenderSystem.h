@@ -4,6 +4,8 @@
 #include "Graphics.h"
 #include "RenderQueue.h"
 #include "Camera.h"
+#include "ECS/ECS.h"
+#include "Math/FrustumCulling.h"
 
 #include <map>
 #include <vector>
@@ -18,8 +20,11 @@ namespace flaw {
 		mat4 projectionMatrix;
 
 		Frustum frustum;
+		FrustumCullTask cullTask;
 
 		RenderQueue renderQueue;
+
+		bool active = false;
 	};
 
 	class RenderSystem {
@@ -36,6 +41,8 @@ namespace flaw {
 		void CreateConstantBuffers();
 		void CreateStructuredBuffers();
 
+		void RemoveInactiveRenderStages();
+
 		void UpdateSystems();
 
 		void GatherLights();
@@ -50,6 +57,7 @@ namespace flaw {
 
 	private:
 		constexpr static uint32_t MaxDecalCount = 1000;
+		constexpr static int32_t CullingVolumeBatchSize = 512;
 
 		Scene& _scene;
 
@@ -75,6 +83,17 @@ namespace flaw {
 
 		std::map<uint32_t, CameraRenderStage> _renderStages;
 
+		struct CullingCandidate {
+			entt::entity entity;
+			const mat4* worldTransform;
+			Ref<Mesh> mesh;
+			bool skeletal;
+		};
+
+		std::vector<entt::entity> _spatialEntities;
+		std::vector<CullingCandidate> _cullingCandidates;
+		CullingVolumes _cullingVolumes;
+
 		Ref<ConstantBuffer> _vpCB;
 		Ref<ConstantBuffer> _lightCB;
 
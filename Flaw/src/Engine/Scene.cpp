@@ -3,9 +3,11 @@
 #include "Components.h"
 #include "Entity.h"
 #include "Serialization.h"
+#include "SceneBinary.h"
 #include "Physics/Physics2D.h"
 #include "Time/Time.h"
 #include "Platform/PlatformEvents.h"
+#include "Platform/FileSystem.h"
 #include "ParticleSystem.h"
 #include "RenderSystem.h"
 #include "SkyBoxSystem.h"
@@ -16,7 +18,9 @@
 #include "PhysicsSystem.h"
 #include "SkeletalSystem.h"
 #include "TransformSystem.h"
+#include "SpatialSystem.h"
 #include "UISystem.h"
+#include "SystemScheduler.h"
 #include "Scripting.h"
 #include "Renderer2D.h"
 #include "AssetManager.h"
@@ -37,9 +41,13 @@ namespace flaw {
 		_monoScriptSystem = CreateScope<MonoScriptSystem>(_app, *this);
 		_physicsSystem = CreateScope<PhysicsSystem>(*this);
 		_transformSystem = CreateScope<TransformSystem>(*this);
+		_spatialSystem = CreateScope<SpatialSystem>(*this);
 		_uiSystem = CreateScope<UISystem>(*this);
 		_renderSystem = CreateScope<RenderSystem>(*this);
 
+		_systemScheduler = CreateScope<SystemScheduler>(_app.GetJobSystem());
+		RegisterSystems();
+
 		_app.GetEventDispatcher().Register<WindowResizeEvent>([this](const WindowResizeEvent& evn) {
 			for (auto&& [entity, camera] : _registry.view<CameraComponent>().each()) {
 				camera.aspectRatio = (float)evn.width / (float)evn.height;
@@ -63,6 +71,7 @@ namespace flaw {
 		entity.AddComponent<EntityComponent>(uuid, name);
 
 		entity.AddComponent<TransformComponent>(position, rotation, scale);
+		entity.AddComponent<RelationshipComponent>();
 
 		_entityMap[uuid] = (entt::entity)entity;
 		
@@ -73,20 +82,30 @@ namespace flaw {
 		Entity entity(_registry.create(), this);
 		entity.AddComponent<EntityComponent>(uuid, name);
 		entity.AddComponent<TransformComponent>();
+		entity.AddComponent<RelationshipComponent>();
 
 		_entityMap[uuid] = (entt::entity)entity;
 
 		return entity;
 	}
 
-	void Scene::DestroyEntity(Entity entity) {
-		UUID entityUUID = entity.GetUUID();
+	void Scene::CreateEntities(const std::vector<EntityComponent>& entityComps, const std::vector<TransformComponent>& transComps, std::vector<entt::entity>& outEntities) {
+		outEntities.resize(entityComps.size());
+		_registry.create(outEntities.begin(), outEntities.end());
 
-		auto it = _parentMap.find(entityUUID);
-		if (it != _parentMap.end()) {
-			_childMap[it->second].erase(entityUUID);
+		// same order as CreateEntityByUUID, construct listeners of a later component can rely on the earlier ones
+		_registry.insert<EntityComponent>(outEntities.begin(), outEntities.end(), entityComps.begin());
+		_registry.insert<TransformComponent>(outEntities.begin(), outEntities.end(), transComps.begin());
+		_registry.insert<RelationshipComponent>(outEntities.begin(), outEntities.end());
+
+		_entityMap.reserve(_entityMap.size() + outEntities.size());
+		for (size_t i = 0; i < outEntities.size(); ++i) {
+			_entityMap[entityComps[i].uuid] = outEntities[i];
 		}
+	}
 
+	void Scene::DestroyEntity(Entity entity) {
+		entity.UnsetParent();
 		DestroyEntityRecursive(entity);
 	}
 
@@ -101,9 +120,13 @@ namespace flaw {
 	void Scene::DestroyEntityRecursive(Entity entity) {
 		UUID entityUUID = entity.GetUUID();
 
-		// call destroy to children
-		entity.EachChildren([this](const Entity& child) { DestroyEntityRecursive(child); });
-		_childMap.erase(entityUUID);
+		// call destroy to children, the next sibling is read before the child is gone
+		entt::entity child = entity.GetComponent<RelationshipComponent>().firstChild;
+		while (child != entt::null) {
+			const entt::entity nextSibling = _registry.get<RelationshipComponent>(child).nextSibling;
+			DestroyEntityRecursive(Entity(child, this));
+			child = nextSibling;
+		}
 
 		if (_physics2DWorld && entity.HasComponent<Rigidbody2DComponent>()) {
 			auto& rigidbody2D = entity.GetComponent<Rigidbody2DComponent>();
@@ -112,7 +135,6 @@ namespace flaw {
 
 		// TODO: mono script component   instance  
 
-		_parentMap.erase(entityUUID);
 		_entityMap.erase(entityUUID);
 
 		_registry.destroy((entt::entity)entity);
@@ -277,21 +299,83 @@ namespace flaw {
 		_monoScriptSystem->Start();
 	}
 
+	void Scene::RegisterSystems() {
+		// systems are added in the order they run, conflicting systems keep that order
+		// scripts can touch anything, physics calls them from its collision and trigger handlers
+		_systemScheduler->AddSystem("MonoScript", SystemAccess().Exclusive().MainThread(), [this]() { _monoScriptSystem->Update(); });
+		_systemScheduler->AddSystem("NativeScript", SystemAccess().Exclusive().MainThread(), [this]() { UpdateScript(); });
+
+		_systemScheduler->AddSystem("Physics2D",
+			SystemAccess()
+				.Write<TransformComponent, Rigidbody2DComponent>(),
+			[this]() { UpdatePhysics2D(); }
+		);
+
+		_systemScheduler->AddSystem("Physics", SystemAccess().Exclusive().MainThread(), [this]() { _physicsSystem->Update(); });
+
+		// runs on a worker next to Transform and Sound, none of them touch animators
+		_systemScheduler->AddSystem("Animation",
+			SystemAccess()
+				.Read<AnimatorComponent>()
+				.Write<AnimationSystem>(),
+			[this]() { _animationSystem->Update(); }
+		);
+
+		_systemScheduler->AddSystem("Transform",
+			SystemAccess()
+				.Write<TransformComponent>(),
+			[this]() { _transformSystem->Update(); }
+		);
+
+		_systemScheduler->AddSystem("Sound",
+			SystemAccess()
+				.Read<TransformComponent, SoundListenerComponent>()
+				.Write<SoundSourceComponent>()
+				.MainThread(),
+			[this]() { UpdateSound(); }
+		);
+
+		// moves socket attachments onto the animated bones once world transforms are known, it refreshes the ones it moves
+		_systemScheduler->AddSystem("Skeletal",
+			SystemAccess()
+				.Read<SkeletalMeshComponent, AnimationSystem>()
+				.Write<TransformComponent, SkeletalSystem>()
+				.MainThread(),
+			[this]() { _skeletalSystem->Update(); }
+		);
+
+		// mesh assets are resolved on the main thread
+		_systemScheduler->AddSystem("Spatial",
+			SystemAccess()
+				.Read<TransformComponent, StaticMeshComponent, SkeletalMeshComponent>()
+				.Write<TransformSystem, SpatialSystem>()
+				.MainThread(),
+			[this]() { _spatialSystem->Update(); }
+		);
+
+		// dispatches the particle compute shaders
+		_systemScheduler->AddSystem("Particle",
+			SystemAccess()
+				.Read<TransformComponent>()
+				.Write<ParticleComponent, ParticleSystem>()
+				.MainThread(),
+			[this]() { _particleSystem->Update(); }
+		);
+
+		// the renderer reads every system above, it is the tail of the frame
+		_systemScheduler->AddSystem("Render", SystemAccess().Exclusive().MainThread(), [this]() {
+			_renderSystem->Update();
+			_renderSystem->Render();
+		});
+
+		_systemScheduler->AddSystem("UI", SystemAccess().Exclusive().MainThread(), [this]() {
+			_uiSystem->Update();
+			_uiSystem->Render();
+		});
+	}
+
 	void Scene::OnUpdate() {
-		_monoScriptSystem->Update();
-		UpdateScript();
-		_animationSystem->Update();
-		_skeletalSystem->Update();
-		UpdatePhysics2D();
-		_physicsSystem->Update();
-		UpdateSound();
-		_transformSystem->Update();
-
-		_renderSystem->Update();
-		_renderSystem->Render();
-
-		_uiSystem->Update();
-		_uiSystem->Render();
+		_systemScheduler->Run();
 	}
 
 	void Scene::OnEnd() {
@@ -376,6 +460,15 @@ namespace flaw {
 	}
 
 	void Scene::ToFile(const char* filepath) {
+		if (std::filesystem::path(filepath).extension() == BinarySceneExtension) {
+			std::vector<int8_t> data;
+			SerializeBinary(*this, data);
+			if (!FileSystem::WriteFile(filepath, data.data(), data.size())) {
+				Log::Error("Failed to write file %s", filepath);
+			}
+			return;
+		}
+
 		std::ofstream file(filepath);
 		YAML::Emitter out;
 		Serialize(out, *this);
@@ -384,6 +477,15 @@ namespace flaw {
 	}
 
 	void Scene::FromFile(const char* filepath) {
+		MappedFile mappedFile;
+		if (mappedFile.Open(filepath) && IsBinaryScene(mappedFile.Data(), mappedFile.Size())) {
+			if (!DeserializeBinary(mappedFile.Data(), mappedFile.Size(), *this)) {
+				Log::Error("Failed to load file %s", filepath);
+			}
+			return;
+		}
+		mappedFile.Close();
+
 		YAML::Node node = YAML::LoadFile(filepath);
 		if (!node) {
 			Log::Error("Failed to load file %s", filepath);
@@ -406,9 +508,6 @@ namespace flaw {
 			scene->CloneEntity(srcEntity, true);
 		}
 
-		scene->_parentMap = _parentMap;
-		scene->_childMap = _childMap;
-
 		return scene;
 	}
 }
\ No newline at end of file
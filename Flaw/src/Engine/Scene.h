@@ -22,7 +22,11 @@ namespace flaw {
 	class PhysicsSystem;
 	class SkeletalSystem;
 	class TransformSystem;
+	class SpatialSystem;
 	class UISystem;
+	class SystemScheduler;
+	struct EntityComponent;
+	struct TransformComponent;
 
 	class Scene {
 	public:
@@ -32,6 +36,8 @@ namespace flaw {
 		Entity CreateEntity(const char* name = "Entity");
 		Entity CreateEntity(const vec3& position, const vec3& rotation = vec3(0.f), const vec3& scale = vec3(1.f), const char* name = "Entity");
 		Entity CreateEntityByUUID(const UUID& uuid, const char* name = "Entity");
+		// bulk CreateEntityByUUID for loaders, each component type is inserted at once and outEntities follows the input order
+		void CreateEntities(const std::vector<EntityComponent>& entityComps, const std::vector<TransformComponent>& transComps, std::vector<entt::entity>& outEntities);
 		void DestroyEntity(Entity entity);
 		void DestroyEntityByUUID(const UUID& uuid);
 		Entity CloneEntity(const Entity& srcEntt, bool sameUUID = false);
@@ -47,12 +53,15 @@ namespace flaw {
 		void UpdateScript();
 		void UpdatePhysics2D();
 
+		// paths with BinarySceneExtension are written in the binary format and everything else as yaml, reading tells them apart by content
 		void ToFile(const char* filepath);
 		void FromFile(const char* filepath);
 
 		Ref<Scene> Clone();
 
 		entt::registry& GetRegistry() { return _registry; }
+		Application& GetApplication() { return _app; }
+
 		ParticleSystem& GetParticleSystem() { return *_particleSystem; }
 		RenderSystem& GetRenderSystem() { return *_renderSystem; }
 		SkyBoxSystem& GetSkyBoxSystem() { return *_skyBoxSystem; }
@@ -63,9 +72,12 @@ namespace flaw {
 		PhysicsSystem& GetPhysicsSystem() { return *_physicsSystem; }
 		SkeletalSystem& GetSkeletalSystem() { return *_skeletalSystem; }
 		TransformSystem& GetTransformSystem() { return *_transformSystem; }
+		SpatialSystem& GetSpatialSystem() { return *_spatialSystem; }
 		UISystem& GetUISystem() { return *_uiSystem; }
 
 	private:
+		void RegisterSystems();
+
 		void DestroyEntityRecursive(Entity entity);
 
 	private:
@@ -85,12 +97,12 @@ namespace flaw {
 		Scope<PhysicsSystem> _physicsSystem;
 		Scope<SkeletalSystem> _skeletalSystem;
 		Scope<TransformSystem> _transformSystem;
+		Scope<SpatialSystem> _spatialSystem;
 		Scope<UISystem> _uiSystem;
 
-		std::unordered_map<UUID, entt::entity> _entityMap; // uuid -> entity
+		Scope<SystemScheduler> _systemScheduler;
 
-		std::unordered_map<UUID, UUID> _parentMap; // child -> parent
-		std::unordered_map<UUID, std::unordered_set<UUID>> _childMap; // parent -> children
+		std::unordered_map<UUID, entt::entity> _entityMap; // uuid -> entity
 	};
 }
 
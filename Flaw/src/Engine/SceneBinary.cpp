@@ -0,0 +1,1354 @@
+#include "pch.h"
+#include "SceneBinary.h"
+#include "Components.h"
+#include "ECS/ECS.h"
+#include "Scene.h"
+#include "Entity.h"
+#include "ParticleSystem.h"
+#include "Log/Log.h"
+
+namespace flaw {
+	constexpr uint64_t BinarySceneAlignment = 8;
+
+	// variable length field of a record, offset is in bytes from the start of the data block
+	struct BinarySceneRange {
+		uint32_t offset = 0;
+		uint32_t count = 0;
+	};
+
+	struct BinarySceneEntity {
+		uint64_t uuid;
+		uint32_t name;
+		int32_t parentIndex; // -1 for roots
+		vec3 position;
+		vec3 rotation;
+		vec3 scale;
+		uint32_t padding;
+	};
+
+	static void AppendBytes(std::vector<int8_t>& out, const void* data, uint64_t size) {
+		const int8_t* bytes = static_cast<const int8_t*>(data);
+		out.insert(out.end(), bytes, bytes + size);
+	}
+
+	static void AlignBytes(std::vector<int8_t>& out) {
+		out.resize((out.size() + BinarySceneAlignment - 1) & ~(BinarySceneAlignment - 1), 0);
+	}
+
+	class BinarySceneWriter {
+	public:
+		BinarySceneWriter(Scene& scene) : _scene(scene) {}
+
+		Scene& GetScene() { return _scene; }
+
+		uint32_t AddString(const std::string& str) {
+			auto it = _stringIndices.find(str);
+			if (it != _stringIndices.end()) {
+				return it->second;
+			}
+
+			const uint32_t index = static_cast<uint32_t>(_stringOffsets.size());
+			_stringOffsets.push_back(static_cast<uint32_t>(_stringChars.size()));
+			_stringChars.insert(_stringChars.end(), str.begin(), str.end());
+			_stringIndices.emplace(str, index);
+
+			return index;
+		}
+
+		template<typename T>
+		BinarySceneRange AddArray(const std::vector<T>& values) {
+			static_assert(std::is_trivially_copyable_v<T>, "binary scene arrays have to be trivially copyable");
+
+			BinarySceneRange range;
+			range.offset = static_cast<uint32_t>(_data.size());
+			range.count = static_cast<uint32_t>(values.size());
+
+			AppendBytes(_data, values.data(), values.size() * sizeof(T));
+			AlignBytes(_data);
+
+			return range;
+		}
+
+		void AddEntity(const BinarySceneEntity& entity) {
+			_entities.push_back(entity);
+		}
+
+		void AddTable(std::string_view name, uint32_t recordSize, std::vector<uint32_t>&& entityIndices, std::vector<int8_t>&& records) {
+			Table& table = _tables.emplace_back();
+			table.name = AddString(std::string(name));
+			table.recordSize = recordSize;
+			table.entityIndices = std::move(entityIndices);
+			table.records = std::move(records);
+		}
+
+		void Write(std::vector<int8_t>& out) {
+			out.clear();
+
+			BinarySceneHeader header;
+			header.entityCount = static_cast<uint32_t>(_entities.size());
+			header.stringCount = static_cast<uint32_t>(_stringOffsets.size());
+			header.tableCount = static_cast<uint32_t>(_tables.size());
+
+			AppendBytes(out, &header, sizeof(BinarySceneHeader));
+			AlignBytes(out);
+
+			header.entitiesOffset = out.size();
+			AppendBytes(out, _entities.data(), _entities.size() * sizeof(BinarySceneEntity));
+			AlignBytes(out);
+
+			header.stringOffsetsOffset = out.size();
+			_stringOffsets.push_back(static_cast<uint32_t>(_stringChars.size()));
+			AppendBytes(out, _stringOffsets.data(), _stringOffsets.size() * sizeof(uint32_t));
+			AlignBytes(out);
+			_stringOffsets.pop_back();
+
+			header.stringCharsOffset = out.size();
+			header.stringCharsSize = _stringChars.size();
+			AppendBytes(out, _stringChars.data(), _stringChars.size());
+			AlignBytes(out);
+
+			header.dataOffset = out.size();
+			header.dataSize = _data.size();
+			AppendBytes(out, _data.data(), _data.size());
+			AlignBytes(out);
+
+			// descriptions first so a reader finds every table without walking the records
+			header.tablesOffset = out.size();
+			out.resize(out.size() + _tables.size() * sizeof(BinarySceneTable), 0);
+			AlignBytes(out);
+
+			for (size_t i = 0; i < _tables.size(); ++i) {
+				const Table& table = _tables[i];
+
+				BinarySceneTable desc;
+				desc.name = table.name;
+				desc.recordSize = table.recordSize;
+				desc.count = static_cast<uint32_t>(table.entityIndices.size());
+
+				desc.entitiesOffset = out.size();
+				AppendBytes(out, table.entityIndices.data(), table.entityIndices.size() * sizeof(uint32_t));
+				AlignBytes(out);
+
+				desc.recordsOffset = out.size();
+				AppendBytes(out, table.records.data(), table.records.size());
+				AlignBytes(out);
+
+				std::memcpy(out.data() + header.tablesOffset + i * sizeof(BinarySceneTable), &desc, sizeof(BinarySceneTable));
+			}
+
+			std::memcpy(out.data(), &header, sizeof(BinarySceneHeader));
+		}
+
+	private:
+		struct Table {
+			uint32_t name;
+			uint32_t recordSize;
+			std::vector<uint32_t> entityIndices;
+			std::vector<int8_t> records;
+		};
+
+		Scene& _scene;
+
+		std::vector<BinarySceneEntity> _entities;
+
+		std::unordered_map<std::string, uint32_t> _stringIndices;
+		std::vector<uint32_t> _stringOffsets;
+		std::vector<char> _stringChars;
+
+		std::vector<int8_t> _data;
+
+		std::vector<Table> _tables;
+	};
+
+	class BinarySceneReader {
+	public:
+		BinarySceneReader(const int8_t* data, uint64_t size)
+			: _data(data)
+			, _size(size)
+		{
+		}
+
+		// checks every block of the header, records are checked while they are read
+		bool Validate() {
+			if (!IsBinaryScene(_data, _size)) {
+				Log::Error("Not a binary scene");
+				return false;
+			}
+
+			std::memcpy(&_header, _data, sizeof(BinarySceneHeader));
+
+			if (_header.version != BinarySceneVersion) {
+				Log::Error("Binary scene version %u is not supported, expected %u, convert the yaml scene again", _header.version, BinarySceneVersion);
+				return false;
+			}
+
+			if (!HasBlock(_header.entitiesOffset, uint64_t(_header.entityCount) * sizeof(BinarySceneEntity))
+				|| !HasBlock(_header.stringOffsetsOffset, (uint64_t(_header.stringCount) + 1) * sizeof(uint32_t))
+				|| !HasBlock(_header.stringCharsOffset, _header.stringCharsSize)
+				|| !HasBlock(_header.dataOffset, _header.dataSize)
+				|| !HasBlock(_header.tablesOffset, uint64_t(_header.tableCount) * sizeof(BinarySceneTable)))
+			{
+				Log::Error("Binary scene is truncated");
+				return false;
+			}
+
+			return true;
+		}
+
+		const BinarySceneHeader& GetHeader() const { return _header; }
+
+		BinarySceneEntity GetEntity(uint32_t index) const {
+			BinarySceneEntity entity;
+			std::memcpy(&entity, _data + _header.entitiesOffset + index * sizeof(BinarySceneEntity), sizeof(BinarySceneEntity));
+			return entity;
+		}
+
+		bool GetTable(uint32_t index, BinarySceneTable& outTable) const {
+			std::memcpy(&outTable, _data + _header.tablesOffset + index * sizeof(BinarySceneTable), sizeof(BinarySceneTable));
+
+			return HasBlock(outTable.entitiesOffset, uint64_t(outTable.count) * sizeof(uint32_t))
+				&& HasBlock(outTable.recordsOffset, uint64_t(outTable.count) * outTable.recordSize);
+		}
+
+		std::string GetString(uint32_t index) const {
+			if (index >= _header.stringCount) {
+				return std::string();
+			}
+
+			uint32_t range[2];
+			std::memcpy(range, _data + _header.stringOffsetsOffset + index * sizeof(uint32_t), sizeof(range));
+			if (range[0] > range[1] || range[1] > _header.stringCharsSize) {
+				return std::string();
+			}
+
+			return std::string(reinterpret_cast<const char*>(_data + _header.stringCharsOffset + range[0]), range[1] - range[0]);
+		}
+
+		// a range outside of the data block reads as an empty array
+		template<typename T>
+		void GetArray(const BinarySceneRange& range, std::vector<T>& out) const {
+			static_assert(std::is_trivially_copyable_v<T>, "binary scene arrays have to be trivially copyable");
+
+			const uint64_t byteSize = uint64_t(range.count) * sizeof(T);
+			if (uint64_t(range.offset) + byteSize > _header.dataSize) {
+				out.clear();
+				return;
+			}
+
+			out.resize(range.count);
+			std::memcpy(out.data(), _data + _header.dataOffset + range.offset, byteSize);
+		}
+
+		void GetBytes(uint64_t offset, uint64_t size, void* out) const {
+			std::memcpy(out, _data + offset, size);
+		}
+
+	private:
+		bool HasBlock(uint64_t offset, uint64_t size) const {
+			return offset <= _size && size <= _size - offset;
+		}
+
+	private:
+		const int8_t* _data;
+		uint64_t _size;
+
+		BinarySceneHeader _header;
+	};
+
+	// packed record of a component and its conversion, records only hold trivially copyable values
+	template<typename T>
+	struct BinaryComponent;
+
+	template<>
+	struct BinaryComponent<CameraComponent> {
+		struct Record {
+			uint8_t perspective;
+			float fov;
+			float orthoSize;
+			float aspectRatio;
+			float nearClip;
+			float farClip;
+			uint32_t depth;
+		};
+
+		static void Write(BinarySceneWriter& writer, const CameraComponent& comp, Record& record) {
+			record.perspective = comp.perspective;
+			record.fov = comp.fov;
+			record.orthoSize = comp.orthoSize;
+			record.aspectRatio = comp.aspectRatio;
+			record.nearClip = comp.nearClip;
+			record.farClip = comp.farClip;
+			record.depth = comp.depth;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, CameraComponent& comp) {
+			comp.perspective = record.perspective != 0;
+			comp.fov = record.fov;
+			comp.orthoSize = record.orthoSize;
+			comp.aspectRatio = record.aspectRatio;
+			comp.nearClip = record.nearClip;
+			comp.farClip = record.farClip;
+			comp.depth = record.depth;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<SpriteRendererComponent> {
+		struct Record {
+			uint64_t texture;
+			vec4 color;
+		};
+
+		static void Write(BinarySceneWriter& writer, const SpriteRendererComponent& comp, Record& record) {
+			record.texture = comp.texture;
+			record.color = comp.color;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, SpriteRendererComponent& comp) {
+			comp.texture = record.texture;
+			comp.color = record.color;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<Rigidbody2DComponent> {
+		struct Record {
+			int32_t bodyType;
+			uint8_t fixedRotation;
+			float density;
+			float friction;
+			float restitution;
+			float restitutionThreshold;
+		};
+
+		static void Write(BinarySceneWriter& writer, const Rigidbody2DComponent& comp, Record& record) {
+			record.bodyType = (int32_t)comp.bodyType;
+			record.fixedRotation = comp.fixedRotation;
+			record.density = comp.density;
+			record.friction = comp.friction;
+			record.restitution = comp.restitution;
+			record.restitutionThreshold = comp.restitutionThreshold;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, Rigidbody2DComponent& comp) {
+			comp.bodyType = (Rigidbody2DComponent::BodyType)record.bodyType;
+			comp.fixedRotation = record.fixedRotation != 0;
+			comp.density = record.density;
+			comp.friction = record.friction;
+			comp.restitution = record.restitution;
+			comp.restitutionThreshold = record.restitutionThreshold;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<BoxCollider2DComponent> {
+		struct Record {
+			vec2 offset;
+			vec2 size;
+		};
+
+		static void Write(BinarySceneWriter& writer, const BoxCollider2DComponent& comp, Record& record) {
+			record.offset = comp.offset;
+			record.size = comp.size;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, BoxCollider2DComponent& comp) {
+			comp.offset = record.offset;
+			comp.size = record.size;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<CircleCollider2DComponent> {
+		struct Record {
+			vec2 offset;
+			float radius;
+		};
+
+		static void Write(BinarySceneWriter& writer, const CircleCollider2DComponent& comp, Record& record) {
+			record.offset = comp.offset;
+			record.radius = comp.radius;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, CircleCollider2DComponent& comp) {
+			comp.offset = record.offset;
+			comp.radius = record.radius;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<RigidbodyComponent> {
+		struct Record {
+			int32_t bodyType;
+			uint8_t isKinematic;
+			float mass;
+		};
+
+		static void Write(BinarySceneWriter& writer, const RigidbodyComponent& comp, Record& record) {
+			record.bodyType = (int32_t)comp.bodyType;
+			record.isKinematic = comp.isKinematic;
+			record.mass = comp.mass;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, RigidbodyComponent& comp) {
+			comp.bodyType = (PhysicsBodyType)record.bodyType;
+			comp.isKinematic = record.isKinematic != 0;
+			comp.mass = record.mass;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<BoxColliderComponent> {
+		struct Record {
+			uint8_t isTrigger;
+			float staticFriction;
+			float dynamicFriction;
+			float restitution;
+			vec3 offset;
+			vec3 size;
+		};
+
+		static void Write(BinarySceneWriter& writer, const BoxColliderComponent& comp, Record& record) {
+			record.isTrigger = comp.isTrigger;
+			record.staticFriction = comp.staticFriction;
+			record.dynamicFriction = comp.dynamicFriction;
+			record.restitution = comp.restitution;
+			record.offset = comp.offset;
+			record.size = comp.size;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, BoxColliderComponent& comp) {
+			comp.isTrigger = record.isTrigger != 0;
+			comp.staticFriction = record.staticFriction;
+			comp.dynamicFriction = record.dynamicFriction;
+			comp.restitution = record.restitution;
+			comp.offset = record.offset;
+			comp.size = record.size;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<SphereColliderComponent> {
+		struct Record {
+			uint8_t isTrigger;
+			float staticFriction;
+			float dynamicFriction;
+			float restitution;
+			vec3 offset;
+			float radius;
+		};
+
+		static void Write(BinarySceneWriter& writer, const SphereColliderComponent& comp, Record& record) {
+			record.isTrigger = comp.isTrigger;
+			record.staticFriction = comp.staticFriction;
+			record.dynamicFriction = comp.dynamicFriction;
+			record.restitution = comp.restitution;
+			record.offset = comp.offset;
+			record.radius = comp.radius;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, SphereColliderComponent& comp) {
+			comp.isTrigger = record.isTrigger != 0;
+			comp.staticFriction = record.staticFriction;
+			comp.dynamicFriction = record.dynamicFriction;
+			comp.restitution = record.restitution;
+			comp.offset = record.offset;
+			comp.radius = record.radius;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<MeshColliderComponent> {
+		struct Record {
+			uint8_t isTrigger;
+			float staticFriction;
+			float dynamicFriction;
+			float restitution;
+			uint64_t mesh;
+		};
+
+		static void Write(BinarySceneWriter& writer, const MeshColliderComponent& comp, Record& record) {
+			record.isTrigger = comp.isTrigger;
+			record.staticFriction = comp.staticFriction;
+			record.dynamicFriction = comp.dynamicFriction;
+			record.restitution = comp.restitution;
+			record.mesh = comp.mesh;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, MeshColliderComponent& comp) {
+			comp.isTrigger = record.isTrigger != 0;
+			comp.staticFriction = record.staticFriction;
+			comp.dynamicFriction = record.dynamicFriction;
+			comp.restitution = record.restitution;
+			comp.mesh = record.mesh;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<TextComponent> {
+		struct Record {
+			uint32_t text; // utf8
+			uint64_t font;
+			vec4 color;
+		};
+
+		static void Write(BinarySceneWriter& writer, const TextComponent& comp, Record& record) {
+			record.text = writer.AddString(Utf16ToUtf8(comp.text));
+			record.font = comp.font;
+			record.color = comp.color;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, TextComponent& comp) {
+			comp.text = Utf8ToUtf16(reader.GetString(record.text));
+			comp.font = record.font;
+			comp.color = record.color;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<SoundListenerComponent> {
+		struct Record {
+			vec3 velocity;
+		};
+
+		static void Write(BinarySceneWriter& writer, const SoundListenerComponent& comp, Record& record) {
+			record.velocity = comp.velocity;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, SoundListenerComponent& comp) {
+			comp.velocity = record.velocity;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<SoundSourceComponent> {
+		struct Record {
+			uint64_t sound;
+			uint8_t loop;
+			uint8_t autoPlay;
+			float volume;
+		};
+
+		static void Write(BinarySceneWriter& writer, const SoundSourceComponent& comp, Record& record) {
+			record.sound = comp.sound;
+			record.loop = comp.loop;
+			record.autoPlay = comp.autoPlay;
+			record.volume = comp.volume;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, SoundSourceComponent& comp) {
+			comp.sound = record.sound;
+			comp.loop = record.loop != 0;
+			comp.autoPlay = record.autoPlay != 0;
+			comp.volume = record.volume;
+		}
+	};
+
+	static BinarySceneRange AddHandleArray(BinarySceneWriter& writer, const std::vector<AssetHandle>& handles) {
+		std::vector<uint64_t> values(handles.begin(), handles.end());
+		return writer.AddArray(values);
+	}
+
+	static void GetHandleArray(const BinarySceneReader& reader, const BinarySceneRange& range, std::vector<AssetHandle>& out) {
+		std::vector<uint64_t> values;
+		reader.GetArray(range, values);
+		out.assign(values.begin(), values.end());
+	}
+
+	template<>
+	struct BinaryComponent<StaticMeshComponent> {
+		struct Record {
+			uint64_t mesh;
+			BinarySceneRange materials; // uint64 handles
+			uint8_t castShadow;
+		};
+
+		static void Write(BinarySceneWriter& writer, const StaticMeshComponent& comp, Record& record) {
+			record.mesh = comp.mesh;
+			record.materials = AddHandleArray(writer, comp.materials);
+			record.castShadow = comp.castShadow;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, StaticMeshComponent& comp) {
+			comp.mesh = record.mesh;
+			GetHandleArray(reader, record.materials, comp.materials);
+			comp.castShadow = record.castShadow != 0;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<SkeletalMeshComponent> {
+		struct Record {
+			uint64_t mesh;
+			BinarySceneRange materials; // uint64 handles
+			uint64_t skeleton;
+			uint8_t castShadow;
+		};
+
+		static void Write(BinarySceneWriter& writer, const SkeletalMeshComponent& comp, Record& record) {
+			record.mesh = comp.mesh;
+			record.materials = AddHandleArray(writer, comp.materials);
+			record.skeleton = comp.skeleton;
+			record.castShadow = comp.castShadow;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, SkeletalMeshComponent& comp) {
+			comp.mesh = record.mesh;
+			GetHandleArray(reader, record.materials, comp.materials);
+			comp.skeleton = record.skeleton;
+			comp.castShadow = record.castShadow != 0;
+		}
+	};
+
+	// modules live in the particle system, they are written next to the component and added once it is inserted
+	template<>
+	struct BinaryComponent<ParticleComponent> {
+		struct Record {
+			int32_t maxParticles;
+			int32_t spaceType;
+			float startSpeed;
+			float startLifeTime;
+			vec4 startColor;
+			vec3 startSize;
+			uint32_t modules;
+
+			// fields of modules whose bit is not set are zero
+			int32_t spawnOverTime;
+			uint8_t burst;
+			float burstStartTime;
+			uint32_t burstParticleCount;
+			uint32_t burstCycleCount;
+			float burstCycleInterval;
+
+			int32_t shapeType;
+			vec3 shapeSize;			// sphere radius in x
+			vec3 shapeThickness;	// sphere thickness in x
+
+			float minSpeed;
+			float maxSpeed;
+
+			vec4 minColor;
+			vec4 maxColor;
+
+			vec3 minSize;
+			vec3 maxSize;
+
+			int32_t colorEasing;
+			float colorEasingStartRatio;
+			vec2 redFactorRange;
+			vec2 greenFactorRange;
+			vec2 blueFactorRange;
+			vec2 alphaFactorRange;
+
+			int32_t sizeEasing;
+			float sizeEasingStartRatio;
+			vec2 sizeFactorRange;
+
+			float noiseStrength;
+			float noiseFrequency;
+
+			int32_t alignment;
+		};
+
+		static void Write(BinarySceneWriter& writer, const ParticleComponent& comp, Record& record) {
+			record.maxParticles = comp.maxParticles;
+			record.spaceType = (int32_t)comp.spaceType;
+			record.startSpeed = comp.startSpeed;
+			record.startLifeTime = comp.startLifeTime;
+			record.startColor = comp.startColor;
+			record.startSize = comp.startSize;
+			record.modules = comp.modules;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, ParticleComponent& comp) {
+			comp.maxParticles = record.maxParticles;
+			comp.spaceType = (ParticleComponent::SpaceType)record.spaceType;
+			comp.startSpeed = record.startSpeed;
+			comp.startLifeTime = record.startLifeTime;
+			comp.startColor = record.startColor;
+			comp.startSize = record.startSize;
+			comp.modules = record.modules;
+		}
+
+		static void WriteModules(ParticleSystem& particleSys, entt::entity entity, Record& record) {
+			if (auto module = particleSys.GetModule<EmissionModule>(entity)) {
+				record.spawnOverTime = module->spawnOverTime;
+				record.burst = module->burst;
+				record.burstStartTime = module->burstStartTime;
+				record.burstParticleCount = module->burstParticleCount;
+				record.burstCycleCount = module->burstCycleCount;
+				record.burstCycleInterval = module->burstCycleInterval;
+			}
+
+			if (auto module = particleSys.GetModule<ShapeModule>(entity)) {
+				record.shapeType = (int32_t)module->shapeType;
+				if (module->shapeType == ShapeModule::ShapeType::Sphere) {
+					record.shapeSize.x = module->sphere.radius;
+					record.shapeThickness.x = module->sphere.thickness;
+				}
+				else if (module->shapeType == ShapeModule::ShapeType::Box) {
+					record.shapeSize = module->box.size;
+					record.shapeThickness = module->box.thickness;
+				}
+			}
+
+			if (auto module = particleSys.GetModule<RandomSpeedModule>(entity)) {
+				record.minSpeed = module->minSpeed;
+				record.maxSpeed = module->maxSpeed;
+			}
+
+			if (auto module = particleSys.GetModule<RandomColorModule>(entity)) {
+				record.minColor = module->minColor;
+				record.maxColor = module->maxColor;
+			}
+
+			if (auto module = particleSys.GetModule<RandomSizeModule>(entity)) {
+				record.minSize = module->minSize;
+				record.maxSize = module->maxSize;
+			}
+
+			if (auto module = particleSys.GetModule<ColorOverLifetimeModule>(entity)) {
+				record.colorEasing = (int32_t)module->easing;
+				record.colorEasingStartRatio = module->easingStartRatio;
+				record.redFactorRange = module->redFactorRange;
+				record.greenFactorRange = module->greenFactorRange;
+				record.blueFactorRange = module->blueFactorRange;
+				record.alphaFactorRange = module->alphaFactorRange;
+			}
+
+			if (auto module = particleSys.GetModule<SizeOverLifetimeModule>(entity)) {
+				record.sizeEasing = (int32_t)module->easing;
+				record.sizeEasingStartRatio = module->easingStartRatio;
+				record.sizeFactorRange = module->sizeFactorRange;
+			}
+
+			if (auto module = particleSys.GetModule<NoiseModule>(entity)) {
+				record.noiseStrength = module->strength;
+				record.noiseFrequency = module->frequency;
+			}
+
+			if (auto module = particleSys.GetModule<RendererModule>(entity)) {
+				record.alignment = (int32_t)module->alignment;
+			}
+		}
+
+		static void AddModules(ParticleSystem& particleSys, entt::entity entity, const Record& record) {
+			if (record.modules & ParticleComponent::ModuleType::Emission) {
+				auto module = particleSys.AddModule<EmissionModule>(entity);
+				module->spawnOverTime = record.spawnOverTime;
+				module->burst = record.burst != 0;
+				module->burstStartTime = record.burstStartTime;
+				module->burstParticleCount = record.burstParticleCount;
+				module->burstCycleCount = record.burstCycleCount;
+				module->burstCycleInterval = record.burstCycleInterval;
+			}
+
+			if (record.modules & ParticleComponent::ModuleType::Shape) {
+				auto module = particleSys.AddModule<ShapeModule>(entity);
+				module->shapeType = (ShapeModule::ShapeType)record.shapeType;
+				if (module->shapeType == ShapeModule::ShapeType::Sphere) {
+					module->sphere.radius = record.shapeSize.x;
+					module->sphere.thickness = record.shapeThickness.x;
+				}
+				else if (module->shapeType == ShapeModule::ShapeType::Box) {
+					module->box.size = record.shapeSize;
+					module->box.thickness = record.shapeThickness;
+				}
+			}
+
+			if (record.modules & ParticleComponent::ModuleType::RandomSpeed) {
+				auto module = particleSys.AddModule<RandomSpeedModule>(entity);
+				module->minSpeed = record.minSpeed;
+				module->maxSpeed = record.maxSpeed;
+			}
+
+			if (record.modules & ParticleComponent::ModuleType::RandomColor) {
+				auto module = particleSys.AddModule<RandomColorModule>(entity);
+				module->minColor = record.minColor;
+				module->maxColor = record.maxColor;
+			}
+
+			if (record.modules & ParticleComponent::ModuleType::RandomSize) {
+				auto module = particleSys.AddModule<RandomSizeModule>(entity);
+				module->minSize = record.minSize;
+				module->maxSize = record.maxSize;
+			}
+
+			if (record.modules & ParticleComponent::ModuleType::ColorOverLifetime) {
+				auto module = particleSys.AddModule<ColorOverLifetimeModule>(entity);
+				module->easing = (Easing)record.colorEasing;
+				module->easingStartRatio = record.colorEasingStartRatio;
+				module->redFactorRange = record.redFactorRange;
+				module->greenFactorRange = record.greenFactorRange;
+				module->blueFactorRange = record.blueFactorRange;
+				module->alphaFactorRange = record.alphaFactorRange;
+			}
+
+			if (record.modules & ParticleComponent::ModuleType::SizeOverLifetime) {
+				auto module = particleSys.AddModule<SizeOverLifetimeModule>(entity);
+				module->easing = (Easing)record.sizeEasing;
+				module->easingStartRatio = record.sizeEasingStartRatio;
+				module->sizeFactorRange = record.sizeFactorRange;
+			}
+
+			if (record.modules & ParticleComponent::ModuleType::Noise) {
+				auto module = particleSys.AddModule<NoiseModule>(entity);
+				module->strength = record.noiseStrength;
+				module->frequency = record.noiseFrequency;
+			}
+
+			if (record.modules & ParticleComponent::ModuleType::Renderer) {
+				auto module = particleSys.AddModule<RendererModule>(entity);
+				module->alignment = (RendererModule::Alignment)record.alignment;
+			}
+		}
+	};
+
+	template<>
+	struct BinaryComponent<SkyLightComponent> {
+		struct Record {
+			vec3 color;
+			float intensity;
+		};
+
+		static void Write(BinarySceneWriter& writer, const SkyLightComponent& comp, Record& record) {
+			record.color = comp.color;
+			record.intensity = comp.intensity;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, SkyLightComponent& comp) {
+			comp.color = record.color;
+			comp.intensity = record.intensity;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<DirectionalLightComponent> {
+		struct Record {
+			vec3 color;
+			float intensity;
+		};
+
+		static void Write(BinarySceneWriter& writer, const DirectionalLightComponent& comp, Record& record) {
+			record.color = comp.color;
+			record.intensity = comp.intensity;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, DirectionalLightComponent& comp) {
+			comp.color = record.color;
+			comp.intensity = record.intensity;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<PointLightComponent> {
+		struct Record {
+			vec3 color;
+			float intensity;
+			float range;
+		};
+
+		static void Write(BinarySceneWriter& writer, const PointLightComponent& comp, Record& record) {
+			record.color = comp.color;
+			record.intensity = comp.intensity;
+			record.range = comp.range;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, PointLightComponent& comp) {
+			comp.color = record.color;
+			comp.intensity = record.intensity;
+			comp.range = record.range;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<SpotLightComponent> {
+		struct Record {
+			vec3 color;
+			float intensity;
+			float inner;
+			float outer;
+			float range;
+		};
+
+		static void Write(BinarySceneWriter& writer, const SpotLightComponent& comp, Record& record) {
+			record.color = comp.color;
+			record.intensity = comp.intensity;
+			record.inner = comp.inner;
+			record.outer = comp.outer;
+			record.range = comp.range;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, SpotLightComponent& comp) {
+			comp.color = record.color;
+			comp.intensity = record.intensity;
+			comp.inner = record.inner;
+			comp.outer = record.outer;
+			comp.range = record.range;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<SkyBoxComponent> {
+		struct Record {
+			uint64_t texture;
+		};
+
+		static void Write(BinarySceneWriter& writer, const SkyBoxComponent& comp, Record& record) {
+			record.texture = comp.texture;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, SkyBoxComponent& comp) {
+			comp.texture = record.texture;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<DecalComponent> {
+		struct Record {
+			uint64_t texture;
+		};
+
+		static void Write(BinarySceneWriter& writer, const DecalComponent& comp, Record& record) {
+			record.texture = comp.texture;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, DecalComponent& comp) {
+			comp.texture = record.texture;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<LandscapeComponent> {
+		struct Record {
+			uint64_t heightMap;
+			uint64_t albedoTexture2DArray;
+			uint32_t tilingX;
+			uint32_t tilingY;
+			uint32_t lodLevelMax;
+			vec2 lodDistanceRange;
+		};
+
+		static void Write(BinarySceneWriter& writer, const LandscapeComponent& comp, Record& record) {
+			record.heightMap = comp.heightMap;
+			record.albedoTexture2DArray = comp.albedoTexture2DArray;
+			record.tilingX = comp.tilingX;
+			record.tilingY = comp.tilingY;
+			record.lodLevelMax = comp.lodLevelMax;
+			record.lodDistanceRange = comp.lodDistanceRange;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, LandscapeComponent& comp) {
+			comp.heightMap = record.heightMap;
+			comp.albedoTexture2DArray = record.albedoTexture2DArray;
+			comp.tilingX = record.tilingX;
+			comp.tilingY = record.tilingY;
+			comp.lodLevelMax = record.lodLevelMax;
+			comp.lodDistanceRange = record.lodDistanceRange;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<AnimatorComponent> {
+		struct Record {
+			uint64_t animatorAsset;
+			uint64_t skeletonAsset;
+			uint8_t useLevelOfDetail;
+			uint8_t useCrowdPose;
+			BinarySceneRange levelOfDetails;
+			int32_t offscreenUpdateInterval;
+			float crowdPoseTimeStep;
+		};
+
+		static void Write(BinarySceneWriter& writer, const AnimatorComponent& comp, Record& record) {
+			record.animatorAsset = comp.animatorAsset;
+			record.skeletonAsset = comp.skeletonAsset;
+			record.useLevelOfDetail = comp.useLevelOfDetail;
+			record.useCrowdPose = comp.useCrowdPose;
+			record.levelOfDetails = writer.AddArray(comp.levelOfDetails);
+			record.offscreenUpdateInterval = comp.offscreenUpdateInterval;
+			record.crowdPoseTimeStep = comp.crowdPoseTimeStep;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, AnimatorComponent& comp) {
+			comp.animatorAsset = record.animatorAsset;
+			comp.skeletonAsset = record.skeletonAsset;
+			comp.useLevelOfDetail = record.useLevelOfDetail != 0;
+			comp.useCrowdPose = record.useCrowdPose != 0;
+			reader.GetArray(record.levelOfDetails, comp.levelOfDetails);
+			comp.offscreenUpdateInterval = record.offscreenUpdateInterval;
+			comp.crowdPoseTimeStep = record.crowdPoseTimeStep;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<CanvasComponent> {
+		struct Record {
+			int32_t renderMode;
+			float planeDistance;
+			uint64_t renderCamera;
+		};
+
+		static void Write(BinarySceneWriter& writer, const CanvasComponent& comp, Record& record) {
+			record.renderMode = (int32_t)comp.renderMode;
+			record.planeDistance = comp.planeDistance;
+			record.renderCamera = comp.renderCamera;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, CanvasComponent& comp) {
+			comp.renderMode = (CanvasComponent::RenderMode)record.renderMode;
+			comp.planeDistance = record.planeDistance;
+			comp.renderCamera = record.renderCamera;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<CanvasScalerComponent> {
+		struct Record {
+			int32_t scaleMode;
+			float scaleFactor;
+			vec2 referenceResolution;
+		};
+
+		static void Write(BinarySceneWriter& writer, const CanvasScalerComponent& comp, Record& record) {
+			record.scaleMode = (int32_t)comp.scaleMode;
+			record.scaleFactor = comp.scaleFactor;
+			record.referenceResolution = comp.referenceResolution;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, CanvasScalerComponent& comp) {
+			comp.scaleMode = (CanvasScalerComponent::ScaleMode)record.scaleMode;
+			comp.scaleFactor = record.scaleFactor;
+			comp.referenceResolution = record.referenceResolution;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<RectLayoutComponent> {
+		struct Record {
+			vec2 anchorMin;
+			vec2 anchorMax;
+			vec2 pivot;
+			vec2 sizeDelta;
+		};
+
+		static void Write(BinarySceneWriter& writer, const RectLayoutComponent& comp, Record& record) {
+			record.anchorMin = comp.anchorMin;
+			record.anchorMax = comp.anchorMax;
+			record.pivot = comp.pivot;
+			record.sizeDelta = comp.sizeDelta;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, RectLayoutComponent& comp) {
+			comp.anchorMin = record.anchorMin;
+			comp.anchorMax = record.anchorMax;
+			comp.pivot = record.pivot;
+			comp.sizeDelta = record.sizeDelta;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<ImageComponent> {
+		struct Record {
+			uint64_t texture;
+			vec4 color;
+		};
+
+		static void Write(BinarySceneWriter& writer, const ImageComponent& comp, Record& record) {
+			record.texture = comp.texture;
+			record.color = comp.color;
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, ImageComponent& comp) {
+			comp.texture = record.texture;
+			comp.color = record.color;
+		}
+	};
+
+	template<>
+	struct BinaryComponent<MonoScriptComponent> {
+		struct FieldRecord {
+			uint32_t fieldType;
+			uint32_t fieldName;
+			uint32_t fieldValue;
+		};
+
+		struct Record {
+			uint32_t name;
+			BinarySceneRange fields; // FieldRecord
+		};
+
+		static void Write(BinarySceneWriter& writer, const MonoScriptComponent& comp, Record& record) {
+			std::vector<FieldRecord> fields(comp.fields.size());
+			for (size_t i = 0; i < comp.fields.size(); ++i) {
+				fields[i].fieldType = writer.AddString(comp.fields[i].fieldType);
+				fields[i].fieldName = writer.AddString(comp.fields[i].fieldName);
+				fields[i].fieldValue = writer.AddString(comp.fields[i].fieldValue);
+			}
+
+			record.name = writer.AddString(comp.name);
+			record.fields = writer.AddArray(fields);
+		}
+
+		static void Read(const BinarySceneReader& reader, const Record& record, MonoScriptComponent& comp) {
+			std::vector<FieldRecord> fields;
+			reader.GetArray(record.fields, fields);
+
+			comp.name = reader.GetString(record.name);
+			comp.fields.resize(fields.size());
+			for (size_t i = 0; i < fields.size(); ++i) {
+				comp.fields[i].fieldType = reader.GetString(fields[i].fieldType);
+				comp.fields[i].fieldName = reader.GetString(fields[i].fieldName);
+				comp.fields[i].fieldValue = reader.GetString(fields[i].fieldValue);
+			}
+		}
+	};
+
+	template<typename T>
+	static void WriteTable(BinarySceneWriter& writer, const std::vector<entt::entity>& entities) {
+		using Record = typename BinaryComponent<T>::Record;
+		static_assert(std::is_trivially_copyable_v<Record>, "binary scene records have to be trivially copyable");
+
+		Scene& scene = writer.GetScene();
+		auto& registry = scene.GetRegistry();
+
+		std::vector<uint32_t> entityIndices;
+		std::vector<int8_t> records;
+
+		for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); ++i) {
+			const T* comp = registry.try_get<T>(entities[i]);
+			if (comp == nullptr) {
+				continue;
+			}
+
+			// zeroed so padding and unused fields are the same on every save
+			Record record;
+			std::memset(&record, 0, sizeof(Record));
+
+			BinaryComponent<T>::Write(writer, *comp, record);
+			if constexpr (std::is_same_v<T, ParticleComponent>) {
+				BinaryComponent<T>::WriteModules(scene.GetParticleSystem(), entities[i], record);
+			}
+
+			entityIndices.push_back(i);
+			AppendBytes(records, &record, sizeof(Record));
+		}
+
+		if (!entityIndices.empty()) {
+			writer.AddTable(TypeName<T>(), sizeof(Record), std::move(entityIndices), std::move(records));
+		}
+	}
+
+	template<typename T>
+	static bool ReadTable(const BinarySceneReader& reader, const BinarySceneTable& table, Scene& scene, const std::vector<entt::entity>& entities) {
+		using Record = typename BinaryComponent<T>::Record;
+
+		if (table.recordSize != sizeof(Record)) {
+			Log::Error("Binary scene table %s has records of %u bytes, expected %u", TypeName<T>().data(), table.recordSize, (uint32_t)sizeof(Record));
+			return false;
+		}
+
+		std::vector<uint32_t> entityIndices(table.count);
+		std::vector<Record> records(table.count);
+		reader.GetBytes(table.entitiesOffset, entityIndices.size() * sizeof(uint32_t), entityIndices.data());
+		reader.GetBytes(table.recordsOffset, records.size() * sizeof(Record), records.data());
+
+		std::vector<entt::entity> handles(table.count);
+		std::vector<T> comps(table.count);
+
+		for (uint32_t i = 0; i < table.count; ++i) {
+			// ascending indices also rule out an entity getting the component twice
+			const uint32_t entityIndex = entityIndices[i];
+			if (entityIndex >= entities.size() || (i > 0 && entityIndex <= entityIndices[i - 1])) {
+				Log::Error("Binary scene table %s has an invalid entity index %u", TypeName<T>().data(), entityIndex);
+				return false;
+			}
+
+			handles[i] = entities[entityIndex];
+			BinaryComponent<T>::Read(reader, records[i], comps[i]);
+		}
+
+		scene.GetRegistry().insert<T>(handles.begin(), handles.end(), comps.begin());
+
+		if constexpr (std::is_same_v<T, ParticleComponent>) {
+			auto& particleSys = scene.GetParticleSystem();
+			for (uint32_t i = 0; i < table.count; ++i) {
+				BinaryComponent<T>::AddModules(particleSys, handles[i], records[i]);
+			}
+		}
+
+		return true;
+	}
+
+	using ReadTableFunc = bool(*)(const BinarySceneReader&, const BinarySceneTable&, Scene&, const std::vector<entt::entity>&);
+
+	// entity and transform components are part of the entity block, every other serialized component is listed here
+	template<typename... Components>
+	struct BinaryComponentList {
+		static void WriteTables(BinarySceneWriter& writer, const std::vector<entt::entity>& entities) {
+			(WriteTable<Components>(writer, entities), ...);
+		}
+
+		static std::unordered_map<std::string_view, ReadTableFunc> GetReadTableFuncs() {
+			return { { TypeName<Components>(), &ReadTable<Components> }... };
+		}
+	};
+
+	using BinarySceneComponents = BinaryComponentList<
+		CameraComponent,
+		SpriteRendererComponent,
+		Rigidbody2DComponent,
+		BoxCollider2DComponent,
+		CircleCollider2DComponent,
+		RigidbodyComponent,
+		BoxColliderComponent,
+		SphereColliderComponent,
+		MeshColliderComponent,
+		TextComponent,
+		SoundListenerComponent,
+		SoundSourceComponent,
+		StaticMeshComponent,
+		SkeletalMeshComponent,
+		ParticleComponent,
+		SkyLightComponent,
+		DirectionalLightComponent,
+		PointLightComponent,
+		SpotLightComponent,
+		SkyBoxComponent,
+		DecalComponent,
+		LandscapeComponent,
+		AnimatorComponent,
+		CanvasComponent,
+		CanvasScalerComponent,
+		RectLayoutComponent,
+		ImageComponent,
+		MonoScriptComponent
+	>;
+
+	static void CollectEntity(entt::registry& registry, entt::entity entity, std::vector<entt::entity>& outEntities) {
+		outEntities.push_back(entity);
+
+		for (entt::entity child = registry.get<RelationshipComponent>(entity).firstChild; child != entt::null; child = registry.get<RelationshipComponent>(child).nextSibling) {
+			CollectEntity(registry, child, outEntities);
+		}
+	}
+
+	bool IsBinaryScene(const int8_t* data, uint64_t size) {
+		if (size < sizeof(BinarySceneHeader)) {
+			return false;
+		}
+
+		uint32_t magic;
+		std::memcpy(&magic, data, sizeof(uint32_t));
+
+		return magic == BinarySceneMagic;
+	}
+
+	void SerializeBinary(Scene& scene, std::vector<int8_t>& out) {
+		auto& registry = scene.GetRegistry();
+
+		// depth first from every root, loading attaches children in this order which keeps the sibling order
+		std::vector<entt::entity> entities;
+		for (auto&& [entity, enttComp, relation] : registry.view<EntityComponent, RelationshipComponent>().each()) {
+			if (relation.parent == entt::null) {
+				CollectEntity(registry, entity, entities);
+			}
+		}
+
+		std::unordered_map<entt::entity, int32_t> entityIndices;
+		entityIndices.reserve(entities.size());
+		for (int32_t i = 0; i < static_cast<int32_t>(entities.size()); ++i) {
+			entityIndices[entities[i]] = i;
+		}
+
+		BinarySceneWriter writer(scene);
+
+		for (entt::entity entity : entities) {
+			const auto& enttComp = registry.get<EntityComponent>(entity);
+			const auto& transComp = registry.get<TransformComponent>(entity);
+			const auto& relation = registry.get<RelationshipComponent>(entity);
+
+			BinarySceneEntity record;
+			std::memset(&record, 0, sizeof(BinarySceneEntity));
+
+			record.uuid = enttComp.uuid;
+			record.name = writer.AddString(enttComp.name);
+			record.parentIndex = relation.parent != entt::null ? entityIndices[relation.parent] : -1;
+			record.position = transComp.position;
+			record.rotation = transComp.rotation;
+			record.scale = transComp.scale;
+
+			writer.AddEntity(record);
+		}
+
+		BinarySceneComponents::WriteTables(writer, entities);
+
+		writer.Write(out);
+	}
+
+	bool DeserializeBinary(const int8_t* data, uint64_t size, Scene& scene) {
+		BinarySceneReader reader(data, size);
+		if (!reader.Validate()) {
+			return false;
+		}
+
+		const BinarySceneHeader& header = reader.GetHeader();
+
+		// tables have to lie inside the file before the scene is touched, a truncated file adds nothing
+		std::vector<BinarySceneTable> tables(header.tableCount);
+		for (uint32_t i = 0; i < header.tableCount; ++i) {
+			if (!reader.GetTable(i, tables[i])) {
+				Log::Error("Binary scene table %u is truncated", i);
+				return false;
+			}
+		}
+
+		std::vector<int32_t> parentIndices(header.entityCount);
+		std::vector<EntityComponent> entityComps(header.entityCount);
+		std::vector<TransformComponent> transComps(header.entityCount);
+
+		for (uint32_t i = 0; i < header.entityCount; ++i) {
+			const BinarySceneEntity record = reader.GetEntity(i);
+			if (record.parentIndex < -1 || record.parentIndex >= static_cast<int32_t>(i)) {
+				Log::Error("Binary scene entity %u comes before its parent", i);
+				return false;
+			}
+
+			parentIndices[i] = record.parentIndex;
+
+			entityComps[i].uuid = record.uuid;
+			entityComps[i].name = reader.GetString(record.name);
+
+			transComps[i].position = record.position;
+			transComps[i].rotation = record.rotation;
+			transComps[i].scale = record.scale;
+		}
+
+		std::vector<entt::entity> entities;
+		scene.CreateEntities(entityComps, transComps, entities);
+
+		for (uint32_t i = 0; i < header.entityCount; ++i) {
+			if (parentIndices[i] >= 0) {
+				Entity(entities[i], &scene).SetParent(Entity(entities[parentIndices[i]], &scene));
+			}
+		}
+
+		static const std::unordered_map<std::string_view, ReadTableFunc> readTableFuncs = BinarySceneComponents::GetReadTableFuncs();
+
+		for (const BinarySceneTable& table : tables) {
+			const std::string name = reader.GetString(table.name);
+
+			auto it = readTableFuncs.find(name);
+			if (it == readTableFuncs.end()) {
+				Log::Warn("Binary scene table %s is not a known component, skipped", name.c_str());
+				continue;
+			}
+
+			if (!it->second(reader, table, scene, entities)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Core.h"
+
+#include <vector>
+
+namespace flaw {
+	class Scene;
+
+	// packed scene format for shipping builds, yaml stays the editor format
+	// Scene::FromFile reads both and Scene::ToFile writes this one for BinarySceneExtension paths, which is the conversion step between them
+	constexpr uint32_t BinarySceneMagic = 0x4e435346; // "FSCN"
+	constexpr uint32_t BinarySceneVersion = 1;
+	constexpr const char* BinarySceneExtension = ".bscene";
+
+	// layout, every block starts 8 byte aligned and offsets are from the start of the file
+	//   header
+	//   entities	uuid, name, parent index and transform per entity, parents come before their children and siblings keep their order
+	//   strings	offset per string followed by the utf8 characters, records reference text by string index
+	//   data		arrays of variable length fields, records reference them by offset and count
+	//   tables		one per component type, entity indices followed by one packed record per entity
+	struct BinarySceneHeader {
+		uint32_t magic = BinarySceneMagic;
+		uint32_t version = BinarySceneVersion;
+		uint32_t entityCount = 0;
+		uint32_t stringCount = 0;
+		uint32_t tableCount = 0;
+		uint32_t padding = 0;
+
+		uint64_t entitiesOffset = 0;
+		uint64_t stringOffsetsOffset = 0;	// stringCount + 1 uint32 offsets into the characters
+		uint64_t stringCharsOffset = 0;
+		uint64_t stringCharsSize = 0;
+		uint64_t dataOffset = 0;
+		uint64_t dataSize = 0;
+		uint64_t tablesOffset = 0;			// tableCount BinarySceneTable
+	};
+
+	struct BinarySceneTable {
+		uint32_t name = 0;					// string index of the component type name
+		uint32_t recordSize = 0;
+		uint32_t count = 0;
+		uint32_t padding = 0;
+
+		uint64_t entitiesOffset = 0;		// count uint32 entity indices in ascending order
+		uint64_t recordsOffset = 0;
+	};
+
+	bool IsBinaryScene(const int8_t* data, uint64_t size);
+
+	void SerializeBinary(Scene& scene, std::vector<int8_t>& out);
+
+	// nothing points into data once it returns, tables of unknown component types are skipped
+	bool DeserializeBinary(const int8_t* data, uint64_t size, Scene& scene);
+}
@@ -134,7 +134,12 @@ namespace flaw {
 		ADD_INTERNAL_CALL(GetMouseButtonUp_Input);
 		ADD_INTERNAL_CALL(GetMouseButton_Input);
 		ADD_INTERNAL_CALL(Raycast_Physics);
+		ADD_INTERNAL_CALL(Raycast_Spatial);
 		ADD_INTERNAL_CALL(PlayState_Animator);
+		ADD_INTERNAL_CALL(SetFloat_Animator);
+		ADD_INTERNAL_CALL(SetInt_Animator);
+		ADD_INTERNAL_CALL(SetBool_Animator);
+		ADD_INTERNAL_CALL(SetTrigger_Animator);
 		ADD_INTERNAL_CALL(AttachEntityToSocket_SkeletalMesh);
 
 		LoadMonoScripting();
@@ -20,6 +20,7 @@ namespace flaw {
 				out << YAML::Key << "Name" << YAML::Value << config.name;
 				out << YAML::Key << "Path" << YAML::Value << config.path;
 				out << YAML::Key << "StartScene" << YAML::Value << config.startScene;
+				out << YAML::Key << "Bundles" << YAML::Value << config.bundles;
 			}
 			out << YAML::EndMap;
 		}
@@ -402,7 +403,21 @@ namespace flaw {
 			auto& comp = entity.GetComponent<flaw::AnimatorComponent>();
 			out << YAML::Key << TypeName<flaw::AnimatorComponent>().data();
 			out << YAML::Value << YAML::BeginMap;
+			out << YAML::Key << "AnimatorAsset" << YAML::Value << comp.animatorAsset;
 			out << YAML::Key << "SkeletonAsset" << YAML::Value << comp.skeletonAsset;
+			out << YAML::Key << "UseLevelOfDetail" << YAML::Value << comp.useLevelOfDetail;
+			out << YAML::Key << "LevelOfDetails" << YAML::Value << YAML::BeginSeq;
+			for (const auto& lod : comp.levelOfDetails) {
+				out << YAML::BeginMap;
+				out << YAML::Key << "MinScreenSize" << YAML::Value << lod.minScreenSize;
+				out << YAML::Key << "UpdateInterval" << YAML::Value << lod.updateInterval;
+				out << YAML::Key << "MaxBoneDepth" << YAML::Value << lod.maxBoneDepth;
+				out << YAML::EndMap;
+			}
+			out << YAML::EndSeq;
+			out << YAML::Key << "OffscreenUpdateInterval" << YAML::Value << comp.offscreenUpdateInterval;
+			out << YAML::Key << "UseCrowdPose" << YAML::Value << comp.useCrowdPose;
+			out << YAML::Key << "CrowdPoseTimeStep" << YAML::Value << comp.crowdPoseTimeStep;
 			out << YAML::EndMap;
 		}
 
@@ -510,6 +525,11 @@ namespace flaw {
 		config.name = root["Name"].as<std::string>();
 		config.path = root["Path"].as<std::string>();
 		config.startScene = root["StartScene"].as<std::string>();
+
+		// projects saved before bundles existed have none
+		if (root["Bundles"]) {
+			config.bundles = root["Bundles"].as<std::vector<std::string>>();
+		}
 	}
 
 	void DeserializeEntityComponent(const YAML::iterator::value_type& component, Entity& entity) {
@@ -792,6 +812,30 @@ namespace flaw {
 	void DeserializeAnimatorComponent(const YAML::iterator::value_type& component, Entity& entity) {
 		auto& comp = entity.AddComponent<AnimatorComponent>();
 		comp.skeletonAsset = component.second["SkeletonAsset"].as<uint64_t>();
+		if (component.second["AnimatorAsset"]) {
+			comp.animatorAsset = component.second["AnimatorAsset"].as<uint64_t>();
+		}
+
+		if (component.second["UseCrowdPose"]) {
+			comp.useCrowdPose = component.second["UseCrowdPose"].as<bool>();
+			comp.crowdPoseTimeStep = component.second["CrowdPoseTimeStep"].as<float>();
+		}
+
+		// scenes saved before animation lod keep the defaults
+		if (!component.second["LevelOfDetails"]) {
+			return;
+		}
+
+		comp.useLevelOfDetail = component.second["UseLevelOfDetail"].as<bool>();
+		comp.levelOfDetails.clear();
+		for (const auto& lodNode : component.second["LevelOfDetails"]) {
+			AnimatorLevelOfDetail lod;
+			lod.minScreenSize = lodNode["MinScreenSize"].as<float>();
+			lod.updateInterval = lodNode["UpdateInterval"].as<int32_t>();
+			lod.maxBoneDepth = lodNode["MaxBoneDepth"].as<int32_t>();
+			comp.levelOfDetails.push_back(lod);
+		}
+		comp.offscreenUpdateInterval = component.second["OffscreenUpdateInterval"].as<int32_t>();
 	}
 
 	void DeserializeMonoScriptComponent(const YAML::iterator::value_type& component, Entity& entity) {
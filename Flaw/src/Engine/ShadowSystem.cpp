@@ -227,7 +227,17 @@ namespace flaw {
 			}
 
 			if (animationSys.HasAnimatorJobContext(entity)) {
-				boneMatricesSB = animationSys.GetAnimatorJobContext(entity).animatedSkinMatricesSB;
+				boneMatricesSB = animationSys.GetAnimatedSkinMatricesSB(entity);
+
+				// a mesh only seen through its shadow must keep animating
+				const MeshBoundingSphere& boundingSphere = mesh->GetBoundingSphere();
+				const vec3 center = transform.worldTransform * vec4(boundingSphere.center, 1.0f);
+				const float maxScale = sqrt(glm::compMax(vec3(length2(transform.worldTransform[0]), length2(transform.worldTransform[1]), length2(transform.worldTransform[2]))));
+
+				const float screenSize = GetShadowMapScreenSize(center, boundingSphere.radius * maxScale);
+				if (screenSize >= 0.0f) {
+					animationSys.ReportScreenSize(entity, screenSize);
+				}
 			}
 			else {
 				auto& skeletonUniforms = skeletalSys.GetSkeletonUniforms(skeletonAsset->GetSkeleton());
@@ -247,14 +257,14 @@ namespace flaw {
 #if false // linear split cascade
 	std::vector<Frustum::Corners> ShadowSystem::GetCascadeFrustumCorners(const Frustum& frustum) {
 		Frustum::Corners worldSpaceCorners = frustum.GetCorners();
-		vec3 tln2tlfDir = worldSpaceCorners.topLeftFar - worldSpaceCorners.topLeftNear;
+		vec3 tln2tlfDir = worldSpaceCorners.topLeftFar() - worldSpaceCorners.topLeftNear();
 		float dist = glm::length(tln2tlfDir);
 
 		vec3 directions[4] = {
 			tln2tlfDir / dist,
-			(worldSpaceCorners.topRightFar - worldSpaceCorners.topRightNear) / dist,
-			(worldSpaceCorners.bottomRightFar - worldSpaceCorners.bottomRightNear) / dist,
-			(worldSpaceCorners.bottomLeftFar - worldSpaceCorners.bottomLeftNear) / dist
+			(worldSpaceCorners.topRightFar() - worldSpaceCorners.topRightNear()) / dist,
+			(worldSpaceCorners.bottomRightFar() - worldSpaceCorners.bottomRightNear()) / dist,
+			(worldSpaceCorners.bottomLeftFar() - worldSpaceCorners.bottomLeftNear()) / dist
 		};
 
 		float stepDist = dist / (float)CascadeShadowCount;
@@ -284,10 +294,10 @@ namespace flaw {
 	std::vector<Frustum::Corners> ShadowSystem::GetCascadeFrustumCorners(const Frustum& frustum) {
 		Frustum::Corners worldSpaceCorners = frustum.GetCorners();
 
-		vec3 viewDirTL = worldSpaceCorners.topLeftFar - worldSpaceCorners.topLeftNear;
-		vec3 viewDirTR = worldSpaceCorners.topRightFar - worldSpaceCorners.topRightNear;
-		vec3 viewDirBR = worldSpaceCorners.bottomRightFar - worldSpaceCorners.bottomRightNear;
-		vec3 viewDirBL = worldSpaceCorners.bottomLeftFar - worldSpaceCorners.bottomLeftNear;
+		vec3 viewDirTL = worldSpaceCorners.topLeftFar() - worldSpaceCorners.topLeftNear();
+		vec3 viewDirTR = worldSpaceCorners.topRightFar() - worldSpaceCorners.topRightNear();
+		vec3 viewDirBR = worldSpaceCorners.bottomRightFar() - worldSpaceCorners.bottomRightNear();
+		vec3 viewDirBL = worldSpaceCorners.bottomLeftFar() - worldSpaceCorners.bottomLeftNear();
 
 		float nearDist = glm::length(viewDirTL);
 		float farDist = nearDist * CascadeShadowCount;
@@ -315,22 +325,22 @@ namespace flaw {
 
 			Frustum::Corners& corners = cascadeCornersList[i];
 
-			corners.topLeftNear = worldSpaceCorners.topLeftNear + viewDirTL * startRatio;
-			corners.topRightNear = worldSpaceCorners.topRightNear + viewDirTR * startRatio;
-			corners.bottomRightNear = worldSpaceCorners.bottomRightNear + viewDirBR * startRatio;
-			corners.bottomLeftNear = worldSpaceCorners.bottomLeftNear + viewDirBL * startRatio;
+			corners.topLeftNear() = worldSpaceCorners.topLeftNear() + viewDirTL * startRatio;
+			corners.topRightNear() = worldSpaceCorners.topRightNear() + viewDirTR * startRatio;
+			corners.bottomRightNear() = worldSpaceCorners.bottomRightNear() + viewDirBR * startRatio;
+			corners.bottomLeftNear() = worldSpaceCorners.bottomLeftNear() + viewDirBL * startRatio;
 
-			corners.topLeftFar = worldSpaceCorners.topLeftNear + viewDirTL * endRatio;
-			corners.topRightFar = worldSpaceCorners.topRightNear + viewDirTR * endRatio;
-			corners.bottomRightFar = worldSpaceCorners.bottomRightNear + viewDirBR * endRatio;
-			corners.bottomLeftFar = worldSpaceCorners.bottomLeftNear + viewDirBL * endRatio;
+			corners.topLeftFar() = worldSpaceCorners.topLeftNear() + viewDirTL * endRatio;
+			corners.topRightFar() = worldSpaceCorners.topRightNear() + viewDirTR * endRatio;
+			corners.bottomRightFar() = worldSpaceCorners.bottomRightNear() + viewDirBR * endRatio;
+			corners.bottomLeftFar() = worldSpaceCorners.bottomLeftNear() + viewDirBL * endRatio;
 		}
 
 		return cascadeCornersList;
 	}
 #endif
 
-	void ShadowSystem::CalcTightDirectionalLightMatrices(const Frustum::Corners& worldSpaceCorners, const vec3& lightDirection, mat4& outView, mat4& outProjection) {
+	void ShadowSystem::CalcTightDirectionalLightMatrices(const Frustum::Corners& worldSpaceCorners, const vec3& lightDirection, mat4& outView, mat4& outProjection, Frustum& outFrustum) {
 		mat4 lightViewMatrix = LookAt(vec3(0.0), lightDirection, Up);
 
 		// # calculate corners coordinates in light space and get min, max coord elements
@@ -368,10 +378,29 @@ namespace flaw {
 
 		// # calculate projection matrix
 		outProjection = Orthographic(minCornerInLightView.x, maxCornerInLightView.x, minCornerInLightView.y, maxCornerInLightView.y, minCornerInLightView.z, maxCornerInLightView.z);
+
+		// # same box as the projection, off center in light view space
+		CreateOrthographicFrustum(minCornerInLightView.x, maxCornerInLightView.x, minCornerInLightView.y, maxCornerInLightView.y, minCornerInLightView.z, maxCornerInLightView.z, outView, outFrustum);
 	}
 
 	void ShadowSystem::Render(const vec3& cameraPos, const Frustum& cameraFrustum) {
 		auto worldSpaceCornersArr = GetCascadeFrustumCorners(cameraFrustum);
+
+		// cascades only depend on the camera and the light, not on the entries drawn into them
+		for (auto& [entt, shadowMap] : _directionalShadowMaps) {
+			for (int32_t i = 0; i < CascadeShadowCount; i++) {
+				const auto& worldSpaceCorners = worldSpaceCornersArr[i];
+				auto& vpMatrix = shadowMap.lightVPMatrices[i];
+
+				CalcTightDirectionalLightMatrices(worldSpaceCorners, shadowMap.lightDirection, vpMatrix.view, vpMatrix.projection, shadowMap.cascadeFrustums[i]);
+
+				vec3 p0 = glm::mix(worldSpaceCorners.topLeftFar(), worldSpaceCorners.topRightFar(), 0.5f);
+				vec3 p1 = glm::mix(worldSpaceCorners.bottomLeftFar(), worldSpaceCorners.bottomRightFar(), 0.5f);
+				vec3 center = glm::mix(p0, p1, 0.5f);
+
+				shadowMap.cascadeDistances[i] = glm::length(center - cameraPos);
+			}
+		}
 		
 		while (!_shadowMapRenderQueue.Empty()) {
 			auto& entry = _shadowMapRenderQueue.Front();
@@ -379,19 +408,8 @@ namespace flaw {
 
 			for (auto& [entt, shadowMap] : _directionalShadowMaps) {
 				for (int32_t i = 0; i < CascadeShadowCount; i++) {
-					const auto& worldSpaceCorners = worldSpaceCornersArr[i];
-					auto& vpMatrix = shadowMap.lightVPMatrices[i];
-
-					CalcTightDirectionalLightMatrices(worldSpaceCorners, shadowMap.lightDirection, vpMatrix.view, vpMatrix.projection);
-					
-					vec3 p0 = glm::mix(worldSpaceCorners.topLeftFar, worldSpaceCorners.topRightFar, 0.5f);
-					vec3 p1 = glm::mix(worldSpaceCorners.bottomLeftFar, worldSpaceCorners.bottomRightFar, 0.5f);
-					vec3 center = glm::mix(p0, p1, 0.5f);
-					
-					shadowMap.cascadeDistances[i] = glm::length(center - cameraPos);
-
 					shadowMap.renderPasses[i]->Bind(false, false);
-					DrawRenderEntry(entry, &vpMatrix, 1);
+					DrawRenderEntry(entry, &shadowMap.lightVPMatrices[i], 1, &shadowMap.cascadeFrustums[i]);
 					shadowMap.renderPasses[i]->Unbind();
 				}
 			}
@@ -410,7 +428,62 @@ namespace flaw {
 		}
 	}
 
-	void ShadowSystem::DrawRenderEntry(const RenderEntry& entry, const LightVPMatrix* lightVPMatrices, int32_t lightVPMatrixCount) {
+	float ShadowSystem::GetShadowMapScreenSize(const vec3& center, float radius) {
+		auto& registry = _scene.GetRegistry();
+
+		float screenSize = -1.0f;
+
+		// cascades of the last render, one frame behind like the camera reports
+		for (auto& [entity, shadowMap] : _directionalShadowMaps) {
+			for (int32_t i = 0; i < CascadeShadowCount; ++i) {
+				if (shadowMap.cascadeDistances[i] > 0.0f && shadowMap.cascadeFrustums[i].TestInside(center, radius, mat4(1.0f))) {
+					screenSize = std::max(screenSize, radius * shadowMap.lightVPMatrices[i].projection[1][1]);
+				}
+			}
+		}
+
+		for (auto&& [entity, transform, lightComp] : registry.view<TransformComponent, SpotLightComponent>().each()) {
+			const vec3 toCenter = center - transform.GetWorldPosition();
+			const float distance = std::max(length(toCenter), 0.0001f);
+			if (distance - radius > lightComp.range) {
+				continue;
+			}
+
+			// the cone grows by the angle the sphere spans
+			const float angle = std::acos(glm::clamp(dot(toCenter / distance, transform.GetWorldFront()), -1.0f, 1.0f));
+			if (angle - std::asin(std::min(radius / distance, 1.0f)) > lightComp.outer) {
+				continue;
+			}
+
+			auto& shadowMap = _spotLightShadowMaps[entity];
+			screenSize = std::max(screenSize, radius * shadowMap.lightVPMatrix.projection[1][1] / distance);
+		}
+
+		// the faces are 90 degrees, their projection scale is 1
+		for (auto&& [entity, transform, lightComp] : registry.view<TransformComponent, PointLightComponent>().each()) {
+			const float distance = std::max(length(center - transform.GetWorldPosition()), 0.0001f);
+			if (distance - radius <= lightComp.range) {
+				screenSize = std::max(screenSize, radius / distance);
+			}
+		}
+
+		return screenSize;
+	}
+
+	uint32_t ShadowSystem::CullInstances(const Mesh& mesh, const BatchedData* batchedDatas, uint32_t instanceCount, Frustum& frustum) {
+		const MeshBoundingSphere& boundingSphere = mesh.GetBoundingSphere();
+
+		_culledBatchedDatas.clear();
+		for (uint32_t i = 0; i < instanceCount; ++i) {
+			if (frustum.TestInside(boundingSphere.center, boundingSphere.radius, batchedDatas[i].worldMatrix)) {
+				_culledBatchedDatas.push_back(batchedDatas[i]);
+			}
+		}
+
+		return static_cast<uint32_t>(_culledBatchedDatas.size());
+	}
+
+	void ShadowSystem::DrawRenderEntry(const RenderEntry& entry, const LightVPMatrix* lightVPMatrices, int32_t lightVPMatrixCount, Frustum* cullFrustum) {
 		auto& cmdQueue = Graphics::GetCommandQueue();
 		auto& pipeline = Graphics::GetMainGraphicsPipeline();
 		auto batchedTransformSB = Graphics::GetBatchedDataSB();
@@ -438,11 +511,22 @@ namespace flaw {
 			auto& mesh = obj.mesh;
 			auto& meshSegment = mesh->GetMeshSegementAt(obj.segmentIndex);
 
-			batchedTransformSB->Update(obj.batchedDatas.data(), obj.batchedDatas.size() * sizeof(BatchedData));
+			const BatchedData* batchedDatas = obj.batchedDatas;
+			uint32_t instanceCount = obj.instanceCount;
+			if (cullFrustum) {
+				instanceCount = CullInstances(*mesh, batchedDatas, instanceCount, *cullFrustum);
+				batchedDatas = _culledBatchedDatas.data();
+			}
+
+			if (instanceCount == 0) {
+				continue;
+			}
+
+			batchedTransformSB->Update(batchedDatas, instanceCount * sizeof(BatchedData));
 
 			cmdQueue.SetPrimitiveTopology(meshSegment.topology);
 			cmdQueue.SetVertexBuffer(mesh->GetGPUVertexBuffer());
-			cmdQueue.DrawIndexedInstanced(mesh->GetGPUIndexBuffer(), meshSegment.indexCount, obj.instanceCount, meshSegment.indexStart, meshSegment.vertexStart);
+			cmdQueue.DrawIndexedInstanced(mesh->GetGPUIndexBuffer(), meshSegment.indexCount, instanceCount, meshSegment.indexStart, meshSegment.vertexStart);
 			cmdQueue.Execute();
 		}
 
@@ -450,12 +534,24 @@ namespace flaw {
 			auto& mesh = obj.mesh;
 			auto& meshSegment = mesh->GetMeshSegementAt(obj.segmentIndex);
 
-			batchedTransformSB->Update(obj.batchedDatas.data(), obj.batchedDatas.size() * sizeof(BatchedData));
+			// bind pose bounds, same as the camera culling of skinned meshes
+			const BatchedData* batchedDatas = obj.batchedDatas;
+			uint32_t instanceCount = obj.instanceCount;
+			if (cullFrustum) {
+				instanceCount = CullInstances(*mesh, batchedDatas, instanceCount, *cullFrustum);
+				batchedDatas = _culledBatchedDatas.data();
+			}
+
+			if (instanceCount == 0) {
+				continue;
+			}
+
+			batchedTransformSB->Update(batchedDatas, instanceCount * sizeof(BatchedData));
 
 			cmdQueue.SetPrimitiveTopology(meshSegment.topology);
 			cmdQueue.SetStructuredBuffer(obj.skeletonBoneMatrices, 2);
 			cmdQueue.SetVertexBuffer(mesh->GetGPUVertexBuffer());
-			cmdQueue.DrawIndexedInstanced(mesh->GetGPUIndexBuffer(), meshSegment.indexCount, obj.instanceCount, meshSegment.indexStart, meshSegment.vertexStart);
+			cmdQueue.DrawIndexedInstanced(mesh->GetGPUIndexBuffer(), meshSegment.indexCount, instanceCount, meshSegment.indexStart, meshSegment.vertexStart);
 			cmdQueue.Execute();
 		}
 	}
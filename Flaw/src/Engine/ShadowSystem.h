@@ -28,6 +28,7 @@ namespace flaw {
 		vec3 lightDirection;
 		std::array<LightVPMatrix, CascadeShadowCount> lightVPMatrices;
 		std::array<float, CascadeShadowCount> cascadeDistances; // Split distances for each cascade
+		std::array<Frustum, CascadeShadowCount> cascadeFrustums; // World space box of each cascade projection, casters outside it are skipped
 		std::array<Ref<GraphicsRenderPass>, CascadeShadowCount> renderPasses;
 	};
 
@@ -91,9 +92,16 @@ namespace flaw {
 		Ref<GraphicsRenderPass> CreatePointLightShadowMapRenderPass();
 
 		std::vector<Frustum::Corners> GetCascadeFrustumCorners(const Frustum& frustum);
-		void CalcTightDirectionalLightMatrices(const Frustum::Corners& worldSpaceCorners, const vec3& lightDirection, mat4& outView, mat4& outProjection);
+		void CalcTightDirectionalLightMatrices(const Frustum::Corners& worldSpaceCorners, const vec3& lightDirection, mat4& outView, mat4& outProjection, Frustum& outFrustum);
 
-		void DrawRenderEntry(const RenderEntry& entry, const LightVPMatrix* lightVPMatrices, int32_t lightVPMatrixCount);
+		// instances outside cullFrustum are not drawn, null draws every instance
+		void DrawRenderEntry(const RenderEntry& entry, const LightVPMatrix* lightVPMatrices, int32_t lightVPMatrixCount, Frustum* cullFrustum = nullptr);
+
+		// largest fraction of a shadow map the bounding sphere covers, -1 when no shadow map sees it
+		float GetShadowMapScreenSize(const vec3& center, float radius);
+
+		// copies the instances whose bounding sphere touches the frustum into _culledBatchedDatas, returns their count
+		uint32_t CullInstances(const Mesh& mesh, const BatchedData* batchedDatas, uint32_t instanceCount, Frustum& frustum);
 
 	private:
 		constexpr static uint32_t ShadowMapSize = 2048;
@@ -108,6 +116,7 @@ namespace flaw {
 		Ref<StructuredBuffer> _lightVPMatricesSB;
 
 		RenderQueue _shadowMapRenderQueue;
+		std::vector<BatchedData> _culledBatchedDatas;
 
 		std::unordered_map<entt::entity, DirectionalLightShadowMap> _directionalShadowMaps;
 		std::unordered_map<entt::entity, SpotLightShadowMap> _spotLightShadowMaps;
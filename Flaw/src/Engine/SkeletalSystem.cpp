@@ -71,8 +71,7 @@ namespace flaw {
 				auto& targetEnttTransComp = targetEntity.GetComponent<TransformComponent>();
 				mat4 globalTransform = mat4(1.0f);
 				if (animationSys.HasAnimatorJobContext(entity)) {
-					auto& animatorContext = animationSys.GetAnimatorJobContext(entity);
-					auto& animatedPoseBoneMatrices = *animatorContext.frontAnimatedBoneMatrices;
+					auto& animatedPoseBoneMatrices = animationSys.GetAnimatedBoneMatrices(entity);
 
 					globalTransform = transComp.worldTransform * animatedPoseBoneMatrices[socketNode.boneIndex] * socketNode.localTransform;
 				}
@@ -83,14 +82,15 @@ namespace flaw {
 					globalTransform = transComp.worldTransform * bindingPoseBoneMatrices[socketNode.boneIndex] * socketNode.localTransform;
 				}
 
-				transformSys.UpdateTransformImmediate(targetEntity);
-
 				mat4 parentWorldMatrix = targetEntity.HasParent() ? targetEntity.GetParent().GetComponent<TransformComponent>().worldTransform : mat4(1.0f);
 				mat4 localMatrix = glm::inverse(parentWorldMatrix) * globalTransform;
 				targetEnttTransComp.position = ExtractPosition(localMatrix);
 				targetEnttTransComp.rotation = ExtractRotation(localMatrix);
 				targetEnttTransComp.dirty = true;
 
+				// runs after the transform system, the attachment and its children are brought up to date here
+				transformSys.UpdateTransformImmediate(targetEntity);
+
 				++attIt;
 			}
 		}
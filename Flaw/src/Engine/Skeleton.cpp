@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Skeleton.h"
+#include "AnimationCompression.h"
 #include "Utils/Search.h"
 #include "Log/Log.h"
 
@@ -12,61 +13,153 @@ namespace flaw {
 	{
 	}
 
-	mat4 SkeletalAnimationNode::GetTransformMatrix(float time) const {
-		return ModelMatrix(InterpolatePosition(time), InterpolateRotation(time), InterpolateScale(time));
+	SkeletalAnimationNode::SkeletalAnimationNode(const CompressedSkeletalAnimationNode& compressed)
+		: _nodeName(compressed.nodeName)
+		, _compressed(true)
+		, _compressedData(compressed)
+	{
 	}
 
-	vec3 SkeletalAnimationNode::InterpolatePosition(float time) const {
-		int32_t index = Lowerbound<SkeletalAnimationNodeKey<vec3>>(_positionKeys, [&time](const auto& pair) { return pair.time >= time; });
-		if (index == 0) {
-			return _positionKeys[0].value;
-		}
-		else if (index == _positionKeys.size()) {
-			return _positionKeys.back().value;
+	// keys walked from the cursor before falling back to a binary search
+	constexpr int32_t MaxKeyCursorSteps = 4;
+
+	// index of the first key at or after time, same as a lower bound search
+	template<typename Key, typename GetTime>
+	static int32_t FindKeyIndex(const std::vector<Key>& keys, float time, int32_t& keyCursor, const GetTime& getTime) {
+		const int32_t keyCount = static_cast<int32_t>(keys.size());
+		auto isAtOrAfter = [time, &getTime](const Key& key) { return getTime(key) >= time; };
+
+		int32_t index = keyCursor;
+		if (index < 0 || index > keyCount || (index > 0 && getTime(keys[index - 1]) >= time)) {
+			// first sample or time went backwards
+			index = Lowerbound(keys, isAtOrAfter);
 		}
+		else {
+			const int32_t stepEnd = std::min(index + MaxKeyCursorSteps, keyCount);
+			while (index < stepEnd && getTime(keys[index]) < time) {
+				index++;
+			}
 
-		const auto& key0 = _positionKeys[index - 1];
-		const auto& key1 = _positionKeys[index];
-		const float factor = (time - key0.time) / (key1.time - key0.time);
+			if (index == stepEnd && index < keyCount && getTime(keys[index]) < time) {
+				index = Lowerbound(keys, index, keyCount, isAtOrAfter);
+			}
+		}
 
-		return mix(key0.value, key1.value, factor);
+		keyCursor = index;
+		return index;
 	}
 
-	quat SkeletalAnimationNode::InterpolateRotation(float time) const {
-		int32_t index = Lowerbound<SkeletalAnimationNodeKey<vec4>>(_rotationKeys, [&time](const auto& pair) { return pair.time >= time; });
+	// getValue decodes a key, interpolate blends two decoded values
+	template<typename Key, typename GetTime, typename GetValue, typename Interpolate>
+	static auto SampleKeys(const std::vector<Key>& keys, float time, int32_t& keyCursor, const GetTime& getTime, const GetValue& getValue, const Interpolate& interpolate) {
+		const int32_t index = FindKeyIndex(keys, time, keyCursor, getTime);
 		if (index == 0) {
-			const auto& key = _rotationKeys[0];
-			return quat(key.value.w, key.value.x, key.value.y, key.value.z);
+			return getValue(keys[0]);
 		}
-		else if (index == _rotationKeys.size()) {
-			const auto& key = _rotationKeys.back();
-			return quat(key.value.w, key.value.x, key.value.y, key.value.z);
+		else if (index == static_cast<int32_t>(keys.size())) {
+			return getValue(keys.back());
 		}
 
-		const auto& key0 = _rotationKeys[index - 1];
-		const auto& key1 = _rotationKeys[index];
-		const float factor = (time - key0.time) / (key1.time - key0.time);
+		const auto& key0 = keys[index - 1];
+		const auto& key1 = keys[index];
+		const float time0 = getTime(key0);
+		const float factor = (time - time0) / (getTime(key1) - time0);
+
+		return interpolate(getValue(key0), getValue(key1), factor);
+	}
+
+	static quat ToQuat(const vec4& value) {
+		return quat(value.w, value.x, value.y, value.z);
+	}
+
+	static vec3 DecodeRangeKey(const QuantizedAnimationKey& key, const vec3& minValue, const vec3& range) {
+		return vec3(
+			DequantizeRange16(key.value[0], minValue.x, range.x),
+			DequantizeRange16(key.value[1], minValue.y, range.y),
+			DequantizeRange16(key.value[2], minValue.z, range.z)
+		);
+	}
+
+	static vec3 LerpVec3(const vec3& a, const vec3& b, float factor) {
+		return mix(a, b, factor);
+	}
+
+	static quat SlerpQuat(const quat& a, const quat& b, float factor) {
+		return normalize(slerp(a, b, factor));
+	}
+
+	mat4 SkeletalAnimationNode::GetTransformMatrix(float time) const {
+		return ModelMatrix(InterpolatePosition(time), InterpolateRotation(time), InterpolateScale(time));
+	}
+
+	mat4 SkeletalAnimationNode::GetTransformMatrix(float time, SkeletalAnimationNodeCursor& cursor) const {
+		return ModelMatrix(InterpolatePosition(time, cursor.positionKey), InterpolateRotation(time, cursor.rotationKey), InterpolateScale(time, cursor.scaleKey));
+	}
 
-		quat q1 = quat(key0.value.w, key0.value.x, key0.value.y, key0.value.z);
-		quat q2 = quat(key1.value.w, key1.value.x, key1.value.y, key1.value.z);
+	vec3 SkeletalAnimationNode::InterpolatePosition(float time) const {
+		int32_t keyCursor = -1;
+		return InterpolatePosition(time, keyCursor);
+	}
 
-		return normalize(slerp(q1, q2, factor));
+	quat SkeletalAnimationNode::InterpolateRotation(float time) const {
+		int32_t keyCursor = -1;
+		return InterpolateRotation(time, keyCursor);
 	}
 
 	vec3 SkeletalAnimationNode::InterpolateScale(float time) const {
-		int32_t index = Lowerbound<SkeletalAnimationNodeKey<vec3>>(_scaleKeys, [&time](const auto& pair) { return pair.time >= time; });
-		if (index == 0) {
-			return _scaleKeys[0].value;
+		int32_t keyCursor = -1;
+		return InterpolateScale(time, keyCursor);
+	}
+
+	vec3 SkeletalAnimationNode::InterpolatePosition(float time, int32_t& keyCursor) const {
+		if (_compressed) {
+			const auto& data = _compressedData;
+			return SampleKeys(data.positionKeys, time, keyCursor,
+				[&data](const QuantizedAnimationKey& key) { return key.time * data.timeStep; },
+				[&data](const QuantizedAnimationKey& key) { return DecodeRangeKey(key, data.positionMin, data.positionRange); },
+				LerpVec3
+			);
 		}
-		else if (index == _scaleKeys.size()) {
-			return _scaleKeys.back().value;
+
+		return SampleKeys(_positionKeys, time, keyCursor,
+			[](const SkeletalAnimationNodeKey<vec3>& key) { return key.time; },
+			[](const SkeletalAnimationNodeKey<vec3>& key) { return key.value; },
+			LerpVec3
+		);
+	}
+
+	quat SkeletalAnimationNode::InterpolateRotation(float time, int32_t& keyCursor) const {
+		if (_compressed) {
+			const auto& data = _compressedData;
+			return SampleKeys(data.rotationKeys, time, keyCursor,
+				[&data](const QuantizedAnimationKey& key) { return key.time * data.timeStep; },
+				[](const QuantizedAnimationKey& key) { return ToQuat(DecodeSmallestThree(key.value)); },
+				SlerpQuat
+			);
 		}
 
-		const auto& key0 = _scaleKeys[index - 1];
-		const auto& key1 = _scaleKeys[index];
-		const float factor = (time - key0.time) / (key1.time - key0.time);
+		return SampleKeys(_rotationKeys, time, keyCursor,
+			[](const SkeletalAnimationNodeKey<vec4>& key) { return key.time; },
+			[](const SkeletalAnimationNodeKey<vec4>& key) { return ToQuat(key.value); },
+			SlerpQuat
+		);
+	}
+
+	vec3 SkeletalAnimationNode::InterpolateScale(float time, int32_t& keyCursor) const {
+		if (_compressed) {
+			const auto& data = _compressedData;
+			return SampleKeys(data.scaleKeys, time, keyCursor,
+				[&data](const QuantizedAnimationKey& key) { return key.time * data.timeStep; },
+				[&data](const QuantizedAnimationKey& key) { return DecodeRangeKey(key, data.scaleMin, data.scaleRange); },
+				LerpVec3
+			);
+		}
 
-		return mix(key0.value, key1.value, factor);
+		return SampleKeys(_scaleKeys, time, keyCursor,
+			[](const SkeletalAnimationNodeKey<vec3>& key) { return key.time; },
+			[](const SkeletalAnimationNodeKey<vec3>& key) { return key.value; },
+			LerpVec3
+		);
 	}
 
 	SkeletalAnimation::SkeletalAnimation(const std::string& name, float durationSec, const std::vector<SkeletalAnimationNode>& animationNodes)
@@ -79,6 +172,20 @@ namespace flaw {
 		}
 	}
 
+	SkeletalAnimation::SkeletalAnimation(const std::string& name, float durationSec, const std::vector<CompressedSkeletalAnimationNode>& compressedNodes)
+		: _name(name)
+		, _durationSec(durationSec)
+	{
+		_nodes.reserve(compressedNodes.size());
+		for (const auto& compressedNode : compressedNodes) {
+			_nodes.emplace_back(compressedNode);
+		}
+
+		for (size_t i = 0; i < _nodes.size(); ++i) {
+			_nodeMap[_nodes[i].GetNodeName()] = i;
+		}
+	}
+
 	int32_t SkeletalAnimation::GetNodeIndex(const std::string& nodeName) const {
 		auto it = _nodeMap.find(nodeName);
 		if (it != _nodeMap.end()) {
@@ -87,15 +194,34 @@ namespace flaw {
 		return -1;
 	}
 
+	SkeletalAnimationBinding::SkeletalAnimationBinding(const Skeleton& skeleton, const SkeletalAnimation& animation) {
+		const auto& nodes = skeleton.GetNodes();
+
+		_animationNodeIndices.resize(nodes.size());
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			_animationNodeIndices[i] = animation.GetNodeIndex(nodes[i].name);
+		}
+	}
+
 	Skeleton::Skeleton(const Descriptor& desc)
 		: _globalInvMatrix(desc.globalInvMatrix)
 		, _nodes(desc.nodes)
 	{
+		_parentIndices.resize(_nodes.size());
+		_nodeDepths.resize(_nodes.size());
+		_bindingPose.Resize(_nodes.size());
+		for (size_t i = 0; i < _nodes.size(); ++i) {
+			const auto& node = _nodes[i];
+			FASSERT(node.parentIndex < static_cast<int32_t>(i), "Skeleton nodes must be sorted parent first");
+
+			_parentIndices[i] = node.parentIndex;
+			_nodeDepths[i] = node.IsRoot() ? 0 : _nodeDepths[node.parentIndex] + 1;
+			ExtractModelMatrix(node.transformMatrix, _bindingPose.positions[i], _bindingPose.rotations[i], _bindingPose.scales[i]);
+		}
+
 		_bones.resize(desc.bones.size());
 		for (const auto& boneNode : desc.bones) {
-			const auto& node = _nodes[boneNode.nodeIndex];
 			_bones[boneNode.boneIndex] = boneNode;
-			_boneNameToIndexMap[node.name] = boneNode.boneIndex;
 		}
 
 		for (const auto& socket : desc.sockets) {
@@ -116,209 +242,21 @@ namespace flaw {
 		throw std::runtime_error("Bone socket not found: " + socketName);
 	}
 
-	void Skeleton::ComputeMatricesInHierachy(const std::function<mat4(int32_t)>& getNodeTransformMatrixFunc, const std::function<void(const mat4&, const mat4&, int32_t)>& hanldeFunc) const {
-		std::vector<mat4> parentMatrices(_nodes.size());
+	Ref<SkeletalAnimationBinding> Skeleton::GetAnimationBinding(const Ref<SkeletalAnimation>& animation) const {
+		std::lock_guard<std::mutex> lock(_animationBindingMutex);
 
-		for (int32_t i = 0; i < _nodes.size(); ++i) {
-			const auto& node = _nodes[i];
-			mat4 localMatrix = getNodeTransformMatrixFunc(i);
-			mat4 transformMatrix = node.IsRoot() ? localMatrix : parentMatrices[node.parentIndex] * localMatrix;
-			
-			auto it = _boneNameToIndexMap.find(node.name);
-			if (it != _boneNameToIndexMap.end()) {
-				int32_t boneIndex = it->second;
-				const auto& boneNode = _bones[boneIndex];
-
-				hanldeFunc(transformMatrix, boneNode.offsetMatrix, boneIndex);
-			}
-
-			parentMatrices[i] = transformMatrix;
+		auto& entry = _animationBindings[animation.get()];
+		if (!entry.binding || entry.animation.lock() != animation) {
+			entry.animation = animation;
+			entry.binding = CreateRef<SkeletalAnimationBinding>(*this, *animation);
 		}
-	}
-
-	void Skeleton::GetBindingPoseBoneMatrices(std::vector<mat4>& out) const {
-		out.resize(_bones.size());
-		ComputeMatricesInHierachy(
-			[this](int32_t nodeIndex) { return _nodes[nodeIndex].transformMatrix; },
-			[this, &out](const mat4& transformMatrix, const mat4& offsetMatrix, int32_t boneIndex) {
-				out[boneIndex] = transformMatrix;
-			}
-		);
-	}
 
-	void Skeleton::GetAnimatedBoneMatrices(const Ref<SkeletalAnimation>& animation, float normalizedTime, std::vector<mat4>& out) const {
-		const float timeSec = animation->GetDurationSec() * normalizedTime;
-		out.resize(_bones.size());
-		ComputeMatricesInHierachy(
-			[this, &animation, &timeSec](int32_t nodeIndex) {
-				int32_t animationNodeIndex = animation->GetNodeIndex(_nodes[nodeIndex].name);
-				if (animationNodeIndex != -1) {
-					return animation->GetAnimationNodeAt(animationNodeIndex).GetTransformMatrix(timeSec);
-				}
-				return _nodes[nodeIndex].transformMatrix;
-			},
-			[this, &out](const mat4& transformMatrix, const mat4& offsetMatrix, int32_t boneIndex) {
-				out[boneIndex] = transformMatrix;
-			}
-		);
+		return entry.binding;
 	}
 
 	void Skeleton::GetBindingPoseSkinMatrices(std::vector<mat4>& out) const {
-		out.resize(_bones.size());
-		ComputeMatricesInHierachy(
-			[this](int32_t nodeIndex) { return _nodes[nodeIndex].transformMatrix; },
-			[this, &out](const mat4& transformMatrix, const mat4& offsetMatrix, int32_t boneIndex) {
-				out[boneIndex] = _globalInvMatrix * transformMatrix * offsetMatrix;
-			}
-		);
-	}
-
-	void Skeleton::GetBlendedAnimatedBoneMatrices(const Ref<SkeletalAnimation>& animation1, const Ref<SkeletalAnimation>& animation2, float normalizedTime, float blendFactor, std::vector<mat4>& out) const {
-		const float timeSec1 = animation1->GetDurationSec() * normalizedTime;
-		const float timeSec2 = animation2->GetDurationSec() * normalizedTime;
-
-		out.resize(_bones.size());
-		ComputeMatricesInHierachy(
-			[this, &animation1, &animation2, &normalizedTime, &blendFactor, &timeSec1, &timeSec2](int32_t nodeIndex) {
-				int32_t animationNodeIndex1 = animation1->GetNodeIndex(_nodes[nodeIndex].name);
-				int32_t animationNodeIndex2 = animation2->GetNodeIndex(_nodes[nodeIndex].name);
-				if (animationNodeIndex1 != -1 && animationNodeIndex2 != -1) {
-					const auto& animationNode1 = animation1->GetAnimationNodeAt(animationNodeIndex1);
-					const auto& animationNode2 = animation2->GetAnimationNodeAt(animationNodeIndex2);
-					const vec3 position = mix(animationNode1.InterpolatePosition(timeSec1), animationNode2.InterpolatePosition(timeSec2), blendFactor);
-					const quat rotation = normalize(slerp(animationNode1.InterpolateRotation(timeSec1), animationNode2.InterpolateRotation(timeSec2), blendFactor));
-					const vec3 scale = mix(animationNode1.InterpolateScale(timeSec1), animationNode2.InterpolateScale(timeSec2), blendFactor);
-					return ModelMatrix(position, rotation, scale);
-				}
-				else if (animationNodeIndex1 != -1) {
-					return animation1->GetAnimationNodeAt(animationNodeIndex1).GetTransformMatrix(timeSec1);
-				}
-				else if (animationNodeIndex2 != -1) {
-					return animation2->GetAnimationNodeAt(animationNodeIndex2).GetTransformMatrix(timeSec2);
-				}
-				return _nodes[nodeIndex].transformMatrix;
-			},
-			[this, &out](const mat4& transformMatrix, const mat4& offsetMatrix, int32_t boneIndex) {
-				out[boneIndex] = transformMatrix;
-			}
-		);
-	}
-
-	void Skeleton::GetAnimatedSkinMatrices(const Ref<SkeletalAnimation>& animation, float normalizedTime, std::vector<mat4>& out) const {
-		const float timeSec = animation->GetDurationSec() * normalizedTime;
-		
-		out.resize(_bones.size());
-		ComputeMatricesInHierachy(
-			[this, &animation, &timeSec](int32_t nodeIndex) {
-				int32_t animationNodeIndex = animation->GetNodeIndex(_nodes[nodeIndex].name);
-				if (animationNodeIndex != -1) {
-					return animation->GetAnimationNodeAt(animationNodeIndex).GetTransformMatrix(timeSec);
-				}
-				return _nodes[nodeIndex].transformMatrix;
-			},
-			[this, &out](const mat4& transformMatrix, const mat4& offsetMatrix, int32_t boneIndex) {
-				out[boneIndex] = _globalInvMatrix * transformMatrix * offsetMatrix;
-			}
-		);
-	}
-
-	void Skeleton::GetBlendedAnimatedSkinMatrices(const Ref<SkeletalAnimation>& animation1, const Ref<SkeletalAnimation>& animation2, float normalizedTime, float blendFactor, std::vector<mat4>& out) const {
-		const float timeSec1 = animation1->GetDurationSec() * normalizedTime;
-		const float timeSec2 = animation2->GetDurationSec() * normalizedTime;
-
-		out.resize(_bones.size());
-		ComputeMatricesInHierachy(
-			[this, &animation1, &animation2, &normalizedTime, &blendFactor, &timeSec1, &timeSec2](int32_t nodeIndex) {
-				int32_t animationNodeIndex1 = animation1->GetNodeIndex(_nodes[nodeIndex].name);
-				int32_t animationNodeIndex2 = animation2->GetNodeIndex(_nodes[nodeIndex].name);
-
-				if (animationNodeIndex1 != -1 && animationNodeIndex2 != -1) {
-					const auto& animationNode1 = animation1->GetAnimationNodeAt(animationNodeIndex1);
-					const auto& animationNode2 = animation2->GetAnimationNodeAt(animationNodeIndex2);
-
-					const vec3 position = mix(animationNode1.InterpolatePosition(timeSec1), animationNode2.InterpolatePosition(timeSec2), blendFactor);
-					const quat rotation = normalize(slerp(animationNode1.InterpolateRotation(timeSec1), animationNode2.InterpolateRotation(timeSec2), blendFactor));
-					const vec3 scale = mix(animationNode1.InterpolateScale(timeSec1), animationNode2.InterpolateScale(timeSec2), blendFactor);
-
-					return ModelMatrix(position, rotation, scale);
-				}
-				else if (animationNodeIndex1 != -1) {
-					return animation1->GetAnimationNodeAt(animationNodeIndex1).GetTransformMatrix(timeSec1);
-				}
-				else if (animationNodeIndex2 != -1) {
-					return animation2->GetAnimationNodeAt(animationNodeIndex2).GetTransformMatrix(timeSec2);
-				}
-
-				return _nodes[nodeIndex].transformMatrix;
-			}, 
-			[this, &out](const mat4& transformMatrix, const mat4& offsetMatrix, int32_t boneIndex) {
-				out[boneIndex] = _globalInvMatrix * transformMatrix * offsetMatrix;
-			}
-		);
-	}
-
-	void Skeleton::GetBindingPoseBoneAndSkinMatrices(std::vector<mat4>& boneOut, std::vector<mat4>& skinOut) const {
-		boneOut.resize(_bones.size());
-		skinOut.resize(_bones.size());
-
-		ComputeMatricesInHierachy(
-			[this](int32_t nodeIndex) { return _nodes[nodeIndex].transformMatrix; },
-			[this, &boneOut, &skinOut](const mat4& transformMatrix, const mat4& offsetMatrix, int32_t boneIndex) {
-				boneOut[boneIndex] = transformMatrix;
-				skinOut[boneIndex] = _globalInvMatrix * transformMatrix * offsetMatrix;
-			}
-		);
-	}
-
-	void Skeleton::GetAnimatedBoneAndSkinMatrices(const Ref<SkeletalAnimation>& animation, float normalizedTime, std::vector<mat4>& boneOut, std::vector<mat4>& skinOut) const {
-		const float timeSec = animation->GetDurationSec() * normalizedTime;
-		boneOut.resize(_bones.size());
-		skinOut.resize(_bones.size());
-		ComputeMatricesInHierachy(
-			[this, &animation, &timeSec](int32_t nodeIndex) {
-				int32_t animationNodeIndex = animation->GetNodeIndex(_nodes[nodeIndex].name);
-				if (animationNodeIndex != -1) {
-					return animation->GetAnimationNodeAt(animationNodeIndex).GetTransformMatrix(timeSec);
-				}
-				return _nodes[nodeIndex].transformMatrix;
-			},
-			[this, &boneOut, &skinOut](const mat4& transformMatrix, const mat4& offsetMatrix, int32_t boneIndex) {
-				boneOut[boneIndex] = transformMatrix;
-				skinOut[boneIndex] = _globalInvMatrix * transformMatrix * offsetMatrix;
-			}
-		);
-	}
-
-	void Skeleton::GetBlendedAnimatedBoneAndSkinMatrices(const Ref<SkeletalAnimation>& animation1, const Ref<SkeletalAnimation>& animation2, float normalizedTime, float blendFactor, std::vector<mat4>& boneOut, std::vector<mat4>& skinOut) const {
-		const float timeSec1 = animation1->GetDurationSec() * normalizedTime;
-		const float timeSec2 = animation2->GetDurationSec() * normalizedTime;
-
-		boneOut.resize(_bones.size());
-		skinOut.resize(_bones.size());
-		ComputeMatricesInHierachy(
-			[this, &animation1, &animation2, &normalizedTime, &blendFactor, &timeSec1, &timeSec2](int32_t nodeIndex) {
-				int32_t animationNodeIndex1 = animation1->GetNodeIndex(_nodes[nodeIndex].name);
-				int32_t animationNodeIndex2 = animation2->GetNodeIndex(_nodes[nodeIndex].name);
-				if (animationNodeIndex1 != -1 && animationNodeIndex2 != -1) {
-					const auto& animationNode1 = animation1->GetAnimationNodeAt(animationNodeIndex1);
-					const auto& animationNode2 = animation2->GetAnimationNodeAt(animationNodeIndex2);
-					const vec3 position = mix(animationNode1.InterpolatePosition(timeSec1), animationNode2.InterpolatePosition(timeSec2), blendFactor);
-					const quat rotation = normalize(slerp(animationNode1.InterpolateRotation(timeSec1), animationNode2.InterpolateRotation(timeSec2), blendFactor));
-					const vec3 scale = mix(animationNode1.InterpolateScale(timeSec1), animationNode2.InterpolateScale(timeSec2), blendFactor);
-					return ModelMatrix(position, rotation, scale);
-				}
-				else if (animationNodeIndex1 != -1) {
-					return animation1->GetAnimationNodeAt(animationNodeIndex1).GetTransformMatrix(timeSec1);
-				}
-				else if (animationNodeIndex2 != -1) {
-					return animation2->GetAnimationNodeAt(animationNodeIndex2).GetTransformMatrix(timeSec2);
-				}
-				return _nodes[nodeIndex].transformMatrix;
-			},
-			[this, &boneOut, &skinOut](const mat4& transformMatrix, const mat4& offsetMatrix, int32_t boneIndex) {
-				boneOut[boneIndex] = transformMatrix;
-				skinOut[boneIndex] = _globalInvMatrix * transformMatrix * offsetMatrix;
-			}
-		);
+		std::vector<mat4> modelMatrices;
+		ComputeModelMatrices(*this, _bindingPose, modelMatrices);
+		ComputeBoneAndSkinMatrices(*this, modelMatrices, nullptr, &out);
 	}
-}
\ No newline at end of file
+}
@@ -3,6 +3,9 @@
 #include "Core.h"
 #include "Graphics.h"
 #include "Utils/SerializationArchive.h"
+#include "SkeletonPose.h"
+
+#include <mutex>
 
 namespace flaw {
 	template<typename T>
@@ -11,42 +14,99 @@ namespace flaw {
 		T value;
 	};
 
-	template<>
-	struct Serializer<SkeletalAnimationNodeKey<vec3>> {
-		static void Serialize(SerializationArchive& archive, const SkeletalAnimationNodeKey<vec3>& value) {
-			archive << value.time;
-			archive << value.value;
-		}
+	template<> struct IsTriviallySerializable<SkeletalAnimationNodeKey<vec3>> : std::true_type {};
+	template<> struct IsTriviallySerializable<SkeletalAnimationNodeKey<vec4>> : std::true_type {};
+	static_assert(sizeof(SkeletalAnimationNodeKey<vec3>) == sizeof(float) * 4 && sizeof(SkeletalAnimationNodeKey<vec4>) == sizeof(float) * 5);
 
-		static void Deserialize(SerializationArchive& archive, SkeletalAnimationNodeKey<vec3>& value) {
-			archive >> value.time;
-			archive >> value.value;
-		}
+	// 16 bit time and value, vec3 values are quantized against the track range, rotations use the smallest three encoding
+	struct QuantizedAnimationKey {
+		uint16_t time = 0;
+		uint16_t value[3] = { 0, 0, 0 };
+	};
+
+	template<> struct IsTriviallySerializable<QuantizedAnimationKey> : std::true_type {};
+	static_assert(sizeof(QuantizedAnimationKey) == sizeof(uint16_t) * 4);
+
+	// output of CompressSkeletalAnimationNode, see AnimationCompression.h
+	struct CompressedSkeletalAnimationNode {
+		std::string nodeName;
+
+		float timeStep = 0.0f; // seconds per quantized time unit
+
+		vec3 positionMin = vec3(0.0f);
+		vec3 positionRange = vec3(0.0f);
+		vec3 scaleMin = vec3(0.0f);
+		vec3 scaleRange = vec3(0.0f);
+
+		std::vector<QuantizedAnimationKey> positionKeys;
+		std::vector<QuantizedAnimationKey> rotationKeys;
+		std::vector<QuantizedAnimationKey> scaleKeys;
 	};
 
 	template<>
-	struct Serializer<SkeletalAnimationNodeKey<vec4>> {
-		static void Serialize(SerializationArchive& archive, const SkeletalAnimationNodeKey<vec4>& value) {
-			archive << value.time;
-			archive << value.value;
+	struct Serializer<CompressedSkeletalAnimationNode> {
+		static void Serialize(SerializationArchive& archive, const CompressedSkeletalAnimationNode& value) {
+			archive << value.nodeName;
+			archive << value.timeStep;
+			archive << value.positionMin;
+			archive << value.positionRange;
+			archive << value.scaleMin;
+			archive << value.scaleRange;
+			archive << value.positionKeys;
+			archive << value.rotationKeys;
+			archive << value.scaleKeys;
 		}
-		static void Deserialize(SerializationArchive& archive, SkeletalAnimationNodeKey<vec4>& value) {
-			archive >> value.time;
-			archive >> value.value;
+
+		static void Deserialize(SerializationArchive& archive, CompressedSkeletalAnimationNode& value) {
+			archive >> value.nodeName;
+			archive >> value.timeStep;
+			archive >> value.positionMin;
+			archive >> value.positionRange;
+			archive >> value.scaleMin;
+			archive >> value.scaleRange;
+			archive >> value.positionKeys;
+			archive >> value.rotationKeys;
+			archive >> value.scaleKeys;
 		}
 	};
 
+	// keys found by the previous sample of an animation node, -1 when nothing was sampled yet
+	struct SkeletalAnimationNodeCursor {
+		int32_t positionKey = -1;
+		int32_t rotationKey = -1;
+		int32_t scaleKey = -1;
+	};
+
+	// playback state of one animation instance, one cursor per animation node
+	struct SkeletalAnimationCursor {
+		std::vector<SkeletalAnimationNodeCursor> nodes;
+	};
+
 	class SkeletalAnimationNode {
 	public:
 		SkeletalAnimationNode() = default;
 		SkeletalAnimationNode(const std::string& nodeName, const std::vector<SkeletalAnimationNodeKey<vec3>>& positionKeys, const std::vector<SkeletalAnimationNodeKey<vec4>>& rotationKeys, const std::vector<SkeletalAnimationNodeKey<vec3>>& scaleKeys);
+		// keys stay quantized and are decoded while sampling
+		SkeletalAnimationNode(const CompressedSkeletalAnimationNode& compressed);
 
 		vec3 InterpolatePosition(float time) const;
 		quat InterpolateRotation(float time) const;
 		vec3 InterpolateScale(float time) const;
 		mat4 GetTransformMatrix(float time) const;
 
+		// continues from the keys of the previous sample, amortized O(1) while time moves forward
+		vec3 InterpolatePosition(float time, int32_t& keyCursor) const;
+		quat InterpolateRotation(float time, int32_t& keyCursor) const;
+		vec3 InterpolateScale(float time, int32_t& keyCursor) const;
+		mat4 GetTransformMatrix(float time, SkeletalAnimationNodeCursor& cursor) const;
+
 		const std::string& GetNodeName() const { return _nodeName; }
+		bool IsCompressed() const { return _compressed; }
+
+		// empty when the node is compressed
+		const std::vector<SkeletalAnimationNodeKey<vec3>>& GetPositionKeys() const { return _positionKeys; }
+		const std::vector<SkeletalAnimationNodeKey<vec4>>& GetRotationKeys() const { return _rotationKeys; }
+		const std::vector<SkeletalAnimationNodeKey<vec3>>& GetScaleKeys() const { return _scaleKeys; }
 
 	private:
 		friend struct Serializer<SkeletalAnimationNode>;
@@ -56,11 +116,19 @@ namespace flaw {
 		std::vector<SkeletalAnimationNodeKey<vec3>> _positionKeys;
 		std::vector<SkeletalAnimationNodeKey<vec4>> _rotationKeys;
 		std::vector<SkeletalAnimationNodeKey<vec3>> _scaleKeys;
+
+		bool _compressed = false;
+		CompressedSkeletalAnimationNode _compressedData;
 	};
 
+	// raw keys only, compressed nodes are stored as CompressedSkeletalAnimationNode
 	template<>
 	struct Serializer<SkeletalAnimationNode> {
 		static void Serialize(SerializationArchive& archive, const SkeletalAnimationNode& value) {
+			if (value._compressed) {
+				throw std::runtime_error("Compressed animation node " + value._nodeName + " must be serialized as CompressedSkeletalAnimationNode");
+			}
+
 			archive << value._nodeName;
 			archive << value._positionKeys;
 			archive << value._rotationKeys;
@@ -78,6 +146,7 @@ namespace flaw {
 	class SkeletalAnimation {
 	public:
 		SkeletalAnimation(const std::string& name, float durationSec, const std::vector<SkeletalAnimationNode>& animationNodes);
+		SkeletalAnimation(const std::string& name, float durationSec, const std::vector<CompressedSkeletalAnimationNode>& compressedNodes);
 
 		int32_t GetNodeIndex(const std::string& nodeName) const;
 
@@ -94,6 +163,20 @@ namespace flaw {
 		std::vector<SkeletalAnimationNode> _nodes;
 	};
 
+	class Skeleton;
+
+	// skeleton node -> animation node table, built once per skeleton and animation pair so sampling never looks up names
+	class SkeletalAnimationBinding {
+	public:
+		SkeletalAnimationBinding(const Skeleton& skeleton, const SkeletalAnimation& animation);
+
+		// returns -1 when the node is not animated
+		int32_t GetAnimationNodeIndex(int32_t nodeIndex) const { return _animationNodeIndices[nodeIndex]; }
+
+	private:
+		std::vector<int32_t> _animationNodeIndices;
+	};
+
 	struct SkeletonNode {
 		std::string name;
 		int32_t parentIndex = -1;
@@ -177,32 +260,38 @@ namespace flaw {
 
 		const mat4& GetGlobalInvMatrix() const { return _globalInvMatrix; }
 		const std::vector<SkeletonNode>& GetNodes() const { return _nodes; }
+		const std::vector<SkeletonBoneNode>& GetBones() const { return _bones; }
+
+		const SkeletonPose& GetBindingPose() const { return _bindingPose; }
+		const std::vector<int32_t>& GetParentIndices() const { return _parentIndices; }
+		const std::vector<int32_t>& GetNodeDepths() const { return _nodeDepths; }
 
 		bool HasSocket(const std::string& socketName) const;
 		const SkeletonBoneSocket& GetSocket(const std::string& socketName) const;
 
-		void GetBindingPoseBoneMatrices(std::vector<mat4>& out) const;
-		void GetAnimatedBoneMatrices(const Ref<SkeletalAnimation>& animation, float normalizedTime, std::vector<mat4>& out) const;
-		void GetBlendedAnimatedBoneMatrices(const Ref<SkeletalAnimation>& animation1, const Ref<SkeletalAnimation>& animation2, float normalizedTime, float blendFactor, std::vector<mat4>& out) const;
-
+		// allocates, meant for setting up a mesh once, animated poses go through Animator
 		void GetBindingPoseSkinMatrices(std::vector<mat4>& out) const;
-		void GetAnimatedSkinMatrices(const Ref<SkeletalAnimation>& animation, float normalizedTime, std::vector<mat4>& out) const;
-		void GetBlendedAnimatedSkinMatrices(const Ref<SkeletalAnimation>& animation1, const Ref<SkeletalAnimation>& animation2, float normalizedTime, float blendFactor, std::vector<mat4>& out) const;
 
-		void GetBindingPoseBoneAndSkinMatrices(std::vector<mat4>& boneOut, std::vector<mat4>& skinOut) const;
-		void GetAnimatedBoneAndSkinMatrices(const Ref<SkeletalAnimation>& animation, float normalizedTime, std::vector<mat4>& boneOut, std::vector<mat4>& skinOut) const;
-		void GetBlendedAnimatedBoneAndSkinMatrices(const Ref<SkeletalAnimation>& animation1, const Ref<SkeletalAnimation>& animation2, float normalizedTime, float blendFactor, std::vector<mat4>& boneOut, std::vector<mat4>& skinOut) const;
+		// built the first time the animation is used with this skeleton, safe to call from animation jobs
+		Ref<SkeletalAnimationBinding> GetAnimationBinding(const Ref<SkeletalAnimation>& animation) const;
 
 	private:
-		void ComputeMatricesInHierachy(const std::function<mat4(int32_t)>& getNodeTransformMatrixFunc, const std::function<void(const mat4&, const mat4&, int32_t)>& hanldeFunc) const;
+		struct AnimationBindingEntry {
+			std::weak_ptr<SkeletalAnimation> animation; // detects a new animation reusing the address of a released one
+			Ref<SkeletalAnimationBinding> binding;
+		};
 
-	private:
 		mat4 _globalInvMatrix = mat4(1.0f);
 		std::vector<SkeletonNode> _nodes;
+		std::vector<int32_t> _parentIndices;
+		std::vector<int32_t> _nodeDepths; // root nodes are 0
+		SkeletonPose _bindingPose;
 		
 		std::vector<SkeletonBoneNode> _bones;
-		std::unordered_map<std::string, int32_t> _boneNameToIndexMap;
 
 		std::unordered_map<std::string, SkeletonBoneSocket> _socketMap;
+
+		mutable std::mutex _animationBindingMutex;
+		mutable std::unordered_map<const SkeletalAnimation*, AnimationBindingEntry> _animationBindings;
 	};
 }
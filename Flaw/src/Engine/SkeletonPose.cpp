@@ -0,0 +1,153 @@
+#include "pch.h"
+#include "SkeletonPose.h"
+#include "Skeleton.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__SSE2__)
+	#define FLAW_POSE_SSE
+	#include <immintrin.h>
+#endif
+
+namespace flaw {
+	// out = a * b, out may alias either input since both are fully read before a column is written
+	static void MultiplyMatrix(const mat4& a, const mat4& b, mat4& out) {
+#ifdef FLAW_POSE_SSE
+		const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+		const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+		const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+		const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+		for (int32_t c = 0; c < 4; ++c) {
+			const __m128 x = _mm_mul_ps(a0, _mm_set1_ps(b[c][0]));
+			const __m128 y = _mm_mul_ps(a1, _mm_set1_ps(b[c][1]));
+			const __m128 z = _mm_mul_ps(a2, _mm_set1_ps(b[c][2]));
+			const __m128 w = _mm_mul_ps(a3, _mm_set1_ps(b[c][3]));
+
+			_mm_storeu_ps(&out[c][0], _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w)));
+		}
+#else
+		out = a * b;
+#endif
+	}
+
+	// same as ModelMatrix(position, rotation, scale) without the intermediate matrices
+	static void ComposeMatrix(const vec3& position, const quat& rotation, const vec3& scale, mat4& out) {
+		const float xx = rotation.x * rotation.x;
+		const float yy = rotation.y * rotation.y;
+		const float zz = rotation.z * rotation.z;
+		const float xy = rotation.x * rotation.y;
+		const float xz = rotation.x * rotation.z;
+		const float yz = rotation.y * rotation.z;
+		const float wx = rotation.w * rotation.x;
+		const float wy = rotation.w * rotation.y;
+		const float wz = rotation.w * rotation.z;
+
+		out[0] = vec4((1.0f - 2.0f * (yy + zz)) * scale.x, 2.0f * (xy + wz) * scale.x, 2.0f * (xz - wy) * scale.x, 0.0f);
+		out[1] = vec4(2.0f * (xy - wz) * scale.y, (1.0f - 2.0f * (xx + zz)) * scale.y, 2.0f * (yz + wx) * scale.y, 0.0f);
+		out[2] = vec4(2.0f * (xz + wy) * scale.z, 2.0f * (yz - wx) * scale.z, (1.0f - 2.0f * (xx + yy)) * scale.z, 0.0f);
+		out[3] = vec4(position, 1.0f);
+	}
+
+	void SamplePose(const Skeleton& skeleton, const SkeletalAnimation& animation, const SkeletalAnimationBinding& binding, float timeSec, SkeletalAnimationCursor* cursor, SkeletonPose& outPose, int32_t maxNodeDepth) {
+		const SkeletonPose& bindingPose = skeleton.GetBindingPose();
+		const std::vector<int32_t>& nodeDepths = skeleton.GetNodeDepths();
+		const uint32_t nodeCount = bindingPose.GetNodeCount();
+
+		outPose.Resize(nodeCount);
+
+		if (cursor) {
+			cursor->nodes.resize(animation.GetAnimationNodes().size());
+		}
+
+		for (uint32_t i = 0; i < nodeCount; ++i) {
+			const bool skipped = maxNodeDepth != -1 && nodeDepths[i] > maxNodeDepth;
+			const int32_t animationNodeIndex = skipped ? -1 : binding.GetAnimationNodeIndex(i);
+			if (animationNodeIndex == -1) {
+				outPose.positions[i] = bindingPose.positions[i];
+				outPose.rotations[i] = bindingPose.rotations[i];
+				outPose.scales[i] = bindingPose.scales[i];
+				continue;
+			}
+
+			const auto& animationNode = animation.GetAnimationNodeAt(animationNodeIndex);
+			if (cursor) {
+				auto& nodeCursor = cursor->nodes[animationNodeIndex];
+				outPose.positions[i] = animationNode.InterpolatePosition(timeSec, nodeCursor.positionKey);
+				outPose.rotations[i] = animationNode.InterpolateRotation(timeSec, nodeCursor.rotationKey);
+				outPose.scales[i] = animationNode.InterpolateScale(timeSec, nodeCursor.scaleKey);
+			}
+			else {
+				outPose.positions[i] = animationNode.InterpolatePosition(timeSec);
+				outPose.rotations[i] = animationNode.InterpolateRotation(timeSec);
+				outPose.scales[i] = animationNode.InterpolateScale(timeSec);
+			}
+		}
+	}
+
+	void BlendPoses(const SkeletonPose& pose1, const SkeletonPose& pose2, float blendFactor, SkeletonPose& outPose) {
+		const uint32_t nodeCount = pose1.GetNodeCount();
+		const float weight1 = 1.0f - blendFactor;
+
+		outPose.Resize(nodeCount);
+
+		for (uint32_t i = 0; i < nodeCount; ++i) {
+			outPose.positions[i] = pose1.positions[i] * weight1 + pose2.positions[i] * blendFactor;
+		}
+
+		// normalized lerp on the same hemisphere, close enough to slerp for blending and much cheaper
+		for (uint32_t i = 0; i < nodeCount; ++i) {
+			const quat& rotation1 = pose1.rotations[i];
+			const quat& rotation2 = pose2.rotations[i];
+			const float weight2 = dot(rotation1, rotation2) < 0.0f ? -blendFactor : blendFactor;
+
+			outPose.rotations[i] = normalize(quat(
+				rotation1.w * weight1 + rotation2.w * weight2,
+				rotation1.x * weight1 + rotation2.x * weight2,
+				rotation1.y * weight1 + rotation2.y * weight2,
+				rotation1.z * weight1 + rotation2.z * weight2
+			));
+		}
+
+		for (uint32_t i = 0; i < nodeCount; ++i) {
+			outPose.scales[i] = pose1.scales[i] * weight1 + pose2.scales[i] * blendFactor;
+		}
+	}
+
+	void ComputeModelMatrices(const Skeleton& skeleton, const SkeletonPose& pose, std::vector<mat4>& outModelMatrices) {
+		const std::vector<int32_t>& parentIndices = skeleton.GetParentIndices();
+		const uint32_t nodeCount = pose.GetNodeCount();
+
+		outModelMatrices.resize(nodeCount);
+
+		for (uint32_t i = 0; i < nodeCount; ++i) {
+			mat4& modelMatrix = outModelMatrices[i];
+			ComposeMatrix(pose.positions[i], pose.rotations[i], pose.scales[i], modelMatrix);
+
+			// parents come before their children, their model matrix is already final
+			const int32_t parentIndex = parentIndices[i];
+			if (parentIndex != -1) {
+				MultiplyMatrix(outModelMatrices[parentIndex], modelMatrix, modelMatrix);
+			}
+		}
+	}
+
+	void ComputeBoneAndSkinMatrices(const Skeleton& skeleton, const std::vector<mat4>& modelMatrices, std::vector<mat4>* outBoneMatrices, std::vector<mat4>* outSkinMatrices) {
+		const std::vector<SkeletonBoneNode>& bones = skeleton.GetBones();
+		const mat4& globalInvMatrix = skeleton.GetGlobalInvMatrix();
+
+		if (outBoneMatrices) {
+			outBoneMatrices->resize(bones.size());
+			for (size_t i = 0; i < bones.size(); ++i) {
+				(*outBoneMatrices)[i] = modelMatrices[bones[i].nodeIndex];
+			}
+		}
+
+		if (outSkinMatrices) {
+			outSkinMatrices->resize(bones.size());
+			for (size_t i = 0; i < bones.size(); ++i) {
+				mat4& skinMatrix = (*outSkinMatrices)[i];
+				MultiplyMatrix(modelMatrices[bones[i].nodeIndex], bones[i].offsetMatrix, skinMatrix);
+				MultiplyMatrix(globalInvMatrix, skinMatrix, skinMatrix);
+			}
+		}
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Core.h"
+#include "Math/Math.h"
+
+#include <vector>
+
+namespace flaw {
+	class Skeleton;
+	class SkeletalAnimation;
+	class SkeletalAnimationBinding;
+	struct SkeletalAnimationCursor;
+
+	// local transform of every skeleton node, kept as separate arrays so sampling and blending stream through memory
+	struct SkeletonPose {
+		std::vector<vec3> positions;
+		std::vector<quat> rotations;
+		std::vector<vec3> scales;
+
+		void Resize(uint32_t nodeCount) {
+			positions.resize(nodeCount);
+			rotations.resize(nodeCount);
+			scales.resize(nodeCount);
+		}
+
+		uint32_t GetNodeCount() const { return static_cast<uint32_t>(positions.size()); }
+	};
+
+	// the pose pipeline, sample or copy poses, blend them, then compute model space matrices
+	// buffers are owned by the caller and only allocate when the node count grows
+
+	// nodes the animation does not touch keep the binding pose, so do nodes deeper than maxNodeDepth unless it is -1
+	void SamplePose(const Skeleton& skeleton, const SkeletalAnimation& animation, const SkeletalAnimationBinding& binding, float timeSec, SkeletalAnimationCursor* cursor, SkeletonPose& outPose, int32_t maxNodeDepth = -1);
+
+	// out may be one of the inputs
+	void BlendPoses(const SkeletonPose& pose1, const SkeletonPose& pose2, float blendFactor, SkeletonPose& outPose);
+
+	// walks the parent sorted nodes once, outModelMatrices is indexed by node
+	void ComputeModelMatrices(const Skeleton& skeleton, const SkeletonPose& pose, std::vector<mat4>& outModelMatrices);
+
+	// either output may be null
+	void ComputeBoneAndSkinMatrices(const Skeleton& skeleton, const std::vector<mat4>& modelMatrices, std::vector<mat4>* outBoneMatrices, std::vector<mat4>* outSkinMatrices);
+}
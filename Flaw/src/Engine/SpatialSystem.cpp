@@ -0,0 +1,184 @@
+#include "pch.h"
+#include "SpatialSystem.h"
+#include "Scene.h"
+#include "Components.h"
+#include "AssetManager.h"
+#include "Assets.h"
+#include "TransformSystem.h"
+#include "Mesh.h"
+
+namespace flaw {
+	SpatialSystem::SpatialSystem(Scene& scene)
+		: _scene(scene)
+		, _tree(FatMargin)
+	{
+		auto& registry = _scene.GetRegistry();
+		registry.on_construct<StaticMeshComponent>().connect<&SpatialSystem::OnMeshConstruct<StaticMeshComponent>>(*this);
+		registry.on_destroy<StaticMeshComponent>().connect<&SpatialSystem::OnMeshDestroy<StaticMeshComponent>>(*this);
+		registry.on_construct<SkeletalMeshComponent>().connect<&SpatialSystem::OnMeshConstruct<SkeletalMeshComponent>>(*this);
+		registry.on_destroy<SkeletalMeshComponent>().connect<&SpatialSystem::OnMeshDestroy<SkeletalMeshComponent>>(*this);
+	}
+
+	SpatialSystem::~SpatialSystem() {
+		auto& registry = _scene.GetRegistry();
+		registry.on_construct<StaticMeshComponent>().disconnect<&SpatialSystem::OnMeshConstruct<StaticMeshComponent>>(*this);
+		registry.on_destroy<StaticMeshComponent>().disconnect<&SpatialSystem::OnMeshDestroy<StaticMeshComponent>>(*this);
+		registry.on_construct<SkeletalMeshComponent>().disconnect<&SpatialSystem::OnMeshConstruct<SkeletalMeshComponent>>(*this);
+		registry.on_destroy<SkeletalMeshComponent>().disconnect<&SpatialSystem::OnMeshDestroy<SkeletalMeshComponent>>(*this);
+	}
+
+	void SpatialSystem::MarkDirty(entt::entity entity) {
+		_dirtyEntities.push_back(entity);
+	}
+
+	void SpatialSystem::Update() {
+		auto& transformSys = _scene.GetTransformSystem();
+
+		for (entt::entity entity : transformSys.GetChangedEntities()) {
+			if (_proxies.find(entity) != _proxies.end()) {
+				_dirtyEntities.push_back(entity);
+			}
+		}
+		transformSys.ClearChangedEntities();
+
+		// meshes that were not loaded last frame are tried again
+		_dirtyEntities.insert(_dirtyEntities.end(), _pendingEntities.begin(), _pendingEntities.end());
+		_pendingEntities.clear();
+
+		std::sort(_dirtyEntities.begin(), _dirtyEntities.end());
+		_dirtyEntities.erase(std::unique(_dirtyEntities.begin(), _dirtyEntities.end()), _dirtyEntities.end());
+
+		for (entt::entity entity : _dirtyEntities) {
+			if (!RefreshProxy(entity)) {
+				_pendingEntities.push_back(entity);
+			}
+		}
+
+		_dirtyEntities.clear();
+
+		_raycaster.Update();
+	}
+
+	bool SpatialSystem::RefreshProxy(entt::entity entity) {
+		auto& registry = _scene.GetRegistry();
+
+		if (!registry.valid(entity) || !registry.all_of<TransformComponent>(entity)) {
+			RemoveProxy(entity);
+			return true;
+		}
+
+		Ref<Mesh> mesh;
+		if (auto staticMeshComp = registry.try_get<StaticMeshComponent>(entity)) {
+			auto meshAsset = AssetManager::GetAsset<StaticMeshAsset>(staticMeshComp->mesh);
+			if (meshAsset == nullptr) {
+				RemoveProxy(entity);
+				return false;
+			}
+			mesh = meshAsset->GetMesh();
+		}
+		else if (auto skeletalMeshComp = registry.try_get<SkeletalMeshComponent>(entity)) {
+			auto meshAsset = AssetManager::GetAsset<SkeletalMeshAsset>(skeletalMeshComp->mesh);
+			if (meshAsset == nullptr) {
+				RemoveProxy(entity);
+				return false;
+			}
+			mesh = meshAsset->GetMesh();
+		}
+		else {
+			RemoveProxy(entity);
+			return true;
+		}
+
+		const auto& transform = registry.get<TransformComponent>(entity);
+		const auto& boundingBox = mesh->GetBoundingBox();
+		const AABB worldAABB = AABB(boundingBox.min, boundingBox.max).Transform(transform.worldTransform);
+
+		auto it = _proxies.find(entity);
+		if (it == _proxies.end()) {
+			Proxy proxy;
+			proxy.proxyId = _tree.CreateProxy(worldAABB, static_cast<uint32_t>(entity));
+			proxy.instanceId = _raycaster.AddInstance(entity, mesh, transform.worldTransform, worldAABB);
+			proxy.bounds = worldAABB;
+			it = _proxies.emplace(entity, proxy).first;
+		}
+		else {
+			const vec3 displacement = worldAABB.GetCenter() - it->second.bounds.GetCenter();
+			_tree.MoveProxy(it->second.proxyId, worldAABB, displacement);
+			_raycaster.UpdateInstance(it->second.instanceId, mesh, transform.worldTransform, worldAABB);
+			it->second.bounds = worldAABB;
+		}
+
+		return true;
+	}
+
+	void SpatialSystem::RemoveProxy(entt::entity entity) {
+		auto it = _proxies.find(entity);
+		if (it == _proxies.end()) {
+			return;
+		}
+
+		_tree.DestroyProxy(it->second.proxyId);
+		_raycaster.RemoveInstance(it->second.instanceId);
+		_proxies.erase(it);
+	}
+
+	void SpatialSystem::QueryFrustum(const Frustum& frustum, std::vector<entt::entity>& outEntities) const {
+		_tree.QueryFrustum(frustum, [this, &outEntities](int32_t proxyId) {
+			outEntities.push_back(ToEntity(_tree.GetUserData(proxyId)));
+			return true;
+		});
+	}
+
+	void SpatialSystem::QuerySphere(const vec3& center, float radius, std::vector<entt::entity>& outEntities) const {
+		_raycaster.GetTopLevelBVH().QuerySphere(center, radius, [this, &outEntities](int32_t instanceId) {
+			outEntities.push_back(_raycaster.GetEntity(instanceId));
+			return true;
+		});
+	}
+
+	void SpatialSystem::QueryBox(const vec3& min, const vec3& max, std::vector<entt::entity>& outEntities) const {
+		_raycaster.GetTopLevelBVH().Query(AABB(min, max), [this, &outEntities](int32_t instanceId) {
+			outEntities.push_back(_raycaster.GetEntity(instanceId));
+			return true;
+		});
+	}
+
+	void SpatialSystem::QueryRay(const Ray& ray, std::vector<entt::entity>& outEntities) const {
+		std::vector<std::pair<float, entt::entity>> hits;
+
+		_raycaster.GetTopLevelBVH().QueryRay(ray, [this, &ray, &hits](int32_t instanceId, float distance) {
+			hits.emplace_back(distance, _raycaster.GetEntity(instanceId));
+			return ray.length;
+		});
+
+		std::sort(hits.begin(), hits.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+		for (const auto& [distance, entity] : hits) {
+			outEntities.push_back(entity);
+		}
+	}
+
+	bool SpatialSystem::Raycast(const Ray& ray, entt::entity& outEntity, float& outDistance) const {
+		bool result = false;
+		outDistance = ray.length;
+
+		// instances are only reported within the shortened ray, each one is the nearest so far
+		_raycaster.GetTopLevelBVH().QueryRay(ray, [&](int32_t instanceId, float distance) {
+			outEntity = _raycaster.GetEntity(instanceId);
+			outDistance = distance;
+			result = true;
+
+			return outDistance;
+		});
+
+		return result;
+	}
+
+	bool SpatialSystem::RaycastMesh(const Ray& ray, MeshRayHit& outHit) const {
+		return _raycaster.Raycast(ray, outHit);
+	}
+
+	void SpatialSystem::RaycastBatch(const std::vector<RaycastQuery>& queries, RaycastBatchResult& outResult, JobSystem* jobSystem) const {
+		_raycaster.RaycastBatch(queries, outResult, jobSystem);
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Core.h"
+#include "ECS/ECS.h"
+#include "Math/Math.h"
+#include "Utils/DynamicAABBTree.h"
+#include "Utils/Raycast.h"
+#include "MeshRaycaster.h"
+
+#include <vector>
+#include <unordered_map>
+
+namespace flaw {
+	class Scene;
+	class JobSystem;
+
+	// world bounds of every mesh entity, kept up to date from transform changes
+	// a dynamic aabb tree with fat boxes serves frustum culling, a top level bvh over tight boxes and the mesh bvhs serves ray and overlap queries
+	class SpatialSystem {
+	public:
+		SpatialSystem(Scene& scene);
+		~SpatialSystem();
+
+		void Update();
+
+		// call when a mesh handle of an entity changes, transform changes are picked up automatically
+		void MarkDirty(entt::entity entity);
+
+		void QueryFrustum(const Frustum& frustum, std::vector<entt::entity>& outEntities) const;
+		void QuerySphere(const vec3& center, float radius, std::vector<entt::entity>& outEntities) const;
+		void QueryBox(const vec3& min, const vec3& max, std::vector<entt::entity>& outEntities) const;
+
+		// entities whose bounds are hit by the ray, nearest first
+		void QueryRay(const Ray& ray, std::vector<entt::entity>& outEntities) const;
+
+		// nearest entity whose bounds are hit by the ray
+		bool Raycast(const Ray& ray, entt::entity& outEntity, float& outDistance) const;
+
+		// triangle level raycasts, the top level bvh finds the entities and their mesh bvhs the triangles
+		// skinned meshes are tested in their binding pose, nothing here touches the gpu
+		bool RaycastMesh(const Ray& ray, MeshRayHit& outHit) const;
+
+		// queries are independent and read only, a batch is split over the job system when one is given
+		// nothing may change the system while a batch runs
+		void RaycastBatch(const std::vector<RaycastQuery>& queries, RaycastBatchResult& outResult, JobSystem* jobSystem = nullptr) const;
+
+		const DynamicAABBTree& GetTree() const { return _tree; }
+		const TopLevelBVH& GetTopLevelBVH() const { return _raycaster.GetTopLevelBVH(); }
+
+	private:
+		template<typename T>
+		void OnMeshConstruct(entt::registry& registry, entt::entity entity) {
+			MarkDirty(entity);
+		}
+
+		template<typename T>
+		void OnMeshDestroy(entt::registry& registry, entt::entity entity) {
+			RemoveProxy(entity);
+			MarkDirty(entity); // may still have another mesh component
+		}
+
+		// returns false when the mesh is not loaded yet
+		bool RefreshProxy(entt::entity entity);
+		void RemoveProxy(entt::entity entity);
+
+		static entt::entity ToEntity(uint32_t userData) { return static_cast<entt::entity>(userData); }
+
+	private:
+		constexpr static float FatMargin = 0.1f;
+
+		Scene& _scene;
+
+		DynamicAABBTree _tree;
+		MeshRaycaster _raycaster;
+
+		struct Proxy {
+			int32_t proxyId;
+			int32_t instanceId;
+			AABB bounds; // tight world bounds, the tree keeps the fat ones
+		};
+
+		std::unordered_map<entt::entity, Proxy> _proxies;
+
+		std::vector<entt::entity> _dirtyEntities;
+		std::vector<entt::entity> _pendingEntities;
+	};
+}
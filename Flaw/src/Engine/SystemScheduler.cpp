@@ -0,0 +1,136 @@
+#include "pch.h"
+#include "SystemScheduler.h"
+#include "Debug/Instrumentor.h"
+#include "Log/Log.h"
+
+namespace flaw {
+	static bool Intersects(const std::vector<entt::id_type>& lhs, const std::vector<entt::id_type>& rhs) {
+		for (auto id : lhs) {
+			if (std::find(rhs.begin(), rhs.end(), id) != rhs.end()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool SystemAccess::ConflictsWith(const SystemAccess& other) const {
+		if (_exclusive || other._exclusive) {
+			return true;
+		}
+
+		return Intersects(_writes, other._writes) || Intersects(_writes, other._reads) || Intersects(_reads, other._writes);
+	}
+
+	SystemScheduler::SystemScheduler(JobSystem& jobSystem)
+		: _jobSystem(jobSystem)
+		, _dirty(false)
+		, _remainingSystems(0)
+	{
+	}
+
+	void SystemScheduler::AddSystem(const char* name, const SystemAccess& access, const std::function<void()>& func) {
+		auto node = CreateScope<SystemNode>();
+		node->name = name;
+		node->access = access;
+		node->func = func;
+
+		_systems.push_back(std::move(node));
+		_dirty = true;
+	}
+
+	void SystemScheduler::Build() {
+		for (auto& node : _systems) {
+			node->dependents.clear();
+			node->dependencyCount = 0;
+		}
+
+		for (int32_t i = 0; i < static_cast<int32_t>(_systems.size()); ++i) {
+			auto& current = *_systems[i];
+
+			for (int32_t j = 0; j < i; ++j) {
+				auto& prev = *_systems[j];
+
+				// main thread systems are executed one by one, keep them in the order they are added
+				const bool bothMainThread = prev.access.IsMainThread() && current.access.IsMainThread();
+
+				if (bothMainThread || prev.access.ConflictsWith(current.access)) {
+					prev.dependents.push_back(i);
+					current.dependencyCount++;
+				}
+			}
+		}
+
+		_dirty = false;
+	}
+
+	void SystemScheduler::Run() {
+		if (_dirty) {
+			Build();
+		}
+
+		if (_systems.empty()) {
+			return;
+		}
+
+		_remainingSystems.store(static_cast<int32_t>(_systems.size()));
+
+		for (auto& node : _systems) {
+			node->remainingDependencies.store(node->dependencyCount);
+		}
+
+		for (int32_t i = 0; i < static_cast<int32_t>(_systems.size()); ++i) {
+			if (_systems[i]->dependencyCount == 0) {
+				Dispatch(i);
+			}
+		}
+
+		while (_remainingSystems.load() > 0) {
+			int32_t index = -1;
+
+			{
+				std::lock_guard<std::mutex> lock(_mainThreadMutex);
+				if (!_mainThreadQueue.empty()) {
+					index = _mainThreadQueue.front();
+					_mainThreadQueue.erase(_mainThreadQueue.begin());
+				}
+			}
+
+			if (index != -1) {
+				Execute(index);
+			}
+			else if (!_jobSystem.RunPendingJob()) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void SystemScheduler::Dispatch(int32_t index) {
+		if (_systems[index]->access.IsMainThread()) {
+			std::lock_guard<std::mutex> lock(_mainThreadMutex);
+			_mainThreadQueue.push_back(index);
+		}
+		else {
+			_jobSystem.Schedule([this, index]() { Execute(index); });
+		}
+	}
+
+	void SystemScheduler::Execute(int32_t index) {
+		auto& node = *_systems[index];
+
+		try {
+			FLAW_PROFILE_SCOPE(node.name);
+			node.func();
+		}
+		catch (const std::exception& e) {
+			Log::Error("System %s failed: %s", node.name, e.what());
+		}
+
+		for (int32_t dependent : node.dependents) {
+			if (_systems[dependent]->remainingDependencies.fetch_sub(1) == 1) {
+				Dispatch(dependent);
+			}
+		}
+
+		_remainingSystems.fetch_sub(1);
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Core.h"
+#include "ECS/ECS.h"
+#include "Utils/JobSystem.h"
+
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <mutex>
+
+namespace flaw {
+	// declares which data a system touches, any type can be used as a resource tag (components, systems, ...)
+	class SystemAccess {
+	public:
+		template<typename... Types>
+		SystemAccess& Read() {
+			(_reads.push_back(entt::type_hash<Types>::value()), ...);
+			return *this;
+		}
+
+		template<typename... Types>
+		SystemAccess& Write() {
+			(_writes.push_back(entt::type_hash<Types>::value()), ...);
+			return *this;
+		}
+
+		// system may read or write anything, it never overlaps with other systems
+		SystemAccess& Exclusive() {
+			_exclusive = true;
+			return *this;
+		}
+
+		// system must run on the thread calling SystemScheduler::Run (graphics, scripting, asset loading, ...)
+		SystemAccess& MainThread() {
+			_mainThread = true;
+			return *this;
+		}
+
+		bool IsMainThread() const { return _mainThread; }
+		bool ConflictsWith(const SystemAccess& other) const;
+
+	private:
+		std::vector<entt::id_type> _reads;
+		std::vector<entt::id_type> _writes;
+
+		bool _exclusive = false;
+		bool _mainThread = false;
+	};
+
+	class SystemScheduler {
+	public:
+		SystemScheduler(JobSystem& jobSystem);
+
+		// systems with conflicting access run in the order they are added, name must be a string literal
+		void AddSystem(const char* name, const SystemAccess& access, const std::function<void()>& func);
+
+		void Run();
+
+	private:
+		struct SystemNode {
+			const char* name;
+			SystemAccess access;
+			std::function<void()> func;
+
+			std::vector<int32_t> dependents;
+			int32_t dependencyCount = 0;
+
+			std::atomic<int32_t> remainingDependencies{ 0 };
+		};
+
+		void Build();
+
+		void Dispatch(int32_t index);
+		void Execute(int32_t index);
+
+	private:
+		JobSystem& _jobSystem;
+
+		std::vector<Scope<SystemNode>> _systems;
+		bool _dirty;
+
+		std::atomic<int32_t> _remainingSystems;
+
+		std::mutex _mainThreadMutex;
+		std::vector<int32_t> _mainThreadQueue;
+	};
+}
@@ -1,50 +1,186 @@
-#include "pch.h"+
+#include "pch.h"
 #include "TransformSystem.h"
 #include "Scene.h"
 #include "Components.h"
+#include "Debug/Instrumentor.h"
 
 namespace flaw {
 	TransformSystem::TransformSystem(Scene& scene)
 		: _scene(scene)
+		, _hierarchyDirty(true)
 	{
+		auto& registry = _scene.GetRegistry();
+		registry.on_construct<TransformComponent>().connect<&TransformSystem::OnHierarchyChanged<TransformComponent>>(*this);
+		registry.on_destroy<TransformComponent>().connect<&TransformSystem::OnHierarchyChanged<TransformComponent>>(*this);
+		registry.on_construct<RectLayoutComponent>().connect<&TransformSystem::OnHierarchyChanged<RectLayoutComponent>>(*this);
+		registry.on_destroy<RectLayoutComponent>().connect<&TransformSystem::OnHierarchyChanged<RectLayoutComponent>>(*this);
 	}
 
-	void TransformSystem::Update() {
+	TransformSystem::~TransformSystem() {
+		auto& registry = _scene.GetRegistry();
+		registry.on_construct<TransformComponent>().disconnect<&TransformSystem::OnHierarchyChanged<TransformComponent>>(*this);
+		registry.on_destroy<TransformComponent>().disconnect<&TransformSystem::OnHierarchyChanged<TransformComponent>>(*this);
+		registry.on_construct<RectLayoutComponent>().disconnect<&TransformSystem::OnHierarchyChanged<RectLayoutComponent>>(*this);
+		registry.on_destroy<RectLayoutComponent>().disconnect<&TransformSystem::OnHierarchyChanged<RectLayoutComponent>>(*this);
+	}
+
+	void TransformSystem::RebuildHierarchy() {
+		FLAW_PROFILE_FUNCTION();
+
 		auto& registry = _scene.GetRegistry();
 
+		_entities.clear();
+		_parents.clear();
+		_levelOffsets.clear();
+		_flatIndices.clear();
+
+		// rect layout entities are positioned by the ui system
 		for (auto&& [entity, transform] : registry.view<TransformComponent>(entt::exclude_t<RectLayoutComponent>()).each()) {
-			Entity entt(entity, &_scene);
+			if (Entity(entity, &_scene).HasParent()) {
+				continue;
+			}
+
+			_entities.push_back(entity);
+			_parents.push_back(-1);
+		}
+
+		// breadth first, so every level is contiguous and comes after its parents
+		int32_t levelBegin = 0;
+		while (levelBegin < _entities.size()) {
+			const int32_t levelEnd = static_cast<int32_t>(_entities.size());
+			_levelOffsets.push_back(levelBegin);
+
+			for (int32_t i = levelBegin; i < levelEnd; ++i) {
+				Entity(_entities[i], &_scene).EachChildren([this, i](const Entity& child) {
+					_entities.push_back(child);
+					_parents.push_back(i);
+				});
+			}
+
+			levelBegin = levelEnd;
+		}
+		_levelOffsets.push_back(static_cast<int32_t>(_entities.size()));
+
+		const int32_t count = static_cast<int32_t>(_entities.size());
+
+		_localMatrices.resize(count);
+		_worldMatrices.resize(count);
+
+		// everything is recalculated once after a rebuild
+		_dirtyFlags.assign(count, 1);
+
+		for (int32_t i = 0; i < count; ++i) {
+			const uint32_t entityIndex = static_cast<uint32_t>(entt::to_entity(_entities[i]));
+			if (entityIndex >= _flatIndices.size()) {
+				_flatIndices.resize(entityIndex + 1, -1);
+			}
+			_flatIndices[entityIndex] = i;
+
+			auto& transform = registry.get<TransformComponent>(_entities[i]);
+			_localMatrices[i] = ModelMatrix(transform.position, transform.rotation, transform.scale);
+			transform.dirty = false;
+		}
+
+		_hierarchyDirty = false;
+	}
+
+	int32_t TransformSystem::GetFlatIndex(entt::entity entity) const {
+		const uint32_t entityIndex = static_cast<uint32_t>(entt::to_entity(entity));
+		if (entityIndex >= _flatIndices.size()) {
+			return -1;
+		}
+
+		const int32_t index = _flatIndices[entityIndex];
+		return index != -1 && _entities[index] == entity ? index : -1;
+	}
+
+	void TransformSystem::Update() {
+		auto& registry = _scene.GetRegistry();
+		auto& jobSystem = _scene.GetApplication().GetJobSystem();
 
-			if (entt.HasParent()) {
+		if (_hierarchyDirty) {
+			RebuildHierarchy();
+		}
+
+		// only locally modified transforms rebuild their local matrix
+		for (auto&& [entity, transform] : registry.view<TransformComponent>().each()) {
+			if (!transform.dirty) {
+				continue;
+			}
+
+			const int32_t index = GetFlatIndex(entity);
+			if (index == -1) {
 				continue;
-			} 
+			}
+
+			_localMatrices[index] = ModelMatrix(transform.position, transform.rotation, transform.scale);
+			_dirtyFlags[index] = 1;
+			transform.dirty = false;
+		}
+
+		// parents are finished before their level starts, dirty flags flow down modified subtrees only
+		for (int32_t level = 0; level + 1 < _levelOffsets.size(); ++level) {
+			const int32_t levelBegin = _levelOffsets[level];
+			const int32_t levelCount = _levelOffsets[level + 1] - levelBegin;
+
+			jobSystem.ParallelFor(levelCount, UpdateBatchSize, [this, &registry, levelBegin](int32_t i) {
+				const int32_t index = levelBegin + i;
+				const int32_t parent = _parents[index];
+
+				if (parent != -1 && _dirtyFlags[parent]) {
+					_dirtyFlags[index] = 1;
+				}
+
+				if (!_dirtyFlags[index]) {
+					return;
+				}
+
+				_worldMatrices[index] = parent != -1 ? _worldMatrices[parent] * _localMatrices[index] : _localMatrices[index];
+				registry.get<TransformComponent>(_entities[index]).worldTransform = _worldMatrices[index];
+			});
+		}
 
-			CalculateWorldTransformRecursive(mat4(1.0f), entt);
+		for (int32_t i = 0; i < _dirtyFlags.size(); ++i) {
+			if (_dirtyFlags[i]) {
+				_changedEntities.push_back(_entities[i]);
+				_dirtyFlags[i] = 0;
+			}
 		}
 	}
 
-	void TransformSystem::CalculateWorldTransformRecursive(const mat4& parentTransform, Entity entity, bool calculateAnyway) {
+	void TransformSystem::CalculateWorldTransformRecursive(const mat4& parentTransform, Entity entity) {
 		TransformComponent& transform = entity.GetComponent<TransformComponent>();
 
-		bool shouldCalculate = calculateAnyway || transform.dirty;
+		const mat4 localTransform = ModelMatrix(transform.position, transform.rotation, transform.scale);
 
-		if (shouldCalculate) {
-			transform.worldTransform = parentTransform * ModelMatrix(transform.position, transform.rotation, transform.scale);
-			transform.dirty = false;
+		transform.worldTransform = parentTransform * localTransform;
+		transform.dirty = false;
+
+		// keep the flattened data in sync so the next update starts from the right matrices
+		const int32_t index = GetFlatIndex(entity);
+		if (index != -1) {
+			_localMatrices[index] = localTransform;
+			_worldMatrices[index] = transform.worldTransform;
 		}
 
-		entity.EachChildren([this, &worldTransform = transform.worldTransform, shouldCalculate](const Entity& child) {
-			CalculateWorldTransformRecursive(worldTransform, child, shouldCalculate);
+		_changedEntities.push_back(entity);
+
+		entity.EachChildren([this, &worldTransform = transform.worldTransform](const Entity& child) {
+			CalculateWorldTransformRecursive(worldTransform, child);
 		});
 	}
 
 	void TransformSystem::UpdateTransformImmediate(entt::entity entity) {
+		if (_hierarchyDirty) {
+			RebuildHierarchy();
+		}
+
 		Entity entt(entity, &_scene);
 
 		while (entt.HasParent()) {
 			entt = entt.GetParent();
 		}
 
-		CalculateWorldTransformRecursive(mat4(1.0f), entt, true);
+		CalculateWorldTransformRecursive(mat4(1.0f), entt);
 	}
-}
\ No newline at end of file
+}
@@ -4,21 +4,57 @@
 #include "ECS/ECS.h"
 #include "Entity.h"
 
+#include <vector>
+
 namespace flaw {
 	class Scene;
 
+	// hierarchy is kept flattened and sorted by depth, every level is updated in parallel after its parents
 	class TransformSystem {
 	public:
 		TransformSystem(Scene& scene);
+		~TransformSystem();
 
 		void Update();
 
 		void UpdateTransformImmediate(entt::entity entity);
 
+		// call when parents change, component add and remove are tracked by the system
+		void MarkHierarchyDirty() { _hierarchyDirty = true; }
+
+		// entities whose world transform was recalculated since the last clear
+		const std::vector<entt::entity>& GetChangedEntities() const { return _changedEntities; }
+		void ClearChangedEntities() { _changedEntities.clear(); }
+
 	private:
-		void CalculateWorldTransformRecursive(const mat4& parentTransform, Entity entity, bool calculateAnyway = false);
+		template<typename T>
+		void OnHierarchyChanged(entt::registry& registry, entt::entity entity) {
+			_hierarchyDirty = true;
+		}
+
+		void RebuildHierarchy();
+
+		int32_t GetFlatIndex(entt::entity entity) const;
+
+		void CalculateWorldTransformRecursive(const mat4& parentTransform, Entity entity);
 
 	private:
+		constexpr static int32_t UpdateBatchSize = 1024;
+
 		Scene& _scene;
+
+		bool _hierarchyDirty;
+
+		// flattened hierarchy, parents always come before their children
+		std::vector<entt::entity> _entities;
+		std::vector<int32_t> _parents;
+		std::vector<mat4> _localMatrices;
+		std::vector<mat4> _worldMatrices;
+		std::vector<uint8_t> _dirtyFlags;
+
+		std::vector<int32_t> _levelOffsets; // first index of each depth level, last entry is the total count
+		std::vector<int32_t> _flatIndices; // entity index -> flat index
+
+		std::vector<entt::entity> _changedEntities;
 	};
-}
\ No newline at end of file
+}
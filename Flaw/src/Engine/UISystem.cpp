@@ -287,37 +287,7 @@ namespace flaw {
 			cmdQueue.SetConstantBuffer(materialCB, 2);
 			cmdQueue.SetStructuredBuffer(batchedTransformSB, 0);
 
-			if (entry.material->albedoTexture) {
-				cmdQueue.SetTexture(entry.material->albedoTexture, ReservedTextureStartSlot);
-			}
-			if (entry.material->normalTexture) {
-				cmdQueue.SetTexture(entry.material->normalTexture, ReservedTextureStartSlot + 1);
-			}
-			if (entry.material->emissiveTexture) {
-				cmdQueue.SetTexture(entry.material->emissiveTexture, ReservedTextureStartSlot + 2);
-			}
-			if (entry.material->heightTexture) {
-				cmdQueue.SetTexture(entry.material->heightTexture, ReservedTextureStartSlot + 3);
-			}
-			if (entry.material->metallicTexture) {
-				cmdQueue.SetTexture(entry.material->metallicTexture, ReservedTextureStartSlot + 4);
-			}
-			if (entry.material->roughnessTexture) {
-				cmdQueue.SetTexture(entry.material->roughnessTexture, ReservedTextureStartSlot + 5);
-			}
-			if (entry.material->ambientOcclusionTexture) {
-				cmdQueue.SetTexture(entry.material->ambientOcclusionTexture, ReservedTextureStartSlot + 6);
-			}
-			for (int32_t i = 0; i < entry.material->cubeTextures.size(); ++i) {
-				if (entry.material->cubeTextures[i]) {
-					cmdQueue.SetTexture(entry.material->cubeTextures[i], CubeTextureStartSlot + i);
-				}
-			}
-			for (int32_t i = 0; i < entry.material->textureArrays.size(); ++i) {
-				if (entry.material->textureArrays[i]) {
-					cmdQueue.SetTexture(entry.material->textureArrays[i], TextureArrayStartSlot + i);
-				}
-			}
+			BindMaterialTextures(cmdQueue, *entry.material);
 
 			cmdQueue.Execute();
 
@@ -325,7 +295,7 @@ namespace flaw {
 				auto& mesh = obj.mesh;
 				auto& meshSegment = mesh->GetMeshSegementAt(obj.segmentIndex);
 
-				batchedTransformSB->Update(obj.batchedDatas.data(), obj.batchedDatas.size() * sizeof(BatchedData));
+				batchedTransformSB->Update(obj.batchedDatas, obj.instanceCount * sizeof(BatchedData));
 
 				cmdQueue.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
 				cmdQueue.SetVertexBuffer(mesh->GetGPUVertexBuffer());
@@ -3,6 +3,7 @@
 #include "Engine/Application.h"
 #include "Engine/Project.h"
 #include "Engine/Scene.h"
+#include "Engine/SceneBinary.h"
 #include "Engine/Components.h"
 #include "Engine/Entity.h"
 #include "Engine/Platform.h"
@@ -11,6 +12,7 @@
 #include "Engine/Scripting.h"
 #include "Engine/AssetManager.h"
 #include "Engine/Assets.h"
+#include "Engine/AssetBundle.h"
 #include "Engine/Fonts.h"
 #include "Engine/Sounds.h"
 #include "Engine/ParticleSystem.h"
@@ -19,7 +21,10 @@
 #include "Engine/LandscapeSystem.h"
 #include "Engine/MonoScriptSystem.h"
 #include "Engine/SkeletalSystem.h"
+#include "Engine/AnimationCompression.h"
+#include "Engine/SkeletonPose.h"
 #include "Engine/TransformSystem.h"
+#include "Engine/SpatialSystem.h"
 #include "Engine/UISystem.h"
 #include "Engine/Mesh.h"
 #include "Engine/Material.h"
@@ -22,6 +22,8 @@ namespace flaw {
 			return 4;
 		case PixelFormat::RGBA32F:
 			return 16;
+		default:
+			break;
 		}
 
 		throw std::runtime_error("Unknown pixel format");
@@ -269,7 +271,7 @@ namespace flaw {
 		const float radianStep = glm::two_pi<float>() / sliceCount;
 
 		uint32_t baseStartIndex = 2;
-		for (int32_t i = 0; i < sliceCount; i++) {
+		for (uint32_t i = 0; i < sliceCount; i++) {
 			const float currentRadian = i * radianStep;
 			const float nextRadian = ((i + 1) % sliceCount) * radianStep;
 
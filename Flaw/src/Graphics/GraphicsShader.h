@@ -51,50 +51,54 @@ namespace flaw {
 		}
 
 		template <typename T>
-		void AddInputElement(const char* name, uint32_t count, bool normalized = false) {
-			FASSERT(false, "Invalid type");
-		}
-
-		template <>
-		void AddInputElement<float>(const char* name, uint32_t count, bool normalized) {
-			InputElement attribute;
-			attribute.name = name;
-			attribute.type = InputElement::ElementType::Float;
-			attribute.count = count;
-			attribute.normalized = normalized;
-			attribute.offset = _stride;
-			_stride += sizeof(float) * count;
-			_inputElements.push_back(std::move(attribute));
-		}
-
-		template <>
-		void AddInputElement<uint32_t>(const char* name, uint32_t count, bool normalized) {
-			InputElement attribute;
-			attribute.name = name;
-			attribute.type = InputElement::ElementType::Uint32;
-			attribute.count = count;
-			attribute.normalized = normalized;
-			attribute.offset = _stride;
-			_stride += sizeof(uint32_t) * count;
-			_inputElements.push_back(std::move(attribute));
-		}
-
-		template <>
-		void AddInputElement<int32_t>(const char* name, uint32_t count, bool normalized) {
-			InputElement attribute;
-			attribute.name = name;
-			attribute.type = InputElement::ElementType::Int;
-			attribute.count = count;
-			attribute.normalized = normalized;
-			attribute.offset = _stride;
-			_stride += sizeof(int32_t) * count;
-			_inputElements.push_back(std::move(attribute));
-		}
+		void AddInputElement(const char* name, uint32_t count, bool normalized = false);
 
 	protected:
 		uint32_t _stride = 0;
 		std::vector<InputElement> _inputElements;
 	};
+
+	// specialized at namespace scope, gcc does not accept explicit specializations inside the class
+	template <typename T>
+	inline void GraphicsShader::AddInputElement(const char*, uint32_t, bool) {
+		FASSERT(false, "Invalid type");
+	}
+
+	template <>
+	inline void GraphicsShader::AddInputElement<float>(const char* name, uint32_t count, bool normalized) {
+		InputElement attribute;
+		attribute.name = name;
+		attribute.type = InputElement::ElementType::Float;
+		attribute.count = count;
+		attribute.normalized = normalized;
+		attribute.offset = _stride;
+		_stride += sizeof(float) * count;
+		_inputElements.push_back(std::move(attribute));
+	}
+
+	template <>
+	inline void GraphicsShader::AddInputElement<uint32_t>(const char* name, uint32_t count, bool normalized) {
+		InputElement attribute;
+		attribute.name = name;
+		attribute.type = InputElement::ElementType::Uint32;
+		attribute.count = count;
+		attribute.normalized = normalized;
+		attribute.offset = _stride;
+		_stride += sizeof(uint32_t) * count;
+		_inputElements.push_back(std::move(attribute));
+	}
+
+	template <>
+	inline void GraphicsShader::AddInputElement<int32_t>(const char* name, uint32_t count, bool normalized) {
+		InputElement attribute;
+		attribute.name = name;
+		attribute.type = InputElement::ElementType::Int;
+		attribute.count = count;
+		attribute.normalized = normalized;
+		attribute.offset = _stride;
+		_stride += sizeof(int32_t) * count;
+		_inputElements.push_back(std::move(attribute));
+	}
 }
 
 
@@ -6,6 +6,11 @@ namespace flaw {
 	using RenderTargetView = void*;
 	using DepthStencilView = void*;
 
+	enum class GraphicsType {
+		DX11,
+		Null, // headless, records commands instead of rendering
+	};
+
 	enum class RenderDomain {
 		Opaque,
 		Masked,
@@ -0,0 +1,124 @@
+#include "pch.h"
+#include "NullBuffers.h"
+#include "NullContext.h"
+#include "Log/Log.h"
+
+#include <cstring>
+
+namespace flaw {
+	static void RecordBufferUpdate(NullContext& context, const void* buffer, uint32_t size) {
+		NullCommand command;
+		command.type = NullCommandType::UpdateBuffer;
+		command.resource = buffer;
+		command.args[0] = size;
+
+		context.Record(command);
+	}
+
+	NullVertexBuffer::NullVertexBuffer(NullContext& context, const Descriptor& descriptor)
+		: _context(context)
+		, _usage(descriptor.usage)
+		, _elmSize(descriptor.elmSize)
+		, _size(descriptor.bufferSize)
+	{
+	}
+
+	// same validation as the dx11 backend so misuse shows up in headless runs too
+	void NullVertexBuffer::Update(const void*, uint32_t elmSize, uint32_t count) {
+		if (_usage == UsageFlag::Static || _usage == UsageFlag::Staging) {
+			Log::Error("Cannot update static or staging buffer");
+			return;
+		}
+
+		if (elmSize * count > _size) {
+			Log::Error("Buffer size is too small");
+			return;
+		}
+
+		_elmSize = elmSize;
+
+		RecordBufferUpdate(_context, this, elmSize * count);
+	}
+
+	NullIndexBuffer::NullIndexBuffer(NullContext& context, const Descriptor& descriptor)
+		: _context(context)
+		, _usage(descriptor.usage)
+		, _size(descriptor.bufferSize)
+		, _indexCount(descriptor.bufferSize / sizeof(uint32_t))
+	{
+	}
+
+	void NullIndexBuffer::Update(const uint32_t*, uint32_t count) {
+		if (_usage == UsageFlag::Static || _usage == UsageFlag::Staging) {
+			Log::Error("Cannot update static or staging buffer");
+			return;
+		}
+
+		if (sizeof(uint32_t) * count > _size) {
+			Log::Error("Buffer size is too small");
+			return;
+		}
+
+		RecordBufferUpdate(_context, this, sizeof(uint32_t) * count);
+	}
+
+	NullConstantBuffer::NullConstantBuffer(NullContext& context, uint32_t size)
+		: _context(context)
+		, _size(size)
+	{
+	}
+
+	void NullConstantBuffer::Update(const void*, int32_t size) {
+		RecordBufferUpdate(_context, this, static_cast<uint32_t>(size));
+	}
+
+	void NullConstantBuffer::BindToGraphicsShader(const uint32_t slot) {
+		NullCommand command;
+		command.type = NullCommandType::SetConstantBuffer;
+		command.resource = this;
+		command.slot = slot;
+
+		_context.Record(command);
+	}
+
+	void NullConstantBuffer::BindToComputeShader(const uint32_t slot) {
+		NullCommand command;
+		command.type = NullCommandType::SetComputeConstantBuffer;
+		command.resource = this;
+		command.slot = slot;
+
+		_context.Record(command);
+	}
+
+	NullStructuredBuffer::NullStructuredBuffer(NullContext& context, const Descriptor& desc)
+		: _context(context)
+	{
+		Create(desc);
+	}
+
+	void NullStructuredBuffer::Create(const Descriptor& desc) {
+		_data.assign(desc.elmSize * desc.count, 0);
+
+		if (desc.initialData) {
+			std::memcpy(_data.data(), desc.initialData, _data.size());
+		}
+	}
+
+	void NullStructuredBuffer::Update(const void* data, uint32_t size) {
+		if (size > _data.size()) {
+			size = static_cast<uint32_t>(_data.size());
+		}
+
+		std::memcpy(_data.data(), data, size);
+
+		RecordBufferUpdate(_context, this, size);
+	}
+
+	void NullStructuredBuffer::Fetch(void* data, uint32_t size) {
+		if (size > _data.size()) {
+			size = static_cast<uint32_t>(_data.size());
+		}
+
+		std::memcpy(data, _data.data(), size);
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Graphics/GraphicsBuffers.h"
+
+#include <vector>
+
+namespace flaw {
+	class NullContext;
+
+	class NullVertexBuffer : public VertexBuffer {
+	public:
+		NullVertexBuffer(NullContext& context, const Descriptor& descriptor);
+		~NullVertexBuffer() override = default;
+
+		void Update(const void* data, uint32_t elmSize, uint32_t count) override;
+		void Bind() override {}
+
+		uint32_t Size() const override { return _size; }
+
+	private:
+		NullContext& _context;
+
+		UsageFlag _usage;
+		uint32_t _elmSize;
+		uint32_t _size;
+	};
+
+	class NullIndexBuffer : public IndexBuffer {
+	public:
+		NullIndexBuffer(NullContext& context, const Descriptor& descriptor);
+		~NullIndexBuffer() override = default;
+
+		void Update(const uint32_t* indices, uint32_t count) override;
+		void Bind() override {}
+
+		uint32_t IndexCount() const override { return _indexCount; }
+
+	private:
+		NullContext& _context;
+
+		UsageFlag _usage;
+		uint32_t _size;
+		uint32_t _indexCount;
+	};
+
+	class NullConstantBuffer : public ConstantBuffer {
+	public:
+		NullConstantBuffer(NullContext& context, uint32_t size);
+		~NullConstantBuffer() = default;
+
+		void Update(const void* data, int32_t size) override;
+
+		void BindToGraphicsShader(const uint32_t slot) override;
+		void BindToComputeShader(const uint32_t slot) override;
+
+		void Unbind() override {}
+
+		uint32_t Size() const override { return _size; }
+
+	private:
+		NullContext& _context;
+
+		uint32_t _size;
+	};
+
+	// keeps a cpu copy so Fetch returns what was last written
+	class NullStructuredBuffer : public StructuredBuffer {
+	public:
+		NullStructuredBuffer(NullContext& context, const Descriptor& desc);
+		~NullStructuredBuffer() = default;
+
+		void Create(const Descriptor& desc) override;
+
+		void Update(const void* data, uint32_t size) override;
+		void Fetch(void* data, uint32_t size) override;
+
+		uint32_t Size() const override { return static_cast<uint32_t>(_data.size()); }
+
+	private:
+		NullContext& _context;
+
+		std::vector<uint8_t> _data;
+	};
+}
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "NullCommandQueue.h"
+
+namespace flaw {
+	NullCommandQueue::NullCommandQueue(NullContext& context)
+		: _context(context)
+	{
+	}
+
+	void NullCommandQueue::Record(NullCommandType type, const void* resource, uint32_t slot, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+		NullCommand command;
+		command.type = type;
+		command.resource = resource;
+		command.slot = slot;
+		command.args[0] = arg0;
+		command.args[1] = arg1;
+		command.args[2] = arg2;
+		command.args[3] = arg3;
+
+		_context.Record(command);
+	}
+
+	void NullCommandQueue::SetPrimitiveTopology(PrimitiveTopology primitiveTopology) {
+		Record(NullCommandType::SetPrimitiveTopology, nullptr, 0, static_cast<uint32_t>(primitiveTopology));
+	}
+
+	void NullCommandQueue::SetPipeline(const Ref<GraphicsPipeline>& pipeline) {
+		Record(NullCommandType::SetPipeline, pipeline.get());
+	}
+
+	void NullCommandQueue::SetVertexBuffer(const Ref<VertexBuffer>& vertexBuffer) {
+		Record(NullCommandType::SetVertexBuffer, vertexBuffer.get());
+	}
+
+	void NullCommandQueue::SetConstantBuffer(const Ref<ConstantBuffer>& constantBuffer, uint32_t slot) {
+		Record(NullCommandType::SetConstantBuffer, constantBuffer.get(), slot);
+	}
+
+	void NullCommandQueue::SetStructuredBuffer(const Ref<StructuredBuffer>& buffer, uint32_t slot) {
+		Record(NullCommandType::SetStructuredBuffer, buffer.get(), slot);
+	}
+
+	void NullCommandQueue::SetTexture(const Ref<Texture>& texture, uint32_t slot) {
+		Record(NullCommandType::SetTexture, texture.get(), slot);
+	}
+
+	void NullCommandQueue::Draw(uint32_t vertexCount, uint32_t vertexOffset) {
+		Record(NullCommandType::Draw, nullptr, 0, vertexCount, vertexOffset);
+	}
+
+	void NullCommandQueue::DrawIndexed(const Ref<IndexBuffer>& indexBuffer, uint32_t indexCount, uint32_t indexOffset, uint32_t vertexOffset) {
+		Record(NullCommandType::DrawIndexed, indexBuffer.get(), 0, indexCount, indexOffset, vertexOffset);
+	}
+
+	void NullCommandQueue::DrawIndexedInstanced(const Ref<IndexBuffer>& indexBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, uint32_t vertexOffset) {
+		Record(NullCommandType::DrawIndexedInstanced, indexBuffer.get(), 0, indexCount, indexOffset, vertexOffset, instanceCount);
+	}
+
+	void NullCommandQueue::SetComputePipeline(const Ref<ComputePipeline>& pipeline) {
+		Record(NullCommandType::SetComputePipeline, pipeline.get());
+	}
+
+	void NullCommandQueue::SetComputeConstantBuffer(const Ref<ConstantBuffer>& constantBuffer, uint32_t slot) {
+		Record(NullCommandType::SetComputeConstantBuffer, constantBuffer.get(), slot);
+	}
+
+	void NullCommandQueue::SetComputeTexture(const Ref<Texture>& texture, BindFlag bindFlag, uint32_t slot) {
+		Record(NullCommandType::SetComputeTexture, texture.get(), slot, static_cast<uint32_t>(bindFlag));
+	}
+
+	void NullCommandQueue::SetComputeStructuredBuffer(const Ref<StructuredBuffer>& buffer, BindFlag bindFlag, uint32_t slot) {
+		Record(NullCommandType::SetComputeStructuredBuffer, buffer.get(), slot, static_cast<uint32_t>(bindFlag));
+	}
+
+	void NullCommandQueue::Dispatch(uint32_t x, uint32_t y, uint32_t z) {
+		Record(NullCommandType::Dispatch, nullptr, 0, x, y, z);
+	}
+
+	void NullCommandQueue::Execute() {
+		Record(NullCommandType::Execute);
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Core.h"
+#include "Graphics/GraphicsCommandQueue.h"
+#include "NullContext.h"
+
+namespace flaw {
+	class NullCommandQueue : public GraphicsCommandQueue {
+	public:
+		NullCommandQueue(NullContext& context);
+		virtual ~NullCommandQueue() = default;
+
+		void SetPrimitiveTopology(PrimitiveTopology primitiveTopology) override;
+		void SetPipeline(const Ref<GraphicsPipeline>& pipeline) override;
+		void SetVertexBuffer(const Ref<VertexBuffer>& vertexBuffer) override;
+		void SetConstantBuffer(const Ref<ConstantBuffer>& constantBuffer, uint32_t slot) override;
+		void SetStructuredBuffer(const Ref<StructuredBuffer>& buffer, uint32_t slot) override;
+		void SetTexture(const Ref<Texture>& texture, uint32_t slot) override;
+
+		void Draw(uint32_t vertexCount, uint32_t vertexOffset = 0) override;
+		void DrawIndexed(const Ref<IndexBuffer>& indexBuffer, uint32_t indexCount, uint32_t indexOffset = 0, uint32_t vertexOffset = 0) override;
+		void DrawIndexedInstanced(const Ref<IndexBuffer>& indexBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset = 0, uint32_t vertexOffset = 0) override;
+
+		void SetComputePipeline(const Ref<ComputePipeline>& pipeline) override;
+		void SetComputeConstantBuffer(const Ref<ConstantBuffer>& constantBuffer, uint32_t slot) override;
+		void SetComputeTexture(const Ref<Texture>& texture, BindFlag bindFlag, uint32_t slot) override;
+		void SetComputeStructuredBuffer(const Ref<StructuredBuffer>& buffer, BindFlag bindFlag, uint32_t slot) override;
+		void Dispatch(uint32_t x, uint32_t y, uint32_t z) override;
+
+		void Execute() override;
+
+	private:
+		void Record(NullCommandType type, const void* resource = nullptr, uint32_t slot = 0, uint32_t arg0 = 0, uint32_t arg1 = 0, uint32_t arg2 = 0, uint32_t arg3 = 0);
+
+	private:
+		NullContext& _context;
+	};
+}
@@ -0,0 +1,198 @@
+#include "pch.h"
+#include "NullContext.h"
+#include "Log/Log.h"
+#include "NullCommandQueue.h"
+#include "NullBuffers.h"
+#include "NullShaders.h"
+#include "NullTextures.h"
+#include "NullRenderPass.h"
+
+namespace flaw {
+	NullContext::NullContext(int32_t width, int32_t height)
+		: _renderWidth(width)
+		, _renderHeight(height)
+		, _currentRenderPass(nullptr)
+		, _recordCommands(true)
+		, _frameCount(0)
+	{
+		CreateMainRenderPass();
+
+		_currentRenderPass = _mainRenderPass.get();
+
+		_commandQueue = CreateRef<NullCommandQueue>(*this);
+
+		Log::Info("Null graphics context Initialized");
+	}
+
+	NullContext::~NullContext() {
+		// render passes unbind themselves on destruction, don't let them rebind the main pass
+		_currentRenderPass = nullptr;
+	}
+
+	void NullContext::Prepare() {
+		_currentRenderPass = _mainRenderPass.get();
+		_currentRenderPass->Bind();
+	}
+
+	void NullContext::Present() {
+		_lastFrameCommands.swap(_commands);
+		_lastFrameStats = _frameStats;
+
+		_commands.clear();
+		_frameStats = {};
+
+		_frameCount++;
+	}
+
+	void NullContext::Record(const NullCommand& command) {
+		switch (command.type) {
+		case NullCommandType::Draw:
+			_frameStats.drawCalls++;
+			_frameStats.vertexCount += command.args[0];
+			break;
+		case NullCommandType::DrawIndexed:
+			_frameStats.drawCalls++;
+			_frameStats.vertexCount += command.args[0];
+			break;
+		case NullCommandType::DrawIndexedInstanced:
+			_frameStats.drawCalls++;
+			_frameStats.vertexCount += static_cast<uint64_t>(command.args[0]) * command.args[3];
+			break;
+		case NullCommandType::Dispatch:
+			_frameStats.dispatches++;
+			break;
+		case NullCommandType::Execute:
+			_frameStats.executes++;
+			break;
+		case NullCommandType::BindRenderPass:
+			_frameStats.renderPassBinds++;
+			break;
+		case NullCommandType::UpdateBuffer:
+			_frameStats.bufferUpdates++;
+			_frameStats.bufferUpdateBytes += command.args[0];
+			break;
+		default:
+			_frameStats.stateChanges++;
+			break;
+		}
+
+		if (_recordCommands) {
+			_commands.push_back(command);
+		}
+	}
+
+	Ref<VertexBuffer> NullContext::CreateVertexBuffer(const VertexBuffer::Descriptor& descriptor) {
+		return CreateRef<NullVertexBuffer>(*this, descriptor);
+	}
+
+	Ref<IndexBuffer> NullContext::CreateIndexBuffer(const IndexBuffer::Descriptor& descriptor) {
+		return CreateRef<NullIndexBuffer>(*this, descriptor);
+	}
+
+	Ref<GraphicsShader> NullContext::CreateGraphicsShader(const char*, const uint32_t) {
+		return CreateRef<NullGraphicsShader>();
+	}
+
+	Ref<GraphicsPipeline> NullContext::CreateGraphicsPipeline() {
+		return CreateRef<NullGraphicsPipeline>();
+	}
+
+	Ref<ConstantBuffer> NullContext::CreateConstantBuffer(uint32_t size) {
+		return CreateRef<NullConstantBuffer>(*this, size);
+	}
+
+	Ref<StructuredBuffer> NullContext::CreateStructuredBuffer(const StructuredBuffer::Descriptor& desc) {
+		return CreateRef<NullStructuredBuffer>(*this, desc);
+	}
+
+	Ref<Texture2D> NullContext::CreateTexture2D(const Texture2D::Descriptor& descriptor) {
+		return CreateRef<NullTexture2D>(descriptor);
+	}
+
+	Ref<Texture2DArray> NullContext::CreateTexture2DArray(const Texture2DArray::Descriptor& descriptor) {
+		return CreateRef<NullTexture2DArray>(descriptor);
+	}
+
+	Ref<TextureCube> NullContext::CreateTextureCube(const TextureCube::Descriptor& descriptor) {
+		return CreateRef<NullTextureCube>(descriptor);
+	}
+
+	Ref<GraphicsRenderPass> NullContext::GetMainRenderPass() {
+		return _mainRenderPass;
+	}
+
+	GraphicsCommandQueue& NullContext::GetCommandQueue() {
+		return *_commandQueue;
+	}
+
+	Ref<GraphicsRenderPass> NullContext::CreateRenderPass(const GraphicsRenderPass::Descriptor& desc) {
+		return CreateRef<NullRenderPass>(*this, desc);
+	}
+
+	void NullContext::Resize(int32_t width, int32_t height) {
+		if (width == 0 || height == 0) {
+			return;
+		}
+
+		_renderWidth = width;
+		_renderHeight = height;
+	}
+
+	void NullContext::GetSize(int32_t& width, int32_t& height) {
+		width = _renderWidth;
+		height = _renderHeight;
+	}
+
+	Ref<ComputeShader> NullContext::CreateComputeShader(const char*) {
+		return CreateRef<NullComputeShader>();
+	}
+
+	Ref<ComputePipeline> NullContext::CreateComputePipeline() {
+		return CreateRef<NullComputePipeline>();
+	}
+
+	void NullContext::CreateMainRenderPass() {
+		auto createBackBuffer = [](int32_t width, int32_t height) {
+			Texture2D::Descriptor desc = {};
+			desc.format = PixelFormat::RGBA8;
+			desc.width = width;
+			desc.height = height;
+			desc.usage = UsageFlag::Static;
+			desc.bindFlags = BindFlag::RenderTarget;
+
+			return CreateRef<NullTexture2D>(desc);
+		};
+
+		auto createDepthStencil = [](int32_t width, int32_t height) {
+			Texture2D::Descriptor desc = {};
+			desc.format = PixelFormat::D24S8_UINT;
+			desc.width = width;
+			desc.height = height;
+			desc.usage = UsageFlag::Static;
+			desc.bindFlags = BindFlag::DepthStencil;
+
+			return CreateRef<NullTexture2D>(desc);
+		};
+
+		GraphicsRenderPass::Descriptor mainRenderPass = {};
+		mainRenderPass.renderTargets.resize(1);
+		mainRenderPass.renderTargets[0].texture = createBackBuffer(_renderWidth, _renderHeight);
+		mainRenderPass.renderTargets[0].viewportX = 0;
+		mainRenderPass.renderTargets[0].viewportY = 0;
+		mainRenderPass.renderTargets[0].viewportWidth = _renderWidth;
+		mainRenderPass.renderTargets[0].viewportHeight = _renderHeight;
+		mainRenderPass.renderTargets[0].clearValue = { 0.0f, 0.0f, 0.0f, 1.0f };
+		mainRenderPass.renderTargets[0].resizeFunc = [createBackBuffer](GraphicsRenderTarget& current, int32_t width, int32_t height) {
+			current.texture = createBackBuffer(width, height);
+			current.viewportWidth = width;
+			current.viewportHeight = height;
+		};
+
+		mainRenderPass.depthStencil.texture = createDepthStencil(_renderWidth, _renderHeight);
+		mainRenderPass.depthStencil.resizeFunc = [createDepthStencil](GraphicsDepthStencil& current, int32_t width, int32_t height) {
+			current.texture = createDepthStencil(width, height);
+		};
+
+		_mainRenderPass = CreateRef<NullRenderPass>(*this, mainRenderPass);
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Core.h"
+
+#include "Graphics/GraphicsContext.h"
+#include "Graphics/GraphicsCommandQueue.h"
+
+#include <vector>
+
+namespace flaw {
+	enum class NullCommandType : uint8_t {
+		SetPrimitiveTopology,
+		SetPipeline,
+		SetVertexBuffer,
+		SetConstantBuffer,
+		SetStructuredBuffer,
+		SetTexture,
+
+		Draw,
+		DrawIndexed,
+		DrawIndexedInstanced,
+
+		SetComputePipeline,
+		SetComputeConstantBuffer,
+		SetComputeTexture,
+		SetComputeStructuredBuffer,
+		Dispatch,
+
+		Execute,
+
+		BindRenderPass,
+		UpdateBuffer,
+	};
+
+	struct NullCommand {
+		NullCommandType type;
+
+		// only used to identify the resource, never dereferenced
+		const void* resource = nullptr;
+
+		uint32_t slot = 0;
+		uint32_t args[4] = {};
+	};
+
+	struct NullFrameStats {
+		uint32_t drawCalls = 0;
+		uint32_t dispatches = 0;
+		uint64_t vertexCount = 0; // vertices or indices submitted, instances included
+		uint32_t stateChanges = 0;
+		uint32_t renderPassBinds = 0;
+		uint32_t bufferUpdates = 0;
+		uint64_t bufferUpdateBytes = 0;
+		uint32_t executes = 0;
+	};
+
+	// headless backend, creates dummy resources and records every command instead of talking to a gpu
+	class FAPI NullContext : public GraphicsContext {
+	public:
+		NullContext(int32_t width, int32_t height);
+		~NullContext();
+
+		void Prepare() override;
+		void Present() override;
+
+		Ref<VertexBuffer> CreateVertexBuffer(const VertexBuffer::Descriptor& descriptor) override;
+		Ref<IndexBuffer> CreateIndexBuffer(const IndexBuffer::Descriptor& descriptor) override;
+		Ref<GraphicsShader> CreateGraphicsShader(const char* filePath, const uint32_t compileFlag) override;
+		Ref<GraphicsPipeline> CreateGraphicsPipeline() override;
+
+		Ref<ConstantBuffer> CreateConstantBuffer(uint32_t size) override;
+
+		Ref<StructuredBuffer> CreateStructuredBuffer(const StructuredBuffer::Descriptor& desc) override;
+
+		Ref<Texture2D> CreateTexture2D(const Texture2D::Descriptor& descriptor) override;
+		Ref<Texture2DArray> CreateTexture2DArray(const Texture2DArray::Descriptor& descriptor) override;
+		Ref<TextureCube> CreateTextureCube(const TextureCube::Descriptor& descriptor) override;
+
+		Ref<GraphicsRenderPass> GetMainRenderPass() override;
+
+		GraphicsCommandQueue& GetCommandQueue() override;
+
+		Ref<GraphicsRenderPass> CreateRenderPass(const GraphicsRenderPass::Descriptor& desc) override;
+
+		void Resize(int32_t width, int32_t height) override;
+		void GetSize(int32_t& width, int32_t& height) override;
+
+		Ref<ComputeShader> CreateComputeShader(const char* filename) override;
+		Ref<ComputePipeline> CreateComputePipeline() override;
+
+		inline void SetRenderPass(GraphicsRenderPass* renderPass) override { _currentRenderPass = renderPass; }
+
+		inline void ResetRenderPass() override {
+			_currentRenderPass = _mainRenderPass.get();
+			_mainRenderPass->Bind(false, false);
+		}
+
+		inline GraphicsRenderPass* GetRenderPass() const { return _currentRenderPass; }
+
+		void Record(const NullCommand& command);
+
+		// when disabled only the stats are updated, useful for long benchmark runs
+		inline void SetRecordCommands(bool record) { _recordCommands = record; }
+
+		// commands and stats recorded since the last Present
+		inline const std::vector<NullCommand>& GetCommands() const { return _commands; }
+		inline const NullFrameStats& GetFrameStats() const { return _frameStats; }
+
+		// commands and stats of the last presented frame
+		inline const std::vector<NullCommand>& GetLastFrameCommands() const { return _lastFrameCommands; }
+		inline const NullFrameStats& GetLastFrameStats() const { return _lastFrameStats; }
+
+		inline uint64_t GetFrameCount() const { return _frameCount; }
+
+	private:
+		void CreateMainRenderPass();
+
+	private:
+		int32_t _renderWidth, _renderHeight;
+
+		Ref<GraphicsRenderPass> _mainRenderPass;
+		GraphicsRenderPass* _currentRenderPass;
+
+		Ref<GraphicsCommandQueue> _commandQueue;
+
+		bool _recordCommands;
+
+		std::vector<NullCommand> _commands;
+		NullFrameStats _frameStats;
+
+		std::vector<NullCommand> _lastFrameCommands;
+		NullFrameStats _lastFrameStats;
+
+		uint64_t _frameCount;
+	};
+}
@@ -0,0 +1,136 @@
+#include "pch.h"
+#include "NullRenderPass.h"
+#include "NullContext.h"
+#include "Log/Log.h"
+
+namespace flaw {
+	NullRenderPass::NullRenderPass(NullContext& context, const Descriptor& desc)
+		: _context(context)
+	{
+		if (desc.renderTargets.empty()) {
+			Log::Error("NullRenderPass::NullRenderPass: No render targets provided.");
+			return;
+		}
+
+		if (desc.renderTargets.size() > MaxRenderTargets) {
+			Log::Error("NullRenderPass::NullRenderPass: Too many render targets. Max is %d.", MaxRenderTargets);
+			return;
+		}
+
+		_renderTargets = desc.renderTargets;
+		_depthStencil = desc.depthStencil;
+	}
+
+	NullRenderPass::~NullRenderPass() {
+		Unbind();
+	}
+
+	void NullRenderPass::Bind(bool clearColor, bool clearDepthStencil) {
+		int32_t width, height;
+		_context.GetSize(width, height);
+
+		Resize(width, height);
+
+		_context.SetRenderPass(this);
+
+		NullCommand command;
+		command.type = NullCommandType::BindRenderPass;
+		command.resource = this;
+		command.args[0] = static_cast<uint32_t>(_renderTargets.size());
+		command.args[1] = clearColor;
+		command.args[2] = clearDepthStencil;
+
+		_context.Record(command);
+	}
+
+	void NullRenderPass::Unbind() {
+		if (_context.GetRenderPass() != this) {
+			return;
+		}
+
+		_context.ResetRenderPass();
+	}
+
+	void NullRenderPass::Resize(int32_t width, int32_t height) {
+		for (auto& renderTarget : _renderTargets) {
+			if (renderTarget.texture->GetWidth() == static_cast<uint32_t>(width) && renderTarget.texture->GetHeight() == static_cast<uint32_t>(height)) {
+				continue;
+			}
+
+			if (!renderTarget.resizeFunc) {
+				continue;
+			}
+
+			renderTarget.resizeFunc(renderTarget, width, height);
+		}
+
+		if (!_depthStencil.texture) {
+			return;
+		}
+
+		if (_depthStencil.texture->GetWidth() == static_cast<uint32_t>(width) && _depthStencil.texture->GetHeight() == static_cast<uint32_t>(height)) {
+			return;
+		}
+
+		if (!_depthStencil.resizeFunc) {
+			return;
+		}
+
+		_depthStencil.resizeFunc(_depthStencil, width, height);
+	}
+
+	void NullRenderPass::PushRenderTarget(const GraphicsRenderTarget& renderTarget) {
+		if (_renderTargets.size() >= MaxRenderTargets) {
+			Log::Error("NullRenderPass::PushRenderTarget: Max render targets reached");
+			return;
+		}
+
+		_renderTargets.push_back(renderTarget);
+	}
+
+	void NullRenderPass::PopRenderTarget() {
+		if (_renderTargets.size() <= 1) {
+			Log::Error("NullRenderPass::PopRenderTarget: No render targets to pop");
+			return;
+		}
+
+		_renderTargets.pop_back();
+	}
+
+	void NullRenderPass::SetBlendMode(int32_t slot, BlendMode blendMode, bool alphaToCoverage) {
+		FASSERT(slot >= 0 && slot < static_cast<int32_t>(_renderTargets.size()), "Invalid render target slot");
+
+		auto& renderTarget = _renderTargets[slot];
+		renderTarget.blendMode = blendMode;
+		renderTarget.alphaToCoverage = alphaToCoverage;
+	}
+
+	void NullRenderPass::SetViewport(int32_t slot, float x, float y, float width, float height) {
+		FASSERT(slot >= 0 && slot < static_cast<int32_t>(_renderTargets.size()), "Invalid render target slot");
+
+		auto& renderTarget = _renderTargets[slot];
+		renderTarget.viewportX = x;
+		renderTarget.viewportY = y;
+		renderTarget.viewportWidth = width;
+		renderTarget.viewportHeight = height;
+	}
+
+	void NullRenderPass::SetRenderTargetMipLevel(int32_t slot, uint32_t mipLevel) {
+		FASSERT(slot >= 0 && slot < static_cast<int32_t>(_renderTargets.size()), "Invalid render target slot");
+
+		_renderTargets[slot].mipLevel = mipLevel;
+	}
+
+	void NullRenderPass::SetDepthStencilMipLevel(uint32_t mipLevel) {
+		_depthStencil.mipLevel = mipLevel;
+	}
+
+	Ref<Texture> NullRenderPass::GetRenderTargetTex(int32_t slot) {
+		FASSERT(slot >= 0 && slot < static_cast<int32_t>(_renderTargets.size()), "Invalid render target slot");
+		return _renderTargets[slot].texture;
+	}
+
+	Ref<Texture> NullRenderPass::GetDepthStencilTex() {
+		return _depthStencil.texture;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Graphics/GraphicsRenderPass.h"
+
+namespace flaw {
+	class NullContext;
+
+	class NullRenderPass : public GraphicsRenderPass {
+	public:
+		NullRenderPass(NullContext& context, const Descriptor& desc);
+		~NullRenderPass();
+
+		void Bind(bool clearColor = true, bool clearDepthStencil = true) override;
+		void Unbind() override;
+
+		void Resize(int32_t width, int32_t height) override;
+
+		void PushRenderTarget(const GraphicsRenderTarget& renderTarget) override;
+		void PopRenderTarget() override;
+
+		void SetBlendMode(int32_t slot, BlendMode blendMode, bool alphaToCoverage) override;
+		void SetViewport(int32_t slot, float x, float y, float width, float height) override;
+
+		void SetRenderTargetMipLevel(int32_t slot, uint32_t mipLevel) override;
+		void SetDepthStencilMipLevel(uint32_t mipLevel) override;
+
+		Ref<Texture> GetRenderTargetTex(int32_t slot) override;
+		Ref<Texture> GetDepthStencilTex() override;
+
+		void ClearAllRenderTargets() override {}
+		void ClearDepthStencil() override {}
+
+		uint32_t GetRenderTargetCount() const override { return static_cast<uint32_t>(_renderTargets.size()); }
+
+	private:
+		static constexpr uint32_t MaxRenderTargets = 8;
+
+		NullContext& _context;
+
+		std::vector<GraphicsRenderTarget> _renderTargets;
+		GraphicsDepthStencil _depthStencil;
+	};
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Graphics/GraphicsShader.h"
+#include "Graphics/GraphicsPipeline.h"
+#include "Graphics/ComputeShader.h"
+#include "Graphics/ComputePipeline.h"
+
+namespace flaw {
+	class NullGraphicsShader : public GraphicsShader {
+	public:
+		NullGraphicsShader() = default;
+
+		void CreateInputLayout() override {}
+		void Bind() override {}
+	};
+
+	class NullGraphicsPipeline : public GraphicsPipeline {
+	public:
+		NullGraphicsPipeline() = default;
+
+		void SetDepthTest(DepthTest, bool = true) override {}
+		void SetCullMode(CullMode cullMode) override { _cullMode = cullMode; }
+		void SetFillMode(FillMode fillMode) override { _fillMode = fillMode; }
+
+		void Bind() override {}
+	};
+
+	class NullComputeShader : public ComputeShader {
+	public:
+		NullComputeShader() = default;
+
+		void Bind() override {}
+		void Dispatch(uint32_t = 1, uint32_t = 1, uint32_t = 1) override {}
+	};
+
+	class NullComputePipeline : public ComputePipeline {
+	public:
+		NullComputePipeline() = default;
+
+		void Bind() override {}
+		void Dispatch(uint32_t = 1, uint32_t = 1, uint32_t = 1) override {}
+	};
+}
@@ -0,0 +1,60 @@
+#include "pch.h"
+#include "NullTextures.h"
+#include "Graphics/GraphicsFunc.h"
+
+#include <cstring>
+
+namespace flaw {
+	NullTexture2D::NullTexture2D(const Descriptor& descriptor)
+		: _format(descriptor.format)
+		, _usage(descriptor.usage)
+		, _accessFlags(descriptor.access)
+		, _bindFlags(descriptor.bindFlags)
+		, _width(descriptor.width)
+		, _height(descriptor.height)
+	{
+	}
+
+	void NullTexture2D::Fetch(void* outData, const uint32_t size) const {
+		std::memset(outData, 0, size);
+	}
+
+	NullTexture2DArray::NullTexture2DArray(const Descriptor& descriptor) {
+		if (!descriptor.fromMemory) {
+			FASSERT(!descriptor.textures.empty(), "Textures is empty");
+
+			const auto& first = descriptor.textures[0];
+
+			_format = first->GetPixelFormat();
+			_usage = first->GetUsage();
+			_accessFlags = first->GetAccessFlags();
+			_bindFlags = first->GetBindFlags();
+			_width = first->GetWidth();
+			_height = first->GetHeight();
+			_arraySize = static_cast<uint32_t>(descriptor.textures.size());
+		}
+		else {
+			_format = descriptor.format;
+			_usage = descriptor.usage;
+			_accessFlags = descriptor.access;
+			_bindFlags = descriptor.bindFlags;
+			_width = descriptor.width;
+			_height = descriptor.height;
+			_arraySize = descriptor.arraySize;
+		}
+	}
+
+	void NullTexture2DArray::FetchAll(void* outData) const {
+		std::memset(outData, 0, _width * _height * GetSizePerPixel(_format) * _arraySize);
+	}
+
+	NullTextureCube::NullTextureCube(const Descriptor& descriptor)
+		: _format(descriptor.format)
+		, _usage(descriptor.usage)
+		, _accessFlags(descriptor.access)
+		, _bindFlags(descriptor.bindFlags)
+		, _width(descriptor.width)
+		, _height(descriptor.height)
+	{
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Graphics/Texture.h"
+
+namespace flaw {
+	// views are opaque handles, the texture itself is returned when the matching bind flag is set
+	class NullTexture2D : public Texture2D {
+	public:
+		NullTexture2D(const Descriptor& descriptor);
+
+		void GenerateMips(uint32_t) override {}
+
+		void Fetch(void* outData, const uint32_t size) const override;
+
+		void CopyTo(Ref<Texture2D>&) const override {}
+		void CopyToSub(Ref<Texture2D>&, const uint32_t, const uint32_t, const uint32_t, const uint32_t) const override {}
+
+		ShaderResourceView GetShaderResourceView() const override { return GetView(BindFlag::ShaderResource); }
+		UnorderedAccessView GetUnorderedAccessView() const override { return GetView(BindFlag::UnorderedAccess); }
+		RenderTargetView GetRenderTargetView(uint32_t = 0) const override { return GetView(BindFlag::RenderTarget); }
+		DepthStencilView GetDepthStencilView(uint32_t = 0) const override { return GetView(BindFlag::DepthStencil); }
+
+		uint32_t GetWidth() const override { return _width; }
+		uint32_t GetHeight() const override { return _height; }
+		PixelFormat GetPixelFormat() const override { return _format; }
+		UsageFlag GetUsage() const override { return _usage; }
+		uint32_t GetBindFlags() const override { return _bindFlags; }
+		uint32_t GetAccessFlags() const override { return _accessFlags; }
+
+	private:
+		void* GetView(BindFlag flag) const { return (_bindFlags & flag) ? const_cast<NullTexture2D*>(this) : nullptr; }
+
+	private:
+		PixelFormat _format;
+		UsageFlag _usage;
+		uint32_t _accessFlags;
+		uint32_t _bindFlags;
+
+		uint32_t _width;
+		uint32_t _height;
+	};
+
+	class NullTexture2DArray : public Texture2DArray {
+	public:
+		NullTexture2DArray(const Descriptor& descriptor);
+
+		void FetchAll(void* outData) const override;
+
+		void CopyTo(Ref<Texture2DArray>&) const override {}
+
+		ShaderResourceView GetShaderResourceView() const override { return GetView(BindFlag::ShaderResource); }
+		UnorderedAccessView GetUnorderedAccessView() const override { return GetView(BindFlag::UnorderedAccess); }
+		RenderTargetView GetRenderTargetView(uint32_t = 0) const override { return GetView(BindFlag::RenderTarget); }
+		DepthStencilView GetDepthStencilView(uint32_t = 0) const override { return GetView(BindFlag::DepthStencil); }
+
+		uint32_t GetWidth() const override { return _width; }
+		uint32_t GetHeight() const override { return _height; }
+		PixelFormat GetPixelFormat() const override { return _format; }
+		UsageFlag GetUsage() const override { return _usage; }
+		uint32_t GetBindFlags() const override { return _bindFlags; }
+		uint32_t GetAccessFlags() const override { return _accessFlags; }
+
+		uint32_t GetArraySize() const override { return _arraySize; }
+
+	private:
+		void* GetView(BindFlag flag) const { return (_bindFlags & flag) ? const_cast<NullTexture2DArray*>(this) : nullptr; }
+
+	private:
+		PixelFormat _format;
+		UsageFlag _usage;
+		uint32_t _accessFlags;
+		uint32_t _bindFlags;
+
+		uint32_t _width;
+		uint32_t _height;
+		uint32_t _arraySize;
+	};
+
+	class NullTextureCube : public TextureCube {
+	public:
+		NullTextureCube(const Descriptor& descriptor);
+
+		void GenerateMips(uint32_t) override {}
+
+		ShaderResourceView GetShaderResourceView() const override { return GetView(BindFlag::ShaderResource); }
+		UnorderedAccessView GetUnorderedAccessView() const override { return GetView(BindFlag::UnorderedAccess); }
+		RenderTargetView GetRenderTargetView(uint32_t = 0) const override { return GetView(BindFlag::RenderTarget); }
+		DepthStencilView GetDepthStencilView(uint32_t = 0) const override { return GetView(BindFlag::DepthStencil); }
+
+		uint32_t GetWidth() const override { return _width; }
+		uint32_t GetHeight() const override { return _height; }
+		PixelFormat GetPixelFormat() const override { return _format; }
+		UsageFlag GetUsage() const override { return _usage; }
+		uint32_t GetBindFlags() const override { return _bindFlags; }
+		uint32_t GetAccessFlags() const override { return _accessFlags; }
+
+	private:
+		void* GetView(BindFlag flag) const { return (_bindFlags & flag) ? const_cast<NullTextureCube*>(this) : nullptr; }
+
+	private:
+		PixelFormat _format;
+		UsageFlag _usage;
+		uint32_t _accessFlags;
+		uint32_t _bindFlags;
+
+		uint32_t _width;
+		uint32_t _height;
+	};
+}
@@ -0,0 +1,243 @@
+#include "pch.h"
+#include "FrustumCulling.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__SSE2__)
+	#define FLAW_CULLING_SSE
+	#include <immintrin.h>
+#endif
+
+#include <cstring>
+
+namespace flaw {
+	void CullingVolumes::Clear() {
+		Resize(0);
+	}
+
+	void CullingVolumes::Resize(uint32_t count) {
+		_count = count;
+
+		_centerX.resize(count);
+		_centerY.resize(count);
+		_centerZ.resize(count);
+		_radius.resize(count);
+		_extentX.resize(count);
+		_extentY.resize(count);
+		_extentZ.resize(count);
+	}
+
+	void CullingVolumes::Set(uint32_t index, const vec3& localCenter, float localRadius, const vec3& localMin, const vec3& localMax, const mat4& modelMatrix) {
+		const float maxScale = sqrt(glm::compMax(vec3(length2(modelMatrix[0]), length2(modelMatrix[1]), length2(modelMatrix[2]))));
+		const vec3 sphereCenter = modelMatrix * vec4(localCenter, 1.0f);
+
+		// box center and extent through the absolute rotation-scale part of the matrix
+		const vec3 boxCenter = modelMatrix * vec4((localMin + localMax) * 0.5f, 1.0f);
+		const vec3 localExtent = (localMax - localMin) * 0.5f;
+		const vec3 boxExtent = abs(vec3(modelMatrix[0])) * localExtent.x + abs(vec3(modelMatrix[1])) * localExtent.y + abs(vec3(modelMatrix[2])) * localExtent.z;
+
+		// the sphere test shares the box center, grow the radius by the offset between both centers
+		_centerX[index] = boxCenter.x;
+		_centerY[index] = boxCenter.y;
+		_centerZ[index] = boxCenter.z;
+		_radius[index] = localRadius * maxScale + length(sphereCenter - boxCenter);
+		_extentX[index] = boxExtent.x;
+		_extentY[index] = boxExtent.y;
+		_extentZ[index] = boxExtent.z;
+	}
+
+	// a volume is culled when it is fully outside one plane, by either its sphere or its box
+	static bool IsVisible(const Frustum& frustum, const CullingVolumes& volumes, uint32_t index) {
+		const float cx = volumes.CenterX()[index];
+		const float cy = volumes.CenterY()[index];
+		const float cz = volumes.CenterZ()[index];
+		const float radius = volumes.Radius()[index];
+		const float ex = volumes.ExtentX()[index];
+		const float ey = volumes.ExtentY()[index];
+		const float ez = volumes.ExtentZ()[index];
+
+		for (const auto& plane : frustum.planes.data) {
+			const vec4& p = plane.data;
+
+			const float distance = p.x * cx + p.y * cy + p.z * cz - p.w;
+			const float boxRadius = std::abs(p.x) * ex + std::abs(p.y) * ey + std::abs(p.z) * ez;
+
+			if (distance > radius || distance > boxRadius) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+#if defined(FLAW_CULLING_SSE)
+	static uint32_t CullVolumesSSE(const Frustum& frustum, const CullingVolumes& volumes, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices) {
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+
+		__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+		__m128 planeAbsX[6], planeAbsY[6], planeAbsZ[6];
+
+		for (int32_t i = 0; i < 6; ++i) {
+			const vec4& p = frustum.planes.data[i].data;
+			planeX[i] = _mm_set1_ps(p.x);
+			planeY[i] = _mm_set1_ps(p.y);
+			planeZ[i] = _mm_set1_ps(p.z);
+			planeW[i] = _mm_set1_ps(p.w);
+			planeAbsX[i] = _mm_andnot_ps(signMask, planeX[i]);
+			planeAbsY[i] = _mm_andnot_ps(signMask, planeY[i]);
+			planeAbsZ[i] = _mm_andnot_ps(signMask, planeZ[i]);
+		}
+
+		uint32_t visibleCount = 0;
+		uint32_t index = begin;
+
+		for (; index + 4 <= end; index += 4) {
+			const __m128 cx = _mm_loadu_ps(volumes.CenterX() + index);
+			const __m128 cy = _mm_loadu_ps(volumes.CenterY() + index);
+			const __m128 cz = _mm_loadu_ps(volumes.CenterZ() + index);
+			const __m128 radius = _mm_loadu_ps(volumes.Radius() + index);
+			const __m128 ex = _mm_loadu_ps(volumes.ExtentX() + index);
+			const __m128 ey = _mm_loadu_ps(volumes.ExtentY() + index);
+			const __m128 ez = _mm_loadu_ps(volumes.ExtentZ() + index);
+
+			__m128 outside = _mm_setzero_ps();
+
+			for (int32_t i = 0; i < 6; ++i) {
+				__m128 distance = _mm_mul_ps(planeX[i], cx);
+				distance = _mm_add_ps(distance, _mm_mul_ps(planeY[i], cy));
+				distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[i], cz));
+				distance = _mm_sub_ps(distance, planeW[i]);
+
+				__m128 boxRadius = _mm_mul_ps(planeAbsX[i], ex);
+				boxRadius = _mm_add_ps(boxRadius, _mm_mul_ps(planeAbsY[i], ey));
+				boxRadius = _mm_add_ps(boxRadius, _mm_mul_ps(planeAbsZ[i], ez));
+
+				outside = _mm_or_ps(outside, _mm_cmpgt_ps(distance, _mm_min_ps(radius, boxRadius)));
+			}
+
+			const uint32_t visibleMask = ~_mm_movemask_ps(outside) & 0xf;
+			for (uint32_t lane = 0; lane < 4; ++lane) {
+				if (visibleMask & (1u << lane)) {
+					outVisibleIndices[visibleCount++] = index + lane;
+				}
+			}
+		}
+
+		for (; index < end; ++index) {
+			if (IsVisible(frustum, volumes, index)) {
+				outVisibleIndices[visibleCount++] = index;
+			}
+		}
+
+		return visibleCount;
+	}
+#endif
+
+#if defined(__AVX__)
+	static uint32_t CullVolumesAVX(const Frustum& frustum, const CullingVolumes& volumes, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices) {
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+		__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+		__m256 planeAbsX[6], planeAbsY[6], planeAbsZ[6];
+
+		for (int32_t i = 0; i < 6; ++i) {
+			const vec4& p = frustum.planes.data[i].data;
+			planeX[i] = _mm256_set1_ps(p.x);
+			planeY[i] = _mm256_set1_ps(p.y);
+			planeZ[i] = _mm256_set1_ps(p.z);
+			planeW[i] = _mm256_set1_ps(p.w);
+			planeAbsX[i] = _mm256_andnot_ps(signMask, planeX[i]);
+			planeAbsY[i] = _mm256_andnot_ps(signMask, planeY[i]);
+			planeAbsZ[i] = _mm256_andnot_ps(signMask, planeZ[i]);
+		}
+
+		uint32_t visibleCount = 0;
+		uint32_t index = begin;
+
+		for (; index + 8 <= end; index += 8) {
+			const __m256 cx = _mm256_loadu_ps(volumes.CenterX() + index);
+			const __m256 cy = _mm256_loadu_ps(volumes.CenterY() + index);
+			const __m256 cz = _mm256_loadu_ps(volumes.CenterZ() + index);
+			const __m256 radius = _mm256_loadu_ps(volumes.Radius() + index);
+			const __m256 ex = _mm256_loadu_ps(volumes.ExtentX() + index);
+			const __m256 ey = _mm256_loadu_ps(volumes.ExtentY() + index);
+			const __m256 ez = _mm256_loadu_ps(volumes.ExtentZ() + index);
+
+			__m256 outside = _mm256_setzero_ps();
+
+			for (int32_t i = 0; i < 6; ++i) {
+				__m256 distance = _mm256_mul_ps(planeX[i], cx);
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(planeY[i], cy));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(planeZ[i], cz));
+				distance = _mm256_sub_ps(distance, planeW[i]);
+
+				__m256 boxRadius = _mm256_mul_ps(planeAbsX[i], ex);
+				boxRadius = _mm256_add_ps(boxRadius, _mm256_mul_ps(planeAbsY[i], ey));
+				boxRadius = _mm256_add_ps(boxRadius, _mm256_mul_ps(planeAbsZ[i], ez));
+
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_min_ps(radius, boxRadius), _CMP_GT_OQ));
+			}
+
+			const uint32_t visibleMask = ~_mm256_movemask_ps(outside) & 0xff;
+			for (uint32_t lane = 0; lane < 8; ++lane) {
+				if (visibleMask & (1u << lane)) {
+					outVisibleIndices[visibleCount++] = index + lane;
+				}
+			}
+		}
+
+		// remaining volumes go through the 4 wide path
+		return visibleCount + CullVolumesSSE(frustum, volumes, index, end, outVisibleIndices + visibleCount);
+	}
+#endif
+
+	uint32_t CullVolumes(const Frustum& frustum, const CullingVolumes& volumes, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices) {
+#if defined(__AVX__)
+		return CullVolumesAVX(frustum, volumes, begin, end, outVisibleIndices);
+#elif defined(FLAW_CULLING_SSE)
+		return CullVolumesSSE(frustum, volumes, begin, end, outVisibleIndices);
+#else
+		uint32_t visibleCount = 0;
+		for (uint32_t index = begin; index < end; ++index) {
+			if (IsVisible(frustum, volumes, index)) {
+				outVisibleIndices[visibleCount++] = index;
+			}
+		}
+		return visibleCount;
+#endif
+	}
+
+	void FrustumCullTask::Schedule(JobSystem& jobSystem, JobCounter& counter, const Frustum& frustum, const CullingVolumes& volumes, uint32_t batchSize) {
+		const uint32_t count = volumes.Count();
+
+		_frustum = frustum;
+		_batchSize = batchSize ? batchSize : DefaultBatchSize;
+
+		// every batch writes into its own range, Finish closes the gaps
+		_visibleIndices.resize(count);
+		_batchVisibleCounts.assign((count + _batchSize - 1) / _batchSize, 0);
+
+		for (uint32_t batch = 0; batch < _batchVisibleCounts.size(); ++batch) {
+			jobSystem.Schedule([this, &volumes, batch, count]() {
+				const uint32_t begin = batch * _batchSize;
+				const uint32_t end = begin + _batchSize < count ? begin + _batchSize : count;
+
+				_batchVisibleCounts[batch] = CullVolumes(_frustum, volumes, begin, end, _visibleIndices.data() + begin);
+			}, &counter);
+		}
+	}
+
+	void FrustumCullTask::Finish() {
+		uint32_t visibleCount = 0;
+		for (uint32_t batch = 0; batch < _batchVisibleCounts.size(); ++batch) {
+			const uint32_t begin = batch * _batchSize;
+			const uint32_t batchCount = _batchVisibleCounts[batch];
+
+			if (begin != visibleCount) {
+				std::memmove(_visibleIndices.data() + visibleCount, _visibleIndices.data() + begin, batchCount * sizeof(uint32_t));
+			}
+
+			visibleCount += batchCount;
+		}
+
+		_visibleIndices.resize(visibleCount);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Core.h"
+#include "Math.h"
+#include "Utils/JobSystem.h"
+
+#include <vector>
+
+namespace flaw {
+	// world space bounding spheres and boxes in structure of arrays layout, tested 4 (sse) or 8 (avx) at a time
+	class CullingVolumes {
+	public:
+		void Clear();
+		void Resize(uint32_t count);
+
+		// local bounds are transformed by the model matrix, the box stays axis aligned in world space
+		void Set(uint32_t index, const vec3& localCenter, float localRadius, const vec3& localMin, const vec3& localMax, const mat4& modelMatrix);
+
+		uint32_t Count() const { return _count; }
+
+		const float* CenterX() const { return _centerX.data(); }
+		const float* CenterY() const { return _centerY.data(); }
+		const float* CenterZ() const { return _centerZ.data(); }
+		const float* Radius() const { return _radius.data(); }
+		const float* ExtentX() const { return _extentX.data(); }
+		const float* ExtentY() const { return _extentY.data(); }
+		const float* ExtentZ() const { return _extentZ.data(); }
+
+	private:
+		uint32_t _count = 0;
+
+		std::vector<float> _centerX, _centerY, _centerZ;
+		std::vector<float> _radius;
+		std::vector<float> _extentX, _extentY, _extentZ;
+	};
+
+	// writes indices of volumes in [begin, end) that are not fully outside the frustum, returns the visible count
+	uint32_t CullVolumes(const Frustum& frustum, const CullingVolumes& volumes, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices);
+
+	// culling split into batches on the job system, call Schedule then Finish after the counter is done
+	class FrustumCullTask {
+	public:
+		static constexpr uint32_t DefaultBatchSize = 1024;
+
+		void Schedule(JobSystem& jobSystem, JobCounter& counter, const Frustum& frustum, const CullingVolumes& volumes, uint32_t batchSize = DefaultBatchSize);
+		void Finish();
+
+		// compact, ascending
+		const std::vector<uint32_t>& GetVisibleIndices() const { return _visibleIndices; }
+
+	private:
+		Frustum _frustum;
+		uint32_t _batchSize = DefaultBatchSize;
+
+		std::vector<uint32_t> _visibleIndices;
+		std::vector<uint32_t> _batchVisibleCounts;
+	};
+}
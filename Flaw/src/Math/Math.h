@@ -22,69 +22,13 @@ namespace flaw {
 	constexpr vec3 Up = vec3(0.0f, 1.0f, 0.0f);
 	constexpr vec3 Down = vec3(0.0f, -1.0f, 0.0f);
 
-	template<>
-	struct Serializer<vec2> {
-		static void Serialize(SerializationArchive& archive, const vec2& value) {
-			archive << value.x;
-			archive << value.y;
-		}
-
-		static void Deserialize(SerializationArchive& archive, vec2& value) {
-			archive >> value.x;
-			archive >> value.y;
-		}
-	};
-
-	template<>
-	struct Serializer<vec3> {
-		static void Serialize(SerializationArchive& archive, const vec3& value) {
-			archive << value.x;
-			archive << value.y;
-			archive << value.z;
-		}
+	// glm keeps the components packed in declaration order, matrices column by column
+	template<> struct IsTriviallySerializable<vec2> : std::true_type {};
+	template<> struct IsTriviallySerializable<vec3> : std::true_type {};
+	template<> struct IsTriviallySerializable<vec4> : std::true_type {};
+	template<> struct IsTriviallySerializable<mat4> : std::true_type {};
 
-		static void Deserialize(SerializationArchive& archive, vec3& value) {
-			archive >> value.x;
-			archive >> value.y;
-			archive >> value.z;
-		}
-	};
-
-	template<>
-	struct Serializer<vec4> {
-		static void Serialize(SerializationArchive& archive, const vec4& value) {
-			archive << value.x;
-			archive << value.y;
-			archive << value.z;
-			archive << value.w;
-		}
-
-		static void Deserialize(SerializationArchive& archive, vec4& value) {
-			archive >> value.x;
-			archive >> value.y;
-			archive >> value.z;
-			archive >> value.w;
-		}
-	};
-
-	template<>
-	struct Serializer<mat4> {
-		static void Serialize(SerializationArchive& archive, const mat4& value) {
-			for (int i = 0; i < 4; ++i) {
-				for (int j = 0; j < 4; ++j) {
-					archive << value[i][j];
-				}
-			}
-		}
-
-		static void Deserialize(SerializationArchive& archive, mat4& value) {
-			for (int i = 0; i < 4; ++i) {
-				for (int j = 0; j < 4; ++j) {
-					archive >> value[i][j];
-				}
-			}
-		}
-	};
+	static_assert(sizeof(vec3) == sizeof(float) * 3 && sizeof(vec4) == sizeof(float) * 4 && sizeof(mat4) == sizeof(float) * 16);
 
 	inline bool EpsilonEqual(float a, float b, float epsilon = 1e-6f) {
 		return abs(a - b) < epsilon;
@@ -326,34 +270,45 @@ namespace flaw {
 	};
 
 	struct Frustum {
+		// gcc does not allow glm types in an anonymous struct, so the named planes and corners index into data
 		struct Planes {
-			union {
-				struct {
-					Plane leftPlane;   
-					Plane rightPlane;  
-					Plane bottomPlane; 
-					Plane topPlane;    
-					Plane nearPlane;   
-					Plane farPlane;    
-				};
-				Plane data[6];
-			};
+			Plane data[6];
+
+			Plane& leftPlane() { return data[0]; }
+			Plane& rightPlane() { return data[1]; }
+			Plane& bottomPlane() { return data[2]; }
+			Plane& topPlane() { return data[3]; }
+			Plane& nearPlane() { return data[4]; }
+			Plane& farPlane() { return data[5]; }
+
+			const Plane& leftPlane() const { return data[0]; }
+			const Plane& rightPlane() const { return data[1]; }
+			const Plane& bottomPlane() const { return data[2]; }
+			const Plane& topPlane() const { return data[3]; }
+			const Plane& nearPlane() const { return data[4]; }
+			const Plane& farPlane() const { return data[5]; }
 		};
 
 		struct Corners {
-			union {
-				struct {
-					vec3 topLeftNear;    
-					vec3 topRightNear;   
-					vec3 bottomRightNear; 
-					vec3 bottomLeftNear; 
-					vec3 topLeftFar;    
-					vec3 topRightFar;    
-					vec3 bottomRightFar; 
-					vec3 bottomLeftFar; 
-				};
-				vec3 data[8];
-			};
+			vec3 data[8];
+
+			vec3& topLeftNear() { return data[0]; }
+			vec3& topRightNear() { return data[1]; }
+			vec3& bottomRightNear() { return data[2]; }
+			vec3& bottomLeftNear() { return data[3]; }
+			vec3& topLeftFar() { return data[4]; }
+			vec3& topRightFar() { return data[5]; }
+			vec3& bottomRightFar() { return data[6]; }
+			vec3& bottomLeftFar() { return data[7]; }
+
+			const vec3& topLeftNear() const { return data[0]; }
+			const vec3& topRightNear() const { return data[1]; }
+			const vec3& bottomRightNear() const { return data[2]; }
+			const vec3& bottomLeftNear() const { return data[3]; }
+			const vec3& topLeftFar() const { return data[4]; }
+			const vec3& topRightFar() const { return data[5]; }
+			const vec3& bottomRightFar() const { return data[6]; }
+			const vec3& bottomLeftFar() const { return data[7]; }
 		};
 
 		Planes planes;
@@ -412,15 +367,15 @@ namespace flaw {
 		inline Corners GetCorners() const {
 			Corners outCorners;
 
-			outCorners.topLeftNear = Plane::GetIntersectPoint(planes.leftPlane, planes.topPlane, planes.nearPlane); 
-			outCorners.topRightNear = Plane::GetIntersectPoint(planes.rightPlane, planes.nearPlane, planes.topPlane);
-			outCorners.bottomRightNear = Plane::GetIntersectPoint(planes.rightPlane, planes.bottomPlane, planes.nearPlane);
-			outCorners.bottomLeftNear = Plane::GetIntersectPoint(planes.leftPlane, planes.bottomPlane, planes.nearPlane);
+			outCorners.topLeftNear() = Plane::GetIntersectPoint(planes.leftPlane(), planes.topPlane(), planes.nearPlane()); 
+			outCorners.topRightNear() = Plane::GetIntersectPoint(planes.rightPlane(), planes.nearPlane(), planes.topPlane());
+			outCorners.bottomRightNear() = Plane::GetIntersectPoint(planes.rightPlane(), planes.bottomPlane(), planes.nearPlane());
+			outCorners.bottomLeftNear() = Plane::GetIntersectPoint(planes.leftPlane(), planes.bottomPlane(), planes.nearPlane());
 
-			outCorners.topLeftFar = Plane::GetIntersectPoint(planes.leftPlane, planes.farPlane, planes.topPlane); 
-			outCorners.topRightFar = Plane::GetIntersectPoint(planes.rightPlane, planes.topPlane, planes.farPlane);
-			outCorners.bottomRightFar = Plane::GetIntersectPoint(planes.rightPlane, planes.farPlane, planes.bottomPlane); 
-			outCorners.bottomLeftFar = Plane::GetIntersectPoint(planes.leftPlane, planes.bottomPlane, planes.farPlane);
+			outCorners.topLeftFar() = Plane::GetIntersectPoint(planes.leftPlane(), planes.farPlane(), planes.topPlane()); 
+			outCorners.topRightFar() = Plane::GetIntersectPoint(planes.rightPlane(), planes.topPlane(), planes.farPlane());
+			outCorners.bottomRightFar() = Plane::GetIntersectPoint(planes.rightPlane(), planes.farPlane(), planes.bottomPlane()); 
+			outCorners.bottomLeftFar() = Plane::GetIntersectPoint(planes.leftPlane(), planes.bottomPlane(), planes.farPlane());
 
 			return outCorners;
 		}
@@ -439,32 +394,79 @@ namespace flaw {
 		// Left plane
 		auto origin = nearCenter - right * nearHalfWidth;
 		auto normal = normalize(cross(origin - position, up));
-		frustrum.planes.leftPlane.data = vec4(normal, dot(normal, origin));
+		frustrum.planes.leftPlane().data = vec4(normal, dot(normal, origin));
 
 		// Right plane
 		origin = nearCenter + right * nearHalfWidth;
 		normal = normalize(cross(up, origin - position));
-		frustrum.planes.rightPlane.data = vec4(normal, dot(normal, origin));
+		frustrum.planes.rightPlane().data = vec4(normal, dot(normal, origin));
 
 		// Top plane
 		origin = nearCenter + up * nearHalfHeight;
 		normal = normalize(cross(origin - position, right));
-		frustrum.planes.topPlane.data = vec4(normal, dot(normal, origin));
+		frustrum.planes.topPlane().data = vec4(normal, dot(normal, origin));
 
 		// Bottom plane
 		origin = nearCenter - up * nearHalfHeight;
 		normal = normalize(cross(right, origin - position));
-		frustrum.planes.bottomPlane.data = vec4(normal, dot(normal, origin));
+		frustrum.planes.bottomPlane().data = vec4(normal, dot(normal, origin));
 
 		// Near plane
 		origin = position + forward * nearClip;
 		normal = -forward;
-		frustrum.planes.nearPlane.data = vec4(normal, dot(normal, origin));
+		frustrum.planes.nearPlane().data = vec4(normal, dot(normal, origin));
 
 		// Far plane
 		origin = position + forward * farClip;
 		normal = forward;
-		frustrum.planes.farPlane.data = vec4(normal, dot(normal, origin));
+		frustrum.planes.farPlane().data = vec4(normal, dot(normal, origin));
+	}
+
+	// box shaped frustum of an orthographic projection, bounds are in view space so off center boxes work too
+	inline void CreateOrthographicFrustum(const float left, const float right, const float bottom, const float top, const float nearClip, const float farClip, const vec3& position, const vec3& rightAxis, const vec3& upAxis, const vec3& forwardAxis, Frustum& frustrum) {
+		// Left plane
+		auto normal = -rightAxis;
+		frustrum.planes.leftPlane().data = vec4(normal, dot(normal, position + rightAxis * left));
+
+		// Right plane
+		normal = rightAxis;
+		frustrum.planes.rightPlane().data = vec4(normal, dot(normal, position + rightAxis * right));
+
+		// Top plane
+		normal = upAxis;
+		frustrum.planes.topPlane().data = vec4(normal, dot(normal, position + upAxis * top));
+
+		// Bottom plane
+		normal = -upAxis;
+		frustrum.planes.bottomPlane().data = vec4(normal, dot(normal, position + upAxis * bottom));
+
+		// Near plane
+		normal = -forwardAxis;
+		frustrum.planes.nearPlane().data = vec4(normal, dot(normal, position + forwardAxis * nearClip));
+
+		// Far plane
+		normal = forwardAxis;
+		frustrum.planes.farPlane().data = vec4(normal, dot(normal, position + forwardAxis * farClip));
+	}
+
+	inline void CreateOrthographicFrustum(const float left, const float right, const float bottom, const float top, const float nearClip, const float farClip, const vec3& position, const vec3& lookDirection, Frustum& frustrum) {
+		vec3 forward = lookDirection;
+		vec3 rightAxis = normalize(cross(Up, forward));
+		vec3 upAxis = normalize(cross(forward, rightAxis));
+
+		CreateOrthographicFrustum(left, right, bottom, top, nearClip, farClip, position, rightAxis, upAxis, forward, frustrum);
+	}
+
+	// axes are taken from the view matrix, no up vector is needed so views looking straight up or down work
+	inline void CreateOrthographicFrustum(const float left, const float right, const float bottom, const float top, const float nearClip, const float farClip, const mat4& viewMatrix, Frustum& frustrum) {
+		const mat4 invViewMatrix = inverse(viewMatrix);
+
+		const vec3 position = invViewMatrix[3];
+		const vec3 rightAxis = normalize(vec3(invViewMatrix[0]));
+		const vec3 upAxis = normalize(vec3(invViewMatrix[1]));
+		const vec3 forward = normalize(vec3(invViewMatrix[2]));
+
+		CreateOrthographicFrustum(left, right, bottom, top, nearClip, farClip, position, rightAxis, upAxis, forward, frustrum);
 	}
 
 	inline void CreateFrustum(const float fovX, const float fovY, const float nearClip, const float farClip, const mat4& transform, Frustum& frustrum) {
@@ -126,6 +126,7 @@ namespace flaw {
 		node.transformMatrix = ToMat4(current->mTransformation);
 
 		result.nodes.emplace_back(node);
+		result.nodeIndexMap.emplace(node.name, nodeIndex);
 		if (parentIndex != -1) {
 			result.nodes[parentIndex].childrenIndices.push_back(nodeIndex);
 		}
@@ -89,13 +89,13 @@ namespace flaw {
 
 	struct ModelSkeleton {
 		std::vector<ModelSkeletonNode> nodes;
+		std::unordered_map<std::string, int32_t> nodeIndexMap; // name -> node index
 		std::unordered_map<std::string, ModelSkeletonBoneNode> boneMap;
 
 		int32_t FindNode(const std::string& name) const {
-			for (size_t i = 0; i < nodes.size(); ++i) {
-				if (nodes[i].name == name) {
-					return static_cast<int32_t>(i);
-				}
+			auto it = nodeIndexMap.find(name);
+			if (it != nodeIndexMap.end()) {
+				return it->second;
 			}
 
 			throw std::runtime_error("Node not found: " + name);
@@ -18,4 +18,30 @@ namespace flaw {
 		static std::string GetUniqueFilePath(const char* expectedPath);
 		static std::string GetUniqueFolderPath(const char* expectedPath);
 	};
+
+	// read only view of a whole file, pages are loaded on first access and the data stays valid until Close
+	class MappedFile {
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// fails for empty files, they can't be mapped
+		bool Open(const char* path);
+		void Close();
+
+		bool IsOpen() const { return _data != nullptr; }
+
+		const int8_t* Data() const { return _data; }
+		uint64_t Size() const { return _size; }
+
+	private:
+		const int8_t* _data;
+		uint64_t _size;
+
+		void* _fileHandle;
+		void* _mappingHandle;
+	};
 }
\ No newline at end of file
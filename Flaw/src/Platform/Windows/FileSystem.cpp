@@ -86,4 +86,69 @@ namespace flaw {
 		}
 		return path.generic_u8string();
 	}
+
+	MappedFile::MappedFile()
+		: _data(nullptr)
+		, _size(0)
+		, _fileHandle(INVALID_HANDLE_VALUE)
+		, _mappingHandle(NULL)
+	{
+	}
+
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+	bool MappedFile::Open(const char* path) {
+		Close();
+
+		HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (hFile == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+			CloseHandle(hFile);
+			return false;
+		}
+
+		HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (hMapping == NULL) {
+			CloseHandle(hFile);
+			return false;
+		}
+
+		void* view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		if (view == nullptr) {
+			CloseHandle(hMapping);
+			CloseHandle(hFile);
+			return false;
+		}
+
+		_data = static_cast<const int8_t*>(view);
+		_size = static_cast<uint64_t>(fileSize.QuadPart);
+		_fileHandle = hFile;
+		_mappingHandle = hMapping;
+
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (_data) {
+			UnmapViewOfFile(_data);
+			_data = nullptr;
+			_size = 0;
+		}
+
+		if (_mappingHandle != NULL) {
+			CloseHandle(_mappingHandle);
+			_mappingHandle = NULL;
+		}
+
+		if (_fileHandle != INVALID_HANDLE_VALUE) {
+			CloseHandle(_fileHandle);
+			_fileHandle = INVALID_HANDLE_VALUE;
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include "pch.h"
+#include "DynamicAABBTree.h"
+
+namespace flaw {
+	// moving proxies get their box stretched this many times their displacement
+	constexpr float DisplacementMultiplier = 4.0f;
+
+	DynamicAABBTree::DynamicAABBTree(float margin)
+		: _margin(margin)
+		, _root(NullNode)
+		, _freeList(NullNode)
+		, _proxyCount(0)
+	{
+	}
+
+	int32_t DynamicAABBTree::AllocateNode() {
+		if (_freeList == NullNode) {
+			_nodes.emplace_back();
+			return static_cast<int32_t>(_nodes.size()) - 1;
+		}
+
+		const int32_t node = _freeList;
+		_freeList = _nodes[node].parent;
+		_nodes[node] = Node();
+
+		return node;
+	}
+
+	void DynamicAABBTree::FreeNode(int32_t node) {
+		_nodes[node].parent = _freeList;
+		_nodes[node].height = -1;
+		_freeList = node;
+	}
+
+	int32_t DynamicAABBTree::CreateProxy(const AABB& aabb, uint32_t userData) {
+		const int32_t proxyId = AllocateNode();
+
+		Node& node = _nodes[proxyId];
+		node.aabb = AABB(aabb.min - vec3(_margin), aabb.max + vec3(_margin));
+		node.userData = userData;
+		node.height = 0;
+
+		InsertLeaf(proxyId);
+		_proxyCount++;
+
+		return proxyId;
+	}
+
+	void DynamicAABBTree::DestroyProxy(int32_t proxyId) {
+		FASSERT(_nodes[proxyId].IsLeaf(), "Proxy must be a leaf node");
+
+		RemoveLeaf(proxyId);
+		FreeNode(proxyId);
+		_proxyCount--;
+	}
+
+	bool DynamicAABBTree::MoveProxy(int32_t proxyId, const AABB& aabb, const vec3& displacement) {
+		Node& node = _nodes[proxyId];
+
+		FASSERT(node.IsLeaf(), "Proxy must be a leaf node");
+
+		AABB fatAABB(aabb.min - vec3(_margin), aabb.max + vec3(_margin));
+
+		const vec3 stretch = displacement * DisplacementMultiplier;
+		fatAABB.min += glm::min(stretch, vec3(0.0f));
+		fatAABB.max += glm::max(stretch, vec3(0.0f));
+
+		if (node.aabb.Contains(aabb)) {
+			// a box that shrank a lot is reinserted so it does not stay huge forever
+			const AABB hugeAABB(fatAABB.min - vec3(4.0f * _margin), fatAABB.max + vec3(4.0f * _margin));
+			if (hugeAABB.Contains(node.aabb)) {
+				return false;
+			}
+		}
+
+		RemoveLeaf(proxyId);
+		_nodes[proxyId].aabb = fatAABB;
+		InsertLeaf(proxyId);
+
+		return true;
+	}
+
+	void DynamicAABBTree::Clear() {
+		_nodes.clear();
+		_root = NullNode;
+		_freeList = NullNode;
+		_proxyCount = 0;
+	}
+
+	void DynamicAABBTree::InsertLeaf(int32_t leaf) {
+		if (_root == NullNode) {
+			_root = leaf;
+			_nodes[_root].parent = NullNode;
+			return;
+		}
+
+		// find the best sibling with the surface area heuristic
+		const AABB leafAABB = _nodes[leaf].aabb;
+
+		int32_t index = _root;
+		while (!_nodes[index].IsLeaf()) {
+			const Node& node = _nodes[index];
+
+			const float area = node.aabb.GetSurfaceArea();
+			const float combinedArea = AABB::Union(node.aabb, leafAABB).GetSurfaceArea();
+
+			// cost of creating a new parent for this node and the new leaf
+			const float cost = 2.0f * combinedArea;
+
+			// minimum cost of pushing the leaf further down the tree
+			const float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](int32_t child) {
+				const Node& childNode = _nodes[child];
+				const float newArea = AABB::Union(leafAABB, childNode.aabb).GetSurfaceArea();
+
+				if (childNode.IsLeaf()) {
+					return newArea + inheritanceCost;
+				}
+
+				return newArea - childNode.aabb.GetSurfaceArea() + inheritanceCost;
+			};
+
+			const float cost1 = childCost(node.child1);
+			const float cost2 = childCost(node.child2);
+
+			if (cost < cost1 && cost < cost2) {
+				break;
+			}
+
+			index = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		const int32_t sibling = index;
+
+		// create a new parent
+		const int32_t oldParent = _nodes[sibling].parent;
+		const int32_t newParent = AllocateNode();
+
+		Node& parentNode = _nodes[newParent];
+		parentNode.parent = oldParent;
+		parentNode.aabb = AABB::Union(leafAABB, _nodes[sibling].aabb);
+		parentNode.height = _nodes[sibling].height + 1;
+		parentNode.child1 = sibling;
+		parentNode.child2 = leaf;
+
+		if (oldParent != NullNode) {
+			if (_nodes[oldParent].child1 == sibling) {
+				_nodes[oldParent].child1 = newParent;
+			}
+			else {
+				_nodes[oldParent].child2 = newParent;
+			}
+		}
+		else {
+			_root = newParent;
+		}
+
+		_nodes[sibling].parent = newParent;
+		_nodes[leaf].parent = newParent;
+
+		Refit(_nodes[leaf].parent);
+	}
+
+	void DynamicAABBTree::RemoveLeaf(int32_t leaf) {
+		if (leaf == _root) {
+			_root = NullNode;
+			return;
+		}
+
+		const int32_t parent = _nodes[leaf].parent;
+		const int32_t grandParent = _nodes[parent].parent;
+		const int32_t sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+		if (grandParent != NullNode) {
+			// connect the sibling to the grand parent and drop the parent
+			if (_nodes[grandParent].child1 == parent) {
+				_nodes[grandParent].child1 = sibling;
+			}
+			else {
+				_nodes[grandParent].child2 = sibling;
+			}
+
+			_nodes[sibling].parent = grandParent;
+			FreeNode(parent);
+
+			Refit(grandParent);
+		}
+		else {
+			_root = sibling;
+			_nodes[sibling].parent = NullNode;
+			FreeNode(parent);
+		}
+	}
+
+	void DynamicAABBTree::Refit(int32_t node) {
+		int32_t index = node;
+
+		while (index != NullNode) {
+			index = Balance(index);
+
+			Node& current = _nodes[index];
+			const Node& child1 = _nodes[current.child1];
+			const Node& child2 = _nodes[current.child2];
+
+			current.height = 1 + (child1.height > child2.height ? child1.height : child2.height);
+			current.aabb = AABB::Union(child1.aabb, child2.aabb);
+
+			index = current.parent;
+		}
+	}
+
+	// rotates the taller child up when the subtree is unbalanced, returns the new root of the subtree
+	int32_t DynamicAABBTree::Balance(int32_t index) {
+		const Node& node = _nodes[index];
+		if (node.IsLeaf() || node.height < 2) {
+			return index;
+		}
+
+		const int32_t balance = _nodes[node.child2].height - _nodes[node.child1].height;
+
+		if (balance > 1) {
+			return Rotate(index, node.child2, node.child1);
+		}
+
+		if (balance < -1) {
+			return Rotate(index, node.child1, node.child2);
+		}
+
+		return index;
+	}
+
+	// B (the tall child) becomes the parent of A, its taller child stays with it and the shorter one replaces B under A
+	int32_t DynamicAABBTree::Rotate(int32_t iA, int32_t iB, int32_t iOther) {
+		Node& A = _nodes[iA];
+		Node& B = _nodes[iB];
+		const Node& other = _nodes[iOther];
+
+		const int32_t iF = B.child1;
+		const int32_t iG = B.child2;
+
+		// B takes the place of A
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		if (B.parent != NullNode) {
+			if (_nodes[B.parent].child1 == iA) {
+				_nodes[B.parent].child1 = iB;
+			}
+			else {
+				_nodes[B.parent].child2 = iB;
+			}
+		}
+		else {
+			_root = iB;
+		}
+
+		// the taller grand child stays under B, the other one moves under A
+		const bool keepF = _nodes[iF].height > _nodes[iG].height;
+		const int32_t iKeep = keepF ? iF : iG;
+		const int32_t iMove = keepF ? iG : iF;
+
+		Node& keep = _nodes[iKeep];
+		Node& move = _nodes[iMove];
+
+		B.child2 = iKeep;
+
+		if (A.child1 == iB) {
+			A.child1 = iMove;
+		}
+		else {
+			A.child2 = iMove;
+		}
+		move.parent = iA;
+
+		A.aabb = AABB::Union(other.aabb, move.aabb);
+		B.aabb = AABB::Union(A.aabb, keep.aabb);
+
+		A.height = 1 + (other.height > move.height ? other.height : move.height);
+		B.height = 1 + (A.height > keep.height ? A.height : keep.height);
+
+		return iB;
+	}
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+#include "Core.h"
+#include "Math/Math.h"
+#include "Utils/Raycast.h"
+
+#include <vector>
+
+namespace flaw {
+	struct AABB {
+		vec3 min = vec3(0.0f);
+		vec3 max = vec3(0.0f);
+
+		AABB() = default;
+		AABB(const vec3& min, const vec3& max) : min(min), max(max) {}
+
+		vec3 GetCenter() const { return (min + max) * 0.5f; }
+		vec3 GetExtent() const { return (max - min) * 0.5f; }
+
+		float GetSurfaceArea() const {
+			const vec3 size = max - min;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		bool Contains(const AABB& other) const {
+			return all(lessThanEqual(min, other.min)) && all(greaterThanEqual(max, other.max));
+		}
+
+		bool Overlaps(const AABB& other) const {
+			return all(lessThanEqual(min, other.max)) && all(greaterThanEqual(max, other.min));
+		}
+
+		// axis aligned box enclosing this box after the transform
+		AABB Transform(const mat4& matrix) const {
+			const vec3 center = matrix * vec4(GetCenter(), 1.0f);
+			const vec3 localExtent = GetExtent();
+			const vec3 extent = abs(vec3(matrix[0])) * localExtent.x + abs(vec3(matrix[1])) * localExtent.y + abs(vec3(matrix[2])) * localExtent.z;
+
+			return AABB(center - extent, center + extent);
+		}
+
+		// slab test, distance is where the ray enters the box or 0 when the origin is inside
+		bool IntersectRay(const vec3& origin, const vec3& invDirection, float maxDistance, float& outDistance) const {
+			float entry = 0.0f;
+			float exit = maxDistance;
+
+			for (int32_t axis = 0; axis < 3; ++axis) {
+				const float t0 = (min[axis] - origin[axis]) * invDirection[axis];
+				const float t1 = (max[axis] - origin[axis]) * invDirection[axis];
+
+				// 0 * inf, the ray runs along the axis on one of its planes so this slab never ends it
+				if (std::isnan(t0) || std::isnan(t1)) {
+					continue;
+				}
+
+				entry = std::max(entry, std::min(t0, t1));
+				exit = std::min(exit, std::max(t0, t1));
+			}
+
+			outDistance = entry;
+			return entry <= exit;
+		}
+
+		static AABB Union(const AABB& a, const AABB& b) {
+			return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+		}
+	};
+
+	// incrementally updated bounding volume hierarchy, leaves keep enlarged (fat) boxes so small moves do not touch the tree
+	class DynamicAABBTree {
+	public:
+		static constexpr int32_t NullNode = -1;
+
+		DynamicAABBTree(float margin = 0.1f);
+
+		int32_t CreateProxy(const AABB& aabb, uint32_t userData);
+		void DestroyProxy(int32_t proxyId);
+
+		// returns true when the proxy left its fat box and was reinserted, displacement enlarges the box in the moving direction
+		bool MoveProxy(int32_t proxyId, const AABB& aabb, const vec3& displacement = vec3(0.0f));
+
+		void Clear();
+
+		uint32_t GetUserData(int32_t proxyId) const { return _nodes[proxyId].userData; }
+		const AABB& GetFatAABB(int32_t proxyId) const { return _nodes[proxyId].aabb; }
+
+		int32_t GetProxyCount() const { return _proxyCount; }
+		int32_t GetHeight() const { return _root == NullNode ? 0 : _nodes[_root].height; }
+
+		// func(proxyId) returns false to stop the query
+		template<typename Func>
+		void Query(const AABB& aabb, const Func& func) const;
+
+		template<typename Func>
+		void QuerySphere(const vec3& center, float radius, const Func& func) const;
+
+		// func(proxyId) returns false to stop the query, subtrees fully inside the frustum are reported without testing their children
+		template<typename Func>
+		void QueryFrustum(const Frustum& frustum, const Func& func) const;
+
+		// func(proxyId, distance) returns the new max distance of the ray, return 0 to stop and the current max distance to keep going
+		template<typename Func>
+		void QueryRay(const Ray& ray, const Func& func) const;
+
+	private:
+		struct Node {
+			AABB aabb;
+			uint32_t userData = 0;
+
+			int32_t parent = NullNode; // next free node when the node is in the free list
+			int32_t child1 = NullNode;
+			int32_t child2 = NullNode;
+
+			int32_t height = -1; // leaf = 0, free node = -1
+
+			bool IsLeaf() const { return child1 == NullNode; }
+		};
+
+		// traversal stack on the stack, falls back to the heap for very deep trees
+		class NodeStack {
+		public:
+			void Push(int32_t node) {
+				if (_count < InlineCapacity) {
+					_inline[_count] = node;
+				}
+				else {
+					_heap.push_back(node);
+				}
+				_count++;
+			}
+
+			int32_t Pop() {
+				_count--;
+				if (_count < InlineCapacity) {
+					return _inline[_count];
+				}
+
+				const int32_t node = _heap.back();
+				_heap.pop_back();
+				return node;
+			}
+
+			bool Empty() const { return _count == 0; }
+
+		private:
+			static constexpr int32_t InlineCapacity = 128;
+
+			int32_t _inline[InlineCapacity];
+			std::vector<int32_t> _heap;
+			int32_t _count = 0;
+		};
+
+		int32_t AllocateNode();
+		void FreeNode(int32_t node);
+
+		void InsertLeaf(int32_t leaf);
+		void RemoveLeaf(int32_t leaf);
+
+		// walks up from the node, refitting boxes and rotating unbalanced nodes
+		void Refit(int32_t node);
+		int32_t Balance(int32_t node);
+		int32_t Rotate(int32_t node, int32_t tallChild, int32_t otherChild);
+
+		// reports every leaf under the node, returns false when func stopped the query
+		template<typename Func>
+		bool ReportSubtree(int32_t node, const Func& func) const;
+
+	private:
+		float _margin;
+
+		std::vector<Node> _nodes;
+		int32_t _root;
+		int32_t _freeList;
+		int32_t _proxyCount;
+	};
+
+	template<typename Func>
+	void DynamicAABBTree::Query(const AABB& aabb, const Func& func) const {
+		NodeStack stack;
+		stack.Push(_root);
+
+		while (!stack.Empty()) {
+			const int32_t nodeId = stack.Pop();
+			if (nodeId == NullNode) {
+				continue;
+			}
+
+			const Node& node = _nodes[nodeId];
+			if (!node.aabb.Overlaps(aabb)) {
+				continue;
+			}
+
+			if (node.IsLeaf()) {
+				if (!func(nodeId)) {
+					return;
+				}
+			}
+			else {
+				stack.Push(node.child1);
+				stack.Push(node.child2);
+			}
+		}
+	}
+
+	template<typename Func>
+	void DynamicAABBTree::QuerySphere(const vec3& center, float radius, const Func& func) const {
+		const float radiusSq = radius * radius;
+
+		NodeStack stack;
+		stack.Push(_root);
+
+		while (!stack.Empty()) {
+			const int32_t nodeId = stack.Pop();
+			if (nodeId == NullNode) {
+				continue;
+			}
+
+			const Node& node = _nodes[nodeId];
+
+			const vec3 closest = clamp(center, node.aabb.min, node.aabb.max);
+			if (length2(closest - center) > radiusSq) {
+				continue;
+			}
+
+			if (node.IsLeaf()) {
+				if (!func(nodeId)) {
+					return;
+				}
+			}
+			else {
+				stack.Push(node.child1);
+				stack.Push(node.child2);
+			}
+		}
+	}
+
+	template<typename Func>
+	bool DynamicAABBTree::ReportSubtree(int32_t root, const Func& func) const {
+		NodeStack stack;
+		stack.Push(root);
+
+		while (!stack.Empty()) {
+			const int32_t nodeId = stack.Pop();
+			const Node& node = _nodes[nodeId];
+
+			if (node.IsLeaf()) {
+				if (!func(nodeId)) {
+					return false;
+				}
+			}
+			else {
+				stack.Push(node.child1);
+				stack.Push(node.child2);
+			}
+		}
+
+		return true;
+	}
+
+	template<typename Func>
+	void DynamicAABBTree::QueryFrustum(const Frustum& frustum, const Func& func) const {
+		NodeStack stack;
+		stack.Push(_root);
+
+		while (!stack.Empty()) {
+			const int32_t nodeId = stack.Pop();
+			if (nodeId == NullNode) {
+				continue;
+			}
+
+			const Node& node = _nodes[nodeId];
+			const vec3 center = node.aabb.GetCenter();
+			const vec3 extent = node.aabb.GetExtent();
+
+			bool outside = false;
+			bool inside = true;
+
+			for (const auto& plane : frustum.planes.data) {
+				const float distance = plane.Distance(center);
+				const float radius = dot(abs(plane.Normal()), extent);
+
+				if (distance > radius) {
+					outside = true;
+					break;
+				}
+
+				if (distance > -radius) {
+					inside = false;
+				}
+			}
+
+			if (outside) {
+				continue;
+			}
+
+			if (inside || node.IsLeaf()) {
+				if (!ReportSubtree(nodeId, func)) {
+					return;
+				}
+			}
+			else {
+				stack.Push(node.child1);
+				stack.Push(node.child2);
+			}
+		}
+	}
+
+	template<typename Func>
+	void DynamicAABBTree::QueryRay(const Ray& ray, const Func& func) const {
+		const vec3 invDirection = 1.0f / ray.direction;
+		float maxDistance = ray.length;
+
+		NodeStack stack;
+		stack.Push(_root);
+
+		while (!stack.Empty()) {
+			const int32_t nodeId = stack.Pop();
+			if (nodeId == NullNode) {
+				continue;
+			}
+
+			const Node& node = _nodes[nodeId];
+
+			float distance;
+			if (!node.aabb.IntersectRay(ray.origin, invDirection, maxDistance, distance)) {
+				continue;
+			}
+
+			if (node.IsLeaf()) {
+				maxDistance = func(nodeId, distance);
+				if (maxDistance <= 0.0f) {
+					return;
+				}
+			}
+			else {
+				stack.Push(node.child1);
+				stack.Push(node.child2);
+			}
+		}
+	}
+}
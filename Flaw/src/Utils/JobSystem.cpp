@@ -0,0 +1,211 @@
+#include "pch.h"
+#include "JobSystem.h"
+
+namespace flaw {
+	static thread_local JobSystem* g_currentSystem = nullptr;
+	static thread_local int32_t g_currentWorkerIndex = -1;
+
+	JobSystem::WorkQueue::WorkQueue()
+		: _jobs(256)
+		, _head(0)
+		, _count(0)
+	{
+	}
+
+	void JobSystem::WorkQueue::Grow() {
+		std::vector<Job> jobs(_jobs.size() * 2);
+		for (uint32_t i = 0; i < _count; ++i) {
+			jobs[i] = std::move(_jobs[(_head + i) % _jobs.size()]);
+		}
+
+		_jobs = std::move(jobs);
+		_head = 0;
+	}
+
+	void JobSystem::WorkQueue::PushBack(Job&& job) {
+		std::lock_guard<SpinLock> lock(_lock);
+
+		if (_count == _jobs.size()) {
+			Grow();
+		}
+
+		_jobs[(_head + _count) % _jobs.size()] = std::move(job);
+		_count++;
+	}
+
+	void JobSystem::WorkQueue::PushFront(Job&& job) {
+		std::lock_guard<SpinLock> lock(_lock);
+
+		if (_count == _jobs.size()) {
+			Grow();
+		}
+
+		_head = (_head + static_cast<uint32_t>(_jobs.size()) - 1) % _jobs.size();
+		_jobs[_head] = std::move(job);
+		_count++;
+	}
+
+	bool JobSystem::WorkQueue::PopBack(Job& job) {
+		std::lock_guard<SpinLock> lock(_lock);
+
+		if (_count == 0) {
+			return false;
+		}
+
+		_count--;
+		job = std::move(_jobs[(_head + _count) % _jobs.size()]);
+
+		return true;
+	}
+
+	bool JobSystem::WorkQueue::PopFront(Job& job) {
+		std::lock_guard<SpinLock> lock(_lock);
+
+		if (_count == 0) {
+			return false;
+		}
+
+		job = std::move(_jobs[_head]);
+		_head = (_head + 1) % _jobs.size();
+		_count--;
+
+		return true;
+	}
+
+	JobSystem::JobSystem(int32_t threadCount)
+		: _pendingJobs(0)
+		, _sleepingWorkers(0)
+		, _stopSignal(false)
+	{
+		if (threadCount < 1) {
+			threadCount = 1;
+		}
+
+		for (int32_t i = 0; i < threadCount + 1; ++i) {
+			_queues.emplace_back(CreateScope<WorkQueue>());
+		}
+
+		for (int32_t i = 0; i < threadCount; ++i) {
+			_threads.emplace_back(&JobSystem::WorkerThread, this, i);
+		}
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+			_stopSignal.store(true);
+		}
+
+		_sleepCondition.notify_all();
+
+		for (auto& thread : _threads) {
+			thread.join();
+		}
+	}
+
+	void JobSystem::Schedule(Job job, JobCounter* counter, const JobCounter* dependency) {
+		if (counter) {
+			counter->_value.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		job._counter = counter;
+		job._dependency = dependency;
+
+		const int32_t queueIndex = g_currentSystem == this ? g_currentWorkerIndex : static_cast<int32_t>(_queues.size()) - 1;
+		_queues[queueIndex]->PushBack(std::move(job));
+
+		_pendingJobs.fetch_add(1);
+
+		if (_sleepingWorkers.load() > 0) {
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+			_sleepCondition.notify_one();
+		}
+	}
+
+	void JobSystem::Wait(const JobCounter& counter) {
+		while (!counter.IsDone()) {
+			if (!RunPendingJob()) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	bool JobSystem::RunPendingJob() {
+		const int32_t queueIndex = g_currentSystem == this ? g_currentWorkerIndex : static_cast<int32_t>(_queues.size()) - 1;
+		return TryExecuteJob(queueIndex);
+	}
+
+	bool JobSystem::TryGetJob(int32_t queueIndex, Job& job) {
+		if (_queues[queueIndex]->PopBack(job)) {
+			return true;
+		}
+
+		// steal from the other queues, oldest job first
+		const int32_t queueCount = static_cast<int32_t>(_queues.size());
+		for (int32_t i = 1; i < queueCount; ++i) {
+			if (_queues[(queueIndex + i) % queueCount]->PopFront(job)) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool JobSystem::TryExecuteJob(int32_t queueIndex) {
+		Job job;
+		if (!TryGetJob(queueIndex, job)) {
+			return false;
+		}
+
+		if (job._dependency && !job._dependency->IsDone()) {
+			// not ready yet, put it back where it is picked up last
+			_queues[queueIndex]->PushFront(std::move(job));
+			return false;
+		}
+
+		_pendingJobs.fetch_sub(1);
+
+		Execute(job);
+
+		return true;
+	}
+
+	void JobSystem::Execute(Job& job) {
+		try {
+			job();
+		}
+		catch (const std::exception& e) {
+			std::cerr << "Exception in job: " << e.what() << std::endl;
+		}
+
+		if (job._counter) {
+			job._counter->_value.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	void JobSystem::WorkerThread(JobSystem* system, int32_t workerIndex) {
+		g_currentSystem = system;
+		g_currentWorkerIndex = workerIndex;
+
+		while (true) {
+			if (system->TryExecuteJob(workerIndex)) {
+				continue;
+			}
+
+			if (system->_pendingJobs.load() > 0) {
+				// jobs exist but are blocked by dependencies or being moved between queues
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(system->_sleepMutex);
+			system->_sleepingWorkers.fetch_add(1);
+			system->_sleepCondition.wait(lock, [system] { return system->_pendingJobs.load() > 0 || system->_stopSignal.load(); });
+			system->_sleepingWorkers.fetch_sub(1);
+
+			if (system->_stopSignal.load() && system->_pendingJobs.load() == 0) {
+				return; // Exit the thread
+			}
+		}
+	}
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "Core.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <type_traits>
+#include <cstddef>
+
+namespace flaw {
+	class JobCounter {
+	public:
+		JobCounter() : _value(0) {}
+
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const { return _value.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<int32_t> _value;
+	};
+
+	// callable with small buffer storage, only allocates when the callable does not fit inline
+	class Job {
+	public:
+		static constexpr size_t InlineSize = 48;
+
+		Job() = default;
+
+		template<typename Func, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, Job>>>
+		Job(Func&& func) {
+			using Callable = std::decay_t<Func>;
+
+			if constexpr (sizeof(Callable) <= InlineSize && alignof(Callable) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Callable>) {
+				new (_storage) Callable(std::forward<Func>(func));
+
+				_invoke = [](void* storage) { (*static_cast<Callable*>(storage))(); };
+				_manage = [](void* dst, void* src) {
+					Callable* srcCallable = static_cast<Callable*>(src);
+					if (dst) {
+						new (dst) Callable(std::move(*srcCallable));
+					}
+					srcCallable->~Callable();
+				};
+			}
+			else {
+				*reinterpret_cast<Callable**>(_storage) = new Callable(std::forward<Func>(func));
+
+				_invoke = [](void* storage) { (**static_cast<Callable**>(storage))(); };
+				_manage = [](void* dst, void* src) {
+					Callable** srcCallable = static_cast<Callable**>(src);
+					if (dst) {
+						*static_cast<Callable**>(dst) = *srcCallable;
+					}
+					else {
+						delete *srcCallable;
+					}
+				};
+			}
+		}
+
+		Job(Job&& other) noexcept {
+			MoveFrom(other);
+		}
+
+		Job& operator=(Job&& other) noexcept {
+			if (this != &other) {
+				Reset();
+				MoveFrom(other);
+			}
+			return *this;
+		}
+
+		Job(const Job&) = delete;
+		Job& operator=(const Job&) = delete;
+
+		~Job() {
+			Reset();
+		}
+
+		void operator()() { _invoke(_storage); }
+
+		explicit operator bool() const { return _invoke != nullptr; }
+
+	private:
+		void MoveFrom(Job& other) {
+			if (other._manage) {
+				other._manage(_storage, other._storage);
+			}
+
+			_invoke = other._invoke;
+			_manage = other._manage;
+			_counter = other._counter;
+			_dependency = other._dependency;
+
+			other._invoke = nullptr;
+			other._manage = nullptr;
+			other._counter = nullptr;
+			other._dependency = nullptr;
+		}
+
+		void Reset() {
+			if (_manage) {
+				_manage(nullptr, _storage);
+			}
+
+			_invoke = nullptr;
+			_manage = nullptr;
+		}
+
+	private:
+		friend class JobSystem;
+
+		using InvokeFunc = void(*)(void* storage);
+		using ManageFunc = void(*)(void* dst, void* src); // move src into dst (when dst is not null) and release src
+
+		alignas(std::max_align_t) uint8_t _storage[InlineSize];
+
+		InvokeFunc _invoke = nullptr;
+		ManageFunc _manage = nullptr;
+
+		JobCounter* _counter = nullptr;
+		const JobCounter* _dependency = nullptr;
+	};
+
+	class JobSystem {
+	public:
+		JobSystem(int32_t threadCount);
+		~JobSystem();
+
+		// schedule a job, counter is decremented when the job is finished and the job will not run before dependency is done
+		void Schedule(Job job, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr);
+
+		// wait until counter is done, calling thread executes pending jobs while waiting
+		void Wait(const JobCounter& counter);
+
+		// execute one pending job on the calling thread, returns false when nothing could be run
+		bool RunPendingJob();
+
+		// call func(index) for every index in [0, count) on worker threads, returns when every index is processed
+		template<typename Func>
+		void ParallelFor(int32_t count, int32_t batchSize, const Func& func) {
+			if (count <= 0) {
+				return;
+			}
+
+			if (batchSize < 1) {
+				batchSize = 1;
+			}
+
+			if (count <= batchSize) {
+				for (int32_t i = 0; i < count; ++i) {
+					func(i);
+				}
+				return;
+			}
+
+			JobCounter counter;
+			for (int32_t begin = batchSize; begin < count; begin += batchSize) {
+				const int32_t end = begin + batchSize < count ? begin + batchSize : count;
+				Schedule([&func, begin, end]() {
+					for (int32_t i = begin; i < end; ++i) {
+						func(i);
+					}
+				}, &counter);
+			}
+
+			// the first batch is processed by the calling thread
+			for (int32_t i = 0; i < batchSize; ++i) {
+				func(i);
+			}
+
+			Wait(counter);
+		}
+
+		int32_t GetWorkerCount() const { return static_cast<int32_t>(_threads.size()); }
+
+	private:
+		class SpinLock {
+		public:
+			void lock() {
+				while (_flag.test_and_set(std::memory_order_acquire)) {
+					std::this_thread::yield();
+				}
+			}
+
+			void unlock() {
+				_flag.clear(std::memory_order_release);
+			}
+
+		private:
+			std::atomic_flag _flag = ATOMIC_FLAG_INIT;
+		};
+
+		// owner pushes and pops at the back, thieves take from the front
+		class WorkQueue {
+		public:
+			WorkQueue();
+
+			void PushBack(Job&& job);
+			void PushFront(Job&& job);
+			bool PopBack(Job& job);
+			bool PopFront(Job& job);
+
+		private:
+			void Grow();
+
+		private:
+			SpinLock _lock;
+			std::vector<Job> _jobs;
+			uint32_t _head;
+			uint32_t _count;
+		};
+
+		static void WorkerThread(JobSystem* system, int32_t workerIndex);
+
+		bool TryGetJob(int32_t queueIndex, Job& job);
+		bool TryExecuteJob(int32_t queueIndex);
+		void Execute(Job& job);
+
+	private:
+		std::vector<std::thread> _threads;
+
+		// one queue per worker, the last one is shared by non worker threads
+		std::vector<Scope<WorkQueue>> _queues;
+
+		std::atomic<int32_t> _pendingJobs;
+		std::atomic<int32_t> _sleepingWorkers;
+
+		std::mutex _sleepMutex;
+		std::condition_variable _sleepCondition;
+
+		std::atomic<bool> _stopSignal;
+	};
+}
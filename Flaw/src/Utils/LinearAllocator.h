@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Core.h"
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+#include <new>
+
+namespace flaw {
+	// bump allocator for data that lives for one frame, nothing is freed until Reset
+	class LinearAllocator {
+	public:
+		LinearAllocator(size_t blockSize = 64 * 1024)
+			: _blockSize(blockSize)
+			, _currentBlock(0)
+			, _usedSize(0)
+		{
+		}
+
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+			while (_currentBlock < _blocks.size()) {
+				auto& block = _blocks[_currentBlock];
+
+				const size_t offset = (block.offset + alignment - 1) & ~(alignment - 1);
+				if (offset + size <= block.size) {
+					block.offset = offset + size;
+					_usedSize += size;
+					return block.data.get() + offset;
+				}
+
+				_currentBlock++;
+			}
+
+			const size_t blockSize = size + alignment > _blockSize ? size + alignment : _blockSize;
+			_blocks.push_back({ CreateScope<uint8_t[]>(blockSize), blockSize, 0 });
+
+			return Allocate(size, alignment);
+		}
+
+		// only trivially destructible types, destructors are never called
+		template<typename T, typename... Args>
+		T* New(Args&&... args) {
+			static_assert(std::is_trivially_destructible<T>::value, "LinearAllocator never calls destructors");
+			return new (Allocate(sizeof(T), alignof(T))) T{ std::forward<Args>(args)... };
+		}
+
+		// keeps the memory, blocks are merged so a steady workload ends up in a single block
+		void Reset() {
+			if (_blocks.size() > 1) {
+				size_t totalSize = 0;
+				for (auto& block : _blocks) {
+					totalSize += block.size;
+				}
+
+				_blocks.clear();
+				_blocks.push_back({ CreateScope<uint8_t[]>(totalSize), totalSize, 0 });
+			}
+
+			for (auto& block : _blocks) {
+				block.offset = 0;
+			}
+
+			_currentBlock = 0;
+			_usedSize = 0;
+		}
+
+		size_t GetUsedSize() const { return _usedSize; }
+
+	private:
+		struct Block {
+			Scope<uint8_t[]> data;
+			size_t size;
+			size_t offset;
+		};
+
+		size_t _blockSize;
+
+		std::vector<Block> _blocks;
+		size_t _currentBlock;
+
+		size_t _usedSize;
+	};
+}
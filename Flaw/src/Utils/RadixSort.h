@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Core.h"
+
+#include <vector>
+
+namespace flaw {
+	// stable lsd radix sort on 64 bit keys, 8 bits per pass, passes where every key has the same digit are skipped
+	// temp is scratch space, pass the same vector every frame to avoid allocations
+	template<typename T, typename KeyFunc>
+	inline void RadixSort(std::vector<T>& items, std::vector<T>& temp, const KeyFunc& getKey) {
+		const size_t count = items.size();
+		if (count < 2) {
+			return;
+		}
+
+		temp.resize(count);
+
+		uint32_t histograms[8][256] = {};
+		for (const auto& item : items) {
+			const uint64_t key = getKey(item);
+			for (int32_t pass = 0; pass < 8; ++pass) {
+				histograms[pass][(key >> (pass * 8)) & 0xff]++;
+			}
+		}
+
+		T* src = items.data();
+		T* dst = temp.data();
+
+		for (int32_t pass = 0; pass < 8; ++pass) {
+			uint32_t* histogram = histograms[pass];
+
+			const uint64_t firstDigit = (getKey(src[0]) >> (pass * 8)) & 0xff;
+			if (histogram[firstDigit] == count) {
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (int32_t digit = 0; digit < 256; ++digit) {
+				const uint32_t digitCount = histogram[digit];
+				histogram[digit] = offset;
+				offset += digitCount;
+			}
+
+			for (size_t i = 0; i < count; ++i) {
+				const uint64_t digit = (getKey(src[i]) >> (pass * 8)) & 0xff;
+				dst[histogram[digit]++] = std::move(src[i]);
+			}
+
+			std::swap(src, dst);
+		}
+
+		if (src != items.data()) {
+			items.swap(temp);
+		}
+	}
+}
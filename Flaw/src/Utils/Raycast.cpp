@@ -1,5 +1,14 @@
 #include "pch.h"
 #include "Raycast.h"
+#include "Utils/JobSystem.h"
+
+#include <algorithm>
+#include <array>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__SSE2__)
+	#define FLAW_RAYCAST_SSE
+	#include <immintrin.h>
+#endif
 
 namespace flaw {
 	BVHTriangle::BVHTriangle(const vec3& p0, const vec3& p1, const vec3& p2)
@@ -26,82 +35,289 @@ namespace flaw {
 		IncludePoint(triangle.p2);
 	}
 
-	void Split(std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles, int32_t parent, int32_t depth) {
-		if (depth >= MaxBVHDepth || nodes[parent].triangleCount <= 1) {
-			return;
+	static float GetSurfaceArea(const BVHBoundingBox& box) {
+		const vec3 size = box.max - box.min;
+		if (size.x < 0.0f || size.y < 0.0f || size.z < 0.0f) {
+			return 0.0f;
 		}
 
-		//    ߽ ڸ.
-		vec3 size = nodes[parent].boundingBox.max - nodes[parent].boundingBox.min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	static void IncludeBox(BVHBoundingBox& box, const BVHBoundingBox& other) {
+		box.min = glm::min(box.min, other.min);
+		box.max = glm::max(box.max, other.max);
+		box.center = (box.min + box.max) * 0.5f;
+	}
+
+	struct BVHBuildContext {
+		const BVHBuildSettings& settings;
+		const std::vector<BVHTriangle>& triangles;
+		std::vector<int32_t>& order; // nodes partition triangle indices, the triangles are reordered once the tree is built
+	};
+
+	struct BVHSplit {
+		int32_t axis = -1;
+		float position = 0.0f;	// triangles with a center below it go to child a
+		float cost = std::numeric_limits<float>::max();
+	};
+
+	static bool FindMidpointSplit(const BVHBoundingBox& centerBounds, BVHSplit& outSplit) {
+		const vec3 size = centerBounds.max - centerBounds.min;
 
-		// 0 : x, 1: y, 2: z
-		int32_t splitAxis = 0;
-		if (size.y > size.x) {
-			splitAxis = 1;
+		int32_t axis = 0;
+		if (size.y > size[axis]) {
+			axis = 1;
 		}
 
-		if (size.z > size.y) {
-			splitAxis = 2;
+		if (size.z > size[axis]) {
+			axis = 2;
 		}
 
-		BVHNode childANode;
-		BVHNode childBNode;
+		if (size[axis] <= 0.0f) {
+			return false;
+		}
+
+		outSplit.axis = axis;
+		outSplit.position = centerBounds.center[axis];
+
+		return true;
+	}
+
+	static bool FindBinnedSAHSplit(const BVHBuildContext& context, int32_t start, int32_t count, const BVHBoundingBox& centerBounds, BVHSplit& outSplit) {
+		struct Bin {
+			BVHBoundingBox bounds;
+			int32_t count = 0;
+		};
+
+		const int32_t binCount = glm::clamp(context.settings.binCount, 2, MaxBVHBinCount);
+
+		std::array<Bin, MaxBVHBinCount> bins;
+		std::array<float, MaxBVHBinCount - 1> costs;
 
-		int32_t left = nodes[parent].triangleStart;
-		int32_t right = nodes[parent].triangleStart + nodes[parent].triangleCount - 1;
+		for (int32_t axis = 0; axis < 3; ++axis) {
+			const float axisMin = centerBounds.min[axis];
+			const float axisSize = centerBounds.max[axis] - axisMin;
+			if (axisSize <= 0.0f) {
+				continue;
+			}
+
+			const float binScale = binCount / axisSize;
 
-		while (left <= right) {
-			auto& tri = triangles[left];
-			bool isInA = false;
-			if (splitAxis == 0) isInA = tri.center.x < nodes[parent].boundingBox.center.x;
-			else if (splitAxis == 1) isInA = tri.center.y < nodes[parent].boundingBox.center.y;
-			else if (splitAxis == 2) isInA = tri.center.z < nodes[parent].boundingBox.center.z;
+			std::fill(bins.begin(), bins.begin() + binCount, Bin());
+			for (int32_t i = start; i < start + count; ++i) {
+				const auto& tri = context.triangles[context.order[i]];
+				const int32_t binIndex = std::min(static_cast<int32_t>((tri.center[axis] - axisMin) * binScale), binCount - 1);
 
-			if (isInA) {
-				childANode.boundingBox.IncludeTriangle(tri);
-				childANode.triangleCount++;
-				left++;
+				bins[binIndex].bounds.IncludeTriangle(tri);
+				bins[binIndex].count++;
 			}
-			else {
-				childBNode.boundingBox.IncludeTriangle(tri);
-				std::swap(triangles[left], triangles[right]);
-				childBNode.triangleCount++;
-				right--;
+
+			// sweep from the left then from the right, costs[i] splits between bin i and i + 1
+			BVHBoundingBox leftBounds;
+			int32_t leftCount = 0;
+			for (int32_t i = 0; i < binCount - 1; ++i) {
+				IncludeBox(leftBounds, bins[i].bounds);
+				leftCount += bins[i].count;
+				costs[i] = leftCount * GetSurfaceArea(leftBounds);
+			}
+
+			BVHBoundingBox rightBounds;
+			int32_t rightCount = 0;
+			for (int32_t i = binCount - 1; i > 0; --i) {
+				IncludeBox(rightBounds, bins[i].bounds);
+				rightCount += bins[i].count;
+				costs[i - 1] += rightCount * GetSurfaceArea(rightBounds);
+			}
+
+			for (int32_t i = 0; i < binCount - 1; ++i) {
+				if (costs[i] < outSplit.cost) {
+					outSplit.axis = axis;
+					outSplit.position = axisMin + (i + 1) / binScale;
+					outSplit.cost = costs[i];
+				}
 			}
 		}
 
-		childANode.triangleStart = nodes[parent].triangleStart;
-		childBNode.triangleStart = left;
+		return outSplit.axis != -1;
+	}
+
+	static int32_t BuildBVHSubtree(const BVHBuildContext& context, std::vector<BVHNode>& nodes, int32_t start, int32_t count, int32_t depth);
 
-		nodes[parent].childA = nodes.size();
-		nodes.push_back(childANode);
+	// appends a subtree built into its own array, child indices move by the insert position
+	static int32_t AppendBVHSubtree(std::vector<BVHNode>& nodes, const std::vector<BVHNode>& subtree) {
+		const int32_t offset = static_cast<int32_t>(nodes.size());
 
-		nodes[parent].childB = nodes.size();
-		nodes.push_back(childBNode);
+		for (BVHNode node : subtree) {
+			if (!node.IsLeaf()) {
+				node.childA += offset;
+				node.childB += offset;
+			}
+			nodes.push_back(node);
+		}
 
-		Split(nodes, triangles, nodes[parent].childA, depth + 1);
-		Split(nodes, triangles, nodes[parent].childB, depth + 1);
+		return offset;
 	}
 
-	void Raycast::BuildBVH(const std::function<vec3(int32_t)>& getVertex, int32_t vertexCount, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles) {
-		BVHNode rootNode;
+	// nodes are stored depth first, a node is followed by its first child
+	static int32_t BuildBVHSubtree(const BVHBuildContext& context, std::vector<BVHNode>& nodes, int32_t start, int32_t count, int32_t depth) {
+		const auto& settings = context.settings;
 
-		triangles.reserve(vertexCount / 3);
-		for (size_t i = 0; i < vertexCount; i += 3) {
-			const auto& v0 = getVertex(i);
-			const auto& v1 = getVertex(i + 1);
-			const auto& v2 = getVertex(i + 2);
+		const int32_t nodeIndex = static_cast<int32_t>(nodes.size());
+		nodes.emplace_back();
+
+		BVHBoundingBox bounds;
+		BVHBoundingBox centerBounds;
+		for (int32_t i = start; i < start + count; ++i) {
+			const auto& tri = context.triangles[context.order[i]];
+			bounds.IncludeTriangle(tri);
+			centerBounds.IncludePoint(tri.center);
+		}
 
-			triangles.emplace_back(v0, v1, v2);
-			rootNode.boundingBox.IncludeTriangle(triangles.back());
-			rootNode.triangleCount++;
+		nodes[nodeIndex].boundingBox = bounds;
+		nodes[nodeIndex].triangleStart = start;
+		nodes[nodeIndex].triangleCount = count;
+
+		// traversal defers one child per level on a fixed stack
+		if (count <= 1 || depth >= std::min(settings.maxDepth, Raycast::MaxTraversalDepth)) {
+			return nodeIndex;
+		}
+
+		BVHSplit split;
+		bool found = false;
+		if (settings.splitMethod == BVHSplitMethod::BinnedSAH) {
+			found = FindBinnedSAHSplit(context, start, count, centerBounds, split);
+
+			// split cost counts triangle tests weighted by child area, compare it with testing every triangle here
+			if (found && count <= settings.maxLeafTriangles) {
+				const float area = GetSurfaceArea(bounds);
+				const float leafCost = count * settings.intersectionCost;
+				const float splitCost = area > 0.0f ? settings.traversalCost + settings.intersectionCost * split.cost / area : leafCost;
+				found = splitCost < leafCost;
+			}
 		}
+		else {
+			found = count > settings.maxLeafTriangles && FindMidpointSplit(centerBounds, split);
+		}
+
+		if (!found) {
+			return nodeIndex;
+		}
+
+		const auto& triangles = context.triangles;
+		auto begin = context.order.begin() + start;
+		auto end = begin + count;
+		auto middle = std::partition(begin, end, [&triangles, &split](int32_t index) { return triangles[index].center[split.axis] < split.position; });
+
+		int32_t countA = static_cast<int32_t>(middle - begin);
+		if (countA == 0 || countA == count) {
+			// every center on one side of the split, halve by center instead
+			countA = count / 2;
+			std::nth_element(begin, begin + countA, end, [&triangles, &split](int32_t a, int32_t b) { return triangles[a].center[split.axis] < triangles[b].center[split.axis]; });
+		}
+
+		const int32_t countB = count - countA;
+
+		int32_t childA, childB;
+		if (settings.jobSystem && count >= settings.parallelTriangleCount) {
+			// the ranges do not overlap, both halves partition their own triangles
+			std::vector<BVHNode> subtreeA, subtreeB;
+
+			JobCounter counter;
+			settings.jobSystem->Schedule([&context, &subtreeA, start, countA, depth]() {
+				BuildBVHSubtree(context, subtreeA, start, countA, depth + 1);
+			}, &counter);
+
+			BuildBVHSubtree(context, subtreeB, start + countA, countB, depth + 1);
+			settings.jobSystem->Wait(counter);
+
+			childA = AppendBVHSubtree(nodes, subtreeA);
+			childB = AppendBVHSubtree(nodes, subtreeB);
+		}
+		else {
+			childA = BuildBVHSubtree(context, nodes, start, countA, depth + 1);
+			childB = BuildBVHSubtree(context, nodes, start + countA, countB, depth + 1);
+		}
+
+		nodes[nodeIndex].childA = childA;
+		nodes[nodeIndex].childB = childB;
+
+		return nodeIndex;
+	}
+
+	void Raycast::BuildBVH(const std::function<vec3(int32_t)>& getVertex, int32_t vertexCount, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles, const BVHBuildSettings& settings, BVHBuildStats* outStats, std::vector<int32_t>* outTriangleIndices) {
+		nodes.clear();
+
+		std::vector<BVHTriangle> sourceTriangles;
+		sourceTriangles.reserve(vertexCount / 3);
+		for (int32_t i = 0; i + 2 < vertexCount; i += 3) {
+			sourceTriangles.emplace_back(getVertex(i), getVertex(i + 1), getVertex(i + 2));
+		}
+
+		std::vector<int32_t> order(sourceTriangles.size());
+		for (int32_t i = 0; i < static_cast<int32_t>(order.size()); ++i) {
+			order[i] = i;
+		}
+
+		nodes.reserve(std::max<size_t>(1, sourceTriangles.size() * 2 / std::max(settings.maxLeafTriangles, 1)));
+
+		BVHBuildContext context = { settings, sourceTriangles, order };
+		BuildBVHSubtree(context, nodes, 0, static_cast<int32_t>(sourceTriangles.size()), 0);
+
+		// leaves reference contiguous ranges, store the triangles in leaf order
+		triangles.resize(order.size());
+		for (size_t i = 0; i < order.size(); ++i) {
+			triangles[i] = sourceTriangles[order[i]];
+		}
+
+		if (outTriangleIndices) {
+			*outTriangleIndices = std::move(order);
+		}
+
+		if (outStats) {
+			*outStats = EvaluateBVH(nodes, settings);
+		}
+	}
+
+	BVHBuildStats Raycast::EvaluateBVH(const std::vector<BVHNode>& nodes, const BVHBuildSettings& settings) {
+		BVHBuildStats stats;
+		if (nodes.empty()) {
+			return stats;
+		}
+
+		const float rootArea = GetSurfaceArea(nodes[0].boundingBox);
+		int32_t leafTriangleCount = 0;
 
-		rootNode.triangleStart = 0;
+		std::vector<std::pair<int32_t, int32_t>> stack; // node, depth
+		stack.emplace_back(0, 0);
 
-		nodes.push_back(rootNode);
+		while (!stack.empty()) {
+			const auto [nodeIndex, depth] = stack.back();
+			stack.pop_back();
 
-		Split(nodes, triangles, 0, 0);
+			const auto& node = nodes[nodeIndex];
+			const float areaRatio = rootArea > 0.0f ? GetSurfaceArea(node.boundingBox) / rootArea : 1.0f;
+
+			stats.nodeCount++;
+			stats.maxDepth = std::max(stats.maxDepth, depth);
+
+			if (node.IsLeaf()) {
+				stats.leafCount++;
+				stats.maxLeafTriangles = std::max(stats.maxLeafTriangles, node.triangleCount);
+				stats.sahCost += areaRatio * node.triangleCount * settings.intersectionCost;
+				leafTriangleCount += node.triangleCount;
+				continue;
+			}
+
+			stats.sahCost += areaRatio * settings.traversalCost;
+
+			stack.emplace_back(node.childA, depth + 1);
+			stack.emplace_back(node.childB, depth + 1);
+		}
+
+		stats.averageLeafTriangles = stats.leafCount > 0 ? static_cast<float>(leafTriangleCount) / stats.leafCount : 0.0f;
+
+		return stats;
 	}
 
 	bool Raycast::BVHBoundingBoxLineIntersect(const BVHBoundingBox& box, const Ray& ray) {
@@ -168,80 +384,262 @@ namespace flaw {
 		return true;
 	}
 
-	bool Raycast::RayCastBVHImpl(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const int32_t current, const Ray& ray, RayHit& hit) {
-		const auto& node = nodes[current];
+	BVHRay::BVHRay(const Ray& ray) {
+		const vec3 invDirection = 1.0f / ray.direction;
 
-		if (!BVHBoundingBoxLineIntersect(node.boundingBox, ray)) {
-			return false;
+		// the fourth lane repeats x, box tests load bounds the same way
+		for (int32_t i = 0; i < 4; ++i) {
+			origin[i] = ray.origin[i % 3];
+			direction[i] = ray.direction[i % 3];
+			this->invDirection[i] = invDirection[i % 3];
 		}
+	}
 
-		bool result = false;
+	static int32_t FlattenBVHNode(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, int32_t nodeIndex, FlatBVH& outBVH) {
+		const auto& node = nodes[nodeIndex];
+
+		const int32_t flatIndex = static_cast<int32_t>(outBVH.nodes.size());
+		outBVH.nodes.emplace_back();
+
+		BVHFlatNode flatNode;
+		flatNode.min = node.boundingBox.min;
+		flatNode.max = node.boundingBox.max;
 
 		if (node.IsLeaf()) {
-			for (int32_t i = 0; i < node.triangleCount; ++i) {
-				auto& tri = triangles[node.triangleStart + i];
-
-				vec3 hitPoint;
-				float t;
-				if (BVHTriangleLineIntersect(tri, ray, hitPoint, t)) {
-					if (t < hit.distance) {
-						hit.position = hitPoint;
-						hit.normal = tri.normal;
-						hit.distance = t;
-						result = true;
+			flatNode.offset = static_cast<int32_t>(outBVH.packs.size());
+
+			// an empty leaf still gets a pack so it is not mistaken for an interior node
+			int32_t packStart = 0;
+			do {
+				BVHTrianglePack pack = {};
+				for (int32_t lane = 0; lane < BVHTrianglePack::Width; ++lane) {
+					const int32_t localIndex = packStart + lane;
+					if (localIndex >= node.triangleCount) {
+						pack.triangleIndices[lane] = -1;
+						continue;
 					}
+
+					const int32_t triangleIndex = node.triangleStart + localIndex;
+					const auto& tri = triangles[triangleIndex];
+					const vec3 edge1 = tri.p1 - tri.p0;
+					const vec3 edge2 = tri.p2 - tri.p0;
+
+					for (int32_t axis = 0; axis < 3; ++axis) {
+						pack.p0[axis][lane] = tri.p0[axis];
+						pack.edge1[axis][lane] = edge1[axis];
+						pack.edge2[axis][lane] = edge2[axis];
+					}
+					pack.triangleIndices[lane] = triangleIndex;
 				}
-			}
+
+				outBVH.packs.push_back(pack);
+				flatNode.packCount++;
+
+				packStart += BVHTrianglePack::Width;
+			} while (packStart < node.triangleCount);
 		}
 		else {
-			RayHit leftHit = hit;
-			RayHit rightHit = hit;
+			FlattenBVHNode(nodes, triangles, node.childA, outBVH);
+			flatNode.offset = FlattenBVHNode(nodes, triangles, node.childB, outBVH);
+		}
 
-			bool leftResult = node.childA != -1 && RayCastBVHImpl(nodes, triangles, node.childA, ray, leftHit);
-			bool rightResult = node.childB != -1 && RayCastBVHImpl(nodes, triangles, node.childB, ray, rightHit);
+		outBVH.nodes[flatIndex] = flatNode;
 
-			if (leftResult && rightResult) {
-				hit = (leftHit.distance < rightHit.distance) ? leftHit : rightHit;
-				result = true;
-			}
-			else if (leftResult) {
-				hit = leftHit;
-				result = true;
-			}
-			else if (rightResult) {
-				hit = rightHit;
-				result = true;
-			}
+		return flatIndex;
+	}
+
+	void Raycast::FlattenBVH(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, FlatBVH& outBVH) {
+		outBVH.nodes.clear();
+		outBVH.packs.clear();
+
+		if (nodes.empty()) {
+			return;
 		}
 
-		return result;
+		outBVH.nodes.reserve(nodes.size());
+		outBVH.packs.reserve(triangles.size() / BVHTrianglePack::Width + 1);
+
+		FlattenBVHNode(nodes, triangles, 0, outBVH);
 	}
 
-	bool Raycast::RaycastBVH(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, RayHit& hit) {
-		return RayCastBVHImpl(nodes, triangles, 0, ray, hit);
+#ifdef FLAW_RAYCAST_SSE
+	static float HorizontalMax(__m128 value) {
+		value = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+		value = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(value);
 	}
 
-	void Raycast::GetCandidateBVHTrianglesImpl(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, int32_t current, const std::function<void(int32_t, int32_t)>& callback) {
-		const auto& node = nodes[current];
+	static float HorizontalMin(__m128 value) {
+		value = _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+		value = _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(value);
+	}
 
-		if (!BVHBoundingBoxLineIntersect(node.boundingBox, ray)) {
-			return;
-		}
+	// x, y and z of a bound in the first three lanes, the fourth repeats x
+	static __m128 LoadBound(const vec3& bound) {
+		const __m128 value = _mm_loadu_ps(&bound.x); // the fourth float is the next member of the node
+		return _mm_shuffle_ps(value, value, _MM_SHUFFLE(0, 2, 1, 0));
+	}
 
-		if (node.IsLeaf()) {
-			callback(node.triangleStart, node.triangleCount);
+	static bool IntersectFlatNode(const BVHFlatNode& node, __m128 origin, __m128 invDirection, float maxDistance, float& outEntryDistance) {
+		const __m128 t0 = _mm_mul_ps(_mm_sub_ps(LoadBound(node.min), origin), invDirection);
+		const __m128 t1 = _mm_mul_ps(_mm_sub_ps(LoadBound(node.max), origin), invDirection);
+
+		// 0 * inf lanes belong to an axis the ray runs along on one of its planes, they must not limit the interval
+		const __m128 unordered = _mm_cmpunord_ps(t0, t1);
+		const __m128 tNear = _mm_or_ps(_mm_andnot_ps(unordered, _mm_min_ps(t0, t1)), _mm_and_ps(unordered, _mm_set1_ps(-std::numeric_limits<float>::infinity())));
+		const __m128 tFar = _mm_or_ps(_mm_andnot_ps(unordered, _mm_max_ps(t0, t1)), _mm_and_ps(unordered, _mm_set1_ps(std::numeric_limits<float>::infinity())));
+
+		const float entry = std::max(HorizontalMax(tNear), 0.0f);
+		const float exit = std::min(HorizontalMin(tFar), maxDistance);
+
+		outEntryDistance = entry;
+		return entry <= exit;
+	}
+#else
+	static bool IntersectFlatNode(const BVHFlatNode& node, const BVHRay& ray, float maxDistance, float& outEntryDistance) {
+		float entry = 0.0f;
+		float exit = maxDistance;
+
+		for (int32_t axis = 0; axis < 3; ++axis) {
+			const float t0 = (node.min[axis] - ray.origin[axis]) * ray.invDirection[axis];
+			const float t1 = (node.max[axis] - ray.origin[axis]) * ray.invDirection[axis];
+			if (std::isnan(t0) || std::isnan(t1)) {
+				continue; // 0 * inf, the ray runs along this axis on one of its planes
+			}
+
+			entry = std::max(entry, std::min(t0, t1));
+			exit = std::min(exit, std::max(t0, t1));
 		}
-		else {
-			if (node.childA != -1) {
-				GetCandidateBVHTrianglesImpl(nodes, triangles, ray, node.childA, callback);
+
+		outEntryDistance = entry;
+		return entry <= exit;
+	}
+#endif
+
+	int32_t Raycast::IntersectBVHChildren(const BVHFlatNode& childA, const BVHFlatNode& childB, const BVHRay& ray, float maxDistance, float outEntryDistances[2]) {
+#ifdef FLAW_RAYCAST_SSE
+		const __m128 origin = _mm_load_ps(ray.origin);
+		const __m128 invDirection = _mm_load_ps(ray.invDirection);
+
+		const bool hitA = IntersectFlatNode(childA, origin, invDirection, maxDistance, outEntryDistances[0]);
+		const bool hitB = IntersectFlatNode(childB, origin, invDirection, maxDistance, outEntryDistances[1]);
+#else
+		const bool hitA = IntersectFlatNode(childA, ray, maxDistance, outEntryDistances[0]);
+		const bool hitB = IntersectFlatNode(childB, ray, maxDistance, outEntryDistances[1]);
+#endif
+		return (hitA ? 1 : 0) | (hitB ? 2 : 0);
+	}
+
+	// moller trumbore on every lane, unused lanes have zero edges and fail the determinant test
+	int32_t Raycast::IntersectBVHTrianglePack(const BVHTrianglePack& pack, const BVHRay& ray, float maxDistance, float outDistances[4], float outU[4], float outV[4]) {
+		constexpr float Epsilon = 1e-6f;
+
+#ifdef FLAW_RAYCAST_SSE
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		const __m128 dx = _mm_set1_ps(ray.direction[0]);
+		const __m128 dy = _mm_set1_ps(ray.direction[1]);
+		const __m128 dz = _mm_set1_ps(ray.direction[2]);
+
+		const __m128 e1x = _mm_load_ps(pack.edge1[0]);
+		const __m128 e1y = _mm_load_ps(pack.edge1[1]);
+		const __m128 e1z = _mm_load_ps(pack.edge1[2]);
+		const __m128 e2x = _mm_load_ps(pack.edge2[0]);
+		const __m128 e2y = _mm_load_ps(pack.edge2[1]);
+		const __m128 e2z = _mm_load_ps(pack.edge2[2]);
+
+		// h = direction x edge2
+		const __m128 hx = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		const __m128 hy = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		const __m128 hz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+		const __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, hx), _mm_mul_ps(e1y, hy)), _mm_mul_ps(e1z, hz));
+		const __m128 absA = _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+		__m128 mask = _mm_cmpgt_ps(absA, _mm_set1_ps(Epsilon));
+
+		const __m128 f = _mm_div_ps(one, _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, one))); // parallel lanes divide by one
+
+		// s = origin - p0
+		const __m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin[0]), _mm_load_ps(pack.p0[0]));
+		const __m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin[1]), _mm_load_ps(pack.p0[1]));
+		const __m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin[2]), _mm_load_ps(pack.p0[2]));
+
+		const __m128 u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, hx), _mm_mul_ps(sy, hy)), _mm_mul_ps(sz, hz)));
+		mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+
+		// q = s x edge1
+		const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+		const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+		const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+		const __m128 v = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+		mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+
+		const __m128 t = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)));
+		mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmple_ps(t, _mm_set1_ps(maxDistance))));
+
+		_mm_storeu_ps(outDistances, t);
+		_mm_storeu_ps(outU, u);
+		_mm_storeu_ps(outV, v);
+
+		return _mm_movemask_ps(mask);
+#else
+		int32_t mask = 0;
+
+		for (int32_t lane = 0; lane < BVHTrianglePack::Width; ++lane) {
+			const vec3 direction(ray.direction[0], ray.direction[1], ray.direction[2]);
+			const vec3 edge1(pack.edge1[0][lane], pack.edge1[1][lane], pack.edge1[2][lane]);
+			const vec3 edge2(pack.edge2[0][lane], pack.edge2[1][lane], pack.edge2[2][lane]);
+
+			const vec3 h = cross(direction, edge2);
+			const float a = dot(edge1, h);
+			if (fabs(a) <= Epsilon) {
+				continue;
+			}
+
+			const float f = 1.0f / a;
+			const vec3 s = vec3(ray.origin[0], ray.origin[1], ray.origin[2]) - vec3(pack.p0[0][lane], pack.p0[1][lane], pack.p0[2][lane]);
+			const float u = f * dot(s, h);
+			if (u < 0.0f || u > 1.0f) {
+				continue;
 			}
-			if (node.childB != -1) {
-				GetCandidateBVHTrianglesImpl(nodes, triangles, ray, node.childB, callback);
+
+			const vec3 q = cross(s, edge1);
+			const float v = f * dot(direction, q);
+			if (v < 0.0f || u + v > 1.0f) {
+				continue;
 			}
+
+			const float t = f * dot(edge2, q);
+			if (t < 0.0f || t > maxDistance) {
+				continue;
+			}
+
+			outDistances[lane] = t;
+			outU[lane] = u;
+			outV[lane] = v;
+			mask |= 1 << lane;
 		}
+
+		return mask;
+#endif
 	}
 
-	void Raycast::GetCandidateBVHTriangles(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, const std::function<void(int32_t, int32_t)>& callback) {
-		GetCandidateBVHTrianglesImpl(nodes, triangles, ray, 0, callback);
+	bool Raycast::RaycastBVH(const FlatBVH& bvh, const std::vector<BVHTriangle>& triangles, const Ray& ray, RayHit& hit) {
+		Ray boundedRay = ray;
+		boundedRay.length = std::min(ray.length, hit.distance);
+
+		bool result = false;
+		TraverseBVH(bvh, boundedRay, [&](int32_t triangleIndex, float distance, const vec2&) {
+			hit.position = ray.origin + ray.direction * distance;
+			hit.normal = triangles[triangleIndex].normal;
+			hit.distance = distance;
+			result = true;
+			return distance;
+		});
+
+		return result;
 	}
-}
\ No newline at end of file
+}
@@ -5,7 +5,7 @@
 #include <functional>
 
 namespace flaw {
-	constexpr int32_t MaxBVHDepth = 3;
+	class JobSystem;
 
 	struct Ray {
 		vec3 origin;
@@ -24,6 +24,7 @@ namespace flaw {
 		vec3 center;
 		vec3 normal;
 
+		BVHTriangle() = default;
 		BVHTriangle(const vec3& p0, const vec3& p1, const vec3& p2);
 	};
 
@@ -46,20 +47,273 @@ namespace flaw {
 		bool IsLeaf() const { return childA == -1 && childB == -1; }
 	};
 
+	template<>
+	struct Serializer<BVHTriangle> {
+		static void Serialize(SerializationArchive& archive, const BVHTriangle& value) {
+			archive << value.p0 << value.p1 << value.p2;
+		}
+
+		static void Deserialize(SerializationArchive& archive, BVHTriangle& value) {
+			vec3 p0, p1, p2;
+			archive >> p0 >> p1 >> p2;
+			value = BVHTriangle(p0, p1, p2);
+		}
+	};
+
+	template<>
+	struct Serializer<BVHNode> {
+		static void Serialize(SerializationArchive& archive, const BVHNode& value) {
+			archive << value.boundingBox.min << value.boundingBox.max;
+			archive << value.triangleStart << value.triangleCount;
+			archive << value.childA << value.childB;
+		}
+
+		static void Deserialize(SerializationArchive& archive, BVHNode& value) {
+			archive >> value.boundingBox.min >> value.boundingBox.max;
+			archive >> value.triangleStart >> value.triangleCount;
+			archive >> value.childA >> value.childB;
+			value.boundingBox.center = (value.boundingBox.min + value.boundingBox.max) * 0.5f;
+		}
+	};
+
+	constexpr int32_t MaxBVHBinCount = 64;
+
+	enum class BVHSplitMethod : uint8_t {
+		Midpoint,	// center of the longest axis, cheap to build
+		BinnedSAH,	// surface area heuristic evaluated at bin boundaries on every axis
+	};
+
+	struct BVHBuildSettings {
+		BVHSplitMethod splitMethod = BVHSplitMethod::BinnedSAH;
+		int32_t maxDepth = 32;				// clamped to Raycast::MaxTraversalDepth by the builder
+		int32_t maxLeafTriangles = 4;		// larger nodes are split whenever their triangles can be separated
+		int32_t binCount = 16; // up to MaxBVHBinCount
+
+		// sah costs, relative to each other
+		float traversalCost = 1.0f;
+		float intersectionCost = 1.0f;
+
+		// nodes with at least this many triangles build their children on the job system when one is given
+		JobSystem* jobSystem = nullptr;
+		int32_t parallelTriangleCount = 4096;
+	};
+
+	struct BVHBuildStats {
+		int32_t nodeCount = 0;
+		int32_t leafCount = 0;
+		int32_t maxDepth = 0;
+		int32_t maxLeafTriangles = 0;
+		float averageLeafTriangles = 0.0f;
+		float sahCost = 0.0f; // expected traversal cost of a ray hitting the root, lower is better
+	};
+
+	// traversal layout of a bvh, the first child of an interior node directly follows it
+	struct BVHFlatNode {
+		vec3 min;
+		int32_t offset = 0;		// leaf: first triangle pack, interior: second child
+		vec3 max;
+		int32_t packCount = 0;	// 0 for interior nodes
+
+		bool IsLeaf() const { return packCount != 0; }
+	};
+
+	// triangles of a leaf four at a time in soa form, unused lanes have an index of -1 and never hit
+	struct alignas(16) BVHTrianglePack {
+		static constexpr int32_t Width = 4;
+
+		float p0[3][Width];
+		float edge1[3][Width];
+		float edge2[3][Width];
+		int32_t triangleIndices[Width];
+	};
+
+	struct FlatBVH {
+		std::vector<BVHFlatNode> nodes;
+		std::vector<BVHTrianglePack> packs;
+
+		bool Empty() const { return nodes.empty(); }
+	};
+
+	// ray in the form the intersection kernels read it
+	struct alignas(16) BVHRay {
+		float origin[4];
+		float direction[4];
+		float invDirection[4];
+
+		BVHRay(const Ray& ray);
+	};
+
 	class Raycast {
 	public:
-		static void BuildBVH(const std::function<vec3(int32_t)>& getVertex, int32_t vertexCount, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles);
+		static constexpr int32_t MaxTraversalDepth = 64;
+
+		// outTriangleIndices receives the source triangle of every bvh triangle, triangles are reordered into leaf order
+		static void BuildBVH(const std::function<vec3(int32_t)>& getVertex, int32_t vertexCount, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles, const BVHBuildSettings& settings = BVHBuildSettings(), BVHBuildStats* outStats = nullptr, std::vector<int32_t>* outTriangleIndices = nullptr);
+
+		// quality metrics of any bvh, costs use the given settings so builders can be compared with the same weights
+		static BVHBuildStats EvaluateBVH(const std::vector<BVHNode>& nodes, const BVHBuildSettings& settings = BVHBuildSettings());
 	
 		static bool BVHBoundingBoxLineIntersect(const BVHBoundingBox& box, const Ray& ray);
 		static bool BVHTriangleLineIntersect(const BVHTriangle& tri, const Ray& ray, vec3& outPos, float& outT);
 
-		static bool RaycastBVH(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, RayHit& hit);
+		static void FlattenBVH(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, FlatBVH& outBVH);
 
-		static void GetCandidateBVHTriangles(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, const std::function<void(int32_t, int32_t)>& callback);
-	
-	private:
-		static bool RayCastBVHImpl(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const int32_t current, const Ray& ray, RayHit& hit);
-	
-		static void GetCandidateBVHTrianglesImpl(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, int32_t current, const std::function<void(int32_t, int32_t)>& callback);
+		// handler(triangleIndex, distance, barycentric) returns the new max distance of the ray, return 0 to stop and the current max distance to keep going
+		// children are visited nearest first and skipped once they start beyond the max distance
+		template<typename HitHandler>
+		static void TraverseBVH(const FlatBVH& bvh, const Ray& ray, HitHandler&& handler);
+
+		// closest hit
+		static bool RaycastBVH(const FlatBVH& bvh, const std::vector<BVHTriangle>& triangles, const Ray& ray, RayHit& hit);
+
+		// callback(triangleStart, triangleCount) for every leaf the ray passes through
+		template<typename Func>
+		static void GetCandidateBVHTriangles(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, const Func& callback);
+
+		// kernels of TraverseBVH, lanes that hit set their bit in the returned mask
+		static int32_t IntersectBVHChildren(const BVHFlatNode& childA, const BVHFlatNode& childB, const BVHRay& ray, float maxDistance, float outEntryDistances[2]);
+		static int32_t IntersectBVHTrianglePack(const BVHTrianglePack& pack, const BVHRay& ray, float maxDistance, float outDistances[4], float outU[4], float outV[4]);
 	};
+
+	static_assert(BVHBuildSettings().maxDepth <= Raycast::MaxTraversalDepth, "built trees have to fit the traversal stack");
+
+	template<typename HitHandler>
+	void Raycast::TraverseBVH(const FlatBVH& bvh, const Ray& ray, HitHandler&& handler) {
+		if (bvh.Empty()) {
+			return;
+		}
+
+		struct StackEntry {
+			int32_t node;
+			float entryDistance;
+		};
+
+		const BVHRay bvhRay(ray);
+		float maxDistance = ray.length;
+
+		// the root is tested like a child so a ray missing the mesh stops here
+		float rootEntry[2];
+		if (!(IntersectBVHChildren(bvh.nodes[0], bvh.nodes[0], bvhRay, maxDistance, rootEntry) & 1)) {
+			return;
+		}
+
+		// built trees never defer more than MaxTraversalDepth children, deeper ones loaded from elsewhere spill to the heap
+		StackEntry stack[MaxTraversalDepth];
+		int32_t stackSize = 0;
+		std::vector<StackEntry> overflowStack;
+		int32_t current = 0;
+
+		while (true) {
+			const BVHFlatNode& node = bvh.nodes[current];
+
+			if (node.IsLeaf()) {
+				for (int32_t packIndex = node.offset; packIndex < node.offset + node.packCount; ++packIndex) {
+					const BVHTrianglePack& pack = bvh.packs[packIndex];
+
+					float distances[4], u[4], v[4];
+					const int32_t mask = IntersectBVHTrianglePack(pack, bvhRay, maxDistance, distances, u, v);
+					for (int32_t lane = 0; lane < BVHTrianglePack::Width; ++lane) {
+						if (!(mask & (1 << lane)) || distances[lane] > maxDistance) {
+							continue; // missed, or an earlier lane shortened the ray
+						}
+
+						maxDistance = handler(pack.triangleIndices[lane], distances[lane], vec2(u[lane], v[lane]));
+						if (maxDistance <= 0.0f) {
+							return;
+						}
+					}
+				}
+			}
+			else {
+				const int32_t childA = current + 1;
+				const int32_t childB = node.offset;
+
+				float entry[2];
+				const int32_t mask = IntersectBVHChildren(bvh.nodes[childA], bvh.nodes[childB], bvhRay, maxDistance, entry);
+
+				if (mask == 3) {
+					// one deferred child per level
+					const bool aFirst = entry[0] <= entry[1];
+					const StackEntry deferred = aFirst ? StackEntry{ childB, entry[1] } : StackEntry{ childA, entry[0] };
+					if (stackSize < MaxTraversalDepth) {
+						stack[stackSize++] = deferred;
+					}
+					else {
+						overflowStack.push_back(deferred);
+					}
+					current = aFirst ? childA : childB;
+					continue;
+				}
+
+				if (mask != 0) {
+					current = mask == 1 ? childA : childB;
+					continue;
+				}
+			}
+
+			// farther children pushed earlier may now start beyond the shortened ray
+			current = -1;
+			while (!overflowStack.empty() || stackSize > 0) {
+				StackEntry deferred;
+				if (!overflowStack.empty()) {
+					deferred = overflowStack.back();
+					overflowStack.pop_back();
+				}
+				else {
+					deferred = stack[--stackSize];
+				}
+
+				if (deferred.entryDistance <= maxDistance) {
+					current = deferred.node;
+					break;
+				}
+			}
+
+			if (current == -1) {
+				return;
+			}
+		}
+	}
+
+	template<typename Func>
+	void Raycast::GetCandidateBVHTriangles(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>&, const Ray& ray, const Func& callback) {
+		if (nodes.empty()) {
+			return;
+		}
+
+		// both children are pushed, a tree within MaxTraversalDepth never needs more than one slot per level plus one
+		int32_t stack[MaxTraversalDepth * 2];
+		int32_t stackSize = 0;
+		std::vector<int32_t> overflowStack;
+		stack[stackSize++] = 0;
+
+		while (!overflowStack.empty() || stackSize > 0) {
+			int32_t nodeIndex;
+			if (!overflowStack.empty()) {
+				nodeIndex = overflowStack.back();
+				overflowStack.pop_back();
+			}
+			else {
+				nodeIndex = stack[--stackSize];
+			}
+
+			const auto& node = nodes[nodeIndex];
+
+			if (!BVHBoundingBoxLineIntersect(node.boundingBox, ray)) {
+				continue;
+			}
+
+			if (node.IsLeaf()) {
+				callback(node.triangleStart, node.triangleCount);
+			}
+			else if (overflowStack.empty() && stackSize + 2 <= MaxTraversalDepth * 2) {
+				stack[stackSize++] = node.childB;
+				stack[stackSize++] = node.childA;
+			}
+			else {
+				overflowStack.push_back(node.childB);
+				overflowStack.push_back(node.childA);
+			}
+		}
+	}
 }
\ No newline at end of file
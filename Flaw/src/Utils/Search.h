@@ -3,11 +3,10 @@
 #include "Core.h"
 
 #include <vector>
-#include <functional>
 
 namespace flaw {
-	template<typename T>
-	inline int32_t BinarySearch(const std::vector<T>& data, const std::function<int32_t(const T&)>& predicate) {
+	template<typename T, typename Predicate>
+	inline int32_t BinarySearch(const std::vector<T>& data, const Predicate& predicate) {
 		int32_t left = 0;
 		int32_t right = static_cast<int32_t>(data.size()) - 1;
 
@@ -46,11 +45,9 @@ namespace flaw {
 		return left;
 	}
 
-	template<typename T>
-	inline int32_t Lowerbound(const std::vector<T>& data, const std::function<bool(const T&)>& predicate) {
-		int32_t left = 0;
-		int32_t right = static_cast<int32_t>(data.size());
-
+	// first index in [left, right) where predicate becomes true
+	template<typename T, typename Predicate>
+	inline int32_t Lowerbound(const std::vector<T>& data, int32_t left, int32_t right, const Predicate& predicate) {
 		while (left < right) {
 			int32_t mid = left + (right - left) / 2;
 			if (predicate(data[mid])) {
@@ -64,6 +61,11 @@ namespace flaw {
 		return left;
 	}
 
+	template<typename T, typename Predicate>
+	inline int32_t Lowerbound(const std::vector<T>& data, const Predicate& predicate) {
+		return Lowerbound(data, 0, static_cast<int32_t>(data.size()), predicate);
+	}
+
 	template<typename T>
 	inline int32_t Upperbound(const std::vector<T>& data, const T& value) {
 		int32_t left = 0;
@@ -82,8 +84,8 @@ namespace flaw {
 		return left;
 	}
 
-	template<typename T>
-	inline int32_t Upperbound(const std::vector<T>& data, const std::function<bool(const T&)>& predicate) {
+	template<typename T, typename Predicate>
+	inline int32_t Upperbound(const std::vector<T>& data, const Predicate& predicate) {
 		int32_t left = 0;
 		int32_t right = static_cast<int32_t>(data.size());
 		while (left < right) {
@@ -4,6 +4,10 @@
 
 #include <vector>
 #include <unordered_map>
+#include <fstream>
+#include <limits>
+#include <cstring>
+#include <stdexcept>
 
 namespace flaw {
 	class SerializationArchive;
@@ -14,28 +18,41 @@ namespace flaw {
 		static void Deserialize(SerializationArchive& archive, T& value) {}
 	};
 
+	// types whose memory matches what their Serializer writes field by field, values and vectors of them are copied as raw bytes
+	// specializations need to be trivially copyable without padding
+	template <typename T>
+	struct IsTriviallySerializable : std::bool_constant<std::is_arithmetic_v<T>> {};
+
 	class SerializationArchive {
 	public:
+		// bytes written to a stream are flushed to the file once this much is buffered
+		static constexpr uint64_t StreamChunkSize = 4 * 1024 * 1024;
+
 		SerializationArchive() = default;
-		SerializationArchive(const int8_t* data, const uint64_t size) {
-			_buffer.resize(size);
-			std::memcpy(_buffer.data(), data, size);
+		SerializationArchive(const int8_t* data, const uint64_t size)
+			: _buffer(data, data + size)
+		{
+		}
+
+		// read only archive over memory of the caller, e.g. a MappedFile, which has to outlive it
+		static SerializationArchive View(const int8_t* data, const uint64_t size) {
+			SerializationArchive archive;
+			archive._view = data;
+			archive._viewSize = size;
+			return archive;
 		}
 
 		// ⺻ Ÿ ȭ
 		template<typename T>
 		typename std::enable_if<std::is_arithmetic_v<T>, SerializationArchive&>::type operator<<(const T& value) {
-			uint32_t oldSize = _buffer.size();
-			_buffer.resize(oldSize + sizeof(T));
-			std::memcpy(_buffer.data() + oldSize, &value, sizeof(T));
+			Write(&value, sizeof(T));
 			return *this;
 		}
 
 		// ⺻ Ÿ ȭ
 		template<typename T>
 		typename std::enable_if<std::is_arithmetic_v<T>, SerializationArchive&>::type operator>>(T& value) {
-			std::memcpy(&value, _buffer.data() + _offset, sizeof(T));
-			_offset += sizeof(T);
+			Read(&value, sizeof(T));
 			return *this;
 		}
 
@@ -47,7 +64,13 @@ namespace flaw {
 			!std::is_enum_v<T>,
 			SerializationArchive&>::type operator<<(const T& value) 
 		{
-			Serializer<T>::Serialize(*this, value);
+			if constexpr (IsTriviallySerializable<T>::value) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				Write(&value, sizeof(T));
+			}
+			else {
+				Serializer<T>::Serialize(*this, value);
+			}
 			return *this;
 		}
 
@@ -59,7 +82,13 @@ namespace flaw {
 			!std::is_enum_v<T>,
 			SerializationArchive&>::type operator>>(T& value) 
 		{
-			Serializer<T>::Deserialize(*this, value);
+			if constexpr (IsTriviallySerializable<T>::value) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				Read(&value, sizeof(T));
+			}
+			else {
+				Serializer<T>::Deserialize(*this, value);
+			}
 			return *this;
 		}
 
@@ -80,31 +109,25 @@ namespace flaw {
 		}
 
 		SerializationArchive& operator<<(const std::string& value) {
-			uint32_t size = value.size();
-			*this << size;
-			uint32_t oldSize = _buffer.size();
-			_buffer.resize(oldSize + size);
-			std::memcpy(_buffer.data() + oldSize, value.data(), size);
+			const uint32_t size = WriteCount(value.size());
+			Write(value.data(), size);
 			return *this;
 		}
 
 		SerializationArchive& operator>>(std::string& value) {
 			uint32_t size;
 			*this >> size;
-			value = std::string((char*)_buffer.data() + _offset, size);
-			_offset += size;
+			value = std::string((const char*)ReadBytes(size), size);
 			return *this;
 		}
 
 		template <typename T>
 		SerializationArchive& operator<<(const std::vector<T>& value) {
-			uint32_t size = value.size();
-			*this << size;
+			const uint32_t size = WriteCount(value.size());
 
-			if constexpr (std::is_arithmetic_v<T>) {
-				uint32_t oldSize = _buffer.size();
-				_buffer.resize(oldSize + sizeof(T) * size);
-				std::memcpy(_buffer.data() + oldSize, value.data(), sizeof(T) * size);
+			if constexpr (IsTriviallySerializable<T>::value) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				Write(value.data(), sizeof(T) * size);
 			}
 			else {
 				for (const auto& v : value) {
@@ -119,13 +142,15 @@ namespace flaw {
 		SerializationArchive& operator>>(std::vector<T>& value) {
 			uint32_t size;
 			*this >> size;
-			value.resize(size);
 
-			if constexpr (std::is_arithmetic_v<T>) {
-				std::memcpy(value.data(), _buffer.data() + _offset, sizeof(T) * size);
-				_offset += sizeof(T) * size;
+			if constexpr (IsTriviallySerializable<T>::value) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				const int8_t* bytes = ReadBytes(sizeof(T) * size); // checked before resizing so a broken count can not allocate
+				value.resize(size);
+				std::memcpy(static_cast<void*>(value.data()), bytes, sizeof(T) * size); // T may have member initializers, trivially copyable is enough
 			}
 			else {
+				value.resize(size);
 				for (auto& v : value) {
 					*this >> v;
 				}
@@ -136,8 +161,7 @@ namespace flaw {
 
 		template <typename TKey, typename TValue>
 		SerializationArchive& operator<<(const std::unordered_map<TKey, TValue>& value) {
-			uint32_t size = value.size();
-			*this << size;
+			WriteCount(value.size());
 			for (const auto& [key, val] : value) {
 				*this << key << val;
 			}
@@ -147,10 +171,6 @@ namespace flaw {
 
 		template <typename TKey, typename TValue>
 		SerializationArchive& operator>>(std::unordered_map<TKey, TValue>& value) {
-			if (RemainingSize() < sizeof(uint32_t)) {
-				throw std::runtime_error("Buffer underflow");
-			}
-
 			uint32_t size;
 			*this >> size;
 			for (uint32_t i = 0; i < size; i++) {
@@ -163,23 +183,101 @@ namespace flaw {
 			return *this;
 		}
 
-		void Consume(uint32_t size) { _offset += size; }
+		// written bytes go to the file from here on, including the ones already buffered
+		// Data and RemainingSize only cover what is not flushed yet
+		bool OpenStream(const char* path) {
+			_stream.open(path, std::ios::binary | std::ios::trunc);
+			if (!_stream.is_open()) {
+				return false;
+			}
+
+			FlushStream();
+			return true;
+		}
+
+		// false if any write to the file failed
+		bool CloseStream() {
+			FlushStream();
+			const bool succeeded = _stream.good();
+			_stream.close();
+			return succeeded;
+		}
+
+		void Consume(uint64_t size) { ReadBytes(size); }
 
-		void Append(const int8_t* buffer, uint32_t size) {
-			_buffer.insert(_buffer.end(), buffer, buffer + size);
+		void Append(const int8_t* buffer, uint64_t size) {
+			Write(buffer, size);
 		}
 
 		void Clear() {
 			_buffer.clear();
+			_view = nullptr;
+			_viewSize = 0;
 			_offset = 0;
 		}
 
-		const int8_t* Data() const { return (const int8_t*)_buffer.data(); }
-		uint32_t Offset() const { return _offset; }
-		uint32_t RemainingSize() const { return _buffer.size() - _offset; }
+		bool IsView() const { return _view != nullptr; }
+
+		const int8_t* Data() const { return _view ? _view : _buffer.data(); }
+		uint64_t Offset() const { return _offset; }
+		uint64_t RemainingSize() const { return Size() - _offset; }
+
+	private:
+		uint64_t Size() const { return _view ? _viewSize : _buffer.size(); }
+
+		// vector insert grows the capacity geometrically, one append per value stays amortized O(1)
+		void Write(const void* data, uint64_t size) {
+			if (_view) {
+				throw std::runtime_error("Write to a read only archive");
+			}
+
+			const int8_t* bytes = static_cast<const int8_t*>(data);
+			_buffer.insert(_buffer.end(), bytes, bytes + size);
+
+			if (_stream.is_open() && _buffer.size() >= StreamChunkSize) {
+				FlushStream();
+			}
+		}
+
+		// counts are stored as uint32, a larger container could not be read back
+		uint32_t WriteCount(uint64_t count) {
+			if (count > std::numeric_limits<uint32_t>::max()) {
+				throw std::runtime_error("Container too large to serialize");
+			}
+
+			const uint32_t count32 = static_cast<uint32_t>(count);
+			*this << count32;
+			return count32;
+		}
+
+		const int8_t* ReadBytes(uint64_t size) {
+			if (RemainingSize() < size) {
+				throw std::runtime_error("Buffer underflow");
+			}
+
+			const int8_t* bytes = Data() + _offset;
+			_offset += size;
+			return bytes;
+		}
+
+		void Read(void* data, uint64_t size) {
+			std::memcpy(data, ReadBytes(size), size);
+		}
+
+		void FlushStream() {
+			// the capacity is kept, chunks after the first one do not allocate
+			_stream.write(reinterpret_cast<const char*>(_buffer.data()), _buffer.size());
+			_buffer.clear();
+		}
 
 	private:
 		std::vector<int8_t> _buffer;
-		uint32_t _offset = 0;
+
+		const int8_t* _view = nullptr;
+		uint64_t _viewSize = 0;
+
+		uint64_t _offset = 0;
+
+		std::ofstream _stream;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include "pch.h"
+#include "TopLevelBVH.h"
+
+#include <algorithm>
+#include <array>
+
+namespace flaw {
+	constexpr int32_t InstanceBinCount = 12;
+
+	TopLevelBVH::TopLevelBVH(float rebuildThreshold)
+		: _instanceCount(0)
+		, _rebuildThreshold(rebuildThreshold)
+		, _builtNodeArea(0.0f)
+		, _needsRebuild(false)
+		, _needsRefit(false)
+	{
+	}
+
+	int32_t TopLevelBVH::AddInstance(const Instance& instance) {
+		int32_t instanceId;
+		if (_freeSlots.empty()) {
+			instanceId = static_cast<int32_t>(_slots.size());
+			_slots.emplace_back();
+		}
+		else {
+			instanceId = _freeSlots.back();
+			_freeSlots.pop_back();
+		}
+
+		_slots[instanceId].instance = instance;
+		_slots[instanceId].active = true;
+		_instanceCount++;
+
+		_needsRebuild = true;
+
+		return instanceId;
+	}
+
+	void TopLevelBVH::UpdateInstance(int32_t instanceId, const Instance& instance) {
+		_slots[instanceId].instance = instance;
+		_needsRefit = true;
+	}
+
+	void TopLevelBVH::RemoveInstance(int32_t instanceId) {
+		_slots[instanceId].instance = Instance();
+		_slots[instanceId].active = false;
+		_freeSlots.push_back(instanceId);
+		_instanceCount--;
+
+		_needsRebuild = true;
+	}
+
+	void TopLevelBVH::Clear() {
+		_slots.clear();
+		_freeSlots.clear();
+		_instanceCount = 0;
+
+		_nodes.clear();
+		_leafInstances.clear();
+		_builtNodeArea = 0.0f;
+
+		_needsRebuild = false;
+		_needsRefit = false;
+	}
+
+	void TopLevelBVH::Update() {
+		if (_needsRebuild) {
+			Rebuild();
+		}
+		else if (_needsRefit) {
+			// refitting keeps the topology, moved instances may leave siblings far apart
+			Refit();
+			if (GetNodeArea() > _builtNodeArea * _rebuildThreshold) {
+				Rebuild();
+			}
+		}
+
+		_needsRebuild = false;
+		_needsRefit = false;
+	}
+
+	void TopLevelBVH::Rebuild() {
+		_nodes.clear();
+		_leafInstances.clear();
+
+		std::vector<vec3> centers(_slots.size());
+		for (int32_t i = 0; i < static_cast<int32_t>(_slots.size()); ++i) {
+			if (_slots[i].active) {
+				_leafInstances.push_back(i);
+				centers[i] = _slots[i].instance.bounds.GetCenter();
+			}
+		}
+
+		if (!_leafInstances.empty()) {
+			_nodes.reserve(_leafInstances.size() * 2);
+			BuildNode(centers, 0, static_cast<int32_t>(_leafInstances.size()), 0);
+		}
+
+		_builtNodeArea = GetNodeArea();
+	}
+
+	// nodes are stored depth first, a node is followed by its first child
+	int32_t TopLevelBVH::BuildNode(const std::vector<vec3>& centers, int32_t start, int32_t count, int32_t depth) {
+		const int32_t nodeIndex = static_cast<int32_t>(_nodes.size());
+		_nodes.emplace_back();
+
+		const vec3& firstCenter = centers[_leafInstances[start]];
+		AABB bounds = _slots[_leafInstances[start]].instance.bounds;
+		AABB centerBounds(firstCenter, firstCenter);
+		for (int32_t i = start + 1; i < start + count; ++i) {
+			const int32_t instanceId = _leafInstances[i];
+			bounds = AABB::Union(bounds, _slots[instanceId].instance.bounds);
+			centerBounds = AABB::Union(centerBounds, AABB(centers[instanceId], centers[instanceId]));
+		}
+
+		_nodes[nodeIndex].bounds = bounds;
+
+		if (count <= MaxLeafInstances || depth >= MaxDepth) {
+			_nodes[nodeIndex].offset = start;
+			_nodes[nodeIndex].count = count;
+			return nodeIndex;
+		}
+
+		// binned sah over instance centers
+		struct Bin {
+			AABB bounds;
+			int32_t count = 0;
+		};
+
+		int32_t splitAxis = -1;
+		float splitPosition = 0.0f;
+		float splitCost = std::numeric_limits<float>::max();
+
+		for (int32_t axis = 0; axis < 3; ++axis) {
+			const float axisMin = centerBounds.min[axis];
+			const float axisSize = centerBounds.max[axis] - axisMin;
+			if (axisSize <= 0.0f) {
+				continue;
+			}
+
+			const float binScale = InstanceBinCount / axisSize;
+
+			std::array<Bin, InstanceBinCount> bins;
+			for (int32_t i = start; i < start + count; ++i) {
+				const int32_t instanceId = _leafInstances[i];
+				const int32_t binIndex = std::min(static_cast<int32_t>((centers[instanceId][axis] - axisMin) * binScale), InstanceBinCount - 1);
+
+				Bin& bin = bins[binIndex];
+				bin.bounds = bin.count == 0 ? _slots[instanceId].instance.bounds : AABB::Union(bin.bounds, _slots[instanceId].instance.bounds);
+				bin.count++;
+			}
+
+			// costs[i] splits between bin i and i + 1
+			std::array<float, InstanceBinCount - 1> costs;
+
+			AABB leftBounds;
+			int32_t leftCount = 0;
+			for (int32_t i = 0; i < InstanceBinCount - 1; ++i) {
+				if (bins[i].count > 0) {
+					leftBounds = leftCount == 0 ? bins[i].bounds : AABB::Union(leftBounds, bins[i].bounds);
+					leftCount += bins[i].count;
+				}
+				costs[i] = leftCount * leftBounds.GetSurfaceArea();
+			}
+
+			AABB rightBounds;
+			int32_t rightCount = 0;
+			for (int32_t i = InstanceBinCount - 1; i > 0; --i) {
+				if (bins[i].count > 0) {
+					rightBounds = rightCount == 0 ? bins[i].bounds : AABB::Union(rightBounds, bins[i].bounds);
+					rightCount += bins[i].count;
+				}
+				costs[i - 1] += rightCount * rightBounds.GetSurfaceArea();
+			}
+
+			for (int32_t i = 0; i < InstanceBinCount - 1; ++i) {
+				if (costs[i] < splitCost) {
+					splitAxis = axis;
+					splitPosition = axisMin + (i + 1) / binScale;
+					splitCost = costs[i];
+				}
+			}
+		}
+
+		auto begin = _leafInstances.begin() + start;
+		auto end = begin + count;
+
+		int32_t countA = 0;
+		if (splitAxis != -1) {
+			auto middle = std::partition(begin, end, [&centers, splitAxis, splitPosition](int32_t instanceId) { return centers[instanceId][splitAxis] < splitPosition; });
+			countA = static_cast<int32_t>(middle - begin);
+		}
+
+		if (countA == 0 || countA == count) {
+			// every center on one side or on the same spot, halve along the longest axis
+			const vec3 size = centerBounds.max - centerBounds.min;
+			const int32_t axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+
+			countA = count / 2;
+			std::nth_element(begin, begin + countA, end, [&centers, axis](int32_t a, int32_t b) { return centers[a][axis] < centers[b][axis]; });
+		}
+
+		BuildNode(centers, start, countA, depth + 1);
+		const int32_t childB = BuildNode(centers, start + countA, count - countA, depth + 1);
+
+		_nodes[nodeIndex].offset = childB;
+
+		return nodeIndex;
+	}
+
+	void TopLevelBVH::Refit() {
+		// children always come after their parent, a reverse walk sees them first
+		for (int32_t i = static_cast<int32_t>(_nodes.size()) - 1; i >= 0; --i) {
+			Node& node = _nodes[i];
+
+			if (node.IsLeaf()) {
+				node.bounds = _slots[_leafInstances[node.offset]].instance.bounds;
+				for (int32_t j = node.offset + 1; j < node.offset + node.count; ++j) {
+					node.bounds = AABB::Union(node.bounds, _slots[_leafInstances[j]].instance.bounds);
+				}
+			}
+			else {
+				node.bounds = AABB::Union(_nodes[i + 1].bounds, _nodes[node.offset].bounds);
+			}
+		}
+	}
+
+	float TopLevelBVH::GetNodeArea() const {
+		float area = 0.0f;
+		for (const Node& node : _nodes) {
+			area += node.bounds.GetSurfaceArea();
+		}
+
+		return area;
+	}
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include "Core.h"
+#include "Math/Math.h"
+#include "Utils/Raycast.h"
+#include "Utils/DynamicAABBTree.h"
+
+#include <vector>
+
+namespace flaw {
+	// bvh over placed instances of bottom level mesh bvhs, built from tight world bounds
+	// instances can change at any time, Update refits the tree when only bounds moved and rebuilds it when instances were added or removed or refitting made it too loose
+	class TopLevelBVH {
+	public:
+		static constexpr int32_t MaxDepth = 48;
+		static constexpr int32_t MaxLeafInstances = 2;
+
+		struct Instance {
+			AABB bounds;						// world space
+			mat4 worldToLocal = mat4(1.0f);
+			const FlatBVH* bvh = nullptr;		// bottom level in local space, owned by the caller, may be null
+			uint32_t userData = 0;
+		};
+
+		// refits whose summed node area grows past rebuildThreshold times the built one rebuild the tree
+		TopLevelBVH(float rebuildThreshold = 1.5f);
+
+		int32_t AddInstance(const Instance& instance);
+		void UpdateInstance(int32_t instanceId, const Instance& instance);
+		void RemoveInstance(int32_t instanceId);
+
+		void Clear();
+
+		// queries see the tree of the last update, instance data is always current
+		void Update();
+
+		const Instance& GetInstance(int32_t instanceId) const { return _slots[instanceId].instance; }
+		uint32_t GetUserData(int32_t instanceId) const { return _slots[instanceId].instance.userData; }
+
+		int32_t GetInstanceCount() const { return _instanceCount; }
+		int32_t GetNodeCount() const { return static_cast<int32_t>(_nodes.size()); }
+
+		// func(instanceId) returns false to stop the query
+		template<typename Func>
+		void Query(const AABB& aabb, const Func& func) const;
+
+		template<typename Func>
+		void QuerySphere(const vec3& center, float radius, const Func& func) const;
+
+		// func(instanceId, distance) for every instance box the ray hits, nearer subtrees first
+		// returns the new max distance of the ray, return 0 to stop and the current max distance to keep going
+		template<typename Func>
+		void QueryRay(const Ray& ray, const Func& func) const;
+
+		// func(instanceId, triangleIndex, distance, barycentric) for triangles of the bottom level bvhs, same return value as QueryRay
+		template<typename Func>
+		void RaycastTriangles(const Ray& ray, const Func& func) const;
+
+	private:
+		struct Slot {
+			Instance instance;
+			bool active = false;
+		};
+
+		struct Node {
+			AABB bounds;
+			int32_t offset = 0;	// leaf: first entry of _leafInstances, interior: second child, the first one follows its parent
+			int32_t count = 0;	// instances of a leaf, 0 for interior nodes
+
+			bool IsLeaf() const { return count != 0; }
+		};
+
+		void Rebuild();
+		void Refit();
+		int32_t BuildNode(const std::vector<vec3>& centers, int32_t start, int32_t count, int32_t depth);
+
+		float GetNodeArea() const;
+
+	private:
+		std::vector<Slot> _slots;
+		std::vector<int32_t> _freeSlots;
+		int32_t _instanceCount;
+
+		std::vector<Node> _nodes;
+		std::vector<int32_t> _leafInstances;
+
+		float _rebuildThreshold;
+		float _builtNodeArea;
+
+		bool _needsRebuild;
+		bool _needsRefit;
+	};
+
+	template<typename Func>
+	void TopLevelBVH::Query(const AABB& aabb, const Func& func) const {
+		if (_nodes.empty()) {
+			return;
+		}
+
+		int32_t stack[MaxDepth * 2];
+		int32_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0) {
+			const int32_t nodeIndex = stack[--stackSize];
+			const Node& node = _nodes[nodeIndex];
+			if (!node.bounds.Overlaps(aabb)) {
+				continue;
+			}
+
+			if (node.IsLeaf()) {
+				for (int32_t i = node.offset; i < node.offset + node.count; ++i) {
+					const int32_t instanceId = _leafInstances[i];
+					if (_slots[instanceId].active && _slots[instanceId].instance.bounds.Overlaps(aabb) && !func(instanceId)) {
+						return;
+					}
+				}
+			}
+			else {
+				stack[stackSize++] = node.offset;
+				stack[stackSize++] = nodeIndex + 1;
+			}
+		}
+	}
+
+	template<typename Func>
+	void TopLevelBVH::QuerySphere(const vec3& center, float radius, const Func& func) const {
+		if (_nodes.empty()) {
+			return;
+		}
+
+		const float radiusSq = radius * radius;
+		auto overlaps = [&center, radiusSq](const AABB& bounds) {
+			const vec3 closest = clamp(center, bounds.min, bounds.max);
+			return length2(closest - center) <= radiusSq;
+		};
+
+		int32_t stack[MaxDepth * 2];
+		int32_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0) {
+			const int32_t nodeIndex = stack[--stackSize];
+			const Node& node = _nodes[nodeIndex];
+			if (!overlaps(node.bounds)) {
+				continue;
+			}
+
+			if (node.IsLeaf()) {
+				for (int32_t i = node.offset; i < node.offset + node.count; ++i) {
+					const int32_t instanceId = _leafInstances[i];
+					if (_slots[instanceId].active && overlaps(_slots[instanceId].instance.bounds) && !func(instanceId)) {
+						return;
+					}
+				}
+			}
+			else {
+				stack[stackSize++] = node.offset;
+				stack[stackSize++] = nodeIndex + 1;
+			}
+		}
+	}
+
+	template<typename Func>
+	void TopLevelBVH::QueryRay(const Ray& ray, const Func& func) const {
+		if (_nodes.empty()) {
+			return;
+		}
+
+		struct StackEntry {
+			int32_t node;
+			float entryDistance;
+		};
+
+		const vec3 invDirection = 1.0f / ray.direction;
+		float maxDistance = ray.length;
+
+		StackEntry stack[MaxDepth * 2];
+		int32_t stackSize = 0;
+
+		float rootEntry;
+		if (_nodes[0].bounds.IntersectRay(ray.origin, invDirection, maxDistance, rootEntry)) {
+			stack[stackSize++] = { 0, rootEntry };
+		}
+
+		while (stackSize > 0) {
+			const StackEntry entry = stack[--stackSize];
+			if (entry.entryDistance > maxDistance) {
+				continue; // a hit found after the push shortened the ray
+			}
+
+			const Node& node = _nodes[entry.node];
+
+			if (node.IsLeaf()) {
+				for (int32_t i = node.offset; i < node.offset + node.count; ++i) {
+					const int32_t instanceId = _leafInstances[i];
+					if (!_slots[instanceId].active) {
+						continue; // removed since the last update
+					}
+
+					float distance;
+					if (!_slots[instanceId].instance.bounds.IntersectRay(ray.origin, invDirection, maxDistance, distance)) {
+						continue;
+					}
+
+					maxDistance = func(instanceId, distance);
+					if (maxDistance <= 0.0f) {
+						return;
+					}
+				}
+				continue;
+			}
+
+			const int32_t childA = entry.node + 1;
+			const int32_t childB = node.offset;
+
+			float entryA, entryB;
+			const bool hitA = _nodes[childA].bounds.IntersectRay(ray.origin, invDirection, maxDistance, entryA);
+			const bool hitB = _nodes[childB].bounds.IntersectRay(ray.origin, invDirection, maxDistance, entryB);
+
+			// the nearer child is pushed last so it is popped first
+			if (hitA && hitB) {
+				if (entryA <= entryB) {
+					stack[stackSize++] = { childB, entryB };
+					stack[stackSize++] = { childA, entryA };
+				}
+				else {
+					stack[stackSize++] = { childA, entryA };
+					stack[stackSize++] = { childB, entryB };
+				}
+			}
+			else if (hitA) {
+				stack[stackSize++] = { childA, entryA };
+			}
+			else if (hitB) {
+				stack[stackSize++] = { childB, entryB };
+			}
+		}
+	}
+
+	template<typename Func>
+	void TopLevelBVH::RaycastTriangles(const Ray& ray, const Func& func) const {
+		float maxDistance = ray.length;
+
+		QueryRay(ray, [this, &ray, &func, &maxDistance](int32_t instanceId, float) {
+			const Instance& instance = _slots[instanceId].instance;
+			if (instance.bvh == nullptr) {
+				return maxDistance;
+			}
+
+			// the direction is not normalized in local space so distances along both rays are the same
+			Ray localRay;
+			localRay.origin = vec3(instance.worldToLocal * vec4(ray.origin, 1.0f));
+			localRay.direction = vec3(instance.worldToLocal * vec4(ray.direction, 0.0f));
+			localRay.length = maxDistance;
+
+			Raycast::TraverseBVH(*instance.bvh, localRay, [&](int32_t triangleIndex, float distance, const vec2& barycentric) {
+				maxDistance = func(instanceId, triangleIndex, distance, barycentric);
+				return maxDistance;
+			});
+
+			return maxDistance;
+		});
+	}
+}
@@ -9,4 +9,6 @@ workspace "Flaw"
     
     include "Flaw-Editor"
     
+    include "Flaw-Tests"
+    
     include "Flaw-ScriptCore"
\ No newline at end of file